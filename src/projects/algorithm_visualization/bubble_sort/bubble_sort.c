@@ -1,25 +1,42 @@
 #include "raylib.h"
+#include "sort_core.h"
+#include "sort_session.h"
+#include "step_scheduler.h"
+#include "bar_renderer.h"
+#include "dataset_loader.h"
+#include "frame_gate.h"
+#include "hud.h"
+#include "prof_overlay.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
+#endif
 
-#define NUM_BARS 15
+#define DEFAULT_BARS 15
+#define MAX_VALUE 600
+#define LOAD_BUDGET_MS 6.0    // dataset parsing per frame while a file loads
 
 // Declare globals
-int values[NUM_BARS];
-int i = 0, j = 0;
-int swapped = 0;
-bool sorted = false;
+SortSession session = {0};
+BubbleSort sorter;
+BarRenderer bars;
+Hud hud;
+HudText sortedText;
+FrameGate gate;     // nothing is redrawn once the array is sorted
+StepScheduler sched;
+int marked = -1;    // left index of the highlighted pair
+DatasetLoad load;   // a file streaming into the session; sorting waits for it
+int valueMin = 0, valueMax = MAX_VALUE;
 
 void UpdateDrawFrame(void);
-void BubbleSortStep(int *array, int length);
-void swap(int *a, int *b);
+void ResetArray(int numBars);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
@@ -28,93 +45,227 @@ int main(void)
 
     // Initialize with full screen size from the start
     InitWindow(GetMonitorWidth(0), GetMonitorHeight(0), "Full Window Raylib");
-    SetTargetFPS(60);
+#if !defined(PLATFORM_WEB)
+    SetTargetFPS(60);   // on the web requestAnimationFrame paces the loop; raylib's wait would busy-wait
+#endif
 
-    srand(time(NULL));
-    for (int i = 0; i < NUM_BARS; i++)
-        values[i] = rand() % 600;
+    BarRendererInit(&bars);
+    FrameGateInit(&gate);
+    HudInit(&hud);
+    HudAdd(&hud, &sortedText);
+    HudTextSet(&sortedText, "SORTED!", 40);
+    StepSchedulerInit(&sched, 60);     // one comparison per frame, as before
+    ResetArray(DEFAULT_BARS);
+    if (argc > 1)
+        DatasetLoadOpen(&load, argv[1]);    // native; the web build has no arguments
 
+#if defined(PLATFORM_WEB)
     emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
+#else
+    while (!WindowShouldClose())
+        UpdateDrawFrame();
+#endif
 
     // --------------------------------------------------------------------------------------
+    DatasetLoadStop(&load);
+    BarRendererUnload(&bars);
+    HudUnload(&hud);
     CloseWindow();
+    SortSessionFree(&session);
     // --------------------------------------------------------------------------------------
 
     return 0;
 }
 
-void UpdateDrawFrame(void)
+// Reuses the session arena; it only grows when numBars exceeds anything seen before
+void ResetArray(int numBars)
 {
-    BubbleSortStep(values, NUM_BARS);
-    BeginDrawing();
-    ClearBackground(BLACK);
+    DatasetLoadStop(&load);
+    SortSessionResize(&session, numBars);
+    GenerateValues(session.values, session.n, DIST_RANDOM, 0, MAX_VALUE, (uint64_t)time(NULL));
+    BubbleSortInit(&sorter, session.values, session.n);
+    StepSchedulerReset(&sched);
+    BarRendererTouch(&bars, 0, session.n - 1);
+    marked = -1;
+    valueMin = 0;
+    valueMax = MAX_VALUE;
+}
 
-    // Draw bars
-    for (int k = 0; k < NUM_BARS; k++)
+// Restarts the sort on the part of the dataset that is in the session by now
+static void UseLoadedData(void)
+{
+    if (session.n < 1)
     {
-        Color color = RAYWHITE;
-        if (k == j || k == j + 1)
-            color = RED;
+        if (!DatasetLoadBusy(&load))
+            ResetArray(DEFAULT_BARS);   // nothing readable in the file
+        return;
+    }
+    valueMin = load.parser.minValue < 0 ? load.parser.minValue : 0;
+    valueMax = load.parser.maxValue > valueMin ? load.parser.maxValue : valueMin + 1;
+    BubbleSortInit(&sorter, session.values, session.n);
+    StepSchedulerReset(&sched);
+    BarRendererTouch(&bars, 0, session.n - 1);
+    marked = -1;
+}
 
-        int barWidth = 800 / NUM_BARS;
-        int barHeight = values[k];
-        int x = k * barWidth;
-        int y = 600 - barHeight;
+static void UpdateLoad(void)
+{
+    int before = session.n;
+    DatasetLoadState was = load.state;
+    DatasetLoadUpdate(&load, &session, LOAD_BUDGET_MS);
+    if (load.state != was)
+        marked = -1;    // the session may have been reallocated
+    if (load.state == LOAD_FAILED)
+    {
+        printf("Cannot load %s\n", load.name);
+        ResetArray(DEFAULT_BARS);
+        load.state = LOAD_IDLE;
+        return;
+    }
+    if ((load.state == LOAD_READING || load.state == LOAD_DONE) && (session.n != before || load.state != was))
+        UseLoadedData();
+}
 
-        DrawRectangle(x, y, barWidth - 2, barHeight, color);
+static int64_t BubbleStepFn(void *ctx, int64_t maxSteps)
+{
+    return BubbleSortRun(ctx, maxSteps);
+}
 
-        // Draw value text on top of the bar
-        char text[8];
-        sprintf(text, "%d", values[k]);
+// Reports the elements the steps since jBefore/iBefore may have swapped: the rest of the
+// pass that was under way and the start of the next one
+static void TouchSteps(int iBefore, int jBefore)
+{
+    if (sorter.i == iBefore)
+        BarRendererTouch(&bars, jBefore, sorter.j);
+    else if (sorter.i == iBefore + 1)
+    {
+        BarRendererTouch(&bars, jBefore, session.n - 1);
+        BarRendererTouch(&bars, 0, sorter.j);
+    }
+    else
+        BarRendererTouch(&bars, 0, session.n - 1);
+}
 
-        int textWidth = MeasureText(text, 10);
-        DrawText(text, x + (barWidth - textWidth) / 2, y - 12, 10, RAYWHITE);
+static void MarkPair(int j)
+{
+    if (marked >= 0)
+    {
+        session.highlight[marked] = HL_NONE;
+        if (marked + 1 < session.n)
+            session.highlight[marked + 1] = HL_NONE;
+        BarRendererTouch(&bars, marked, marked + 1);
     }
+    marked = -1;
+    if (sorter.sorted || j + 1 >= session.n)
+        return;
 
-    if (sorted)
-        DrawText("SORTED!", 20, 20, 40, GREEN);
+    session.highlight[j] = HL_ACTIVE;
+    session.highlight[j + 1] = HL_ACTIVE;
+    BarRendererTouch(&bars, j, j + 1);
+    marked = j;
+}
 
-    EndDrawing();
+// Milliseconds since page navigation on the web, since InitWindow natively
+static double StartupClockMs(void)
+{
+#if defined(PLATFORM_WEB)
+    return emscripten_get_now();
+#else
+    return GetTime() * 1000.0;
+#endif
 }
 
-// instead of bubble sort we implmenet bubble sort step by step for visualization
-void BubbleSortStep(int *array, int length)
+void UpdateDrawFrame(void)
 {
-    if (sorted)
+    bool animating = !sorter.sorted || DatasetLoadBusy(&load) || PROF_OVERLAY_VISIBLE();
+    if (!FrameGateBegin(&gate, animating))
         return;
-
-    if (i < length - 1)
+    PROF_FRAME_BEGIN();
+#if defined(PLATFORM_WEB)
+    if (IsKeyPressed(KEY_O))
+        DatasetLoadOpen(&load, NULL);
+#else
+    if (IsFileDropped())
+    {
+        FilePathList dropped = LoadDroppedFiles();
+        if (dropped.count > 0 && !DatasetLoadOpen(&load, dropped.paths[0]))
+            printf("Cannot open %s\n", dropped.paths[0]);
+        UnloadDroppedFiles(dropped);
+    }
+#endif
+    if (DatasetLoadBusy(&load))
     {
-        if (j < length - i - 1)
+        // SPACE sorts the part that is already in
+        if (IsKeyPressed(KEY_SPACE))
         {
-            if (array[j] > array[j + 1])
-            {
-                // swap
-                swap(&array[j], &array[j + 1]);
-                swapped = 1;
-            }
-            (j)++;
+            DatasetLoadStop(&load);
+            if (load.state == LOAD_DONE)
+                UseLoadedData();
         }
         else
         {
-            if (swapped == 0)
-            {
-                sorted = true;
-                i = length;
-            }
-            j = 0;
-            (i)++;
+            PROF_SCOPE("load") UpdateLoad();
         }
     }
-    else
+    if (IsKeyPressed(KEY_UP))
+        ResetArray(session.n * 2);
+    if (IsKeyPressed(KEY_DOWN))
+        ResetArray(session.n / 2);
+    if (IsKeyPressed(KEY_R))
+        ResetArray(session.n);
+    if (IsKeyPressed(KEY_RIGHT_BRACKET))
+        StepSchedulerFaster(&sched);
+    if (IsKeyPressed(KEY_LEFT_BRACKET))
+        StepSchedulerSlower(&sched);
+
+    if (!DatasetLoadBusy(&load))
     {
-        sorted = true;
+        int iBefore = sorter.i, jBefore = sorter.j;
+        PROF_SCOPE("sort step") StepSchedulerRun(&sched, gate.frameTime, BubbleStepFn, &sorter);
+        TouchSteps(iBefore, jBefore);
     }
-}
+    MarkPair(sorter.j);
+    PROF_SCOPE("hud") HudUpdate(&hud);
+    PROF_OVERLAY_UPDATE();
 
-void swap(int *a, int *b)
-{
-    int temp = *a;
-    *a = *b;
-    *b = temp;
-}
\ No newline at end of file
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    int sw = GetScreenWidth();
+    int sh = GetScreenHeight();
+
+    // Draw bars
+    BarView view = {
+        .values = session.values,
+        .highlight = session.highlight,
+        .n = session.n,
+        .minValue = valueMin,
+        .maxValue = valueMax,
+        .rangeLo = 0, .rangeHi = -1,
+        .labels = true,
+        .tracked = !DatasetLoadBusy(&load),     // the session grows while a file loads
+        .colors = { RAYWHITE, RAYWHITE, RED, RAYWHITE },
+    };
+    PROF_SCOPE("bars") BarRendererDraw(&bars, &view, (Rectangle){ 0, 40, (float)sw, (float)(sh - 40) });
+
+    if (DatasetLoadBusy(&load))
+    {
+        Rectangle bar = { 20, 20, (float)(sw - 40), 8 };
+        DrawRectangleRec(bar, DARKGRAY);
+        DrawRectangleRec((Rectangle){ bar.x, bar.y, bar.width * DatasetLoadProgress(&load), bar.height }, SKYBLUE);
+    }
+    else if (sorter.sorted)
+        HudTextDraw(&sortedText, 20, 20, GREEN);
+
+    PROF_OVERLAY_DRAW(sw - 250, 50);
+    PROF_SCOPE("end drawing") EndDrawing();
+    PROF_FRAME_END();
+
+    // Startup cost as a visitor sees it: time to the first finished frame
+    static bool firstFrameReported = false;
+    if (!firstFrameReported)
+    {
+        printf("First frame at %.0f ms\n", StartupClockMs());
+        firstFrameReported = true;
+    }
+}
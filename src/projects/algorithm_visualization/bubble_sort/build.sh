@@ -1,6 +1,26 @@
-emcc bubble_sort.c -o index.html \
--I/home/c9der/raylib/src \
-/home/c9der/raylib/src/libraylib.web.a \
--s USE_GLFW=3 -s ASYNCIFY -s TOTAL_MEMORY=134217728 \
+# Usage: ./build.sh [release|size|profile|debug]
+#   release  -O3 with LTO and wasm SIMD (default)
+#   size     -Oz with LTO and wasm SIMD: the smallest download, for mobile
+#   profile  release plus the prof.h section timers (F2 overlay, F4 trace export)
+#   debug    -O0 with DWARF, a source map, runtime assertions and the section timers
+# No Asyncify: the program only runs from emscripten_set_main_loop and never blocks
+set -e
+case "${1:-release}" in
+    release) OPT="-O3 -flto" ;;
+    size) OPT="-Oz -flto" ;;
+    profile) OPT="-O3 -flto -DPROF_ENABLED" ;;
+    debug) OPT="-O0 -g -gsource-map -s ASSERTIONS=2 -DPROF_ENABLED" ;;
+    *) echo "usage: $0 [release|size|profile|debug]"; exit 1 ;;
+esac
+RAYLIB_SRC="${RAYLIB_SRC:-/home/c9der/raylib/src}"    # raylib/src with libraylib.web.a
+
+emcc bubble_sort.c ../sort_core/sort_bubble.c ../sort_core/sort_data.c ../sort_core/sort_session.c ../sort_core/sort_dataset.c ../sort_core/sort_trace.c ../sort_core/sort_cache.c ../sort_core/step_scheduler.c ../common/bar_renderer.c ../common/dataset_loader.c ../../raylib/common/hud.c ../../raylib/common/prof.c ../../raylib/common/prof_overlay.c ../../raylib/common/frame_gate.c -o index.html \
+-I../sort_core -I../common -I../../raylib/common \
+-I"$RAYLIB_SRC" \
+"$RAYLIB_SRC/libraylib.web.a" \
+$OPT -msimd128 \
+-s USE_GLFW=3 -s INITIAL_MEMORY=16777216 -s ALLOW_MEMORY_GROWTH=1 \
 -DPLATFORM_WEB --shell-file ./shell.html
 
+# Download size; the page prints its time to first frame in the console
+echo "index.wasm: $(wc -c < index.wasm) bytes, $(gzip -9c index.wasm | wc -c) gzipped"
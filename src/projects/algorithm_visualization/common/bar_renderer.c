@@ -0,0 +1,363 @@
+// bar_renderer.c
+#include "bar_renderer.h"
+#include "sort_session.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LABEL_FONT_SIZE 10
+#define LABEL_MIN_BAR_WIDTH 12
+#define LABEL_HEADROOM (LABEL_FONT_SIZE + 2)   // labels of full-height bars sit above the plot
+#define GAP_MIN_BAR_WIDTH 3
+#define MAX_COLUMN_HEIGHT 65535
+
+#if defined(PLATFORM_WEB)
+static const char *barFragmentShader =
+    "#version 100\n"
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 fragTexCoord;\n"
+    "varying vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform float plotHeight;\n"
+    "uniform float rows;\n"
+    "uniform vec4 color0;\n"
+    "uniform vec4 color1;\n"
+    "uniform vec4 color2;\n"
+    "uniform vec4 color3;\n"
+    "uniform vec4 spreadColor;\n"
+    "void main() {\n"
+    "    float lane = floor(fragTexCoord.y * rows * 0.5);\n"
+    "    float local = fragTexCoord.y * rows * 0.5 - lane;\n"
+    "    vec4 top = texture2D(texture0, vec2(fragTexCoord.x, (lane * 2.0 + 0.5) / rows));\n"
+    "    vec4 bot = texture2D(texture0, vec2(fragTexCoord.x, (lane * 2.0 + 1.5) / rows));\n"
+#else
+static const char *barFragmentShader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "out vec4 finalColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform float plotHeight;\n"
+    "uniform float rows;\n"
+    "uniform vec4 color0;\n"
+    "uniform vec4 color1;\n"
+    "uniform vec4 color2;\n"
+    "uniform vec4 color3;\n"
+    "uniform vec4 spreadColor;\n"
+    "void main() {\n"
+    "    float lane = floor(fragTexCoord.y * rows * 0.5);\n"
+    "    float local = fragTexCoord.y * rows * 0.5 - lane;\n"
+    "    vec4 top = texture(texture0, vec2(fragTexCoord.x, (lane * 2.0 + 0.5) / rows));\n"
+    "    vec4 bot = texture(texture0, vec2(fragTexCoord.x, (lane * 2.0 + 1.5) / rows));\n"
+#endif
+    "    float maxH = floor(top.r * 255.0 + 0.5) * 256.0 + floor(top.g * 255.0 + 0.5);\n"
+    "    float minH = floor(bot.r * 255.0 + 0.5) * 256.0 + floor(bot.g * 255.0 + 0.5);\n"
+    "    float y = (1.0 - local) * plotHeight;\n"
+    "    if (top.a < 0.5 || y >= maxH) discard;\n"
+    "    float code = floor(top.b * 255.0 + 0.5);\n"
+    "    vec4 c = color0;\n"
+    "    if (code == 1.0) c = color1;\n"
+    "    else if (code == 2.0) c = color2;\n"
+    "    else if (code == 3.0) c = color3;\n"
+    // Columns that stand for several elements show their min..max spread lighter
+    "    if (y >= minH) c = mix(c, spreadColor, 0.5);\n"
+#if defined(PLATFORM_WEB)
+    "    gl_FragColor = c * fragColor;\n"
+#else
+    "    finalColor = c * fragColor;\n"
+#endif
+    "}\n";
+
+// Which highlight wins when several elements share a pixel column
+static const unsigned char highlightPriority[4] = {
+    [HL_NONE] = 0, [HL_DONE] = 1, [HL_RANGE] = 2, [HL_ACTIVE] = 3
+};
+
+static void SetColorUniform(Shader shader, int loc, Color c) {
+    float v[4] = { c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+    SetShaderValue(shader, loc, v, SHADER_UNIFORM_VEC4);
+}
+
+void BarRendererInit(BarRenderer *r) {
+    *r = (BarRenderer){0};
+    r->shader = LoadShaderFromMemory(NULL, barFragmentShader);
+    r->locPlotHeight = GetShaderLocation(r->shader, "plotHeight");
+    r->locRows = GetShaderLocation(r->shader, "rows");
+    r->locColors[0] = GetShaderLocation(r->shader, "color0");
+    r->locColors[1] = GetShaderLocation(r->shader, "color1");
+    r->locColors[2] = GetShaderLocation(r->shader, "color2");
+    r->locColors[3] = GetShaderLocation(r->shader, "color3");
+    r->locSpread = GetShaderLocation(r->shader, "spreadColor");
+}
+
+// Two texel rows per lane
+static void EnsureColumns(BarRenderer *r, int width, int lanes) {
+    if (width == r->width && lanes == r->lanes && r->pixels) return;
+
+    if (r->pixels) UnloadTexture(r->columns);
+    free(r->pixels);
+    r->width = width;
+    r->lanes = lanes;
+    r->pixels = calloc((size_t)width * 2 * lanes * 4, 1);
+    r->built = false;
+
+    Image img = GenImageColor(width, 2 * lanes, BLANK);
+    r->columns = LoadTextureFromImage(img);
+    UnloadImage(img);
+    SetTextureFilter(r->columns, TEXTURE_FILTER_POINT);
+}
+
+// Pixels per value unit over the view's value range
+static float BarScale(const BarView *v, float plotHeight) {
+    double range = (double)v->maxValue - (double)v->minValue;
+    return plotHeight / (float)(range > 0 ? range : 1);
+}
+
+// Bar height in pixels; done in double so extreme value ranges cannot overflow
+static float BarHeight(const BarView *v, int value, float scale) {
+    return (float)((double)value - (double)v->minValue) * scale;
+}
+
+// Reduces the array to one texel per pixel column, for columns c0..c1-1 of a lane
+static void BuildColumns(BarRenderer *r, const BarView *v, int lane, int cols, float plotHeight, int c0, int c1) {
+    unsigned char *top = r->pixels + (size_t)lane * 2 * cols * 4;
+    unsigned char *bot = top + (size_t)cols * 4;
+    int n = v->n;
+    float scale = BarScale(v, plotHeight);
+    bool gaps = (int64_t)n * GAP_MIN_BAR_WIDTH <= cols;
+
+    for (int c = c0; c < c1; c++) {
+        int lo = (int)((int64_t)c * n / cols);
+        int next = (int)((int64_t)(c + 1) * n / cols);
+        int hi = next > lo ? next : lo + 1;
+
+        int mn = INT_MAX, mx = INT_MIN;
+        unsigned char code = HL_NONE;
+        for (int k = lo; k < hi; k++) {
+            int val = v->values[k];
+            if (val < mn) mn = val;
+            if (val > mx) mx = val;
+            unsigned char hl = v->highlight ? v->highlight[k] : HL_NONE;
+            if (hl == HL_NONE && k >= v->rangeLo && k <= v->rangeHi) hl = HL_RANGE;
+            if (highlightPriority[hl] > highlightPriority[code]) code = hl;
+        }
+        if (v->allDone && code != HL_ACTIVE) code = HL_DONE;
+
+        int hMax = (int)(BarHeight(v, mx, scale) + 0.5f);
+        int hMin = (hi - lo > 1) ? (int)(BarHeight(v, mn, scale) + 0.5f) : hMax;
+        if (hMax < 0) hMax = 0;
+        if (hMax > MAX_COLUMN_HEIGHT) hMax = MAX_COLUMN_HEIGHT;
+        if (hMin < 0) hMin = 0;
+        if (hMin > hMax) hMin = hMax;
+
+        // The last pixel of a wide bar is left empty to separate it from its neighbour
+        bool gap = gaps && next > lo;
+
+        unsigned char *t = top + (size_t)c * 4;
+        unsigned char *b = bot + (size_t)c * 4;
+        t[0] = (unsigned char)(hMax >> 8);
+        t[1] = (unsigned char)(hMax & 0xFF);
+        t[2] = code;
+        t[3] = gap ? 0 : 255;
+        b[0] = (unsigned char)(hMin >> 8);
+        b[1] = (unsigned char)(hMin & 0xFF);
+        b[2] = 0;
+        b[3] = 255;
+    }
+}
+
+void BarRendererTouch(BarRenderer *r, int lo, int hi) {
+    if (lo > hi) return;
+    if (r->spanCount == BAR_MAX_SPANS) {
+        for (int s = 1; s < r->spanCount; s++) {
+            if (r->spanLo[s] < r->spanLo[0]) r->spanLo[0] = r->spanLo[s];
+            if (r->spanHi[s] > r->spanHi[0]) r->spanHi[0] = r->spanHi[s];
+        }
+        r->spanCount = 1;
+    }
+    r->spanLo[r->spanCount] = lo;
+    r->spanHi[r->spanCount] = hi;
+    r->spanCount++;
+}
+
+// Touches the elements whose range color differs between the built and the new range
+static void TouchRangeChange(BarRenderer *r, const BarView *v) {
+    int oldLo = r->builtRangeLo, oldHi = r->builtRangeHi;
+    int newLo = v->rangeLo, newHi = v->rangeHi;
+    if (oldLo == newLo && oldHi == newHi) return;
+    if (oldLo > oldHi || newLo > newHi || oldHi < newLo || newHi < oldLo) {
+        BarRendererTouch(r, oldLo, oldHi);
+        BarRendererTouch(r, newLo, newHi);
+        return;
+    }
+    BarRendererTouch(r, oldLo < newLo ? oldLo : newLo, (oldLo < newLo ? newLo : oldLo) - 1);
+    BarRendererTouch(r, (oldHi < newHi ? oldHi : newHi) + 1, oldHi < newHi ? newHi : oldHi);
+}
+
+static bool SameLayout(const BarRenderer *r, const BarView *v, int cols, float plotHeight) {
+    return r->built && r->builtCols == cols && r->builtHeight == plotHeight && r->builtN == v->n &&
+           r->builtMin == v->minValue && r->builtMax == v->maxValue && r->builtAllDone == v->allDone &&
+           r->builtValues == v->values && r->builtHighlight == v->highlight;
+}
+
+// Rebuilds and uploads the columns over each touched span, one texture rect per row
+static void UpdateTouchedColumns(BarRenderer *r, const BarView *v, int cols, float plotHeight) {
+    int n = v->n;
+    for (int s = 0; s < r->spanCount; s++) {
+        int lo = r->spanLo[s] < 0 ? 0 : r->spanLo[s];
+        int hi = r->spanHi[s] >= n ? n - 1 : r->spanHi[s];
+        if (lo > hi) continue;
+        // Columns whose elements overlap lo..hi, one extra each side for the rounding
+        int c0 = (int)((int64_t)lo * cols / n) - 1;
+        int c1 = (int)((int64_t)(hi + 1) * cols / n) + 2;
+        if (c0 < 0) c0 = 0;
+        if (c1 > cols) c1 = cols;
+        BuildColumns(r, v, 0, cols, plotHeight, c0, c1);
+        Rectangle row = { (float)c0, 0, (float)(c1 - c0), 1 };
+        UpdateTextureRec(r->columns, row, r->pixels + (size_t)c0 * 4);
+        row.y = 1;
+        UpdateTextureRec(r->columns, row, r->pixels + ((size_t)cols + c0) * 4);
+    }
+}
+
+static void EnsureLabels(BarRenderer *r, int n) {
+    if (n <= r->labelCapacity) return;
+
+    r->labelValues = realloc(r->labelValues, (size_t)n * sizeof(int));
+    r->labelWidths = realloc(r->labelWidths, (size_t)n * sizeof(int));
+    r->labelCapacity = n;
+}
+
+// Label rectangle inside the layer, whose top sits LABEL_HEADROOM above the plot
+static Rectangle LabelRect(const BarView *v, float barWidth, int k, int width, int val, float plotHeight, float scale) {
+    float x = (float)(int)(k * barWidth + (barWidth - width) / 2);
+    float y = (float)(int)(LABEL_HEADROOM + plotHeight - BarHeight(v, val, scale)) - LABEL_FONT_SIZE - 2;
+    return (Rectangle){ x, y, (float)width, LABEL_FONT_SIZE };
+}
+
+// Redraws only the labels whose value changed since the last frame, then draws the
+// whole layer as one quad
+static void DrawLabels(BarRenderer *r, const BarView *v, Rectangle bounds, float scale) {
+    float barWidth = bounds.width / v->n;
+    if (barWidth < LABEL_MIN_BAR_WIDTH) return;
+
+    EnsureLabels(r, v->n);
+    bool fresh = HudLayerResize(&r->labelLayer, (int)bounds.width, (int)bounds.height + LABEL_HEADROOM);
+    if (fresh || v->n != r->labelN || v->minValue != r->labelMin || v->maxValue != r->labelMax) {
+        if (!fresh) {
+            HudLayerBegin(&r->labelLayer);
+            ClearBackground(BLANK);
+            HudLayerEnd();
+        }
+        for (int k = 0; k < v->n; k++) r->labelValues[k] = INT_MIN;
+        r->labelN = v->n;
+        r->labelMin = v->minValue;
+        r->labelMax = v->maxValue;
+    }
+
+    bool begun = false;
+    for (int k = 0; k < v->n; k++) {
+        int val = v->values[k];
+        if (r->labelValues[k] == val) continue;
+        if (!begun) { HudLayerBegin(&r->labelLayer); begun = true; }
+
+        if (r->labelValues[k] != INT_MIN && r->labelWidths[k] <= barWidth - 2) {
+            HudLayerClear(LabelRect(v, barWidth, k, r->labelWidths[k], r->labelValues[k], bounds.height, scale));
+        }
+        char text[12];
+        snprintf(text, sizeof(text), "%d", val);
+        r->labelWidths[k] = MeasureText(text, LABEL_FONT_SIZE);
+        r->labelValues[k] = val;
+        if (r->labelWidths[k] > barWidth - 2) continue;
+
+        Rectangle rect = LabelRect(v, barWidth, k, r->labelWidths[k], val, bounds.height, scale);
+        DrawText(text, (int)rect.x, (int)rect.y, LABEL_FONT_SIZE, RAYWHITE);
+    }
+    if (begun) HudLayerEnd();
+
+    HudLayerDraw(&r->labelLayer, (int)bounds.x, (int)bounds.y - LABEL_HEADROOM, WHITE);
+}
+
+static void SetUniforms(BarRenderer *r, const BarView *view, float plotHeight) {
+    float rows = (float)(2 * r->lanes);
+    SetShaderValue(r->shader, r->locPlotHeight, &plotHeight, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(r->shader, r->locRows, &rows, SHADER_UNIFORM_FLOAT);
+    for (int c = 0; c < 4; c++) SetColorUniform(r->shader, r->locColors[c], view->colors[c]);
+    SetColorUniform(r->shader, r->locSpread, WHITE);
+}
+
+void BarRendererDraw(BarRenderer *r, const BarView *view, Rectangle bounds) {
+    int cols = (int)bounds.width;
+    if (cols <= 0 || bounds.height <= 0 || view->n <= 0) return;
+
+    EnsureColumns(r, cols, 1);
+    if (view->tracked && SameLayout(r, view, cols, bounds.height)) {
+        TouchRangeChange(r, view);
+        UpdateTouchedColumns(r, view, cols, bounds.height);
+    } else {
+        BuildColumns(r, view, 0, cols, bounds.height, 0, cols);
+        UpdateTexture(r->columns, r->pixels);
+    }
+    r->spanCount = 0;
+    r->built = true;
+    r->builtCols = cols;
+    r->builtHeight = bounds.height;
+    r->builtN = view->n;
+    r->builtMin = view->minValue;
+    r->builtMax = view->maxValue;
+    r->builtRangeLo = view->rangeLo;
+    r->builtRangeHi = view->rangeHi;
+    r->builtAllDone = view->allDone;
+    r->builtValues = view->values;
+    r->builtHighlight = view->highlight;
+
+    SetUniforms(r, view, bounds.height);
+    BeginShaderMode(r->shader);
+    DrawTexturePro(r->columns, (Rectangle){ 0, 0, (float)cols, 2 }, bounds, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    EndShaderMode();
+
+    if (view->labels) {
+        float scale = BarScale(view, bounds.height);
+        DrawLabels(r, view, bounds, scale);
+    }
+}
+
+void BarRendererDrawLanes(BarRenderer *r, const BarView *views, int count, const Rectangle *bounds) {
+    int cols = (int)bounds[0].width;
+    float plotHeight = bounds[0].height;
+    if (count <= 0 || cols <= 0 || plotHeight <= 0) return;
+
+    EnsureColumns(r, cols, count);
+    for (int i = 0; i < count; i++) {
+        if (views[i].n > 0) BuildColumns(r, &views[i], i, cols, plotHeight, 0, cols);
+        else memset(r->pixels + (size_t)i * 2 * cols * 4, 0, (size_t)cols * 4);   // row 0 alpha 0: nothing drawn
+    }
+    UpdateTexture(r->columns, r->pixels);
+    r->built = false;
+
+    // Same texture and shader: raylib batches every lane into one draw call
+    SetUniforms(r, &views[0], plotHeight);
+    BeginShaderMode(r->shader);
+    for (int i = 0; i < count; i++) {
+        Rectangle source = { 0, (float)(2 * i), (float)cols, 2 };
+        Rectangle dest = { bounds[i].x, bounds[i].y, (float)cols, plotHeight };
+        DrawTexturePro(r->columns, source, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    }
+    EndShaderMode();
+}
+
+void BarRendererUnload(BarRenderer *r) {
+    if (r->pixels) UnloadTexture(r->columns);
+    UnloadShader(r->shader);
+    HudLayerUnload(&r->labelLayer);
+    free(r->pixels);
+    free(r->labelValues);
+    free(r->labelWidths);
+    *r = (BarRenderer){0};
+}
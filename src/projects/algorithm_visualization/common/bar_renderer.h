@@ -0,0 +1,69 @@
+// bar_renderer.h
+// Draws a whole value array as bars in a single textured quad. The array is reduced to
+// one texel per pixel column (min/max/highlight), uploaded once per frame and expanded
+// into bars by a fragment shader, so the draw cost no longer depends on N.
+//
+// A view marked tracked promises that every element changed since the previous frame was
+// reported with BarRendererTouch; then only the columns over those elements are rebuilt
+// and uploaded, as long as the layout (size, value range, arrays) stayed the same.
+//
+// BarRendererDrawLanes draws several arrays (the sort race's lanes) from one texture with
+// two rows per lane, in one shader pass that raylib batches into a single draw call.
+#ifndef BAR_RENDERER_H
+#define BAR_RENDERER_H
+
+#include "raylib.h"
+#include "hud.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BAR_MAX_SPANS 8               // touched spans kept apart; more are merged into one
+
+typedef struct BarView {
+    const int *values;
+    const unsigned char *highlight;   // HighlightCode per element, may be NULL
+    int n;
+    int minValue, maxValue;           // value range mapped onto the plot height; minValue draws empty
+    int rangeLo, rangeHi;             // inclusive range drawn with the range color, rangeLo > rangeHi for none
+    bool allDone;                     // draw every bar with the done color
+    bool labels;                      // value labels above bars that are wide enough
+    bool tracked;                     // changes were reported with BarRendererTouch
+    Color colors[4];                  // indexed by HighlightCode
+} BarView;
+
+typedef struct BarRenderer {
+    Texture2D columns;                // width x 2 per lane: row 0 = max height + highlight, row 1 = min height
+    Shader shader;
+    int locPlotHeight, locRows;
+    int locColors[4];
+    int locSpread;
+    unsigned char *pixels;            // CPU staging for the column texture
+    int width, lanes;
+
+    // What the texture holds, for tracked partial updates
+    bool built;
+    int builtCols, builtN, builtMin, builtMax, builtRangeLo, builtRangeHi;
+    float builtHeight;
+    bool builtAllDone;
+    const int *builtValues;
+    const unsigned char *builtHighlight;
+    int spanLo[BAR_MAX_SPANS], spanHi[BAR_MAX_SPANS];
+    int spanCount;
+
+    // Labels live in a layer; only the bars whose value changed are redrawn into it
+    HudLayer labelLayer;
+    int *labelValues;
+    int *labelWidths;
+    int labelCapacity;
+    int labelN, labelMin, labelMax;   // layout the layer was drawn for
+} BarRenderer;
+
+void BarRendererInit(BarRenderer *r);
+void BarRendererDraw(BarRenderer *r, const BarView *view, Rectangle bounds);
+// Lanes of equal size; their colors are views[0]'s and labels are not drawn
+void BarRendererDrawLanes(BarRenderer *r, const BarView *views, int count, const Rectangle *bounds);
+// Elements lo..hi changed value or highlight since the last draw
+void BarRendererTouch(BarRenderer *r, int lo, int hi);
+void BarRendererUnload(BarRenderer *r);
+
+#endif // BAR_RENDERER_H
@@ -0,0 +1,240 @@
+// dataset_loader.c
+#include "dataset_loader.h"
+#include "step_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/emscripten.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define CHUNK_BYTES (1 << 20)
+#define WEB_CHUNKS_AHEAD 4          // slices the browser may read ahead of the parser
+
+static void Release(DatasetLoad *l) {
+#if defined(PLATFORM_WEB)
+    EM_ASM({
+        var s = Module.datasetSource;
+        if (s) { s.file = null; s.chunks = []; }
+    });
+    free(l->chunk);
+    l->chunk = NULL;
+#else
+    if (l->map) munmap((void *)l->map, (size_t)l->size);
+    l->map = NULL;
+#endif
+}
+
+bool DatasetLoadBusy(const DatasetLoad *l) {
+    return l->state == LOAD_PICKING || l->state == LOAD_COUNTING || l->state == LOAD_READING;
+}
+
+float DatasetLoadProgress(const DatasetLoad *l) {
+    if (l->state == LOAD_DONE) return 1.0f;
+    if (l->size <= 0) return 0.0f;
+    float pass = (float)l->offset / (float)l->size;
+    if (l->parser.format != DATASET_TEXT) return l->state == LOAD_READING ? pass : 0.0f;
+    // Text is read twice; counting is the cheaper half but the bytes are the same
+    if (l->state == LOAD_COUNTING) return pass * 0.5f;
+    return l->state == LOAD_READING ? 0.5f + pass * 0.5f : 0.0f;
+}
+
+// Starts the pass that parses into the session; counting pass done or not needed
+static bool BeginReading(DatasetLoad *l, SortSession *session, int total) {
+    l->truncated = total > SORT_SESSION_MAX_N;
+    if (l->truncated) total = SORT_SESSION_MAX_N;
+    if (total < 1 || !SortSessionResize(session, total)) return false;
+    l->total = total;
+    l->offset = 0;
+    l->state = LOAD_READING;
+    DatasetParserBegin(&l->parser, l->parser.format, session->values, total);
+    session->n = 0;
+    return true;
+}
+
+#if defined(PLATFORM_WEB)
+// The picker and the slice reads live in JS; C pulls one chunk at a time from
+// Module.datasetSource and tells it which offset the next pass starts at
+bool DatasetLoadOpen(DatasetLoad *l, const char *path) {
+    (void)path;
+    Release(l);
+    *l = (DatasetLoad){ .state = LOAD_PICKING };
+    l->chunk = malloc(CHUNK_BYTES);
+    if (!l->chunk) {
+        l->state = LOAD_FAILED;
+        return false;
+    }
+    EM_ASM({
+        var s = Module.datasetSource;
+        if (!s) {
+            s = Module.datasetSource = { file: null, cancelled: false, chunks: [], next: 0, reading: false, input: null };
+            s.input = document.createElement('input');
+            s.input.type = 'file';
+            s.input.accept = '.bin,.i32,.csv,.txt';
+            s.input.addEventListener('change', function() {
+                s.file = s.input.files.length ? s.input.files[0] : null;
+                s.chunks = [];
+                s.next = 0;
+                s.input.value = '';
+            });
+            s.input.addEventListener('cancel', function() { s.cancelled = true; });
+            // Reads ahead until WEB_CHUNKS_AHEAD slices wait for the parser
+            s.pump = function() {
+                if (s.reading || !s.file || s.next >= s.file.size || s.chunks.length >= $1) return;
+                var file = s.file, start = s.next, end = Math.min(start + $0, file.size);
+                s.reading = true;
+                s.next = end;
+                file.slice(start, end).arrayBuffer().then(function(buffer) {
+                    s.reading = false;
+                    if (s.file === file) s.chunks.push(new Uint8Array(buffer));
+                    s.pump();
+                }, function() {
+                    s.reading = false;
+                    s.file = null;
+                });
+            };
+        }
+        s.file = null;
+        s.cancelled = false;
+        s.input.click();
+    }, CHUNK_BYTES, WEB_CHUNKS_AHEAD);
+    return true;
+}
+
+// Copies the next read-ahead chunk into l->chunk; 0 when none is ready yet
+static int NextChunk(DatasetLoad *l) {
+    return EM_ASM_INT({
+        var s = Module.datasetSource;
+        if (!s.chunks.length) {
+            s.pump();
+            return 0;
+        }
+        var c = s.chunks.shift();
+        HEAPU8.set(c, $0);
+        s.pump();
+        return c.length;
+    }, l->chunk);
+}
+
+static void RewindSource(void) {
+    EM_ASM({
+        var s = Module.datasetSource;
+        s.chunks = [];
+        s.next = 0;
+        s.pump();
+    });
+}
+
+// Once the picker returned a file: its name and size; -1 while waiting, -2 if dismissed
+static int64_t PickedFile(DatasetLoad *l) {
+    double size = EM_ASM_DOUBLE({
+        var s = Module.datasetSource;
+        if (!s.file) return s.cancelled ? -2 : -1;
+        stringToUTF8(s.file.name, $0, $1);
+        return s.file.size;
+    }, l->name, (int)sizeof(l->name));
+    return (int64_t)size;
+}
+#else
+bool DatasetLoadOpen(DatasetLoad *l, const char *path) {
+    Release(l);
+    *l = (DatasetLoad){ .state = LOAD_FAILED };
+    const char *base = strrchr(path, '/');
+    snprintf(l->name, sizeof(l->name), "%s", base ? base + 1 : path);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);              // the mapping keeps the file open
+    if (map == MAP_FAILED) return false;
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    l->map = map;
+    l->size = (int64_t)st.st_size;
+    l->state = LOAD_PICKING;    // the first update starts the right pass
+    return true;
+}
+#endif
+
+static void FinishPass(DatasetLoad *l, SortSession *session) {
+    DatasetParserFinish(&l->parser);
+    if (l->state == LOAD_COUNTING) {
+        if (!BeginReading(l, session, l->parser.count)) {
+            l->state = LOAD_FAILED;
+            Release(l);
+            return;
+        }
+#if defined(PLATFORM_WEB)
+        RewindSource();
+#endif
+        return;
+    }
+    session->n = DatasetParserStored(&l->parser);
+    l->truncated = l->truncated || l->parser.count > l->total;
+    l->state = LOAD_DONE;
+    Release(l);
+}
+
+bool DatasetLoadUpdate(DatasetLoad *l, SortSession *session, double budgetMs) {
+    if (l->state == LOAD_PICKING) {
+#if defined(PLATFORM_WEB)
+        int64_t size = PickedFile(l);
+        if (size == -1) return true;
+        if (size < 0) {
+            DatasetLoadStop(l);
+            return false;
+        }
+        l->size = size;
+#endif
+        DatasetFormat format = DatasetFormatFromName(l->name);
+        if (format == DATASET_TEXT) {
+            l->state = LOAD_COUNTING;
+            l->offset = 0;
+            DatasetParserBegin(&l->parser, format, NULL, 0);
+        } else {
+            l->parser.format = format;
+            if (!BeginReading(l, session, (int)(l->size / 4 < INT32_MAX ? l->size / 4 : INT32_MAX))) {
+                l->state = LOAD_FAILED;
+                Release(l);
+                return false;
+            }
+        }
+    }
+    if (l->state != LOAD_COUNTING && l->state != LOAD_READING) return false;
+
+    double start = SortClockMs();
+    while (SortClockMs() - start < budgetMs) {
+        if (l->offset >= l->size) {
+            FinishPass(l, session);
+            if (l->state != LOAD_READING) break;
+            continue;
+        }
+#if defined(PLATFORM_WEB)
+        int got = NextChunk(l);
+        if (got == 0) break;            // the browser has not read the next slice yet
+        DatasetParserFeed(&l->parser, l->chunk, (size_t)got);
+#else
+        int64_t got = l->size - l->offset < CHUNK_BYTES ? l->size - l->offset : CHUNK_BYTES;
+        DatasetParserFeed(&l->parser, l->map + l->offset, (size_t)got);
+#endif
+        l->offset += got;
+        if (l->state == LOAD_READING) session->n = DatasetParserStored(&l->parser);
+    }
+    return DatasetLoadBusy(l);
+}
+
+void DatasetLoadStop(DatasetLoad *l) {
+    if (!DatasetLoadBusy(l)) return;
+    l->state = l->state == LOAD_READING ? LOAD_DONE : LOAD_IDLE;
+    Release(l);
+}
@@ -0,0 +1,48 @@
+// dataset_loader.h
+// Loads an integer dataset (see sort_dataset.h) into a SortSession a few milliseconds
+// per frame. Natively the file is memory-mapped and parsed in place; in the browser a
+// file picker hands the file over and its slices are read asynchronously, at most a few
+// chunks ahead of the parser. Peak memory is the session plus those chunks.
+//
+// session->n grows as values arrive, so the loaded prefix can be drawn (and sorted, after
+// DatasetLoadStop) before the whole file is in.
+#ifndef DATASET_LOADER_H
+#define DATASET_LOADER_H
+
+#include "sort_dataset.h"
+#include "sort_session.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    LOAD_IDLE,
+    LOAD_PICKING,              // web: waiting for the user to choose a file
+    LOAD_COUNTING,             // text: first pass, counting values
+    LOAD_READING,
+    LOAD_DONE,
+    LOAD_FAILED
+} DatasetLoadState;
+
+typedef struct DatasetLoad {
+    DatasetLoadState state;
+    char name[128];
+    int64_t size;              // file bytes
+    int64_t offset;            // bytes consumed in the current pass
+    int total;                 // values that will be stored (known from LOAD_READING on)
+    bool truncated;            // the file held more than SORT_SESSION_MAX_N values
+    DatasetParser parser;
+
+    const unsigned char *map;  // native: the whole file
+    unsigned char *chunk;      // web: the chunk being parsed
+} DatasetLoad;
+
+// Native: maps path. Web: path is ignored and the browser's file picker opens
+bool DatasetLoadOpen(DatasetLoad *l, const char *path);
+// Parses for up to budgetMs; true while the load is still in progress
+bool DatasetLoadUpdate(DatasetLoad *l, SortSession *session, double budgetMs);
+// Ends the load early; what was read stays in the session
+void DatasetLoadStop(DatasetLoad *l);
+float DatasetLoadProgress(const DatasetLoad *l);   // 0..1 over both passes
+bool DatasetLoadBusy(const DatasetLoad *l);
+
+#endif // DATASET_LOADER_H
@@ -1,7 +1,29 @@
-emcc merge_sort.c -o index.html \
--I/home/c9der/raylib/src \
-/home/c9der/raylib/src/libraylib.web.a \
--s USE_GLFW=3 -s ASYNCIFY -s TOTAL_MEMORY=134217728 \
--DPLATFORM_WEB --shell-file ./shell.html \
--gsource-map
+# Usage: ./build.sh [release|size|profile|debug]
+#   release  -O3 with LTO and wasm SIMD (default)
+#   size     -Oz with LTO and wasm SIMD: the smallest download, for mobile
+#   profile  release plus the prof.h section timers (F2 overlay, F4 trace export)
+#   debug    -O0 with DWARF, a source map, runtime assertions and the section timers
+# No Asyncify: the program only runs from emscripten_set_main_loop and never blocks
+set -e
+case "${1:-release}" in
+    release) OPT="-O3 -flto" ;;
+    size) OPT="-Oz -flto" ;;
+    profile) OPT="-O3 -flto -DPROF_ENABLED" ;;
+    debug) OPT="-O0 -g -gsource-map -s ASSERTIONS=2 -DPROF_ENABLED" ;;
+    *) echo "usage: $0 [release|size|profile|debug]"; exit 1 ;;
+esac
+RAYLIB_SRC="${RAYLIB_SRC:-/home/c9der/raylib/src}"    # raylib/src with libraylib.web.a
+# A release build must not ship a stale map from an earlier debug build
+rm -f index.wasm.map
 
+emcc merge_sort.c ../sort_core/sort_engine.c ../sort_core/sort_bubble.c ../sort_core/sort_exchange.c ../sort_core/sort_merge.c ../sort_core/sort_simd.c ../sort_core/sort_parallel.c ../sort_core/sort_quick.c ../sort_core/sort_race.c ../sort_core/sort_heap.c ../sort_core/sort_radix.c ../sort_core/sort_intro.c ../sort_core/sort_tim.c ../sort_core/sort_insertion.c ../sort_core/sort_data.c ../sort_core/sort_session.c ../sort_core/sort_dataset.c ../sort_core/sort_trace.c ../sort_core/sort_cache.c ../sort_core/step_scheduler.c ../common/bar_renderer.c ../common/dataset_loader.c ../../raylib/common/hud.c ../../raylib/common/prof.c ../../raylib/common/prof_overlay.c ../../raylib/common/frame_gate.c -o index.html \
+-I../sort_core -I../common -I../../raylib/common \
+-I"$RAYLIB_SRC" \
+"$RAYLIB_SRC/libraylib.web.a" \
+$OPT -msimd128 \
+-s USE_GLFW=3 -s INITIAL_MEMORY=16777216 -s ALLOW_MEMORY_GROWTH=1 \
+-pthread -s PTHREAD_POOL_SIZE=navigator.hardwareConcurrency \
+-DPLATFORM_WEB --shell-file ./shell.html
+
+# Download size; the page prints its time to first frame in the console
+echo "index.wasm: $(wc -c < index.wasm) bytes, $(gzip -9c index.wasm | wc -c) gzipped"
@@ -1,13 +1,40 @@
 // merge_sort_vis_.c
 #include "raylib.h"
+#include "sort_core.h"
+#include "sort_cache.h"
+#include "sort_engine.h"
+#include "sort_parallel.h"
+#include "sort_race.h"
+#include "sort_session.h"
+#include "sort_trace.h"
+#include "step_scheduler.h"
+#include "bar_renderer.h"
+#include "dataset_loader.h"
+#include "frame_gate.h"
+#include "hud.h"
+#include "prof_overlay.h"
+#if !defined(PLATFORM_WEB)
+#include "sort_external.h"
+#endif
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
+#if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
+#endif
 
-#define NUM_BARS 80
+#define DEFAULT_BARS 80
 #define MAX_VALUE 600
-#define MIN_BAR_WIDTH 2
+#define TRACE_MAX_N (1 << 20)     // above this the trace would not fit comfortably in memory
+#define TRACE_MAX_N_QUADRATIC 4096            // O(n^2) engines: about 12 MB and 0.1 s to record
+#define TRACE_MAX_BYTES ((size_t)256 << 20)   // any larger trace is dropped and the sort runs live
+#define TRACE_CHECK_STEPS 65536   // recording checks this often whether the trace has failed
+#define SEEK_FRACTION 100         // LEFT/RIGHT scrub by 1% of the trace
+#define LOAD_BUDGET_MS 6.0        // dataset parsing per frame while a file loads
+#define HEAT_ROW_HEIGHT 10        // one heatmap row per buffer under the bars
+#define HEAT_MAX_COLUMNS 4096
 
 typedef enum {
     ST_IDLE,
@@ -15,146 +42,880 @@ typedef enum {
     ST_DONE
 } SortState;
 
-static int values[NUM_BARS];
-static int aux[NUM_BARS];
-static int curr_size = 1;    // current size of subarrays to merge
-static int left_start = 0;   // start index of the current merge
-static int i_idx = 0, j_idx = 0, k_idx = 0;
-static int mid = 0, right = 0;
+static SortSession session = {0};
+static const SortEngine *engine;     // number keys pick the algorithm; merge by default
+
+// Keys 1-9, 0, - and = select sortEngines in order
+static const int engineKeys[] = { KEY_ONE, KEY_TWO, KEY_THREE, KEY_FOUR, KEY_FIVE, KEY_SIX, KEY_SEVEN,
+                                  KEY_EIGHT, KEY_NINE, KEY_ZERO, KEY_MINUS, KEY_EQUAL };
+#define ENGINE_KEY_COUNT ((int)(sizeof(engineKeys) / sizeof(engineKeys[0])))
+static SortMachine sorter;
+static BarRenderer bars;
+static Hud hud;
+static FrameGate gate;          // paused, done or idle screens are not redrawn
+static HudText titleText, helpText, statusText;
+static int markedI = -1, markedJ = -1;
+
+// Trace mode: the sort is recorded once at full speed and the bars replay the trace. A
+// trace that cannot be recorded is dropped and that sort runs live
+static bool traceMode = true;
+static bool traceDropped = false;
+static SortTrace trace;
+static TracePlayer player;
+
+// Cache model (C, trace mode): the replay's reads and writes of values and aux go through
+// a simulated L1, L2 and TLB, and a heatmap under the bars shows how each cache line's
+// recent accesses fared. V cycles the presets of sort_cache.h
+static bool cacheMode = false;
+static int cachePreset = 0;
+static SortCache cache;
+static double cacheRate;        // simulated accesses per second over the last frame's steps
+static HudText cacheText;
+
+// Per heatmap column, summed over the cache lines under it
+typedef struct HeatColumn {
+    uint32_t accesses, l1Misses, l2Misses;
+} HeatColumn;
+
+static HeatColumn heatColumns[HEAT_MAX_COLUMNS];
+
+// Parallel mode: merge sort on a pthread pool; the bars read the shared buffers live
+static bool parallelMode = false;
+static ParallelSort psort;
+static int frontMarks[PSORT_MAX_THREADS];
+static int frontMarkCount = 0;
+
+// External mode (native): sorted out of core through temporary files, see StartExternal
+static bool externalMode = false;
+
+// Race mode: the entered engines sort copies of the array side by side with equal CPU time
+// each; in it the number keys enter and withdraw lanes instead of picking the algorithm
+static bool raceMode = false;
+static bool raceEntered[SORT_RACE_MAX_LANES];
+static SortRace race;
+static HudText laneTexts[SORT_RACE_MAX_LANES];
+static int laneMarks[SORT_RACE_MAX_LANES][2];
+
+// Dataset mode: a file streams into the session; the bars show the prefix read so far
+static DatasetLoad load;
+static int valueMin = 0, valueMax = MAX_VALUE;
 
 static SortState state = ST_IDLE;
 static bool paused = true;
-static int speed = 2;
+static StepScheduler sched;
 
-void ResetArray(void);
-void ResetMergeIndices(void);
-void NextMerge(void);
-void DoMergeStep(void);
+void ResetArray(int numBars);
 void UpdateDrawFrame(void);
+static void StopExternal(void);
+
+static bool Tracing(void) {
+    int maxN = engine->quadratic ? TRACE_MAX_N_QUADRATIC : TRACE_MAX_N;
+    return traceMode && !traceDropped && !parallelMode && !externalMode && !raceMode && session.n <= maxN;
+}
 
-void ResetArray(void) {
-    srand((unsigned)time(NULL));
-    for (int i = 0; i < NUM_BARS; i++)
-        values[i] = 20 + rand() % (MAX_VALUE - 20);
-    curr_size = 1;
-    left_start = 0;
+// Reuses the session arena; it only grows when numBars exceeds anything seen before
+void ResetArray(int numBars) {
+    ParallelSortWait(&psort);     // only reachable once the workers are done; joins them
+    DatasetLoadStop(&load);
+    StopExternal();
+    SortSessionResize(&session, numBars);
+    GenerateValues(session.values, session.n, DIST_RANDOM, 20, MAX_VALUE, (uint64_t)time(NULL));
+    valueMin = 0;
+    valueMax = MAX_VALUE;
+    SortMachineInit(&sorter, engine, session.values, session.aux, session.n);
+    SortTraceFree(&trace);
+    traceDropped = false;
+    StepSchedulerReset(&sched);
+    markedI = markedJ = -1;
+    frontMarkCount = 0;
     paused = true;
     state = ST_IDLE;
 }
 
-void ResetMergeIndices(void) {
-    int n = NUM_BARS;
-    mid = left_start + curr_size - 1;
-    right = (left_start + 2 * curr_size - 1 < n - 1)
-                ? (left_start + 2 * curr_size - 1)
-                : (n - 1);
-    i_idx = left_start;
-    j_idx = mid + 1;
-    k_idx = left_start;
+// Points the sorter at whatever prefix of the dataset is in the session by now
+static void UseLoadedData(void) {
+    if (session.n < 1) {
+        if (!DatasetLoadBusy(&load)) ResetArray(DEFAULT_BARS);   // nothing readable in the file
+        return;
+    }
+    valueMin = load.parser.minValue < 0 ? load.parser.minValue : 0;
+    valueMax = load.parser.maxValue > valueMin ? load.parser.maxValue : valueMin + 1;
+    StopExternal();
+    SortMachineInit(&sorter, engine, session.values, session.aux, session.n);
+    SortTraceFree(&trace);
+    traceDropped = false;
+    StepSchedulerReset(&sched);
+    markedI = markedJ = -1;
+    frontMarkCount = 0;
+    paused = true;
+    state = ST_IDLE;
 }
 
-void NextMerge(void) {
-    left_start += 2 * curr_size;
-    if (left_start >= NUM_BARS - 1) {
-        curr_size *= 2;
-        left_start = 0;
-        if (curr_size >= NUM_BARS) {
-            state = ST_DONE;
-            paused = true;
-            return;
+// Web: path is ignored and the file picker opens
+static void OpenDataset(const char *path) {
+    ParallelSortWait(&psort);
+    StopExternal();
+    if (!DatasetLoadOpen(&load, path)) {
+        printf("Cannot open %s\n", path ? path : "a dataset");
+        return;
+    }
+    markedI = markedJ = -1;
+    frontMarkCount = 0;
+    paused = true;
+    state = ST_IDLE;
+}
+
+static void UpdateLoad(void) {
+    int before = session.n;
+    DatasetLoadState was = load.state;
+    DatasetLoadUpdate(&load, &session, LOAD_BUDGET_MS);
+    if (load.state == LOAD_FAILED) {
+        printf("Cannot load %s\n", load.name);
+        ResetArray(DEFAULT_BARS);
+        load.state = LOAD_IDLE;
+        return;
+    }
+    if ((load.state == LOAD_READING || load.state == LOAD_DONE) && (session.n != before || load.state != was))
+        UseLoadedData();
+}
+
+// Starts the model cold on the trace being replayed, or detaches it; on a failure the
+// replay carries on without it
+static void AttachCache(void) {
+    player.cache = NULL;
+    if (!cacheMode || !Tracing() || !trace.bytes) return;
+    int *buffers[2] = { session.values, session.aux };
+    if (SortCacheBegin(&cache, &sortCachePresets[cachePreset], buffers, trace.bufferCount, session.n))
+        player.cache = &cache;
+    else
+        printf("Cannot model the %s cache for %d values\n", sortCachePresets[cachePreset].name, session.n);
+}
+
+// Runs the whole sort with a trace attached, then rewinds the buffers to the input. If
+// the trace fails the sort stops, the input comes back from the first keyframe and the
+// machine starts over live
+static void RecordTrace(void) {
+    int *buffers[2] = { session.values, session.aux };
+    SortTraceBegin(&trace, buffers, engine->bufferCount, session.n, 0, TRACE_MAX_BYTES);
+    SortMachineAttachTrace(&sorter, &trace);
+    while (!trace.failed && !SortMachineDone(&sorter)) SortMachineRun(&sorter, TRACE_CHECK_STEPS);
+    SortMachineAttachTrace(&sorter, NULL);
+    if (trace.failed) {
+        const int *input = trace.keyframeCount > 0 ? trace.keyframes[0].snapshot : NULL;
+        for (int b = 0; input && b < trace.bufferCount; b++)
+            memcpy(buffers[b], input + (size_t)b * session.n, (size_t)session.n * sizeof(int));
+        printf("Cannot record a trace of %d values; sorting live\n", session.n);
+        SortTraceFree(&trace);
+        SortMachineInit(&sorter, engine, session.values, session.aux, session.n);
+        traceDropped = true;
+        return;
+    }
+    TracePlayerInit(&player, &trace, buffers);
+    AttachCache();
+}
+
+// Sets highlight[k]; the bars rebuild only the columns of elements touched like this
+static void SetHighlight(int k, unsigned char code) {
+    session.highlight[k] = code;
+    BarRendererTouch(&bars, k, k);
+}
+
+static void MarkActive(int a, int b) {
+    if (markedI >= 0) SetHighlight(markedI, HL_NONE);
+    if (markedJ >= 0) SetHighlight(markedJ, HL_NONE);
+    markedI = markedJ = -1;
+    if (state != ST_SORTING) return;
+
+    if (a >= 0 && a < session.n) SetHighlight(markedI = a, HL_ACTIVE);
+    if (b >= 0 && b < session.n) SetHighlight(markedJ = b, HL_ACTIVE);
+}
+
+static int64_t MachineStepFn(void *ctx, int64_t maxSteps) {
+    return SortMachineRun(ctx, maxSteps);
+}
+
+static int64_t ReplayStepFn(void *ctx, int64_t maxSteps) {
+    return TracePlayerRun(ctx, maxSteps);
+}
+
+// Workers own the buffers until they finish; nothing may reset or resize them meanwhile
+static bool ParallelBusy(void) {
+    return parallelMode && state == ST_SORTING;
+}
+
+// One highlight per worker at its write position in the buffer being filled
+static void MarkWriteFronts(const ParallelProgress *pr) {
+    for (int k = 0; k < frontMarkCount; k++) session.highlight[frontMarks[k]] = HL_NONE;
+    frontMarkCount = 0;
+    if (state != ST_SORTING) return;
+
+    for (int t = 0; t < pr->threadCount; t++) {
+        int at = pr->sliceLo[t] + pr->written[t];
+        if (at >= pr->sliceHi[t] || at >= session.n) continue;
+        session.highlight[at] = HL_ACTIVE;
+        frontMarks[frontMarkCount++] = at;
+    }
+}
+
+#if !defined(PLATFORM_WEB)
+// External mode: the array goes out to a temporary file and comes back sorted through
+// runs of n/8 values merged 4 at a time, so run formation and a second merge pass show
+// at any size. The number keys pick the algorithm that sorts each run
+#define EXTERNAL_RUNS 8
+#define EXTERNAL_FAN_IN 4
+
+static ExternalSort ext;
+static FILE *extIn, *extOut;
+static int extHeads[EXTERNAL_FAN_IN];
+static unsigned char extHighlight[EXTERNAL_FAN_IN];
+
+static void StopExternal(void) {
+    ExternalSortFree(&ext);
+    ext.phase = EXT_IDLE;
+    if (extIn) fclose(extIn);
+    if (extOut) fclose(extOut);
+    extIn = extOut = NULL;
+}
+
+// A failure leaves ext in EXT_FAILED, which the next step reports
+static void StartExternal(void) {
+    StopExternal();
+    extIn = tmpfile();
+    extOut = tmpfile();
+    if (extIn && extOut) {
+        setvbuf(extIn, NULL, _IONBF, 0);
+        setvbuf(extOut, NULL, _IONBF, 0);
+    }
+    if (!extIn || !extOut || fwrite(session.values, sizeof(int), (size_t)session.n, extIn) != (size_t)session.n) {
+        StopExternal();
+        ext = (ExternalSort){ .phase = EXT_FAILED, .error = "cannot write a temporary file" };
+        return;
+    }
+    size_t runValues = (size_t)(session.n + EXTERNAL_RUNS - 1) / EXTERNAL_RUNS;
+    ExternalConfig config = { .memoryBytes = runValues * 2 * sizeof(int), .engine = engine };
+    config.ioBytes = config.memoryBytes / (EXTERNAL_FAN_IN + 1);
+    ExternalSortBegin(&ext, extIn, extOut, &config);
+}
+
+static int64_t ExternalStepFn(void *ctx, int64_t maxSteps) {
+    return ExternalSortRun(ctx, maxSteps);
+}
+
+// Steps the sort; once it is done the output is read back into the session
+static bool StepExternal(void) {
+    StepSchedulerRun(&sched, gate.frameTime, ExternalStepFn, &ext);
+    if (!ExternalSortDone(&ext)) return false;
+    if (ext.phase == EXT_FAILED) {
+        printf("External sort: %s\n", ext.error);
+    } else {
+        rewind(extOut);
+        if (fread(session.values, sizeof(int), (size_t)session.n, extOut) != (size_t)session.n)
+            printf("External sort: cannot read the output back\n");
+    }
+    return true;
+}
+
+static int DescribeExternal(char *buf, int size) {
+    double mb = (double)(ext.bytesRead + ext.bytesWritten) / (1024.0 * 1024.0);
+    if (ext.phase == EXT_RUNS)
+        return snprintf(buf, size, "  runs:%d (%d values each)  I/O:%.2f MB at %.0f MB/s", ext.runsFormed,
+                        ext.runCapacity, mb, ExternalSortMBps(&ext));
+    if (ext.phase == EXT_MERGE)
+        return snprintf(buf, size, "  pass:%d/%d  merging %d runs  I/O:%.2f MB at %.0f MB/s", ext.pass,
+                        ext.passCount, ext.streamCount, mb, ExternalSortMBps(&ext));
+    if (ext.phase == EXT_DONE)
+        return snprintf(buf, size, "  %d runs, %d passes: %.1f ms, %.0f MB/s", ext.runsFormed, ext.pass,
+                        ExternalSortSeconds(&ext) * 1000.0, ExternalSortMBps(&ext));
+    if (ext.phase == EXT_FAILED)
+        return snprintf(buf, size, "  failed: %s", ext.error);
+    return 0;
+}
+
+static void DrawProgress(Rectangle bar, float done, Color color) {
+    DrawRectangleRec(bar, DARKGRAY);
+    DrawRectangleRec((Rectangle){ bar.x, bar.y, bar.width * (done < 1.0f ? done : 1.0f), bar.height }, color);
+}
+
+// Run formation: the run buffer with the part read for the current run highlighted, under
+// the input file cut into runs. Merging: each run's head value, the loser tree's winner
+// highlighted, over one lane per run and one for the group's output
+static void DrawExternal(Rectangle area) {
+    Rectangle strip = { area.x + 10, area.y, area.width - 20, 10 };
+    Rectangle plot = { area.x, area.y + 20, area.width, area.height - 20 };
+    BarView view = {
+        .minValue = valueMin,
+        .maxValue = valueMax,
+        .rangeLo = 0, .rangeHi = -1,
+        .colors = { RAYWHITE, GREEN, ORANGE, SKYBLUE },
+    };
+
+    if (ext.phase == EXT_RUNS) {
+        DrawProgress(strip, ext.total > 0 ? (float)ext.inputRead / (float)ext.total : 1.0f, SKYBLUE);
+        for (int64_t at = ext.runCapacity; at < ext.total; at += ext.runCapacity) {
+            float x = strip.x + strip.width * (float)at / (float)ext.total;
+            DrawLineEx((Vector2){ x, strip.y - 2 }, (Vector2){ x, strip.y + strip.height + 2 }, 2, BLACK);
+        }
+        view.values = ext.run;
+        view.n = ext.runFilled;
+        view.rangeHi = ext.runLength - 1;
+        BarRendererDraw(&bars, &view, plot);
+        return;
+    }
+    if (ext.phase != EXT_MERGE) return;
+
+    int k = ext.streamCount < EXTERNAL_FAN_IN ? ext.streamCount : EXTERNAL_FAN_IN;
+    int64_t written = ext.groupWritten + ext.outLen;
+    DrawProgress(strip, ext.groupLength > 0 ? (float)written / (float)ext.groupLength : 1.0f, GREEN);
+
+    float laneHeight = 14;
+    for (int i = 0; i < k; i++) {
+        const ExternalStream *s = &ext.streams[i];
+        Rectangle lane = { strip.x, plot.y + plot.height - (float)(k - i) * laneHeight, strip.width, laneHeight - 4 };
+        DrawProgress(lane, s->length > 0 ? (float)s->consumed / (float)s->length : 1.0f,
+                     i == ext.tree[0] ? ORANGE : SKYBLUE);
+        extHighlight[i] = i == ext.tree[0] ? HL_ACTIVE : HL_NONE;
+        if (!ExternalStreamHead(&ext, i, &extHeads[i])) {
+            extHeads[i] = valueMin;      // exhausted: an empty bar
+            extHighlight[i] = HL_NONE;
+        }
+    }
+    view.values = extHeads;
+    view.highlight = extHighlight;
+    view.n = k;
+    plot.height -= (float)k * laneHeight + 10;
+    BarRendererDraw(&bars, &view, plot);
+}
+#else
+// The web build has no temporary files; externalMode stays false there
+static void StopExternal(void) {}
+static void StartExternal(void) {}
+static bool StepExternal(void) { return true; }
+static int DescribeExternal(char *buf, int size) { (void)buf; (void)size; return 0; }
+static void DrawExternal(Rectangle area) { (void)area; }
+#endif
+
+static void StartRace(void) {
+    const SortEngine *entered[SORT_RACE_MAX_LANES];
+    int count = 0;
+    for (int e = 0; e < sortEngineCount && e < SORT_RACE_MAX_LANES; e++) {
+        if (raceEntered[e]) entered[count++] = &sortEngines[e];
+    }
+    if (!SortRaceBegin(&race, entered, count, session.values, session.n))
+        printf("Cannot race %d lanes of %d values\n", count, session.n);
+    for (int i = 0; i < SORT_RACE_MAX_LANES; i++) laneMarks[i][0] = laneMarks[i][1] = -1;
+}
+
+static int64_t RaceStepFn(void *ctx, int64_t maxSteps) {
+    return SortRaceRun(ctx, maxSteps);
+}
+
+// Each running lane's compared pair, like MarkActive for the session
+static void MarkLanes(SortCursor cursors[]) {
+    for (int i = 0; i < race.laneCount; i++) {
+        SortRaceLane *lane = &race.lanes[i];
+        for (int m = 0; m < 2; m++) {
+            if (laneMarks[i][m] >= 0) lane->highlight[laneMarks[i][m]] = HL_NONE;
+            laneMarks[i][m] = -1;
         }
+        SortMachineCursor(&lane->machine, &cursors[i]);
+        if (lane->place) continue;
+        int marks[2] = { cursors[i].a, cursors[i].b };
+        for (int m = 0; m < 2; m++) {
+            if (marks[m] < 0 || marks[m] >= race.n) continue;
+            lane->highlight[marks[m]] = HL_ACTIVE;
+            laneMarks[i][m] = marks[m];
+        }
+    }
+}
+
+// The engines that will race, for the status line before the start
+static void DescribeEntered(char *buf, int size) {
+    int len = snprintf(buf, size, "  lanes:");
+    for (int e = 0; e < sortEngineCount && e < SORT_RACE_MAX_LANES && len < size; e++) {
+        if (raceEntered[e]) len += snprintf(buf + len, size - len, " %s", sortEngines[e].name);
+    }
+}
+
+static void DescribeLanes(void) {
+    for (int i = 0; i < race.laneCount; i++) {
+        const SortRaceLane *lane = &race.lanes[i];
+        double mops = SortRaceLaneOpsPerSecond(lane) / 1e6;
+        if (lane->place)
+            HudTextSetf(&laneTexts[i], 14, "#%d %s  %.2f ms  %.1f M ops/s", lane->place, lane->engine->name,
+                        lane->ms, mops);
+        else
+            HudTextSetf(&laneTexts[i], 14, "%s  %.2f ms  %.1f M ops/s  ops:%lld", lane->engine->name, lane->ms,
+                        mops, (long long)lane->steps);
+    }
+}
+
+// One cell per lane, two columns once there are more than three and three past eight;
+// every plot has the same size so the lanes share the renderer's texture
+static void DrawRace(Rectangle area, const SortCursor cursors[]) {
+    int count = race.laneCount;
+    int gridCols = count > 8 ? 3 : count > 3 ? 2 : 1;
+    int gridRows = (count + gridCols - 1) / gridCols;
+    float cellWidth = area.width / (float)gridCols;
+    float cellHeight = area.height / (float)gridRows;
+    BarView views[SORT_RACE_MAX_LANES];
+    Rectangle plots[SORT_RACE_MAX_LANES];
+
+    for (int i = 0; i < count; i++) {
+        const SortRaceLane *lane = &race.lanes[i];
+        float x = area.x + (float)(i % gridCols) * cellWidth;
+        float y = area.y + (float)(i / gridCols) * cellHeight;
+        plots[i] = (Rectangle){ x + 6, y + 24, (float)(int)(cellWidth - 12), (float)(int)(cellHeight - 30) };
+        views[i] = (BarView){
+            .values = lane->values,
+            .highlight = lane->highlight,
+            .n = race.n,
+            .minValue = valueMin,
+            .maxValue = valueMax,
+            .rangeLo = lane->place ? 0 : cursors[i].rangeLo,
+            .rangeHi = lane->place ? -1 : cursors[i].rangeHi,
+            .allDone = lane->place > 0,
+            .colors = { RAYWHITE, GREEN, ORANGE, SKYBLUE },
+        };
+        HudTextDraw(&laneTexts[i], (int)x + 6, (int)y + 4, lane->place == 1 ? GOLD : LIGHTGRAY);
     }
-    ResetMergeIndices();
+    BarRendererDrawLanes(&bars, views, count, plots);
 }
 
-void DoMergeStep(void) {
+static bool SameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// Sums the heat of the lines under each column, then draws runs of equal color: green for
+// L1 hits, yellow for L2 hits, red for memory, brighter for more accesses
+static void DrawCacheHeat(int buf, Rectangle row) {
+    const SortCacheHeat *heat = &cache.heat[buf];
+    int n = session.n;
+    int columns = (int)row.width < HEAT_MAX_COLUMNS ? (int)row.width : HEAT_MAX_COLUMNS;
+    if (columns < 1) return;
+    uint32_t peak = 1;
+    for (int col = 0; col < columns; col++) {
+        int lo = (int)((int64_t)col * n / columns);
+        int hi = (int)((int64_t)(col + 1) * n / columns) - 1;
+        if (hi < lo) hi = lo;
+        HeatColumn sum = {0};
+        for (int line = SortCacheLineOf(&cache, buf, lo); line <= SortCacheLineOf(&cache, buf, hi); line++) {
+            sum.accesses += heat->accesses[line];
+            sum.l1Misses += heat->l1Misses[line];
+            sum.l2Misses += heat->l2Misses[line];
+        }
+        heatColumns[col] = sum;
+        if (sum.accesses > peak) peak = sum.accesses;
+    }
+
+    DrawRectangleRec(row, (Color){ 30, 30, 30, 255 });
+    float columnWidth = row.width / (float)columns;
+    float logPeak = log2f(1.0f + (float)peak);
+    int runStart = 0;
+    Color runColor = BLANK;
+    for (int col = 0; col <= columns; col++) {
+        Color color = BLANK;
+        if (col < columns && heatColumns[col].accesses > 0) {
+            const HeatColumn *h = &heatColumns[col];
+            float l1 = (float)h->l1Misses / (float)h->accesses, l2 = (float)h->l2Misses / (float)h->accesses;
+            float bright = 0.25f + 0.75f * log2f(1.0f + (float)h->accesses) / logPeak;
+            color = (Color){ (unsigned char)(255.0f * l1 * bright), (unsigned char)(220.0f * (1.0f - l2) * bright), 0, 255 };
+        }
+        if (col < columns && col > runStart && SameColor(color, runColor)) continue;
+        if (col > runStart && runColor.a > 0)
+            DrawRectangleRec((Rectangle){ row.x + runStart * columnWidth, row.y, (col - runStart) * columnWidth, row.height },
+                             runColor);
+        runStart = col;
+        runColor = color;
+    }
+}
+
+static const char *SizeLabel(int bytes, char *buf, int size) {
+    if (bytes >= 1024 && bytes % 1024 == 0) snprintf(buf, size, "%d KB", bytes / 1024);
+    else snprintf(buf, size, "%d B", bytes);
+    return buf;
+}
+
+static bool CacheShown(void) {
+    return player.cache && Tracing() && state != ST_IDLE;
+}
+
+void StepSort(void) {
     if (state != ST_SORTING || paused) return;
 
-    for (int step = 0; step < speed; step++) {
-        if (i_idx <= mid && j_idx <= right) {
-            if (values[i_idx] <= values[j_idx])
-                aux[k_idx++] = values[i_idx++];
-            else
-                aux[k_idx++] = values[j_idx++];
-        } else if (i_idx <= mid) {
-            aux[k_idx++] = values[i_idx++];
-        } else if (j_idx <= right) {
-            aux[k_idx++] = values[j_idx++];
+    if (raceMode) {
+        StepSchedulerRun(&sched, gate.frameTime, RaceStepFn, &race);
+        if (SortRaceDone(&race)) {
+            state = ST_DONE;
+            paused = true;
+        }
+        return;
+    }
+
+    if (externalMode) {
+        if (StepExternal()) {
+            state = ST_DONE;
+            paused = true;
+        }
+        return;
+    }
+
+    if (parallelMode) {
+        if (ParallelSortDone(&psort)) {
+            state = ST_DONE;
+            paused = true;
         }
+        return;
+    }
 
-        // If merged this segment
-        if (k_idx > right) {
-            for (int t = left_start; t <= right; t++)
-                values[t] = aux[t];
-            NextMerge();
-            break; // break this step loop to refresh drawing
+    if (Tracing()) {
+        uint64_t accesses = cache.l1.accesses;
+        if (player.cache) SortCacheFadeHeat(&cache);
+        StepSchedulerRun(&sched, gate.frameTime, ReplayStepFn, &player);
+        if (player.cache && sched.lastMs > 0) cacheRate = (double)(cache.l1.accesses - accesses) / sched.lastMs * 1000.0;
+        if (TracePlayerDone(&player)) {
+            state = ST_DONE;
+            paused = true;
         }
+        return;
+    }
+
+    // Nothing is drawn until the end in run-to-completion mode. Before the first step the
+    // engine's fast path (SIMD for merge-simd) sorts the input; once the machine has
+    // started, values can be mid-pass (radix, tim), so the machine finishes itself
+    if (sched.mode == SCHED_COMPLETE) {
+        double t0 = SortClockMs();
+        if (SortMachineStats(&sorter)->steps == 0)
+            engine->sortFast(session.values, session.aux, session.n);
+        else
+            SortMachineRun(&sorter, INT64_MAX);
+        sched.lastMs = SortClockMs() - t0;
+        state = ST_DONE;
+        paused = true;
+        return;
     }
+
+    StepSchedulerRun(&sched, gate.frameTime, MachineStepFn, &sorter);
+    if (SortMachineDone(&sorter)) {
+        state = ST_DONE;
+        paused = true;
+    }
+}
+
+static void SeekTrace(int64_t delta, bool absolute) {
+    if (!Tracing() || state == ST_IDLE) return;
+
+    int64_t target = absolute ? delta : (int64_t)player.op + delta;
+    if (target < 0) target = 0;
+    TracePlayerSeek(&player, (uint64_t)target);
+    StepSchedulerReset(&sched);
+    state = TracePlayerDone(&player) ? ST_DONE : ST_SORTING;
+    paused = true;
+}
+
+// Milliseconds since page navigation on the web, since InitWindow natively
+static double StartupClockMs(void) {
+#if defined(PLATFORM_WEB)
+    return emscripten_get_now();
+#else
+    return GetTime() * 1000.0;
+#endif
 }
 
 void UpdateDrawFrame(void) {
-    if (IsKeyPressed(KEY_SPACE)) {
+    bool animating = (state == ST_SORTING && !paused) || DatasetLoadBusy(&load) || PROF_OVERLAY_VISIBLE();
+    if (!FrameGateBegin(&gate, animating)) return;
+    PROF_FRAME_BEGIN();
+    if (DatasetLoadBusy(&load)) {
+        // SPACE sorts the part that is already in; the handler below starts it
+        if (IsKeyPressed(KEY_SPACE)) {
+            DatasetLoadStop(&load);
+            if (load.state == LOAD_DONE) UseLoadedData();
+        } else {
+            PROF_SCOPE("load") UpdateLoad();
+        }
+    }
+    if (IsKeyPressed(KEY_SPACE) && !ParallelBusy() && !DatasetLoadBusy(&load)) {
         if (state == ST_IDLE) {
+            if (raceMode)
+                StartRace();
+            else if (externalMode)
+                StartExternal();
+            else if (parallelMode)
+                ParallelSortStart(&psort, session.values, session.aux, session.n, ParallelSortDefaultThreads());
+            else if (Tracing())
+                RecordTrace();
             state = ST_SORTING;
             paused = false;
-            ResetMergeIndices();
         } else if (state == ST_DONE) {
-            ResetArray();
+            ResetArray(session.n);
         } else {
             paused = !paused;
         }
     }
-    if (IsKeyPressed(KEY_R)) ResetArray();
-    if (IsKeyPressed(KEY_RIGHT_BRACKET)) speed *= 2;
-    if (IsKeyPressed(KEY_LEFT_BRACKET)) speed = (speed > 1) ? speed / 2 : 1;
+    if (!ParallelBusy()) {
+        if (IsKeyPressed(KEY_R)) ResetArray(session.n);
+        if (IsKeyPressed(KEY_UP)) ResetArray(session.n * 2);
+        if (IsKeyPressed(KEY_DOWN)) ResetArray(session.n / 2);
+        if (IsKeyPressed(KEY_T) && state == ST_IDLE) traceMode = !traceMode;
+        if (IsKeyPressed(KEY_C)) {
+            cacheMode = !cacheMode;
+            AttachCache();
+        }
+        if (IsKeyPressed(KEY_V)) {
+            cachePreset = (cachePreset + 1) % sortCachePresetCount;
+            AttachCache();
+        }
+        if (IsKeyPressed(KEY_P) && state == ST_IDLE) {
+            parallelMode = !parallelMode;
+            externalMode = raceMode = false;
+        }
+        if (IsKeyPressed(KEY_G) && state == ST_IDLE) {
+            raceMode = !raceMode;
+            parallelMode = externalMode = false;
+        }
+#if defined(PLATFORM_WEB)
+        if (IsKeyPressed(KEY_O)) OpenDataset(NULL);
+#else
+        if (IsKeyPressed(KEY_X) && state == ST_IDLE) {
+            externalMode = !externalMode;
+            parallelMode = raceMode = false;
+        }
+        if (IsFileDropped()) {
+            FilePathList dropped = LoadDroppedFiles();
+            if (dropped.count > 0) OpenDataset(dropped.paths[0]);
+            UnloadDroppedFiles(dropped);
+        }
+#endif
+        for (int e = 0; e < sortEngineCount && e < ENGINE_KEY_COUNT; e++) {
+            if (raceMode) {
+                if (IsKeyPressed(engineKeys[e]) && state == ST_IDLE && e < SORT_RACE_MAX_LANES) raceEntered[e] = !raceEntered[e];
+            } else if (IsKeyPressed(engineKeys[e]) && engine != &sortEngines[e]) {
+                engine = &sortEngines[e];
+                parallelMode = false;
+                ResetArray(session.n);
+            }
+        }
+    }
+    if (IsKeyPressed(KEY_RIGHT_BRACKET)) StepSchedulerFaster(&sched);
+    if (IsKeyPressed(KEY_LEFT_BRACKET)) StepSchedulerSlower(&sched);
+
+    int64_t seekStep = (int64_t)(trace.opCount / SEEK_FRACTION) + 1;
+    if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT)) SeekTrace(-seekStep, false);
+    if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT)) SeekTrace(seekStep, false);
+    if (IsKeyPressed(KEY_HOME)) SeekTrace(0, true);
+    if (IsKeyPressed(KEY_END)) SeekTrace((int64_t)trace.opCount, true);
+
+#if defined(PLATFORM_WEB)
+    // Natively Esc is raylib's exit key and main cleans up after the loop
     if (IsKeyPressed(KEY_ESCAPE)) {
         emscripten_cancel_main_loop();
+        ParallelSortWait(&psort);
+        DatasetLoadStop(&load);
+        SortRaceFree(&race);
+        BarRendererUnload(&bars);
+        HudUnload(&hud);
         CloseWindow();
+        SortTraceFree(&trace);
+        SortCacheFree(&cache);
+        SortSessionFree(&session);
         return;
     }
+#endif
+
+    PROF_SCOPE("sort step") StepSort();
+
+    int rangeLo = 0, rangeHi = -1;
+    const int *shown = session.values;
+    ParallelProgress progress = {0};
+    bool racing = raceMode && state != ST_IDLE;
+    SortCursor laneCursors[SORT_RACE_MAX_LANES];
+    if (racing) {
+        MarkLanes(laneCursors);
+        DescribeLanes();
+    }
+    if (parallelMode) {
+        if (state == ST_SORTING) {
+            ParallelSortProgress(&psort, &progress);
+            shown = progress.front;
+        }
+        MarkWriteFronts(&progress);
+    } else if (Tracing() && state != ST_IDLE) {
+        int lo, hi;
+        if (TracePlayerTakeTouched(&player, &lo, &hi)) BarRendererTouch(&bars, lo, hi);
+        MarkActive(player.cur.cmpA, player.cur.cmpB);
+        rangeLo = player.cur.rangeLo;
+        rangeHi = player.cur.rangeHi;
+    } else if (externalMode || raceMode) {
+        MarkActive(-1, -1);
+    } else {
+        SortCursor cursor;
+        SortMachineCursor(&sorter, &cursor);
+        MarkActive(cursor.a, cursor.b);
+        rangeLo = cursor.rangeLo;
+        rangeHi = cursor.rangeHi;
+    }
 
-    DoMergeStep();
+    if (raceMode)
+        HudTextSetf(&titleText, 20, "Sort Race (equal CPU time per lane)");
+    else if (externalMode)
+        HudTextSetf(&titleText, 20, "External Merge Sort Visualization (runs sorted by %s)", engine->name);
+    else if (parallelMode)
+        HudTextSetf(&titleText, 20, "Parallel Merge Sort Visualization (%d threads)", ParallelSortDefaultThreads());
+    else
+        HudTextSetf(&titleText, 20, "%s Visualization", engine->title);
+    char buf[200], rate[32];
+    int len = sprintf(buf, "State: %s  speed:%s  n:%d  steps/frame:%lld",
+                      state == ST_DONE ? "done" : (paused ? "paused" : "running"),
+                      StepSchedulerDescribe(&sched, rate, sizeof(rate)), session.n, (long long)sched.lastSteps);
+    if (load.state == LOAD_PICKING)
+        sprintf(buf + len, "  choosing a file...");
+    else if (DatasetLoadBusy(&load))
+        snprintf(buf + len, sizeof(buf) - len, "  loading %s %.0f%%", load.name, DatasetLoadProgress(&load) * 100.0f);
+    else if (racing)
+        sprintf(buf + len, "  lanes:%d  finished:%d", race.laneCount, race.finished);
+    else if (raceMode)
+        DescribeEntered(buf + len, (int)sizeof(buf) - len);
+    else if (externalMode && state != ST_IDLE)
+        DescribeExternal(buf + len, (int)sizeof(buf) - len);
+    else if (parallelMode && state == ST_SORTING)
+        sprintf(buf + len, "  pass:%d/%d", progress.pass, progress.passCount);
+    else if (parallelMode && state == ST_DONE)
+        sprintf(buf + len, "  %d threads: %.1f ms", psort.threadCount, psort.seconds * 1000.0);
+    else if (Tracing() && state != ST_IDLE)
+        sprintf(buf + len, "  op:%llu/%llu  trace:%zu KB", (unsigned long long)player.op,
+                (unsigned long long)trace.opCount, SortTraceBytes(&trace) / 1024);
+    else if (!Tracing())
+        sprintf(buf + len, "  cmp:%llu  (live)", (unsigned long long)SortMachineStats(&sorter)->comparisons);
+    HudTextSet(&statusText, buf, 16);
+    if (CacheShown()) {
+        const SortCacheConfig *config = &cache.config;
+        char l1[16], l2[16];
+        HudTextSetf(&cacheText, 14, "cache %s (L1 %s %d-way, L2 %s %d-way, TLB %d x %d B)  miss L1 %.2f%%  L2 %.2f%%  "
+                    "TLB %.2f%%  writebacks L1 %llu  L2 %llu  %.1f M accesses/s",
+                    config->name, SizeLabel(config->l1.sizeBytes, l1, sizeof(l1)), config->l1.ways,
+                    SizeLabel(config->l2.sizeBytes, l2, sizeof(l2)), config->l2.ways,
+                    config->tlb.sizeBytes / config->tlb.lineBytes, config->tlb.lineBytes, SortCacheMissRate(&cache.l1) * 100.0,
+                    SortCacheMissRate(&cache.l2) * 100.0, SortCacheMissRate(&cache.tlb) * 100.0,
+                    (unsigned long long)cache.l1.writebacks, (unsigned long long)cache.l2.writebacks, cacheRate / 1e6);
+    } else if (cacheMode && Tracing()) {
+        HudTextSetf(&cacheText, 14, "cache %s: modeled on trace replays; starts with the sort", sortCachePresets[cachePreset].name);
+    } else {
+        HudTextSet(&cacheText, "", 14);
+    }
+    PROF_SCOPE("hud") HudUpdate(&hud);
+    PROF_OVERLAY_UPDATE();
 
     BeginDrawing();
     ClearBackground(BLACK);
 
     int sw = GetScreenWidth();
     int sh = GetScreenHeight();
-    float barWidth = (float)sw / NUM_BARS;
 
-    for (int i = 0; i < NUM_BARS; i++) {
-        int h = values[i];
-        int x = i * barWidth;
-        int y = sh - h;
-        Color c = RAYWHITE;
+    BarView view = {
+        .values = shown,
+        .highlight = session.highlight,
+        .n = session.n,
+        .minValue = valueMin,
+        .maxValue = valueMax,
+        .rangeLo = (state == ST_SORTING) ? rangeLo : 0,
+        .rangeHi = (state == ST_SORTING) ? rangeHi : -1,
+        .allDone = state == ST_DONE,
+        .tracked = Tracing() && state == ST_SORTING,     // the player reports what it wrote
+        .colors = { RAYWHITE, GREEN, ORANGE, SKYBLUE },
+    };
+    Rectangle plot = { 0, 100, (float)sw, (float)(sh - 100) };
+    if (CacheShown()) {
+        // values, then aux when the engine uses it, along the bottom
+        for (int b = cache.bufferCount - 1; b >= 0; b--) {
+            plot.height -= HEAT_ROW_HEIGHT + 2;
+            DrawCacheHeat(b, (Rectangle){ plot.x, plot.y + plot.height + 2, plot.width, HEAT_ROW_HEIGHT });
+        }
+    }
+    if (racing) {
+        PROF_SCOPE("bars") DrawRace(plot, laneCursors);
+    } else if (externalMode && state == ST_SORTING) {
+        PROF_SCOPE("bars") DrawExternal(plot);
+    } else {
+        PROF_SCOPE("bars") BarRendererDraw(&bars, &view, plot);
+    }
+
+    HudTextDraw(&titleText, 10, 10, RAYWHITE);
+    HudTextDraw(&helpText, 10, 40, LIGHTGRAY);
+    HudTextDraw(&statusText, 10, 65, LIGHTGRAY);
+    HudTextDraw(&cacheText, 10, 84, LIGHTGRAY);
 
-        if (state == ST_SORTING) {
-            if (i >= left_start && i <= right) c = GREEN;
-            if (i == i_idx || i == j_idx) c = ORANGE;
+    // Per-worker progress through its slice of the current pass
+    if (parallelMode && state == ST_SORTING) {
+        float slot = (float)(sw - 20) / (float)progress.threadCount;
+        for (int t = 0; t < progress.threadCount; t++) {
+            int size = progress.sliceHi[t] - progress.sliceLo[t];
+            float done = size > 0 ? (float)progress.written[t] / (float)size : 1.0f;
+            Rectangle bar = { 10 + slot * (float)t, 86, slot - 4, 8 };
+            DrawRectangleRec(bar, DARKGRAY);
+            DrawRectangleRec((Rectangle){ bar.x, bar.y, bar.width * (done < 1.0f ? done : 1.0f), bar.height }, SKYBLUE);
         }
-        if (state == ST_DONE) c = SKYBLUE;
+    }
 
-        DrawRectangle(x + 1, y, barWidth - 2, h, c);
+    if (DatasetLoadBusy(&load)) {
+        Rectangle bar = { 10, 86, (float)(sw - 20), 8 };
+        DrawRectangleRec(bar, DARKGRAY);
+        DrawRectangleRec((Rectangle){ bar.x, bar.y, bar.width * DatasetLoadProgress(&load), bar.height }, SKYBLUE);
     }
 
-    DrawText("Merge Sort Visualization", 10, 10, 20, RAYWHITE);
-    DrawText("SPACE: start/pause | R: reset | [ ] speed | Esc quit", 10, 40, 16, LIGHTGRAY);
-    char buf[128];
-    sprintf(buf, "State: %s  speed:%d  size:%d", 
-            state == ST_DONE ? "done" : (paused ? "paused" : "running"), speed, curr_size);
-    DrawText(buf, 10, 65, 16, LIGHTGRAY);
+    PROF_OVERLAY_DRAW(sw - 250, 110);
+    PROF_SCOPE("end drawing") EndDrawing();
+    PROF_FRAME_END();
 
-    EndDrawing();
+    // Startup cost as a visitor sees it: time to the first finished frame
+    static bool firstFrameReported = false;
+    if (!firstFrameReported) {
+        printf("First frame at %.0f ms\n", StartupClockMs());
+        firstFrameReported = true;
+    }
 }
 
-int main(void) {
+int main(int argc, char **argv) {
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(1000, 700, "Merge Sort Visualization");
-    SetTargetFPS(60);
-    ResetArray();
+#if !defined(PLATFORM_WEB)
+    SetTargetFPS(60);   // on the web requestAnimationFrame paces the loop; raylib's wait would busy-wait
+#endif
+    BarRendererInit(&bars);
+    FrameGateInit(&gate);
+    HudInit(&hud);
+    HudAdd(&hud, &titleText);
+    HudAdd(&hud, &helpText);
+    HudAdd(&hud, &statusText);
+    HudAdd(&hud, &cacheText);
+    for (int i = 0; i < SORT_RACE_MAX_LANES; i++) {
+        HudAdd(&hud, &laneTexts[i]);
+        raceEntered[i] = true;
+    }
+#if defined(PLATFORM_WEB)
+    HudTextSet(&helpText, "SPACE: start/pause | R: reset | UP/DOWN: size | [ ] speed | LEFT/RIGHT/HOME/END: scrub | T: trace mode | C/V: cache model/preset | 1-9 0 - =: algorithm | P: parallel | G: race | O: load data | Esc quit", 16);
+#else
+    HudTextSet(&helpText, "SPACE: start/pause | R: reset | UP/DOWN: size | [ ] speed | LEFT/RIGHT/HOME/END: scrub | T: trace mode | C/V: cache model/preset | 1-9 0 - =: algorithm | P: parallel | G: race | X: external | drop a file: load data | Esc quit", 16);
+#endif
+    engine = SortEngineFind("merge");
+    StepSchedulerInit(&sched, 120);    // the old 2 steps per frame at 60 FPS
+    ResetArray(DEFAULT_BARS);
+    if (argc > 1) OpenDataset(argv[1]);     // native; the web build has no arguments
 
+#if defined(PLATFORM_WEB)
     emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
+#else
+    while (!WindowShouldClose()) UpdateDrawFrame();
+#endif
 
+    ParallelSortWait(&psort);
+    DatasetLoadStop(&load);
+    StopExternal();
+    SortRaceFree(&race);
+    BarRendererUnload(&bars);
+    HudUnload(&hud);
     CloseWindow();
+    SortTraceFree(&trace);
+    SortCacheFree(&cache);
+    SortSessionFree(&session);
     return 0;
 }
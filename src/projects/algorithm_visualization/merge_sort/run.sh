@@ -1 +1,13 @@
-python3 -m http.server 8080
+# The pthread build needs SharedArrayBuffer, which browsers only expose to
+# cross-origin isolated pages, so serve with COOP/COEP headers
+python3 -c '
+import http.server
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    def end_headers(self):
+        self.send_header("Cross-Origin-Opener-Policy", "same-origin")
+        self.send_header("Cross-Origin-Embedder-Policy", "require-corp")
+        super().end_headers()
+
+http.server.ThreadingHTTPServer(("", 8080), Handler).serve_forever()
+'
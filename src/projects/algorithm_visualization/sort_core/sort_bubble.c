@@ -0,0 +1,95 @@
+// sort_bubble.c
+#include "sort_core.h"
+
+static inline void swap(int *a, int *b)
+{
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+void BubbleSortInit(BubbleSort *s, int *values, int length)
+{
+    s->values = values;
+    s->length = length;
+    s->i = 0;
+    s->j = 0;
+    s->bound = length;
+    s->lastSwap = 0;
+    s->sorted = length < 2;
+    s->stats = (SortStats){0};
+    s->trace = NULL;
+}
+
+// instead of bubble sort we implmenet bubble sort step by step for visualization
+void BubbleSortStep(BubbleSort *s)
+{
+    if (s->sorted)
+        return;
+
+    int *array = s->values;
+    s->stats.steps++;
+
+    if (s->j < s->bound - 1)
+    {
+        s->stats.comparisons++;
+        SORT_TRACE(s->trace, TraceCompare(s->trace, 0, s->j, 0, s->j + 1));
+        if (array[s->j] > array[s->j + 1])
+        {
+            SORT_TRACE(s->trace, TraceSwap(s->trace, 0, s->j, s->j + 1));
+            swap(&array[s->j], &array[s->j + 1]);
+            s->stats.swaps++;
+            s->lastSwap = s->j + 1;
+        }
+        (s->j)++;
+    }
+    else
+    {
+        // Nothing moved past the last swap, so the next pass can stop there
+        s->bound = s->lastSwap;
+        s->lastSwap = 0;
+        s->j = 0;
+        (s->i)++;
+        if (s->bound < 2)
+            s->sorted = true;
+    }
+}
+
+int64_t BubbleSortRun(BubbleSort *s, int64_t maxSteps)
+{
+    uint64_t start = s->stats.steps;
+    while (!s->sorted && (int64_t)(s->stats.steps - start) < maxSteps)
+        BubbleSortStep(s);
+    return (int64_t)(s->stats.steps - start);
+}
+
+void BubbleSortCursor(const BubbleSort *s, SortCursor *c)
+{
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (s->sorted)
+        return;
+    if (s->j < s->bound - 1)
+    {
+        c->a = s->j;
+        c->b = s->j + 1;
+    }
+    c->rangeHi = s->bound - 1;
+}
+
+void BubbleSortFast(int *values, int n)
+{
+    int bound = n;
+    while (bound > 1)
+    {
+        int lastSwap = 0;
+        for (int j = 0; j < bound - 1; j++)
+        {
+            if (values[j] > values[j + 1])
+            {
+                swap(&values[j], &values[j + 1]);
+                lastSwap = j + 1;
+            }
+        }
+        bound = lastSwap;
+    }
+}
@@ -0,0 +1,99 @@
+// sort_cache.c
+#include "sort_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+// "tiny" is scaled down so the default 80 bars already spill out of L1; "small" suits
+// arrays of a few thousand elements; "desktop" is a typical x86 core
+const SortCacheConfig sortCachePresets[] = {
+    { "tiny",    { 256, 16, 2 },       { 2048, 16, 4 },        { 8 * 256, 256, 2 } },
+    { "small",   { 4096, 64, 4 },      { 64 * 1024, 64, 8 },   { 16 * 4096, 4096, 4 } },
+    { "desktop", { 32 * 1024, 64, 8 }, { 512 * 1024, 64, 8 },  { 64 * 4096, 4096, 4 } },
+};
+const int sortCachePresetCount = (int)(sizeof(sortCachePresets) / sizeof(sortCachePresets[0]));
+
+static bool PowerOfTwo(int v) {
+    return v > 0 && (v & (v - 1)) == 0;
+}
+
+static int Log2(int v) {
+    int shift = 0;
+    while ((1 << shift) < v) shift++;
+    return shift;
+}
+
+static bool LevelInit(SortCacheLevel *level, SortCacheGeometry g) {
+    if (!PowerOfTwo(g.lineBytes) || g.ways < 1 || g.sizeBytes % (g.lineBytes * g.ways) != 0) return false;
+    int sets = g.sizeBytes / (g.lineBytes * g.ways);
+    if (!PowerOfTwo(sets)) return false;
+    *level = (SortCacheLevel){ .ways = g.ways, .lineShift = Log2(g.lineBytes), .setMask = (uint64_t)sets - 1 };
+    level->tags = malloc((size_t)sets * (size_t)g.ways * sizeof(uint64_t));
+    return level->tags != NULL;
+}
+
+static void LevelReset(SortCacheLevel *level) {
+    size_t entries = (size_t)(level->setMask + 1) * (size_t)level->ways;
+    memset(level->tags, 0xFF, entries * sizeof(uint64_t));     // UINT64_MAX: empty
+    level->accesses = level->misses = level->writebacks = 0;
+}
+
+bool SortCacheBegin(SortCache *c, const SortCacheConfig *config, int *buffers[], int bufferCount, int n) {
+    SortCacheFree(c);
+    c->config = *config;
+    // The fast path takes a line it hit as a page it hit, so a line may not span pages
+    if (config->l1.lineBytes > config->tlb.lineBytes || n < 1 || !LevelInit(&c->l1, config->l1) ||
+        !LevelInit(&c->l2, config->l2) || !LevelInit(&c->tlb, config->tlb)) {
+        SortCacheFree(c);
+        return false;
+    }
+
+    c->bufferCount = bufferCount < TRACE_MAX_BUFFERS ? bufferCount : TRACE_MAX_BUFFERS;
+    size_t total = 0;
+    for (int b = 0; b < c->bufferCount; b++) {
+        c->base[b] = (uintptr_t)buffers[b];
+        c->baseLine[b] = (uint64_t)c->base[b] >> c->l1.lineShift;
+        c->heat[b].lines = SortCacheLineOf(c, b, n - 1) + 1;
+        total += (size_t)c->heat[b].lines * 3;
+    }
+    c->block = malloc(total * sizeof(uint32_t));
+    if (!c->block) {
+        SortCacheFree(c);
+        return false;
+    }
+    uint32_t *next = c->block;
+    for (int b = 0; b < c->bufferCount; b++) {
+        SortCacheHeat *h = &c->heat[b];
+        h->accesses = next;
+        h->l1Misses = next + h->lines;
+        h->l2Misses = next + 2 * (size_t)h->lines;
+        next += 3 * (size_t)h->lines;
+    }
+    SortCacheReset(c);
+    return true;
+}
+
+void SortCacheFree(SortCache *c) {
+    free(c->l1.tags);
+    free(c->l2.tags);
+    free(c->tlb.tags);
+    free(c->block);
+    *c = (SortCache){0};
+}
+
+void SortCacheReset(SortCache *c) {
+    LevelReset(&c->l1);
+    LevelReset(&c->l2);
+    LevelReset(&c->tlb);
+    c->lastLine = UINT64_MAX;
+    c->lastTag = NULL;
+    for (int b = 0; b < c->bufferCount; b++)
+        memset(c->heat[b].accesses, 0, (size_t)c->heat[b].lines * 3 * sizeof(uint32_t));
+}
+
+void SortCacheFadeHeat(SortCache *c) {
+    for (int b = 0; b < c->bufferCount; b++) {
+        uint32_t *counters = c->heat[b].accesses;
+        size_t count = (size_t)c->heat[b].lines * 3;
+        for (size_t i = 0; i < count; i++) counters[i] >>= 1;
+    }
+}
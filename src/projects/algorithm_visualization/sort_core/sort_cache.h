@@ -0,0 +1,180 @@
+// sort_cache.h
+// Memory-hierarchy model for the sort visualizers: every read and write of values[] and
+// aux[] goes through a set-associative L1, an L2 behind it and a TLB, each with LRU
+// replacement. Both caches are write-back and write-allocate: a dirty line evicted from
+// L1 is written into L2 (an L2 access that leaves the line dirty there), and one evicted
+// from L2 goes to memory; each counts as a writeback of its level. Addresses are the
+// buffers' real ones, so lines split the arrays where the hardware would.
+//
+// The model is fed from a trace replay (TracePlayer.cache): every op is turned into the
+// element reads and writes it stands for. Per L1 line of each buffer it keeps how many
+// accesses hit, missed L1 and missed L2 since the last fade, which the visualizers draw as
+// a heatmap. An access to the line the previous one touched skips the set search, so
+// sequential scans cost a few instructions per element.
+#ifndef SORT_CACHE_H
+#define SORT_CACHE_H
+
+#include "sort_trace.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bytes, bytes per line and ways; sizeBytes / (lineBytes * ways) sets, a power of two.
+// A TLB is a cache of translations: lineBytes is the page size, sizeBytes its reach
+typedef struct SortCacheGeometry {
+    int sizeBytes, lineBytes, ways;
+} SortCacheGeometry;
+
+typedef struct SortCacheConfig {
+    const char *name;
+    SortCacheGeometry l1, l2, tlb;
+} SortCacheConfig;
+
+extern const SortCacheConfig sortCachePresets[];
+extern const int sortCachePresetCount;
+
+typedef struct SortCacheLevel {
+    uint64_t *tags;        // sets * ways, most recently used first; line << 1 | dirty
+    int ways;
+    int lineShift;
+    uint64_t setMask;
+    uint64_t accesses, misses, writebacks;
+} SortCacheLevel;
+
+// Activity per L1 line of one buffer since the last SortCacheFadeHeat
+typedef struct SortCacheHeat {
+    uint32_t *accesses;
+    uint32_t *l1Misses;
+    uint32_t *l2Misses;    // went to memory
+    int lines;
+} SortCacheHeat;
+
+typedef struct SortCache {
+    SortCacheConfig config;
+    SortCacheLevel l1, l2, tlb;
+    int bufferCount;
+    uintptr_t base[TRACE_MAX_BUFFERS];
+    uint64_t baseLine[TRACE_MAX_BUFFERS];
+    SortCacheHeat heat[TRACE_MAX_BUFFERS];
+    uint64_t lastLine;     // L1 line of the previous access, the MRU way of its set
+    uint64_t *lastTag;     // its tag, for marking it dirty
+    uint32_t *block;       // heat counters of every buffer
+} SortCache;
+
+// Sizes the model for n-element buffers and starts it cold; false when a geometry is not
+// a power of two or memory runs out
+bool SortCacheBegin(SortCache *c, const SortCacheConfig *config, int *buffers[], int bufferCount, int n);
+void SortCacheFree(SortCache *c);
+// Empties every level and zeroes the counters and the heat, keeping the geometry
+void SortCacheReset(SortCache *c);
+// Halves the heat counters, so the map shows recent activity
+void SortCacheFadeHeat(SortCache *c);
+
+// Heat slot of element idx; the first line can hold fewer elements, the buffer need not
+// start on a line
+static inline int SortCacheLineOf(const SortCache *c, int buf, int idx) {
+    return (int)(((uint64_t)(c->base[buf] + (uintptr_t)idx * sizeof(int)) >> c->l1.lineShift) - c->baseLine[buf]);
+}
+
+static inline double SortCacheMissRate(const SortCacheLevel *level) {
+    return level->accesses ? (double)level->misses / (double)level->accesses : 0.0;
+}
+
+//------------------------------------------------------------------------------------
+// Simulation (inline: called for every element access of a replay)
+//------------------------------------------------------------------------------------
+// Looks line up in its set and makes it the most recently used way; on a miss it
+// replaces the least recently used one. Returns the slot now holding line; *dirtyVictim
+// is the line evicted dirty, UINT64_MAX for none
+static inline uint64_t *SortCacheLookup(SortCacheLevel *level, uint64_t line, bool *hit, uint64_t *dirtyVictim) {
+    uint64_t *set = level->tags + (size_t)(line & level->setMask) * (size_t)level->ways;
+    uint64_t entry = line << 1;
+    int way = 0;
+    while (way < level->ways && (set[way] >> 1) != line) way++;
+    level->accesses++;
+    *hit = way < level->ways;
+    *dirtyVictim = UINT64_MAX;
+    if (*hit) {
+        entry = set[way];
+    } else {
+        way = level->ways - 1;
+        level->misses++;
+        if (set[way] != UINT64_MAX && (set[way] & 1)) {
+            level->writebacks++;
+            *dirtyVictim = set[way] >> 1;
+        }
+    }
+    for (; way > 0; way--) set[way] = set[way - 1];
+    set[0] = entry;
+    return set;
+}
+
+// A dirty L1 line goes to L2, which allocates it if needed and keeps it dirty
+static inline void SortCacheWriteBack(SortCache *c, uint64_t l1Line) {
+    bool hit;
+    uint64_t victim;
+    uint64_t addr = l1Line << c->l1.lineShift;
+    *SortCacheLookup(&c->l2, addr >> c->l2.lineShift, &hit, &victim) |= 1;
+}
+
+static inline void SortCacheAccess(SortCache *c, int buf, int idx, bool write) {
+    uintptr_t addr = c->base[buf] + (uintptr_t)idx * sizeof(int);
+    uint64_t line = (uint64_t)addr >> c->l1.lineShift;
+    SortCacheHeat *heat = &c->heat[buf];
+    uint32_t slot = (uint32_t)(line - c->baseLine[buf]);
+    heat->accesses[slot]++;
+    if (line == c->lastLine) {
+        // Same line, same page: an L1 and TLB hit that changes no LRU order
+        c->l1.accesses++;
+        c->tlb.accesses++;
+        *c->lastTag |= write;
+        return;
+    }
+
+    bool hit;
+    uint64_t victim, l2Victim;
+    SortCacheLookup(&c->tlb, (uint64_t)addr >> c->tlb.lineShift, &hit, &victim);
+    uint64_t *tag = SortCacheLookup(&c->l1, line, &hit, &victim);
+    if (!hit) {
+        heat->l1Misses[slot]++;
+        SortCacheLookup(&c->l2, (uint64_t)addr >> c->l2.lineShift, &hit, &l2Victim);
+        if (!hit) heat->l2Misses[slot]++;
+        // After the fill, as a write buffer would drain it
+        if (victim != UINT64_MAX) SortCacheWriteBack(c, victim);
+    }
+    *tag |= write;
+    c->lastLine = line;
+    c->lastTag = tag;
+}
+
+// The element reads and writes behind one trace op
+static inline void SortCacheApply(SortCache *c, const TraceOp *op) {
+    switch (op->type) {
+    case TRACE_COMPARE:
+        SortCacheAccess(c, op->bufA, op->a, false);
+        SortCacheAccess(c, op->bufB, op->b, false);
+        break;
+    case TRACE_SWAP:
+        SortCacheAccess(c, op->bufA, op->a, false);
+        SortCacheAccess(c, op->bufA, op->b, false);
+        SortCacheAccess(c, op->bufA, op->a, true);
+        SortCacheAccess(c, op->bufA, op->b, true);
+        break;
+    case TRACE_MOVE:
+        SortCacheAccess(c, op->bufB, op->b, false);
+        SortCacheAccess(c, op->bufA, op->a, true);
+        break;
+    case TRACE_WRITE:
+        SortCacheAccess(c, op->bufA, op->a, true);
+        break;
+    case TRACE_COPY_RANGE:
+        for (int k = op->a; k <= op->b; k++) {
+            SortCacheAccess(c, op->bufB, k, false);
+            SortCacheAccess(c, op->bufA, k, true);
+        }
+        break;
+    case TRACE_RANGE:
+        break;
+    }
+}
+
+#endif // SORT_CACHE_H
@@ -0,0 +1,342 @@
+// sort_core.h
+// Render-free sort step engines shared by the visualizers and the native tools.
+// Nothing in here may depend on raylib or emscripten.
+#ifndef SORT_CORE_H
+#define SORT_CORE_H
+
+#include "sort_trace.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Operation counters collected by every engine
+typedef struct SortStats {
+    uint64_t comparisons;
+    uint64_t swaps;
+    uint64_t writes;       // element stores that are not part of a swap
+    uint64_t steps;        // calls that made progress (one compare or one element move)
+} SortStats;
+
+//------------------------------------------------------------------------------------
+// Bubble sort: one comparison per step. Each pass stops at the previous pass's last
+// swap, since everything after it is already in place; a pass without swaps ends it
+//------------------------------------------------------------------------------------
+typedef struct BubbleSort {
+    int *values;
+    int length;
+    int i, j;              // pass number, pair (j, j + 1) compared next
+    int bound;             // [bound, length) is final
+    int lastSwap;          // bound for the next pass: one past the last swap of this one
+    bool sorted;
+    SortStats stats;
+    SortTrace *trace;      // optional, attach after Init
+} BubbleSort;
+
+void BubbleSortInit(BubbleSort *s, int *values, int length);
+void BubbleSortStep(BubbleSort *s);
+int64_t BubbleSortRun(BubbleSort *s, int64_t maxSteps);   // returns steps executed
+
+//------------------------------------------------------------------------------------
+// Bottom-up merge sort: one element merged into aux per step
+//------------------------------------------------------------------------------------
+typedef struct MergeSort {
+    int *values;
+    int *aux;
+    int n;
+    int currSize;          // current size of subarrays to merge
+    int leftStart;         // start index of the current merge
+    int iIdx, jIdx, kIdx;
+    int mid, right;
+    bool done;
+    SortStats stats;
+    SortTrace *trace;      // optional, attach after Init; buffer 0 = values, 1 = aux
+} MergeSort;
+
+void MergeSortInit(MergeSort *m, int *values, int *aux, int n);
+void ResetMergeIndices(MergeSort *m);
+void NextMerge(MergeSort *m);
+bool DoMergeStep(MergeSort *m);                            // true when a segment finished merging
+int64_t MergeSortRun(MergeSort *m, int64_t maxSteps, bool stopAtMergeEnd);
+
+//------------------------------------------------------------------------------------
+// Live highlight state, reported by every engine through its Cursor function
+//------------------------------------------------------------------------------------
+typedef struct SortCursor {
+    int a, b;              // elements being compared or moved, -1 when none
+    int rangeLo, rangeHi;  // region being worked on, empty when rangeHi < rangeLo
+} SortCursor;
+
+void BubbleSortCursor(const BubbleSort *s, SortCursor *c);
+void MergeSortCursor(const MergeSort *m, SortCursor *c);
+
+//------------------------------------------------------------------------------------
+// Sub-machines shared by the hybrid sorts
+//------------------------------------------------------------------------------------
+// Swap-based insertion sort over [lo, hi]; one comparison per step
+typedef struct InsertionPass {
+    int lo, hi;
+    int i, j;
+    bool done;
+} InsertionPass;
+
+void InsertionPassInit(InsertionPass *p, int lo, int hi, int sortedUpTo);   // [lo, sortedUpTo) already sorted
+bool InsertionPassStep(InsertionPass *p, int *values, SortStats *stats, SortTrace *trace);   // true when finished
+void InsertionSortFast(int *values, int lo, int hi);
+
+// Max-heap sift-down inside values[base .. base + size); one level per step
+typedef struct HeapSift {
+    int base, size;
+    int node;
+    bool active;
+} HeapSift;
+
+void HeapSiftBegin(HeapSift *h, int base, int size, int node);
+void HeapSiftStep(HeapSift *h, int *values, SortStats *stats, SortTrace *trace);
+void HeapSortFast(int *values, int lo, int hi);
+
+// Median of values[lo], values[mid], values[hi], without moving anything
+int MedianOfThree(const int *values, int lo, int mid, int hi, SortStats *stats, SortTrace *trace);
+
+//------------------------------------------------------------------------------------
+// Quicksort with 3-way (Dijkstra) partitioning: one comparison per step
+//------------------------------------------------------------------------------------
+#define QUICK_STACK 64         // smaller side is always taken first, so depth <= log2(n)
+
+typedef struct QuickSort {
+    int *values;
+    int n;
+    int stackLo[QUICK_STACK], stackHi[QUICK_STACK];
+    int top;
+    int lo, hi;            // range being partitioned
+    int lt, i, gt;         // [lo, lt) < pivot, [lt, i) == pivot, (gt, hi] > pivot
+    int pivot;
+    bool partitioning;
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} QuickSort;
+
+void QuickSortInit(QuickSort *q, int *values, int n);
+int64_t QuickSortRun(QuickSort *q, int64_t maxSteps);
+void QuickSortCursor(const QuickSort *q, SortCursor *c);
+void QuickSortFast(int *values, int n);
+
+//------------------------------------------------------------------------------------
+// Heapsort: one sift level per step
+//------------------------------------------------------------------------------------
+typedef struct HeapSort {
+    int *values;
+    int n;
+    bool building;         // heapify phase, then extraction
+    int next;              // building: next node to sift; extracting: last index of the heap
+    HeapSift sift;
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} HeapSort;
+
+void HeapSortInit(HeapSort *h, int *values, int n);
+int64_t HeapSortRun(HeapSort *h, int64_t maxSteps);
+void HeapSortCursor(const HeapSort *h, SortCursor *c);
+
+//------------------------------------------------------------------------------------
+// LSD radix sort, 8-bit digits, ping-ponging between values and aux: one element per step
+//------------------------------------------------------------------------------------
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (32 / RADIX_BITS)
+
+typedef enum { RADIX_COUNT, RADIX_SCATTER, RADIX_COPY_BACK } RadixPhase;
+
+typedef struct RadixSort {
+    int *values;
+    int *aux;
+    int n;
+    int pass;
+    RadixPhase phase;
+    int i;
+    int srcBuf;            // 0 = values, 1 = aux; the other buffer is written
+    int offsets[RADIX_BUCKETS];
+    bool done;
+    SortStats stats;
+    SortTrace *trace;      // buffer 0 = values, 1 = aux; counting reads show as self-compares
+} RadixSort;
+
+void RadixSortInit(RadixSort *r, int *values, int *aux, int n);
+int64_t RadixSortRun(RadixSort *r, int64_t maxSteps);
+void RadixSortCursor(const RadixSort *r, SortCursor *c);
+void RadixSortFast(int *values, int *aux, int n);
+
+//------------------------------------------------------------------------------------
+// Introsort: median-of-3 Hoare quicksort, heapsort below the depth limit, insertion
+// sort for small ranges. One comparison (or one sift level) per step
+//------------------------------------------------------------------------------------
+#define INTRO_STACK 64
+#define INTRO_SMALL 16
+
+typedef enum { INTRO_POP, INTRO_PARTITION, INTRO_HEAP, INTRO_INSERTION } IntroMode;
+
+typedef struct IntroFrame {
+    int lo, hi;
+    int depth;             // partitions left before falling back to heapsort
+} IntroFrame;
+
+typedef struct IntroSort {
+    int *values;
+    int n;
+    IntroFrame stack[INTRO_STACK];
+    int top;
+    IntroMode mode;
+    IntroFrame cur;
+    int pivot, i, j;
+    bool scanJ;            // Hoare scan: false while advancing i, true while retreating j
+    bool heapBuilding;
+    int heapNext;
+    HeapSift sift;
+    InsertionPass ins;
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} IntroSort;
+
+void IntroSortInit(IntroSort *s, int *values, int n);
+int64_t IntroSortRun(IntroSort *s, int64_t maxSteps);
+void IntroSortCursor(const IntroSort *s, SortCursor *c);
+void IntroSortFast(int *values, int n);
+
+//------------------------------------------------------------------------------------
+// Timsort: natural runs extended to minrun by insertion, merged under the stack
+// invariants using aux for the left run. One comparison or element move per step
+//------------------------------------------------------------------------------------
+#define TIM_MAX_RUNS 85
+
+typedef enum {
+    TIM_SCAN,              // start a new run at pos
+    TIM_EXTEND_RUN,        // walk the natural run
+    TIM_REVERSE,           // reverse a strictly descending run
+    TIM_INSERTION,         // pad a short run to minRun
+    TIM_COLLAPSE,          // pick the next merge, if any
+    TIM_COPY_LEFT,         // left run -> aux
+    TIM_MERGE              // aux + right run -> values
+} TimMode;
+
+typedef struct TimRun {
+    int base, len;
+} TimRun;
+
+typedef struct TimSort {
+    int *values;
+    int *aux;
+    int n;
+    int minRun;
+    TimRun runs[TIM_MAX_RUNS];
+    int runCount;
+    int pos;               // first element not yet in a run
+    TimMode mode;
+    bool finalCollapse;    // all runs found, merge everything
+    int runStart, runEnd;
+    bool descending;
+    int revLo, revHi;
+    InsertionPass ins;
+    int mergeLo;
+    int i, iEnd, j, jEnd, k;   // merge cursors: i in aux, j and k in values
+    bool done;
+    SortStats stats;
+    SortTrace *trace;      // buffer 0 = values, 1 = aux
+} TimSort;
+
+void TimSortInit(TimSort *t, int *values, int *aux, int n);
+int64_t TimSortRun(TimSort *t, int64_t maxSteps);
+void TimSortCursor(const TimSort *t, SortCursor *c);
+void TimSortFast(int *values, int *aux, int n);
+
+//------------------------------------------------------------------------------------
+// Exchange sorts beside bubble sort (sort_exchange.c), one comparison per step:
+// cocktail shaker alternates pass direction and narrows both ends to the last swaps,
+// comb sort compares across a gap that shrinks by 1.3 until a gap-1 pass swaps nothing,
+// odd-even transposition alternates the (even, odd) and (odd, even) pairs
+//------------------------------------------------------------------------------------
+typedef struct CocktailSort {
+    int *values;
+    int n;
+    int lo, hi;            // unsorted window [lo, hi]
+    int j;                 // forward: pair (j, j + 1); backward: pair (j - 1, j)
+    bool forward;
+    int lastSwap;          // the window edge the current pass will leave
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} CocktailSort;
+
+void CocktailSortInit(CocktailSort *c, int *values, int n);
+int64_t CocktailSortRun(CocktailSort *c, int64_t maxSteps);
+void CocktailSortCursor(const CocktailSort *c, SortCursor *cursor);
+void CocktailSortFast(int *values, int n);
+
+typedef struct CombSort {
+    int *values;
+    int n;
+    int gap;
+    int j;                 // pair (j, j + gap)
+    bool swapped;          // in the current pass
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} CombSort;
+
+void CombSortInit(CombSort *c, int *values, int n);
+int64_t CombSortRun(CombSort *c, int64_t maxSteps);
+void CombSortCursor(const CombSort *c, SortCursor *cursor);
+void CombSortFast(int *values, int n);
+
+typedef struct OddEvenSort {
+    int *values;
+    int n;
+    int phase;             // 0: pairs (0, 1), (2, 3), ...; 1: pairs (1, 2), (3, 4), ...
+    int j;                 // pair (j, j + 1)
+    bool swapped;          // in the current phase
+    int quiet;             // phases in a row without a swap; two in a row means sorted
+    bool done;
+    SortStats stats;
+    SortTrace *trace;
+} OddEvenSort;
+
+void OddEvenSortInit(OddEvenSort *o, int *values, int n);
+int64_t OddEvenSortRun(OddEvenSort *o, int64_t maxSteps);
+void OddEvenSortCursor(const OddEvenSort *o, SortCursor *cursor);
+
+// One odd-even phase over the pairs (from, from + 1), (from + 2, from + 3), ... that lie
+// below to, without a branch per pair (4-lane SIMD when built with it, see sort_simd.c);
+// true when any pair was out of order. Threads may run disjoint ranges of one phase
+bool OddEvenPhase(int *values, int from, int to);
+void OddEvenSortFast(int *values, int n);
+
+//------------------------------------------------------------------------------------
+// Fast paths for the original engines: same algorithm, no per-step bookkeeping
+//------------------------------------------------------------------------------------
+void BubbleSortFast(int *values, int n);
+void MergeSortFast(int *values, int *aux, int n);
+
+// Bottom-up merge sort on 4-lane SIMD (wasm SIMD128 or SSE4.1), ping-ponging between
+// values and aux; scalar MergeSortFast when built without either
+void MergeSortSimd(int *values, int *aux, int n);
+const char *MergeSortSimdName(void);      // "simd128", "sse4.1" or "scalar"
+
+//------------------------------------------------------------------------------------
+// Input generation
+//------------------------------------------------------------------------------------
+typedef enum {
+    DIST_RANDOM,
+    DIST_SORTED,
+    DIST_REVERSED,
+    DIST_FEW_UNIQUE,
+    DIST_NEARLY_SORTED,    // sorted, then about one in 64 elements swapped up to 16 places away
+    DIST_COUNT
+} SortDistribution;
+
+const char *SortDistributionName(SortDistribution dist);
+bool SortDistributionFromName(const char *name, SortDistribution *out);
+// Fills values with n ints in [minValue, maxValue) following dist; same seed -> same data
+void GenerateValues(int *values, int n, SortDistribution dist, int minValue, int maxValue, uint64_t seed);
+bool IsSorted(const int *values, int n);
+
+#endif // SORT_CORE_H
@@ -0,0 +1,78 @@
+// sort_data.c
+#include "sort_core.h"
+#include <string.h>
+
+#define FEW_UNIQUE_KEYS 16
+#define NEARLY_SORTED_EVERY 64         // one displaced element per this many
+#define NEARLY_SORTED_REACH 16         // how far a displaced element moves at most
+
+static const char *distNames[DIST_COUNT] = {
+    "random", "sorted", "reversed", "few-unique", "nearly-sorted"
+};
+
+// xorshift64* - small, fast and reproducible across platforms (rand() is not)
+static uint64_t NextRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+const char *SortDistributionName(SortDistribution dist) {
+    return (dist >= 0 && dist < DIST_COUNT) ? distNames[dist] : "unknown";
+}
+
+bool SortDistributionFromName(const char *name, SortDistribution *out) {
+    for (int d = 0; d < DIST_COUNT; d++) {
+        if (strcmp(name, distNames[d]) == 0) {
+            *out = (SortDistribution)d;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GenerateValues(int *values, int n, SortDistribution dist, int minValue, int maxValue, uint64_t seed) {
+    uint64_t rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    uint64_t range = (maxValue > minValue) ? (uint64_t)(maxValue - minValue) : 1;
+
+    switch (dist) {
+    case DIST_SORTED:
+    case DIST_REVERSED:
+    case DIST_NEARLY_SORTED:
+        for (int i = 0; i < n; i++) {
+            int rank = (dist == DIST_REVERSED) ? n - 1 - i : i;
+            values[i] = minValue + (int)((uint64_t)rank * range / (uint64_t)(n > 0 ? n : 1));
+        }
+        if (dist != DIST_NEARLY_SORTED || n < 2) break;
+        for (int k = 0; k < n / NEARLY_SORTED_EVERY + 1; k++) {
+            int i = (int)(NextRandom(&rng) % (uint64_t)n);
+            int j = i + 1 + (int)(NextRandom(&rng) % NEARLY_SORTED_REACH);
+            if (j >= n) j = n - 1;
+            int tmp = values[i];
+            values[i] = values[j];
+            values[j] = tmp;
+        }
+        break;
+    case DIST_FEW_UNIQUE: {
+        int keys[FEW_UNIQUE_KEYS];
+        for (int k = 0; k < FEW_UNIQUE_KEYS; k++)
+            keys[k] = minValue + (int)(NextRandom(&rng) % range);
+        for (int i = 0; i < n; i++)
+            values[i] = keys[NextRandom(&rng) % FEW_UNIQUE_KEYS];
+    } break;
+    case DIST_RANDOM:
+    default:
+        for (int i = 0; i < n; i++)
+            values[i] = minValue + (int)(NextRandom(&rng) % range);
+        break;
+    }
+}
+
+bool IsSorted(const int *values, int n) {
+    for (int i = 1; i < n; i++)
+        if (values[i - 1] > values[i]) return false;
+    return true;
+}
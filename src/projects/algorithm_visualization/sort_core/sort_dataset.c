@@ -0,0 +1,104 @@
+// sort_dataset.c
+#include "sort_dataset.h"
+#include <limits.h>
+#include <string.h>
+
+DatasetFormat DatasetFormatFromName(const char *fileName) {
+    const char *dot = strrchr(fileName, '.');
+    if (!dot) return DATASET_BINARY;
+    char ext[8] = {0};
+    for (int i = 0; i < 7 && dot[i + 1]; i++) {
+        char c = dot[i + 1];
+        ext[i] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    return (strcmp(ext, "csv") == 0 || strcmp(ext, "txt") == 0) ? DATASET_TEXT : DATASET_BINARY;
+}
+
+void DatasetParserBegin(DatasetParser *p, DatasetFormat format, int *values, int capacity) {
+    *p = (DatasetParser){ .format = format, .values = values, .capacity = values ? capacity : 0 };
+}
+
+int DatasetParserStored(const DatasetParser *p) {
+    return p->count < p->capacity ? p->count : p->capacity;
+}
+
+static void Store(DatasetParser *p, int v) {
+    if (p->count < p->capacity) {
+        p->values[p->count] = v;
+        if (p->count == 0 || v < p->minValue) p->minValue = v;
+        if (p->count == 0 || v > p->maxValue) p->maxValue = v;
+    }
+    if (p->count < INT_MAX) p->count++;
+}
+
+static int32_t ReadLE32(const unsigned char *b) {
+    return (int32_t)((uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24);
+}
+
+static void FeedBinary(DatasetParser *p, const unsigned char *data, size_t size) {
+    // Finish a value split by the previous chunk
+    if (p->carryLen > 0) {
+        while (p->carryLen < 4 && size > 0) {
+            p->carry[p->carryLen++] = *data++;
+            size--;
+        }
+        if (p->carryLen < 4) return;
+        Store(p, ReadLE32(p->carry));
+        p->carryLen = 0;
+    }
+
+    size_t whole = size / 4;
+    if (!p->values) {
+        // Counting: nothing to store
+        int64_t count = (int64_t)p->count + (int64_t)whole;
+        p->count = count > INT_MAX ? INT_MAX : (int)count;
+    } else {
+        for (size_t i = 0; i < whole; i++) Store(p, ReadLE32(data + i * 4));
+    }
+    size_t rest = size - whole * 4;
+    memcpy(p->carry, data + whole * 4, rest);
+    p->carryLen = (int)rest;
+}
+
+static void EndNumber(DatasetParser *p) {
+    if (p->inNumber) {
+        int64_t v = p->negative ? -p->number : p->number;
+        Store(p, v < INT_MIN ? INT_MIN : (v > INT_MAX ? INT_MAX : (int)v));
+    }
+    p->number = 0;
+    p->negative = p->inNumber = p->inFraction = p->sawSign = false;
+}
+
+static void FeedText(DatasetParser *p, const unsigned char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = data[i];
+        if (c >= '0' && c <= '9') {
+            if (p->inFraction) continue;
+            p->inNumber = true;
+            // Saturate well above the int range so the clamp in EndNumber still applies
+            if (p->number < ((int64_t)1 << 40)) p->number = p->number * 10 + (c - '0');
+        } else if (c == '.' && p->inNumber && !p->inFraction) {
+            p->inFraction = true;
+        } else if ((c == '-' || c == '+') && !p->inNumber && !p->sawSign) {
+            p->negative = c == '-';
+            p->sawSign = true;
+        } else {
+            EndNumber(p);
+            // "1-2" is two values; the sign belongs to the second
+            if (c == '-' || c == '+') {
+                p->negative = c == '-';
+                p->sawSign = true;
+            }
+        }
+    }
+}
+
+void DatasetParserFeed(DatasetParser *p, const unsigned char *data, size_t size) {
+    if (p->format == DATASET_TEXT) FeedText(p, data, size);
+    else FeedBinary(p, data, size);
+}
+
+void DatasetParserFinish(DatasetParser *p) {
+    if (p->format == DATASET_TEXT) EndNumber(p);
+    p->carryLen = 0;            // a partial trailing int32 is dropped
+}
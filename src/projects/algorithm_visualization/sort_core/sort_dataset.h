@@ -0,0 +1,48 @@
+// sort_dataset.h
+// Incremental parser for integer datasets. Bytes arrive in chunks of any size (a file
+// picker, a memory map) and are parsed straight into the destination buffer, so loading
+// never holds a second copy of the data.
+//
+//   binary: little-endian int32, back to back
+//   text:   integers separated by anything that is not a digit or a sign (CSV, one per
+//           line, ...). Fractions are truncated; values are clamped to the int range.
+//
+// A text file's value count is not known up front: run the parser once over the file
+// with values == NULL to count, then size the buffer and parse it for real.
+#ifndef SORT_DATASET_H
+#define SORT_DATASET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    DATASET_BINARY,
+    DATASET_TEXT
+} DatasetFormat;
+
+typedef struct DatasetParser {
+    DatasetFormat format;
+    int *values;               // NULL: count only
+    int capacity;
+    int count;                 // values parsed so far, including any beyond capacity
+    int minValue, maxValue;    // over the stored values; valid when count > 0
+
+    // A value split across chunks
+    unsigned char carry[4];
+    int carryLen;
+    int64_t number;
+    bool negative, inNumber, inFraction, sawSign;
+} DatasetParser;
+
+// .csv and .txt are text, anything else binary
+DatasetFormat DatasetFormatFromName(const char *fileName);
+
+void DatasetParserBegin(DatasetParser *p, DatasetFormat format, int *values, int capacity);
+void DatasetParserFeed(DatasetParser *p, const unsigned char *data, size_t size);
+// Ends a trailing number that had no separator after it
+void DatasetParserFinish(DatasetParser *p);
+// Values stored; count may be larger when the input held more than capacity
+int DatasetParserStored(const DatasetParser *p);
+
+#endif // SORT_DATASET_H
@@ -0,0 +1,101 @@
+// sort_engine.c
+#include "sort_engine.h"
+#include <string.h>
+
+// Adapters from the typed engine functions to the SortEngine signatures
+#define ENGINE_ACCESSORS(Type, prefix, doneField)                                              \
+    static bool prefix##Done(const void *s) { return ((const Type *)s)->doneField; }          \
+    static SortStats *prefix##Stats(void *s) { return &((Type *)s)->stats; }                   \
+    static SortTrace **prefix##Trace(void *s) { return &((Type *)s)->trace; }                  \
+    static void prefix##CursorFn(const void *s, SortCursor *c) { prefix##SortCursor(s, c); }
+
+ENGINE_ACCESSORS(BubbleSort, Bubble, sorted)
+ENGINE_ACCESSORS(MergeSort, Merge, done)
+ENGINE_ACCESSORS(QuickSort, Quick, done)
+ENGINE_ACCESSORS(HeapSort, Heap, done)
+ENGINE_ACCESSORS(RadixSort, Radix, done)
+ENGINE_ACCESSORS(IntroSort, Intro, done)
+ENGINE_ACCESSORS(TimSort, Tim, done)
+ENGINE_ACCESSORS(CocktailSort, Cocktail, done)
+ENGINE_ACCESSORS(CombSort, Comb, done)
+ENGINE_ACCESSORS(OddEvenSort, OddEven, done)
+
+static void BubbleInit(void *s, int *values, int *aux, int n) { (void)aux; BubbleSortInit(s, values, n); }
+static void MergeInit(void *s, int *values, int *aux, int n) { MergeSortInit(s, values, aux, n); }
+static void QuickInit(void *s, int *values, int *aux, int n) { (void)aux; QuickSortInit(s, values, n); }
+static void HeapInit(void *s, int *values, int *aux, int n) { (void)aux; HeapSortInit(s, values, n); }
+static void RadixInit(void *s, int *values, int *aux, int n) { RadixSortInit(s, values, aux, n); }
+static void IntroInit(void *s, int *values, int *aux, int n) { (void)aux; IntroSortInit(s, values, n); }
+static void TimInit(void *s, int *values, int *aux, int n) { TimSortInit(s, values, aux, n); }
+static void CocktailInit(void *s, int *values, int *aux, int n) { (void)aux; CocktailSortInit(s, values, n); }
+static void CombInit(void *s, int *values, int *aux, int n) { (void)aux; CombSortInit(s, values, n); }
+static void OddEvenInit(void *s, int *values, int *aux, int n) { (void)aux; OddEvenSortInit(s, values, n); }
+
+static int64_t BubbleSteps(void *s, int64_t maxSteps) { return BubbleSortRun(s, maxSteps); }
+static int64_t MergeSteps(void *s, int64_t maxSteps) { return MergeSortRun(s, maxSteps, false); }
+static int64_t QuickSteps(void *s, int64_t maxSteps) { return QuickSortRun(s, maxSteps); }
+static int64_t HeapSteps(void *s, int64_t maxSteps) { return HeapSortRun(s, maxSteps); }
+static int64_t RadixSteps(void *s, int64_t maxSteps) { return RadixSortRun(s, maxSteps); }
+static int64_t IntroSteps(void *s, int64_t maxSteps) { return IntroSortRun(s, maxSteps); }
+static int64_t TimSteps(void *s, int64_t maxSteps) { return TimSortRun(s, maxSteps); }
+static int64_t CocktailSteps(void *s, int64_t maxSteps) { return CocktailSortRun(s, maxSteps); }
+static int64_t CombSteps(void *s, int64_t maxSteps) { return CombSortRun(s, maxSteps); }
+static int64_t OddEvenSteps(void *s, int64_t maxSteps) { return OddEvenSortRun(s, maxSteps); }
+
+static void BubbleFast(int *values, int *aux, int n) { (void)aux; BubbleSortFast(values, n); }
+static void QuickFast(int *values, int *aux, int n) { (void)aux; QuickSortFast(values, n); }
+static void HeapFast(int *values, int *aux, int n) { (void)aux; HeapSortFast(values, 0, n - 1); }
+static void IntroFast(int *values, int *aux, int n) { (void)aux; IntroSortFast(values, n); }
+static void CocktailFast(int *values, int *aux, int n) { (void)aux; CocktailSortFast(values, n); }
+static void CombFast(int *values, int *aux, int n) { (void)aux; CombSortFast(values, n); }
+static void OddEvenFast(int *values, int *aux, int n) { (void)aux; OddEvenSortFast(values, n); }
+
+#define ENGINE(name, title, buffers, quadratic, prefix, fast) \
+    { name, title, buffers, quadratic, prefix##Init, prefix##Steps, prefix##Done, prefix##Stats, prefix##Trace, prefix##CursorFn, fast }
+
+const SortEngine sortEngines[] = {
+    ENGINE("bubble", "Bubble Sort", 1, true, Bubble, BubbleFast),
+    ENGINE("merge", "Merge Sort", 2, false, Merge, MergeSortFast),
+    ENGINE("merge-simd", "Merge Sort (SIMD)", 2, false, Merge, MergeSortSimd),
+    ENGINE("quick", "Quicksort (3-way)", 1, false, Quick, QuickFast),
+    ENGINE("heap", "Heapsort", 1, false, Heap, HeapFast),
+    ENGINE("radix", "LSD Radix Sort", 2, false, Radix, RadixSortFast),
+    ENGINE("intro", "Introsort", 1, false, Intro, IntroFast),
+    ENGINE("tim", "Timsort", 2, false, Tim, TimSortFast),
+    ENGINE("cocktail", "Cocktail Shaker Sort", 1, true, Cocktail, CocktailFast),
+    ENGINE("comb", "Comb Sort", 1, false, Comb, CombFast),
+    ENGINE("odd-even", "Odd-Even Transposition Sort", 1, true, OddEven, OddEvenFast),
+};
+
+const int sortEngineCount = (int)(sizeof(sortEngines) / sizeof(sortEngines[0]));
+
+const SortEngine *SortEngineFind(const char *name) {
+    for (int e = 0; e < sortEngineCount; e++)
+        if (strcmp(sortEngines[e].name, name) == 0) return &sortEngines[e];
+    return NULL;
+}
+
+void SortMachineInit(SortMachine *m, const SortEngine *engine, int *values, int *aux, int n) {
+    m->engine = engine;
+    engine->init(&m->as, values, aux, n);
+}
+
+int64_t SortMachineRun(SortMachine *m, int64_t maxSteps) {
+    return m->engine->run(&m->as, maxSteps);
+}
+
+bool SortMachineDone(const SortMachine *m) {
+    return m->engine->done(&m->as);
+}
+
+const SortStats *SortMachineStats(const SortMachine *m) {
+    return m->engine->stats((void *)&m->as);
+}
+
+void SortMachineAttachTrace(SortMachine *m, SortTrace *trace) {
+    *m->engine->trace(&m->as) = trace;
+}
+
+void SortMachineCursor(const SortMachine *m, SortCursor *c) {
+    m->engine->cursor(&m->as, c);
+}
@@ -0,0 +1,53 @@
+// sort_engine.h
+// One interface over every step engine, so the visualizers and tools can pick an
+// algorithm at runtime. Each engine pairs a resumable step machine (for drawing,
+// tracing and op counts) with a fast path that sorts the same input in tight loops.
+#ifndef SORT_ENGINE_H
+#define SORT_ENGINE_H
+
+#include "sort_core.h"
+
+typedef struct SortEngine {
+    const char *name;
+    const char *title;
+    int bufferCount;       // buffers a trace must capture: 2 when the engine writes aux
+    bool quadratic;        // O(n^2) steps: callers keep traced and timed runs small
+    void (*init)(void *state, int *values, int *aux, int n);
+    int64_t (*run)(void *state, int64_t maxSteps);     // steps executed, fewer than maxSteps when finished
+    bool (*done)(const void *state);
+    SortStats *(*stats)(void *state);
+    SortTrace **(*trace)(void *state);
+    void (*cursor)(const void *state, SortCursor *c);
+    void (*sortFast)(int *values, int *aux, int n);
+} SortEngine;
+
+// Storage for any engine's state; no allocation beyond the caller's buffers
+typedef struct SortMachine {
+    const SortEngine *engine;
+    union {
+        BubbleSort bubble;
+        MergeSort merge;
+        QuickSort quick;
+        HeapSort heap;
+        RadixSort radix;
+        IntroSort intro;
+        TimSort tim;
+        CocktailSort cocktail;
+        CombSort comb;
+        OddEvenSort oddEven;
+    } as;
+} SortMachine;
+
+extern const SortEngine sortEngines[];
+extern const int sortEngineCount;
+
+const SortEngine *SortEngineFind(const char *name);     // NULL when unknown
+
+void SortMachineInit(SortMachine *m, const SortEngine *engine, int *values, int *aux, int n);
+int64_t SortMachineRun(SortMachine *m, int64_t maxSteps);
+bool SortMachineDone(const SortMachine *m);
+const SortStats *SortMachineStats(const SortMachine *m);
+void SortMachineAttachTrace(SortMachine *m, SortTrace *trace);
+void SortMachineCursor(const SortMachine *m, SortCursor *c);
+
+#endif // SORT_ENGINE_H
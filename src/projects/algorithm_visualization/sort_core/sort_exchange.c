@@ -0,0 +1,214 @@
+// sort_exchange.c
+// Cocktail shaker, comb and odd-even transposition sorts. Each step compares one pair
+// and swaps it when out of order, like bubble sort; OddEvenSortFast and OddEvenPhase
+// live in sort_simd.c
+#include "sort_core.h"
+
+static inline bool CompareSwap(int *values, int a, int b, SortStats *stats, SortTrace *trace) {
+    stats->comparisons++;
+    SORT_TRACE(trace, TraceCompare(trace, 0, a, 0, b));
+    if (values[a] <= values[b]) return false;
+    SORT_TRACE(trace, TraceSwap(trace, 0, a, b));
+    int tmp = values[a];
+    values[a] = values[b];
+    values[b] = tmp;
+    stats->swaps++;
+    return true;
+}
+
+//------------------------------------------------------------------------------------
+// Cocktail shaker sort
+//------------------------------------------------------------------------------------
+void CocktailSortInit(CocktailSort *c, int *values, int n) {
+    c->values = values;
+    c->n = n;
+    c->lo = 0;
+    c->hi = n - 1;
+    c->j = 0;
+    c->forward = true;
+    c->lastSwap = 0;
+    c->done = n < 2;
+    c->stats = (SortStats){0};
+    c->trace = NULL;
+}
+
+// A forward pass leaves the window ending at its last swap, a backward one starting at
+// its last swap; lastSwap starts at the far edge so a pass without swaps closes the window
+int64_t CocktailSortRun(CocktailSort *c, int64_t maxSteps) {
+    uint64_t start = c->stats.steps;
+    while (!c->done && (int64_t)(c->stats.steps - start) < maxSteps) {
+        c->stats.steps++;
+        if (c->forward) {
+            if (c->j < c->hi) {
+                if (CompareSwap(c->values, c->j, c->j + 1, &c->stats, c->trace)) c->lastSwap = c->j;
+                c->j++;
+            } else {
+                c->hi = c->lastSwap;
+                c->forward = false;
+                c->j = c->lastSwap = c->hi;
+            }
+        } else {
+            if (c->j > c->lo) {
+                if (CompareSwap(c->values, c->j - 1, c->j, &c->stats, c->trace)) c->lastSwap = c->j;
+                c->j--;
+            } else {
+                c->lo = c->lastSwap;
+                c->forward = true;
+                c->j = c->lastSwap = c->lo;
+            }
+        }
+        if (c->lo >= c->hi) c->done = true;
+    }
+    return (int64_t)(c->stats.steps - start);
+}
+
+void CocktailSortCursor(const CocktailSort *c, SortCursor *cursor) {
+    *cursor = (SortCursor){ -1, -1, 0, -1 };
+    if (c->done) return;
+    if (c->forward && c->j < c->hi) {
+        cursor->a = c->j;
+        cursor->b = c->j + 1;
+    } else if (!c->forward && c->j > c->lo) {
+        cursor->a = c->j - 1;
+        cursor->b = c->j;
+    }
+    cursor->rangeLo = c->lo;
+    cursor->rangeHi = c->hi;
+}
+
+void CocktailSortFast(int *values, int n) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int last = lo;
+        for (int j = lo; j < hi; j++) {
+            if (values[j] > values[j + 1]) {
+                int tmp = values[j];
+                values[j] = values[j + 1];
+                values[j + 1] = tmp;
+                last = j;
+            }
+        }
+        hi = last;
+
+        last = hi;
+        for (int j = hi; j > lo; j--) {
+            if (values[j - 1] > values[j]) {
+                int tmp = values[j - 1];
+                values[j - 1] = values[j];
+                values[j] = tmp;
+                last = j;
+            }
+        }
+        lo = last;
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Comb sort
+//------------------------------------------------------------------------------------
+static inline int NextGap(int gap) {
+    gap = gap * 10 / 13;
+    return gap > 1 ? gap : 1;
+}
+
+void CombSortInit(CombSort *c, int *values, int n) {
+    c->values = values;
+    c->n = n;
+    c->gap = NextGap(n);
+    c->j = 0;
+    c->swapped = false;
+    c->done = n < 2;
+    c->stats = (SortStats){0};
+    c->trace = NULL;
+}
+
+int64_t CombSortRun(CombSort *c, int64_t maxSteps) {
+    uint64_t start = c->stats.steps;
+    while (!c->done && (int64_t)(c->stats.steps - start) < maxSteps) {
+        c->stats.steps++;
+        if (c->j + c->gap < c->n) {
+            if (CompareSwap(c->values, c->j, c->j + c->gap, &c->stats, c->trace)) c->swapped = true;
+            c->j++;
+        } else if (c->gap == 1 && !c->swapped) {
+            c->done = true;
+        } else {
+            c->gap = NextGap(c->gap);
+            c->j = 0;
+            c->swapped = false;
+        }
+    }
+    return (int64_t)(c->stats.steps - start);
+}
+
+void CombSortCursor(const CombSort *c, SortCursor *cursor) {
+    *cursor = (SortCursor){ -1, -1, 0, -1 };
+    if (c->done) return;
+    if (c->j + c->gap < c->n) {
+        cursor->a = c->j;
+        cursor->b = c->j + c->gap;
+    }
+    cursor->rangeHi = c->n - 1;
+}
+
+void CombSortFast(int *values, int n) {
+    int gap = n;
+    bool swapped = true;
+    while (gap > 1 || swapped) {
+        gap = NextGap(gap);
+        swapped = false;
+        for (int j = 0; j + gap < n; j++) {
+            if (values[j] > values[j + gap]) {
+                int tmp = values[j];
+                values[j] = values[j + gap];
+                values[j + gap] = tmp;
+                swapped = true;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Odd-even transposition sort
+//------------------------------------------------------------------------------------
+void OddEvenSortInit(OddEvenSort *o, int *values, int n) {
+    o->values = values;
+    o->n = n;
+    o->phase = 0;
+    o->j = 0;
+    o->swapped = false;
+    o->quiet = 0;
+    o->done = n < 2;
+    o->stats = (SortStats){0};
+    o->trace = NULL;
+}
+
+int64_t OddEvenSortRun(OddEvenSort *o, int64_t maxSteps) {
+    uint64_t start = o->stats.steps;
+    while (!o->done && (int64_t)(o->stats.steps - start) < maxSteps) {
+        o->stats.steps++;
+        if (o->j + 1 < o->n) {
+            if (CompareSwap(o->values, o->j, o->j + 1, &o->stats, o->trace)) o->swapped = true;
+            o->j += 2;
+        } else {
+            // Pairs of one phase never overlap, so a quiet even and odd phase in a row
+            // have compared every neighbour
+            o->quiet = o->swapped ? 0 : o->quiet + 1;
+            o->done = o->quiet >= 2;
+            o->phase ^= 1;
+            o->j = o->phase;
+            o->swapped = false;
+        }
+    }
+    return (int64_t)(o->stats.steps - start);
+}
+
+void OddEvenSortCursor(const OddEvenSort *o, SortCursor *cursor) {
+    *cursor = (SortCursor){ -1, -1, 0, -1 };
+    if (o->done) return;
+    if (o->j + 1 < o->n) {
+        cursor->a = o->j;
+        cursor->b = o->j + 1;
+    }
+    cursor->rangeLo = o->j;
+    cursor->rangeHi = o->n - 1;
+}
@@ -0,0 +1,415 @@
+// sort_external.c
+#include "sort_external.h"
+#include "step_scheduler.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define DEFAULT_IO_BYTES (1 << 20)
+#define MAX_FAN_IN 4096
+
+static bool Fail(ExternalSort *e, const char *error) {
+    if (e->phase != EXT_FAILED) e->error = error;
+    e->phase = EXT_FAILED;
+    return false;
+}
+
+static void Finish(ExternalSort *e) {
+    if (fflush(e->out) != 0) {
+        Fail(e, "cannot write the output");
+        return;
+    }
+    e->phase = EXT_DONE;
+}
+
+// Unbuffered, and already unlinked so the space comes back when it is closed
+static FILE *TempFile(const char *dir) {
+    FILE *f = NULL;
+    if (!dir) {
+        f = tmpfile();
+    } else {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/sort_external_XXXXXX", dir);
+        int fd = mkstemp(path);
+        if (fd < 0) return NULL;
+        unlink(path);
+        f = fdopen(fd, "w+b");
+        if (!f) close(fd);
+    }
+    if (f) setvbuf(f, NULL, _IONBF, 0);
+    return f;
+}
+
+static bool WriteValues(ExternalSort *e, FILE *f, const int *values, size_t count) {
+    if (fwrite(values, sizeof(int), count, f) != count) return Fail(e, "write failed (disk full?)");
+    e->bytesWritten += count * sizeof(int);
+    return true;
+}
+
+static size_t ReadValues(ExternalSort *e, FILE *f, int *values, size_t count) {
+    size_t got = fread(values, sizeof(int), count, f);
+    e->bytesRead += got * sizeof(int);
+    return got;
+}
+
+// Several runs share a file and a merge reads some while another file is appended to, so
+// every temporary file access seeks first
+static bool AppendValues(ExternalSort *e, int file, const int *values, size_t count) {
+    ExternalFile *f = &e->files[file];
+    if (fseeko(f->file, (off_t)f->size * (off_t)sizeof(int), SEEK_SET) != 0)
+        return Fail(e, "cannot seek a temporary file");
+    if (!WriteValues(e, f->file, values, count)) return false;
+    f->size += (int64_t)count;
+    return true;
+}
+
+// The file runs of the current pass go to, opening a new one when the pass changes;
+// -1 on a failure
+static int WriteFile(ExternalSort *e) {
+    if (e->writeFile >= 0 && e->writePass == e->pass) return e->writeFile;
+    if (e->fileCount == e->fileSlots) {
+        int slots = e->fileSlots ? e->fileSlots * 2 : 4;
+        ExternalFile *files = realloc(e->files, (size_t)slots * sizeof(ExternalFile));
+        if (!files) {
+            Fail(e, "out of memory for the file list");
+            return -1;
+        }
+        e->files = files;
+        e->fileSlots = slots;
+    }
+    FILE *f = TempFile(e->config.tempDir);
+    if (!f) {
+        Fail(e, "cannot create a temporary file");
+        return -1;
+    }
+    // The previous write file stays open while runs in it are queued
+    if (e->writeFile >= 0 && e->files[e->writeFile].runs == 0) {
+        fclose(e->files[e->writeFile].file);
+        e->files[e->writeFile].file = NULL;
+    }
+    e->files[e->fileCount] = (ExternalFile){ f, 0, 0 };
+    e->writeFile = e->fileCount++;
+    e->writePass = e->pass;
+    return e->writeFile;
+}
+
+static bool PushRun(ExternalSort *e, int file, int64_t offset, int64_t length) {
+    if (e->runCount == e->runSlots) {
+        int slots = e->runSlots ? e->runSlots * 2 : 16;
+        ExternalRun *runs = realloc(e->runs, (size_t)slots * sizeof(ExternalRun));
+        if (!runs) return Fail(e, "out of memory for the run list");
+        e->runs = runs;
+        e->runSlots = slots;
+    }
+    e->runs[e->runCount++] = (ExternalRun){ file, offset, length };
+    e->files[file].runs++;
+    return true;
+}
+
+// A merged run is done with; its file goes once nothing else needs it
+static void ReleaseRun(ExternalSort *e, const ExternalRun *r) {
+    ExternalFile *f = &e->files[r->file];
+    if (--f->runs == 0 && r->file != e->writeFile) {
+        fclose(f->file);
+        f->file = NULL;
+    }
+}
+
+bool ExternalSortBegin(ExternalSort *e, FILE *in, FILE *out, const ExternalConfig *config) {
+    *e = (ExternalSort){ .phase = EXT_RUNS, .config = *config, .in = in, .out = out, .writeFile = -1 };
+    if (!e->config.engine) e->config.engine = SortEngineFind("radix");
+    if (e->config.memoryBytes < EXTERNAL_MIN_MEMORY) e->config.memoryBytes = EXTERNAL_MIN_MEMORY;
+    if (e->config.ioBytes == 0) e->config.ioBytes = DEFAULT_IO_BYTES;
+
+    if (fseeko(in, 0, SEEK_END) != 0) return Fail(e, "input is not seekable");
+    off_t size = ftello(in);
+    rewind(in);
+    if (size < 0) return Fail(e, "cannot size the input");
+    e->total = (int64_t)size / (int64_t)sizeof(int);    // a partial trailing int32 is dropped
+
+    e->memoryValues = e->config.memoryBytes / sizeof(int);
+    e->memory = malloc(e->memoryValues * sizeof(int));
+    if (!e->memory) return Fail(e, "out of memory for the budget");
+    size_t half = e->memoryValues / 2;
+    if (half > INT_MAX) half = INT_MAX;
+    e->run = e->memory;
+    e->aux = e->memory + half;
+    e->runCapacity = (int)half;
+
+    // One block of the budget is the merge output; the rest feed the inputs
+    size_t blocks = e->config.memoryBytes / e->config.ioBytes;
+    if (blocks > e->memoryValues) blocks = e->memoryValues;
+    if (blocks > MAX_FAN_IN + 1) blocks = MAX_FAN_IN + 1;
+    e->fanIn = blocks > 3 ? (int)blocks - 1 : 2;
+    e->streams = calloc((size_t)e->fanIn, sizeof(ExternalStream));
+    e->tree = malloc((size_t)e->fanIn * sizeof(int));
+    e->keys = malloc((size_t)e->fanIn * sizeof(int64_t));
+    if (!e->streams || !e->tree || !e->keys) return Fail(e, "out of memory for the merge");
+    return true;
+}
+
+//------------------------------------------------------------------------------------
+// Merge: loser tree over the group's streams
+//------------------------------------------------------------------------------------
+
+// Head value above the stream index, so one compare orders values and breaks ties;
+// exhausted streams lose to everything
+static void UpdateKey(ExternalSort *e, int i) {
+    const ExternalStream *s = &e->streams[i];
+    e->keys[i] = s->pos < s->len ? (int64_t)s->buf[s->pos] * ((int64_t)1 << 32) + i : INT64_MAX;
+}
+
+static bool Beats(const ExternalSort *e, int a, int b) {
+    return e->keys[a] < e->keys[b];
+}
+
+// Node i's children are 2i and 2i+1; nodes k..2k-1 are the streams themselves
+static int BuildNode(ExternalSort *e, int node) {
+    int k = e->streamCount;
+    if (node >= k) return node - k;
+    int a = BuildNode(e, 2 * node);
+    int b = BuildNode(e, 2 * node + 1);
+    if (Beats(e, b, a)) {
+        e->tree[node] = a;
+        return b;
+    }
+    e->tree[node] = b;
+    return a;
+}
+
+// Stream w's head changed: replay its matches on the way to the root
+static void Replay(ExternalSort *e, int w) {
+    int winner = w;
+    for (int node = (w + e->streamCount) / 2; node >= 1; node /= 2) {
+        if (Beats(e, e->tree[node], winner)) {
+            int loser = winner;
+            winner = e->tree[node];
+            e->tree[node] = loser;
+        }
+    }
+    e->tree[0] = winner;
+}
+
+static void Refill(ExternalSort *e, ExternalStream *s) {
+    int64_t want = s->unread < s->capacity ? s->unread : s->capacity;
+    size_t got = 0;
+    if (want > 0 && fseeko(s->file, (off_t)s->next * (off_t)sizeof(int), SEEK_SET) == 0)
+        got = ReadValues(e, s->file, s->buf, (size_t)want);
+    if ((int64_t)got < want) {
+        Fail(e, "cannot read a temporary file");
+        s->unread = 0;
+    }
+    s->unread -= (int64_t)got;
+    s->next += (int64_t)got;
+    s->pos = 0;
+    s->len = (int)got;
+}
+
+static bool FlushOut(ExternalSort *e) {
+    if (e->outLen == 0) return true;
+    bool written = e->finalGroup ? WriteValues(e, e->out, e->outBuf, (size_t)e->outLen)
+                                 : AppendValues(e, e->groupFile, e->outBuf, (size_t)e->outLen);
+    if (!written) return false;
+    e->groupWritten += e->outLen;
+    e->outLen = 0;
+    return true;
+}
+
+static void StartGroup(ExternalSort *e) {
+    for (;;) {
+        if (e->runHead >= e->passEnd) {
+            e->pass++;
+            e->passEnd = e->runCount;
+        }
+        int waiting = e->runCount - e->runHead;
+        e->finalGroup = waiting <= e->fanIn;
+        int k = e->finalGroup ? waiting : e->passEnd - e->runHead;
+        if (k > e->fanIn) k = e->fanIn;
+        if (k > 1 || e->finalGroup) {
+            e->streamCount = k;
+            break;
+        }
+        // A lone run left at the end of a pass joins the next one as it is
+        ExternalRun lone = e->runs[e->runHead++];
+        e->files[lone.file].runs--;
+        if (!PushRun(e, lone.file, lone.offset, lone.length)) return;
+    }
+
+    // A final group reaching past the pass also reads runs this pass wrote: one more pass
+    int k = e->streamCount;
+    if (e->runHead + k > e->passEnd) {
+        e->pass++;
+        e->passEnd = e->runCount;
+    }
+    size_t block = e->memoryValues / (size_t)(k + 1);
+    if (block > INT_MAX) block = INT_MAX;
+    e->groupLength = 0;
+    for (int i = 0; i < k; i++) {
+        const ExternalRun *r = &e->runs[e->runHead + i];
+        ExternalStream *s = &e->streams[i];
+        *s = (ExternalStream){ .file = e->files[r->file].file, .length = r->length, .next = r->offset,
+                               .unread = r->length, .buf = e->memory + (size_t)i * block, .capacity = (int)block };
+        Refill(e, s);
+        UpdateKey(e, i);
+        e->groupLength += r->length;
+    }
+    e->outBuf = e->memory + (size_t)k * block;
+    e->outCapacity = (int)block;
+    e->outLen = 0;
+    e->groupWritten = 0;
+    if (!e->finalGroup) {
+        e->groupFile = WriteFile(e);
+        if (e->groupFile < 0) return;
+        e->groupOffset = e->files[e->groupFile].size;
+    }
+    e->tree[0] = k > 1 ? BuildNode(e, 1) : 0;
+}
+
+static void StartMerge(ExternalSort *e) {
+    e->phase = EXT_MERGE;
+    e->pass = 0;
+    e->passEnd = 0;
+    e->passCount = 0;
+    for (int64_t runs = e->runCount; runs > 1; runs = (runs + e->fanIn - 1) / e->fanIn) e->passCount++;
+    StartGroup(e);
+}
+
+static void FinishGroup(ExternalSort *e) {
+    if (!FlushOut(e)) return;
+    for (int i = 0; i < e->streamCount; i++) ReleaseRun(e, &e->runs[e->runHead + i]);
+    e->runHead += e->streamCount;
+    e->streamCount = 0;
+    if (e->finalGroup) {
+        Finish(e);
+        return;
+    }
+    if (!PushRun(e, e->groupFile, e->groupOffset, e->groupWritten)) return;
+    StartGroup(e);
+}
+
+static int64_t StepMerge(ExternalSort *e, int64_t maxSteps) {
+    int64_t done = 0;
+    while (done < maxSteps && e->phase == EXT_MERGE) {
+        int w = e->tree[0];
+        ExternalStream *s = &e->streams[w];
+        if (s->pos >= s->len) {            // the winner is exhausted, so all of them are
+            FinishGroup(e);
+            continue;
+        }
+        e->outBuf[e->outLen++] = s->buf[s->pos++];
+        s->consumed++;
+        done++;
+        if (e->outLen == e->outCapacity && !FlushOut(e)) break;
+        if (s->pos == s->len && s->unread > 0) Refill(e, s);
+        UpdateKey(e, w);
+        Replay(e, w);
+    }
+    return done;
+}
+
+//------------------------------------------------------------------------------------
+// Run formation
+//------------------------------------------------------------------------------------
+
+// Sorts the run and appends it to the run file. A single run that holds the whole input
+// goes straight to the output instead
+static void FinishRun(ExternalSort *e) {
+    bool last = e->inputRead == e->total;
+    if (e->runLength > 0) {
+        e->config.engine->sortFast(e->run, e->aux, e->runLength);
+        e->runsFormed++;
+        if (last && e->runCount == 0) {
+            if (WriteValues(e, e->out, e->run, (size_t)e->runLength)) Finish(e);
+            return;
+        }
+        int file = WriteFile(e);
+        if (file < 0) return;
+        int64_t offset = e->files[file].size;
+        if (!AppendValues(e, file, e->run, (size_t)e->runLength) || !PushRun(e, file, offset, e->runLength))
+            return;
+        e->runLength = 0;
+    }
+    if (!last) return;
+    if (e->runCount == 0) Finish(e);     // empty input
+    else StartMerge(e);
+}
+
+static int64_t StepRuns(ExternalSort *e, int64_t maxSteps) {
+    int64_t done = 0;
+    while (done < maxSteps && e->phase == EXT_RUNS) {
+        int64_t want = e->runCapacity - e->runLength;
+        if (want > e->total - e->inputRead) want = e->total - e->inputRead;
+        if (want > maxSteps - done) want = maxSteps - done;
+        if (want > 0) {
+            size_t got = ReadValues(e, e->in, e->run + e->runLength, (size_t)want);
+            if ((int64_t)got < want) e->total = e->inputRead + (int64_t)got;   // the file shrank
+            e->runLength += (int)got;
+            e->inputRead += (int64_t)got;
+            done += (int64_t)got;
+            if (e->runLength > e->runFilled) e->runFilled = e->runLength;
+        }
+        if (e->runLength == e->runCapacity || e->inputRead == e->total) FinishRun(e);
+    }
+    return done;
+}
+
+int64_t ExternalSortRun(ExternalSort *e, int64_t maxSteps) {
+    int64_t done = 0;
+    double start = SortClockMs();
+    if (e->phase == EXT_RUNS) {
+        done += StepRuns(e, maxSteps);
+        double now = SortClockMs();
+        e->runMs += now - start;
+        start = now;
+    }
+    if (e->phase == EXT_MERGE && done < maxSteps) {
+        done += StepMerge(e, maxSteps - done);
+        e->mergeMs += SortClockMs() - start;
+    }
+    return done;
+}
+
+bool ExternalSortDone(const ExternalSort *e) {
+    return e->phase == EXT_DONE || e->phase == EXT_FAILED;
+}
+
+void ExternalSortFree(ExternalSort *e) {
+    for (int i = 0; i < e->fileCount; i++) {
+        if (e->files[i].file) fclose(e->files[i].file);
+    }
+    free(e->files);
+    free(e->runs);
+    free(e->streams);
+    free(e->tree);
+    free(e->keys);
+    free(e->memory);
+    e->files = NULL;
+    e->runs = NULL;
+    e->streams = NULL;
+    e->tree = NULL;
+    e->keys = NULL;
+    e->memory = e->run = e->aux = e->outBuf = NULL;
+    e->fileCount = e->fileSlots = 0;
+    e->writeFile = -1;
+    e->runCount = e->runSlots = e->runHead = e->streamCount = 0;
+    e->runFilled = e->runLength = 0;
+}
+
+bool ExternalStreamHead(const ExternalSort *e, int i, int *value) {
+    if (e->phase != EXT_MERGE || i < 0 || i >= e->streamCount) return false;
+    const ExternalStream *s = &e->streams[i];
+    if (s->pos >= s->len) return false;
+    *value = s->buf[s->pos];
+    return true;
+}
+
+double ExternalSortSeconds(const ExternalSort *e) {
+    return (e->runMs + e->mergeMs) / 1000.0;
+}
+
+double ExternalSortMBps(const ExternalSort *e) {
+    double seconds = ExternalSortSeconds(e);
+    return seconds > 0 ? (double)(e->bytesRead + e->bytesWritten) / (1024.0 * 1024.0) / seconds : 0.0;
+}
@@ -0,0 +1,124 @@
+// sort_external.h
+// External (out-of-core) merge sort for int32 files larger than memory; native only.
+// Input is read in runs that fit the memory budget, each run is sorted with an engine's
+// fast path and appended to a temporary file, then the runs are merged k ways through a
+// loser tree, in as many passes as the fan-in needs. Runs are offsets into a few shared
+// files (one for run formation, one per merge pass), so the open descriptors do not grow
+// with the input. Every file access is a large
+// sequential block straight into the budget's buffers; temporary files are unbuffered
+// and in/out should be too (setvbuf _IONBF before any I/O), or stdio copies each block.
+//
+// Like SortMachine it is resumable: ExternalSortRun does a bounded number of steps per
+// call, a step being one value read into a run or one value merged out. Sorting and
+// spilling a full run happen inside the step that completes it.
+//
+// Files hold raw int32 in host byte order, little-endian on everything we build for:
+// the binary layout sort_dataset.h reads.
+#ifndef SORT_EXTERNAL_H
+#define SORT_EXTERNAL_H
+
+#include "sort_engine.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define EXTERNAL_MIN_MEMORY 64         // bytes: a 2-way merge of tiny blocks, for demos
+
+typedef enum {
+    EXT_IDLE,
+    EXT_RUNS,                  // reading, sorting and spilling runs
+    EXT_MERGE,
+    EXT_DONE,
+    EXT_FAILED
+} ExternalPhase;
+
+typedef struct ExternalConfig {
+    size_t memoryBytes;        // everything the sort buffers; a run is memoryBytes / 8 values
+    size_t ioBytes;            // block per merge input; fan-in is memoryBytes / ioBytes - 1
+    const char *tempDir;       // NULL: the system's (tmpfile)
+    const SortEngine *engine;  // sorts each run; NULL: radix, the fastest for int32 keys
+} ExternalConfig;
+
+// Temporary file of runs written back to back; closed once none of them is waiting
+typedef struct ExternalFile {
+    FILE *file;                // deleted when closed
+    int64_t size;              // values written
+    int runs;                  // runs in it still queued
+} ExternalFile;
+
+typedef struct ExternalRun {
+    int file;                  // index into ExternalSort.files
+    int64_t offset, length;    // values
+} ExternalRun;
+
+// One merge input: a run read a block at a time
+typedef struct ExternalStream {
+    FILE *file;
+    int64_t length, consumed;
+    int64_t next;              // file position of the next unread value
+    int64_t unread;            // values still in the file
+    int *buf;
+    int pos, len, capacity;
+} ExternalStream;
+
+typedef struct ExternalSort {
+    ExternalPhase phase;
+    ExternalConfig config;
+    FILE *in, *out;
+    int64_t total;             // values in the input
+    int *memory;               // the whole budget; carved up per phase
+    size_t memoryValues;
+
+    // Run formation: run and aux split the budget
+    int *run, *aux;
+    int runCapacity, runLength;
+    int runFilled;             // high-water mark of run; the rest still holds the last run
+    int64_t inputRead;
+
+    // Runs waiting to merge, as a queue: a group's output is appended at the tail
+    ExternalRun *runs;
+    int runCount, runSlots, runHead;
+    int passEnd;               // queue index where the current merge pass ends
+    int pass, passCount;       // passCount: projected from the run count and fan-in
+    int runsFormed;
+
+    ExternalFile *files;
+    int fileCount, fileSlots;
+    int writeFile, writePass;  // the file the runs of pass writePass go to; -1 before the first
+
+    // Current merge group
+    int fanIn;                 // most streams a group may merge
+    ExternalStream *streams;
+    int streamCount;
+    int *tree;                 // loser tree: tree[0] the winner, tree[1..k-1] the losers
+    int64_t *keys;             // per stream: head value and index packed, INT64_MAX when exhausted
+    int *outBuf;
+    int outLen, outCapacity;
+    int groupFile;             // output of a group that is not final; the final one writes out
+    int64_t groupOffset;
+    int64_t groupWritten, groupLength;
+    bool finalGroup;
+
+    // Throughput; only time spent inside ExternalSortRun counts
+    uint64_t bytesRead, bytesWritten;
+    double runMs, mergeMs;
+    const char *error;         // set in EXT_FAILED
+} ExternalSort;
+
+// Sorts the binary stream in into out, from the start of in. Allocates the budget; false
+// with e->error set when it cannot start
+bool ExternalSortBegin(ExternalSort *e, FILE *in, FILE *out, const ExternalConfig *config);
+// Steps executed, fewer than maxSteps once finished (EXT_DONE or EXT_FAILED)
+int64_t ExternalSortRun(ExternalSort *e, int64_t maxSteps);
+bool ExternalSortDone(const ExternalSort *e);
+// Closes the temporary files and frees the budget; in and out stay open
+void ExternalSortFree(ExternalSort *e);
+
+// Value at the front of stream i of the current group; false once it is exhausted
+bool ExternalStreamHead(const ExternalSort *e, int i, int *value);
+double ExternalSortSeconds(const ExternalSort *e);
+// Megabytes read plus written per second of sort time so far
+double ExternalSortMBps(const ExternalSort *e);
+
+#endif // SORT_EXTERNAL_H
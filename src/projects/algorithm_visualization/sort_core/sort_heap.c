@@ -0,0 +1,112 @@
+// sort_heap.c
+#include "sort_core.h"
+
+static inline void SwapAt(int *values, int a, int b, SortStats *stats, SortTrace *trace) {
+    SORT_TRACE(trace, TraceSwap(trace, 0, a, b));
+    int tmp = values[a];
+    values[a] = values[b];
+    values[b] = tmp;
+    stats->swaps++;
+}
+
+void HeapSiftBegin(HeapSift *h, int base, int size, int node) {
+    h->base = base;
+    h->size = size;
+    h->node = node;
+    h->active = 2 * node + 1 < size;
+}
+
+// One level: pick the larger child, swap it up if it beats the node
+void HeapSiftStep(HeapSift *h, int *values, SortStats *stats, SortTrace *trace) {
+    if (!h->active) return;
+    stats->steps++;
+
+    int base = h->base;
+    int node = base + h->node;
+    int child = base + 2 * h->node + 1;
+    if (child + 1 < base + h->size) {
+        stats->comparisons++;
+        SORT_TRACE(trace, TraceCompare(trace, 0, child, 0, child + 1));
+        if (values[child] < values[child + 1]) child++;
+    }
+    stats->comparisons++;
+    SORT_TRACE(trace, TraceCompare(trace, 0, node, 0, child));
+    if (values[node] < values[child]) {
+        SwapAt(values, node, child, stats, trace);
+        h->node = child - base;
+        h->active = 2 * h->node + 1 < h->size;
+    } else {
+        h->active = false;
+    }
+}
+
+void HeapSortInit(HeapSort *h, int *values, int n) {
+    h->values = values;
+    h->n = n;
+    h->building = true;
+    h->next = n / 2 - 1;
+    h->sift = (HeapSift){0};
+    h->done = n < 2;
+    h->stats = (SortStats){0};
+    h->trace = NULL;
+}
+
+int64_t HeapSortRun(HeapSort *h, int64_t maxSteps) {
+    uint64_t start = h->stats.steps;
+    while (!h->done && (int64_t)(h->stats.steps - start) < maxSteps) {
+        if (h->sift.active) {
+            HeapSiftStep(&h->sift, h->values, &h->stats, h->trace);
+        } else if (h->building) {
+            if (h->next >= 0) {
+                HeapSiftBegin(&h->sift, 0, h->n, h->next--);
+            } else {
+                h->building = false;
+                h->next = h->n - 1;
+            }
+        } else if (h->next > 0) {
+            // Move the max behind the heap, then restore the heap property from the root
+            h->stats.steps++;
+            SwapAt(h->values, 0, h->next, &h->stats, h->trace);
+            HeapSiftBegin(&h->sift, 0, h->next, 0);
+            h->next--;
+        } else {
+            h->done = true;
+        }
+    }
+    return (int64_t)(h->stats.steps - start);
+}
+
+void HeapSortCursor(const HeapSort *h, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (h->done) return;
+    if (h->sift.active) {
+        c->a = h->sift.base + h->sift.node;
+        c->b = h->sift.base + 2 * h->sift.node + 1;
+    }
+    c->rangeHi = h->building ? h->n - 1 : h->next;
+}
+
+static void SiftDownFast(int *a, int node, int size) {
+    int value = a[node];
+    for (;;) {
+        int child = 2 * node + 1;
+        if (child >= size) break;
+        if (child + 1 < size && a[child] < a[child + 1]) child++;
+        if (value >= a[child]) break;
+        a[node] = a[child];
+        node = child;
+    }
+    a[node] = value;
+}
+
+void HeapSortFast(int *values, int lo, int hi) {
+    int *a = values + lo;
+    int size = hi - lo + 1;
+    for (int node = size / 2 - 1; node >= 0; node--) SiftDownFast(a, node, size);
+    for (int end = size - 1; end > 0; end--) {
+        int tmp = a[0];
+        a[0] = a[end];
+        a[end] = tmp;
+        SiftDownFast(a, 0, end);
+    }
+}
@@ -0,0 +1,48 @@
+// sort_insertion.c
+// Insertion sort sub-machine used by introsort (small ranges) and timsort (short runs)
+#include "sort_core.h"
+
+void InsertionPassInit(InsertionPass *p, int lo, int hi, int sortedUpTo) {
+    if (sortedUpTo <= lo) sortedUpTo = lo + 1;
+    p->lo = lo;
+    p->hi = hi;
+    p->i = sortedUpTo;
+    p->j = sortedUpTo;
+    p->done = sortedUpTo > hi;
+}
+
+// Sinks values[i] towards lo by adjacent swaps; each call does one comparison
+bool InsertionPassStep(InsertionPass *p, int *values, SortStats *stats, SortTrace *trace) {
+    if (p->done) return true;
+    stats->steps++;
+
+    int j = p->j;
+    stats->comparisons++;
+    SORT_TRACE(trace, TraceCompare(trace, 0, j - 1, 0, j));
+    if (values[j - 1] > values[j]) {
+        SORT_TRACE(trace, TraceSwap(trace, 0, j - 1, j));
+        int tmp = values[j - 1];
+        values[j - 1] = values[j];
+        values[j] = tmp;
+        stats->swaps++;
+        p->j = j - 1;
+        if (p->j > p->lo) return false;
+    }
+
+    p->i++;
+    p->j = p->i;
+    p->done = p->i > p->hi;
+    return p->done;
+}
+
+void InsertionSortFast(int *values, int lo, int hi) {
+    for (int i = lo + 1; i <= hi; i++) {
+        int key = values[i];
+        int j = i - 1;
+        while (j >= lo && values[j] > key) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = key;
+    }
+}
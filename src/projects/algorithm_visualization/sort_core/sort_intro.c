@@ -0,0 +1,199 @@
+// sort_intro.c
+#include "sort_core.h"
+
+static int DepthLimit(int n) {
+    int depth = 0;
+    while (n > 1) {
+        depth += 2;
+        n >>= 1;
+    }
+    return depth;
+}
+
+static void Push(IntroSort *s, int lo, int hi, int depth) {
+    if (hi - lo < 1) return;
+    s->stack[s->top++] = (IntroFrame){ lo, hi, depth };
+}
+
+void IntroSortInit(IntroSort *s, int *values, int n) {
+    s->values = values;
+    s->n = n;
+    s->top = 0;
+    s->mode = INTRO_POP;
+    s->cur = (IntroFrame){ 0, -1, 0 };
+    s->sift = (HeapSift){0};
+    s->done = n < 2;
+    s->stats = (SortStats){0};
+    s->trace = NULL;
+    Push(s, 0, n - 1, DepthLimit(n));
+}
+
+static void BeginFrame(IntroSort *s) {
+    IntroFrame f = s->cur;
+    int size = f.hi - f.lo + 1;
+    SORT_TRACE(s->trace, TraceRange(s->trace, f.lo, f.hi));
+    if (size <= INTRO_SMALL) {
+        InsertionPassInit(&s->ins, f.lo, f.hi, f.lo + 1);
+        s->mode = INTRO_INSERTION;
+    } else if (f.depth == 0) {
+        // Too many unbalanced partitions: heapsort bounds this range at n log n
+        s->heapBuilding = true;
+        s->heapNext = size / 2 - 1;
+        s->sift.active = false;
+        s->mode = INTRO_HEAP;
+    } else {
+        s->stats.steps++;
+        s->pivot = MedianOfThree(s->values, f.lo, f.lo + (f.hi - f.lo) / 2, f.hi, &s->stats, s->trace);
+        s->i = f.lo - 1;
+        s->j = f.hi + 1;
+        s->scanJ = false;
+        s->mode = INTRO_PARTITION;
+    }
+}
+
+// One Hoare scan comparison; the median-of-3 pivot keeps both scans inside [lo, hi]
+static void PartitionStep(IntroSort *s) {
+    int *values = s->values;
+    s->stats.steps++;
+    s->stats.comparisons++;
+    if (!s->scanJ) {
+        s->i++;
+        SORT_TRACE(s->trace, TraceCompare(s->trace, 0, s->i, 0, s->i));
+        if (values[s->i] < s->pivot) return;
+        s->scanJ = true;
+        return;
+    }
+
+    s->j--;
+    SORT_TRACE(s->trace, TraceCompare(s->trace, 0, s->j, 0, s->j));
+    if (values[s->j] > s->pivot) return;
+
+    if (s->i >= s->j) {
+        IntroFrame f = s->cur;
+        if (s->j - f.lo > f.hi - s->j - 1) {
+            Push(s, f.lo, s->j, f.depth - 1);
+            Push(s, s->j + 1, f.hi, f.depth - 1);
+        } else {
+            Push(s, s->j + 1, f.hi, f.depth - 1);
+            Push(s, f.lo, s->j, f.depth - 1);
+        }
+        s->mode = INTRO_POP;
+        return;
+    }
+
+    SORT_TRACE(s->trace, TraceSwap(s->trace, 0, s->i, s->j));
+    int tmp = values[s->i];
+    values[s->i] = values[s->j];
+    values[s->j] = tmp;
+    s->stats.swaps++;
+    s->scanJ = false;
+}
+
+static void HeapStep(IntroSort *s) {
+    int lo = s->cur.lo;
+    int size = s->cur.hi - lo + 1;
+    if (s->sift.active) {
+        HeapSiftStep(&s->sift, s->values, &s->stats, s->trace);
+    } else if (s->heapBuilding) {
+        if (s->heapNext >= 0) {
+            HeapSiftBegin(&s->sift, lo, size, s->heapNext--);
+        } else {
+            s->heapBuilding = false;
+            s->heapNext = size - 1;
+        }
+    } else if (s->heapNext > 0) {
+        int end = lo + s->heapNext;
+        s->stats.steps++;
+        s->stats.swaps++;
+        SORT_TRACE(s->trace, TraceSwap(s->trace, 0, lo, end));
+        int tmp = s->values[lo];
+        s->values[lo] = s->values[end];
+        s->values[end] = tmp;
+        HeapSiftBegin(&s->sift, lo, s->heapNext, 0);
+        s->heapNext--;
+    } else {
+        s->mode = INTRO_POP;
+    }
+}
+
+int64_t IntroSortRun(IntroSort *s, int64_t maxSteps) {
+    uint64_t start = s->stats.steps;
+    while (!s->done && (int64_t)(s->stats.steps - start) < maxSteps) {
+        switch (s->mode) {
+        case INTRO_POP:
+            if (s->top == 0) {
+                s->done = true;
+                break;
+            }
+            s->cur = s->stack[--s->top];
+            BeginFrame(s);
+            break;
+        case INTRO_PARTITION:
+            PartitionStep(s);
+            break;
+        case INTRO_HEAP:
+            HeapStep(s);
+            break;
+        case INTRO_INSERTION:
+            if (InsertionPassStep(&s->ins, s->values, &s->stats, s->trace)) s->mode = INTRO_POP;
+            break;
+        }
+    }
+    return (int64_t)(s->stats.steps - start);
+}
+
+void IntroSortCursor(const IntroSort *s, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (s->done || s->mode == INTRO_POP) return;
+    c->rangeLo = s->cur.lo;
+    c->rangeHi = s->cur.hi;
+    if (s->mode == INTRO_PARTITION) {
+        c->a = s->i >= s->cur.lo ? s->i : -1;
+        c->b = s->j <= s->cur.hi ? s->j : -1;
+    } else if (s->mode == INTRO_HEAP && s->sift.active) {
+        c->a = s->sift.base + s->sift.node;
+        c->b = s->sift.base + 2 * s->sift.node + 1;
+    } else if (s->mode == INTRO_INSERTION && !s->ins.done) {
+        c->a = s->ins.j - 1;
+        c->b = s->ins.j;
+    }
+}
+
+void IntroSortFast(int *values, int n) {
+    IntroFrame stack[INTRO_STACK];
+    int top = 0;
+    IntroFrame f = { 0, n - 1, DepthLimit(n) };
+    SortStats unused = {0};
+    for (;;) {
+        int size = f.hi - f.lo + 1;
+        if (size <= INTRO_SMALL || f.depth == 0) {
+            if (size <= INTRO_SMALL)
+                InsertionSortFast(values, f.lo, f.hi);
+            else
+                HeapSortFast(values, f.lo, f.hi);
+            if (top == 0) break;
+            f = stack[--top];
+            continue;
+        }
+
+        int pivot = MedianOfThree(values, f.lo, f.lo + (f.hi - f.lo) / 2, f.hi, &unused, NULL);
+        int i = f.lo - 1, j = f.hi + 1;
+        for (;;) {
+            do i++; while (values[i] < pivot);
+            do j--; while (values[j] > pivot);
+            if (i >= j) break;
+            int tmp = values[i];
+            values[i] = values[j];
+            values[j] = tmp;
+        }
+
+        IntroFrame left = { f.lo, j, f.depth - 1 }, right = { j + 1, f.hi, f.depth - 1 };
+        if (j - f.lo < f.hi - j - 1) {
+            stack[top++] = right;
+            f = left;
+        } else {
+            stack[top++] = left;
+            f = right;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+// sort_merge.c
+#include "sort_core.h"
+#include <string.h>
+
+void MergeSortInit(MergeSort *m, int *values, int *aux, int n) {
+    m->values = values;
+    m->aux = aux;
+    m->n = n;
+    m->currSize = 1;
+    m->leftStart = 0;
+    m->done = n < 2;
+    m->stats = (SortStats){0};
+    m->trace = NULL;
+    if (!m->done) ResetMergeIndices(m);
+}
+
+void ResetMergeIndices(MergeSort *m) {
+    int n = m->n;
+    m->mid = m->leftStart + m->currSize - 1;
+    m->right = (m->leftStart + 2 * m->currSize - 1 < n - 1)
+                   ? (m->leftStart + 2 * m->currSize - 1)
+                   : (n - 1);
+    m->iIdx = m->leftStart;
+    m->jIdx = m->mid + 1;
+    m->kIdx = m->leftStart;
+    SORT_TRACE(m->trace, TraceRange(m->trace, m->leftStart, m->right));
+}
+
+void NextMerge(MergeSort *m) {
+    m->leftStart += 2 * m->currSize;
+    if (m->leftStart >= m->n - 1) {
+        m->currSize *= 2;
+        m->leftStart = 0;
+        if (m->currSize >= m->n) {
+            m->done = true;
+            return;
+        }
+    }
+    ResetMergeIndices(m);
+}
+
+bool DoMergeStep(MergeSort *m) {
+    if (m->done) return false;
+
+    int *values = m->values;
+    int *aux = m->aux;
+    m->stats.steps++;
+
+    SortTrace *trace = m->trace;
+    if (m->iIdx <= m->mid && m->jIdx <= m->right) {
+        m->stats.comparisons++;
+        SORT_TRACE(trace, TraceCompare(trace, 0, m->iIdx, 0, m->jIdx));
+        if (values[m->iIdx] <= values[m->jIdx]) {
+            SORT_TRACE(trace, TraceMove(trace, 1, m->kIdx, 0, m->iIdx));
+            aux[m->kIdx++] = values[m->iIdx++];
+        } else {
+            SORT_TRACE(trace, TraceMove(trace, 1, m->kIdx, 0, m->jIdx));
+            aux[m->kIdx++] = values[m->jIdx++];
+        }
+    } else if (m->iIdx <= m->mid) {
+        SORT_TRACE(trace, TraceMove(trace, 1, m->kIdx, 0, m->iIdx));
+        aux[m->kIdx++] = values[m->iIdx++];
+    } else if (m->jIdx <= m->right) {
+        SORT_TRACE(trace, TraceMove(trace, 1, m->kIdx, 0, m->jIdx));
+        aux[m->kIdx++] = values[m->jIdx++];
+    }
+    m->stats.writes++;
+
+    // If merged this segment
+    if (m->kIdx > m->right) {
+        SORT_TRACE(trace, TraceCopyRange(trace, 0, 1, m->leftStart, m->right - m->leftStart + 1));
+        for (int t = m->leftStart; t <= m->right; t++)
+            values[t] = aux[t];
+        m->stats.writes += (uint64_t)(m->right - m->leftStart + 1);
+        NextMerge(m);
+        return true;
+    }
+    return false;
+}
+
+int64_t MergeSortRun(MergeSort *m, int64_t maxSteps, bool stopAtMergeEnd) {
+    int64_t steps = 0;
+    while (!m->done && steps < maxSteps) {
+        steps++;
+        if (DoMergeStep(m) && stopAtMergeEnd) break;
+    }
+    return steps;
+}
+
+void MergeSortCursor(const MergeSort *m, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (m->done) return;
+    c->a = m->iIdx <= m->mid ? m->iIdx : -1;
+    c->b = m->jIdx <= m->right ? m->jIdx : -1;
+    c->rangeLo = m->leftStart;
+    c->rangeHi = m->right;
+}
+
+// Same passes and copy-back as DoMergeStep, without the per-element state machine
+void MergeSortFast(int *values, int *aux, int n) {
+    for (int size = 1; size < n; size *= 2) {
+        for (int lo = 0; lo < n - size; lo += 2 * size) {
+            int mid = lo + size - 1;
+            int hi = (lo + 2 * size - 1 < n - 1) ? lo + 2 * size - 1 : n - 1;
+            int i = lo, j = mid + 1, k = lo;
+            while (i <= mid && j <= hi) aux[k++] = (values[i] <= values[j]) ? values[i++] : values[j++];
+            while (i <= mid) aux[k++] = values[i++];
+            while (j <= hi) aux[k++] = values[j++];
+            memcpy(values + lo, aux + lo, (size_t)(hi - lo + 1) * sizeof(int));
+        }
+    }
+}
@@ -0,0 +1,270 @@
+// sort_parallel.c
+#include "sort_parallel.h"
+#include "sort_core.h"
+#include "step_scheduler.h"
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __EMSCRIPTEN__
+#include <emscripten/threading.h>
+#endif
+
+#define PROGRESS_BLOCK 65536       // outputs between progress stores
+#define MIN_ELEMENTS_PER_THREAD 4096
+#define MIN_PAIRS_PER_THREAD 1024      // below this a phase is cheaper than its barrier
+
+int ParallelSortDefaultThreads(void) {
+#ifdef __EMSCRIPTEN__
+    int cores = emscripten_num_logical_cores();
+#else
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cores < 1) cores = 1;
+    return cores < PSORT_MAX_THREADS ? cores : PSORT_MAX_THREADS;
+}
+
+static inline int SliceStart(const ParallelSort *p, int t) {
+    return (int)((int64_t)p->n * t / p->threadCount);
+}
+
+// How many of the first d merged outputs come from a (ties go to a, keeping the merge stable)
+static int CoRank(const int *a, int m, const int *b, int k, int d) {
+    int lo = d > k ? d - k : 0;
+    int hi = d < m ? d : m;
+    while (lo < hi) {
+        int i = lo + (hi - lo) / 2;
+        if (a[i] <= b[d - i - 1]) lo = i + 1; else hi = i;
+    }
+    return lo;
+}
+
+// Branch-free merge of outputs [d0, d1) of a and b into out + d0
+static void MergeRange(ParallelSort *p, int t, const int *a, int m, const int *b, int k, int d0, int d1, int *out) {
+    int i = CoRank(a, m, b, k, d0), j = d0 - i;
+    int iEnd = CoRank(a, m, b, k, d1), jEnd = d1 - iEnd;
+    int d = d0;
+    while (d < d1) {
+        int blockStart = d;
+        int blockEnd = (d1 - d > PROGRESS_BLOCK) ? d + PROGRESS_BLOCK : d1;
+        while (d < blockEnd && i < iEnd && j < jEnd) {
+            int x = a[i], y = b[j];
+            bool takeB = y < x;
+            out[d++] = takeB ? y : x;
+            i += !takeB;
+            j += takeB;
+        }
+        while (d < blockEnd && i < iEnd) out[d++] = a[i++];
+        while (d < blockEnd && j < jEnd) out[d++] = b[j++];
+        atomic_fetch_add_explicit(&p->written[t], d - blockStart, memory_order_relaxed);
+    }
+}
+
+// One thread's share of a merge pass: every pair of runs overlapping its output slice
+static void MergeSlice(ParallelSort *p, int pass, int t, const int *src, int *dst) {
+    const int *b = p->bounds[pass - 1];
+    int runs = p->runCount[pass - 1];
+    int s = SliceStart(p, t), e = SliceStart(p, t + 1);
+
+    for (int r = 0; r < runs; r += 2) {
+        bool odd = r + 1 == runs;
+        int lo = b[r], mid = b[r + 1];
+        int hi = odd ? mid : b[r + 2];
+        int from = s > lo ? s : lo;
+        int to = e < hi ? e : hi;
+        if (from >= to) continue;
+
+        if (odd) {
+            // Odd run out: carried into the next pass unchanged
+            memcpy(dst + from, src + from, (size_t)(to - from) * sizeof(int));
+            atomic_fetch_add_explicit(&p->written[t], to - from, memory_order_relaxed);
+            continue;
+        }
+        MergeRange(p, t, src + lo, mid - lo, src + mid, hi - mid, from - lo, to - lo, dst + lo);
+    }
+}
+
+static void *Worker(void *arg) {
+    ParallelWorker *w = arg;
+    ParallelSort *p = w->sort;
+    int t = w->index;
+    while (!atomic_load(&p->go)) sched_yield();
+
+    int lo = p->bounds[0][t], hi = p->bounds[0][t + 1];
+    MergeSortSimd(p->values + lo, p->aux + lo, hi - lo);
+    atomic_store_explicit(&p->written[t], hi - lo, memory_order_relaxed);
+    pthread_barrier_wait(&p->barrier);
+
+    int *src = p->values, *dst = p->aux;
+    for (int pass = 1; pass <= p->passCount; pass++) {
+        if (t == 0) atomic_store(&p->pass, pass);
+        atomic_store_explicit(&p->written[t], 0, memory_order_relaxed);
+        MergeSlice(p, pass, t, src, dst);
+        pthread_barrier_wait(&p->barrier);
+        int *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    // An odd number of passes leaves the result in aux
+    if (src != p->values) {
+        int s = SliceStart(p, t), e = SliceStart(p, t + 1);
+        memcpy(p->values + s, src + s, (size_t)(e - s) * sizeof(int));
+        pthread_barrier_wait(&p->barrier);
+    }
+    if (t == 0) {
+        p->seconds = (SortClockMs() - p->startMs) / 1000.0;
+        atomic_store(&p->done, true);
+    }
+    return NULL;
+}
+
+// Splits [0, n) into one chunk per thread and precomputes the run boundaries of every pass
+static void Layout(ParallelSort *p, int threadCount) {
+    int n = p->n;
+    p->threadCount = threadCount;
+    for (int t = 0; t <= threadCount; t++) p->bounds[0][t] = SliceStart(p, t);
+    p->runCount[0] = threadCount;
+    p->passCount = 0;
+    while (p->runCount[p->passCount] > 1) {
+        int prev = p->passCount++;
+        int runs = (p->runCount[prev] + 1) / 2;
+        for (int r = 0; r < runs; r++) p->bounds[p->passCount][r] = p->bounds[prev][2 * r];
+        p->bounds[p->passCount][runs] = n;
+        p->runCount[p->passCount] = runs;
+    }
+}
+
+int ParallelSortStart(ParallelSort *p, int *values, int *aux, int n, int threadCount) {
+    if (threadCount > PSORT_MAX_THREADS) threadCount = PSORT_MAX_THREADS;
+    if (threadCount > n / MIN_ELEMENTS_PER_THREAD) threadCount = n / MIN_ELEMENTS_PER_THREAD;
+    if (threadCount < 1) threadCount = 1;
+
+    p->values = values;
+    p->aux = aux;
+    p->n = n;
+    p->threadCount = threadCount;
+    atomic_store(&p->go, false);
+    atomic_store(&p->pass, 0);
+    atomic_store(&p->done, false);
+    for (int t = 0; t < PSORT_MAX_THREADS; t++) atomic_store(&p->written[t], 0);
+    p->startMs = SortClockMs();
+
+    // Workers hold at the gate until the layout matches the threads that actually started
+    int started = 0;
+    for (; started < threadCount; started++) {
+        p->workers[started] = (ParallelWorker){ p, started };
+        if (pthread_create(&p->threads[started], NULL, Worker, &p->workers[started]) != 0) break;
+    }
+    if (started == 0) {
+        Layout(p, 1);
+        MergeSortSimd(values, aux, n);
+        p->seconds = (SortClockMs() - p->startMs) / 1000.0;
+        atomic_store(&p->done, true);
+        return 0;
+    }
+
+    Layout(p, started);
+    pthread_barrier_init(&p->barrier, NULL, (unsigned)started);
+    p->running = true;
+    atomic_store(&p->go, true);
+    return started;
+}
+
+bool ParallelSortDone(ParallelSort *p) {
+    if (!atomic_load(&p->done)) return false;
+    if (p->running) {
+        for (int t = 0; t < p->threadCount; t++) pthread_join(p->threads[t], NULL);
+        pthread_barrier_destroy(&p->barrier);
+        p->running = false;
+    }
+    return true;
+}
+
+void ParallelSortWait(ParallelSort *p) {
+    if (!p->running) return;
+    for (int t = 0; t < p->threadCount; t++) pthread_join(p->threads[t], NULL);
+    pthread_barrier_destroy(&p->barrier);
+    p->running = false;
+}
+
+void ParallelSortProgress(const ParallelSort *p, ParallelProgress *out) {
+    int pass = atomic_load(&p->pass);
+    out->pass = pass;
+    out->passCount = p->passCount;
+    // Pass k writes aux when k is odd; the chunk sorts work in values
+    out->front = (pass % 2 == 1) ? p->aux : p->values;
+    out->threadCount = p->threadCount;
+    for (int t = 0; t < p->threadCount; t++) {
+        out->sliceLo[t] = pass == 0 ? p->bounds[0][t] : SliceStart(p, t);
+        out->sliceHi[t] = pass == 0 ? p->bounds[0][t + 1] : SliceStart(p, t + 1);
+        out->written[t] = atomic_load_explicit(&p->written[t], memory_order_relaxed);
+    }
+}
+
+typedef struct OddEvenShared {
+    int *values;
+    int n;
+    int threadCount;
+    pthread_barrier_t barrier;
+    atomic_bool go;
+    atomic_bool swapped[3];    // per phase, rotating: one being set, one being read, one cleared
+} OddEvenShared;
+
+typedef struct OddEvenWorker {
+    OddEvenShared *shared;
+    int index;
+} OddEvenWorker;
+
+static void *OddEvenWorkerMain(void *arg) {
+    OddEvenWorker *w = arg;
+    OddEvenShared *s = w->shared;
+    int t = w->index;
+    while (!atomic_load(&s->go)) sched_yield();
+
+    // Every thread reads the same flag after the same barrier, so all of them count the
+    // same quiet phases and stop together. Thread 0 clears the next phase's slot: its last
+    // reader finished before the barrier thread 0 has just passed
+    for (int phase = 0, quiet = 0; quiet < 2; phase++) {
+        int parity = phase & 1;
+        int pairs = (s->n - parity) / 2;
+        int from = parity + 2 * (int)((int64_t)pairs * t / s->threadCount);
+        int to = parity + 2 * (int)((int64_t)pairs * (t + 1) / s->threadCount);
+        if (t == 0) atomic_store_explicit(&s->swapped[(phase + 1) % 3], false, memory_order_relaxed);
+        if (OddEvenPhase(s->values, from, to)) atomic_store_explicit(&s->swapped[phase % 3], true, memory_order_relaxed);
+        pthread_barrier_wait(&s->barrier);
+        quiet = atomic_load_explicit(&s->swapped[phase % 3], memory_order_relaxed) ? 0 : quiet + 1;
+    }
+    return NULL;
+}
+
+int OddEvenSortParallel(int *values, int n, int threadCount) {
+    if (threadCount > PSORT_MAX_THREADS) threadCount = PSORT_MAX_THREADS;
+    if (threadCount > n / 2 / MIN_PAIRS_PER_THREAD) threadCount = n / 2 / MIN_PAIRS_PER_THREAD;
+
+    OddEvenShared shared = { .values = values, .n = n };
+    atomic_store(&shared.go, false);
+    for (int k = 0; k < 3; k++) atomic_store(&shared.swapped[k], false);
+
+    // The caller is thread 0. Workers hold at the gate until the barrier matches the
+    // threads that actually started
+    pthread_t threads[PSORT_MAX_THREADS];
+    OddEvenWorker workers[PSORT_MAX_THREADS];
+    int started = 1;
+    for (; started < threadCount; started++) {
+        workers[started] = (OddEvenWorker){ &shared, started };
+        if (pthread_create(&threads[started], NULL, OddEvenWorkerMain, &workers[started]) != 0) break;
+    }
+    if (started == 1) {
+        OddEvenSortFast(values, n);
+        return 0;
+    }
+
+    shared.threadCount = started;
+    pthread_barrier_init(&shared.barrier, NULL, (unsigned)started);
+    atomic_store(&shared.go, true);
+    workers[0] = (OddEvenWorker){ &shared, 0 };
+    OddEvenWorkerMain(&workers[0]);
+    for (int t = 1; t < started; t++) pthread_join(threads[t], NULL);
+    pthread_barrier_destroy(&shared.barrier);
+    return started;
+}
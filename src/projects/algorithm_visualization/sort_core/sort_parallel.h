@@ -0,0 +1,69 @@
+// sort_parallel.h
+// Multithreaded merge sort. Each thread sorts one chunk with the SIMD path, then every
+// merge pass is split into equal output slices by merge path (co-ranking), so all
+// threads stay busy down to the final two-run merge. The caller starts the sort and
+// polls it; nothing blocks the main loop. Uses pthreads natively and in the browser
+// (Emscripten -pthread, which needs a cross-origin isolated page for SharedArrayBuffer).
+//
+// OddEvenSortParallel splits every odd-even transposition phase between threads instead;
+// it blocks and is meant for the native tools.
+#ifndef SORT_PARALLEL_H
+#define SORT_PARALLEL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define PSORT_MAX_THREADS 16
+#define PSORT_MAX_PASSES 5     // log2(PSORT_MAX_THREADS) merge passes after the chunk sorts
+
+struct ParallelSort;
+
+typedef struct ParallelWorker {
+    struct ParallelSort *sort;
+    int index;
+} ParallelWorker;
+
+typedef struct ParallelSort {
+    int *values;
+    int *aux;
+    int n;
+    int threadCount;
+    int passCount;             // merge passes; pass 0 is the chunk sorts
+    int bounds[PSORT_MAX_PASSES + 1][PSORT_MAX_THREADS + 1];   // run boundaries entering each pass
+    int runCount[PSORT_MAX_PASSES + 1];
+    pthread_t threads[PSORT_MAX_THREADS];
+    ParallelWorker workers[PSORT_MAX_THREADS];
+    pthread_barrier_t barrier;
+    bool running;              // threads started and not yet joined
+
+    // Shared with the workers
+    atomic_bool go;
+    atomic_int pass;
+    atomic_int written[PSORT_MAX_THREADS];     // elements output by each thread in the current pass
+    atomic_bool done;
+    double startMs, seconds;
+} ParallelSort;
+
+// What the renderer needs for one frame
+typedef struct ParallelProgress {
+    int pass, passCount;
+    const int *front;          // buffer being written by the current pass
+    int threadCount;
+    int sliceLo[PSORT_MAX_THREADS], sliceHi[PSORT_MAX_THREADS];   // each thread's output slice
+    int written[PSORT_MAX_THREADS];
+} ParallelProgress;
+
+int ParallelSortDefaultThreads(void);
+// Starts up to threadCount workers sorting values (aux is scratch of the same size) and
+// returns how many started; 0 means threads were unavailable and it sorted on the caller
+int ParallelSortStart(ParallelSort *p, int *values, int *aux, int n, int threadCount);
+bool ParallelSortDone(ParallelSort *p);        // joins the workers once they have finished
+void ParallelSortWait(ParallelSort *p);        // blocks until sorted; native tools only
+void ParallelSortProgress(const ParallelSort *p, ParallelProgress *out);
+
+// Sorts values with up to threadCount threads each running a slice of every phase, one
+// barrier per phase; returns the threads used, 0 when it sorted on the caller
+int OddEvenSortParallel(int *values, int n, int threadCount);
+
+#endif // SORT_PARALLEL_H
@@ -0,0 +1,157 @@
+// sort_quick.c
+#include "sort_core.h"
+
+#define QUICK_SMALL 16
+
+static inline void SwapAt(int *values, int a, int b, SortStats *stats, SortTrace *trace) {
+    SORT_TRACE(trace, TraceSwap(trace, 0, a, b));
+    int tmp = values[a];
+    values[a] = values[b];
+    values[b] = tmp;
+    stats->swaps++;
+}
+
+int MedianOfThree(const int *values, int lo, int mid, int hi, SortStats *stats, SortTrace *trace) {
+    int a = values[lo], b = values[mid], c = values[hi];
+    stats->comparisons += 2;
+    SORT_TRACE(trace, TraceCompare(trace, 0, lo, 0, mid));
+    SORT_TRACE(trace, TraceCompare(trace, 0, mid, 0, hi));
+    if ((a <= b) == (b <= c)) return b;
+    stats->comparisons++;
+    SORT_TRACE(trace, TraceCompare(trace, 0, lo, 0, hi));
+    if ((b <= a) == (a <= c)) return a;
+    return c;
+}
+
+// Samples at the quartiles rather than the ends: partitioning a sorted range rotates its
+// upper part (smallest element last), and an end sample would then pick the minimum
+static int ChoosePivot(const int *values, int lo, int hi, SortStats *stats, SortTrace *trace) {
+    int quarter = (hi - lo) / 4;
+    return MedianOfThree(values, lo + quarter, lo + (hi - lo) / 2, hi - quarter, stats, trace);
+}
+
+static void Push(QuickSort *q, int lo, int hi) {
+    if (hi - lo < 1) return;
+    q->stackLo[q->top] = lo;
+    q->stackHi[q->top] = hi;
+    q->top++;
+}
+
+void QuickSortInit(QuickSort *q, int *values, int n) {
+    q->values = values;
+    q->n = n;
+    q->top = 0;
+    q->lo = 0;
+    q->hi = -1;
+    q->partitioning = false;
+    q->done = n < 2;
+    q->stats = (SortStats){0};
+    q->trace = NULL;
+    Push(q, 0, n - 1);
+}
+
+int64_t QuickSortRun(QuickSort *q, int64_t maxSteps) {
+    uint64_t start = q->stats.steps;
+    int *values = q->values;
+    while (!q->done && (int64_t)(q->stats.steps - start) < maxSteps) {
+        if (!q->partitioning) {
+            if (q->top == 0) {
+                q->done = true;
+                break;
+            }
+            q->top--;
+            q->lo = q->stackLo[q->top];
+            q->hi = q->stackHi[q->top];
+            q->stats.steps++;
+            SORT_TRACE(q->trace, TraceRange(q->trace, q->lo, q->hi));
+            q->pivot = ChoosePivot(values, q->lo, q->hi, &q->stats, q->trace);
+            q->lt = q->i = q->lo;
+            q->gt = q->hi;
+            q->partitioning = true;
+            continue;
+        }
+
+        if (q->i > q->gt) {
+            // Larger side goes deeper in the stack so the smaller one is sorted first
+            q->partitioning = false;
+            int leftLen = q->lt - q->lo, rightLen = q->hi - q->gt;
+            if (leftLen > rightLen) {
+                Push(q, q->lo, q->lt - 1);
+                Push(q, q->gt + 1, q->hi);
+            } else {
+                Push(q, q->gt + 1, q->hi);
+                Push(q, q->lo, q->lt - 1);
+            }
+            continue;
+        }
+
+        q->stats.steps++;
+        q->stats.comparisons++;
+        SORT_TRACE(q->trace, TraceCompare(q->trace, 0, q->i, 0, q->i));
+        int v = values[q->i];
+        if (v < q->pivot) {
+            if (q->lt != q->i) SwapAt(values, q->lt, q->i, &q->stats, q->trace);
+            q->lt++;
+            q->i++;
+        } else if (v > q->pivot) {
+            SwapAt(values, q->i, q->gt, &q->stats, q->trace);
+            q->gt--;
+        } else {
+            q->i++;
+        }
+    }
+    return (int64_t)(q->stats.steps - start);
+}
+
+void QuickSortCursor(const QuickSort *q, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (q->done || !q->partitioning) return;
+    c->a = q->i <= q->gt ? q->i : -1;
+    c->b = q->gt;
+    c->rangeLo = q->lo;
+    c->rangeHi = q->hi;
+}
+
+void QuickSortFast(int *values, int n) {
+    int stackLo[QUICK_STACK], stackHi[QUICK_STACK];
+    int top = 0;
+    int lo = 0, hi = n - 1;
+    SortStats unused = {0};
+    for (;;) {
+        if (hi - lo < QUICK_SMALL) {
+            InsertionSortFast(values, lo, hi);
+            if (top == 0) break;
+            top--;
+            lo = stackLo[top];
+            hi = stackHi[top];
+            continue;
+        }
+
+        int pivot = ChoosePivot(values, lo, hi, &unused, NULL);
+        int lt = lo, i = lo, gt = hi;
+        while (i <= gt) {
+            int v = values[i];
+            if (v < pivot) {
+                values[i++] = values[lt];
+                values[lt++] = v;
+            } else if (v > pivot) {
+                values[i] = values[gt];
+                values[gt--] = v;
+            } else {
+                i++;
+            }
+        }
+
+        // Loop on the smaller side, defer the larger one
+        if (lt - lo < hi - gt) {
+            stackLo[top] = gt + 1;
+            stackHi[top] = hi;
+            hi = lt - 1;
+        } else {
+            stackLo[top] = lo;
+            stackHi[top] = lt - 1;
+            lo = gt + 1;
+        }
+        top++;
+    }
+}
@@ -0,0 +1,82 @@
+// sort_race.c
+#include "sort_race.h"
+#include "step_scheduler.h"
+#include <string.h>
+
+#define MAX_LANE_CHUNK (1 << 20)
+
+bool SortRaceBegin(SortRace *r, const SortEngine *const engines[], int laneCount, const int *input, int n) {
+    if (laneCount > SORT_RACE_MAX_LANES) laneCount = SORT_RACE_MAX_LANES;
+    r->n = n;
+    r->laneCount = 0;
+    r->finished = 0;
+    if (laneCount < 1 || n < 1) return false;
+
+    // The arena only grows, so racing again at the same size reuses it as is
+    if (!ArenaReserve(&r->arena, SortSessionBytes(n) * (size_t)laneCount)) return false;
+    ArenaReset(&r->arena);
+    for (int i = 0; i < laneCount; i++) {
+        SortRaceLane *lane = &r->lanes[i];
+        *lane = (SortRaceLane){ .engine = engines[i], .chunk = 1 };
+        lane->values = ArenaAlloc(&r->arena, (size_t)n * sizeof(int));
+        lane->aux = ArenaAlloc(&r->arena, (size_t)n * sizeof(int));
+        lane->highlight = ArenaAlloc(&r->arena, (size_t)n);
+        memcpy(lane->values, input, (size_t)n * sizeof(int));
+        memset(lane->highlight, 0, (size_t)n);
+        SortMachineInit(&lane->machine, lane->engine, lane->values, lane->aux, n);
+        if (SortMachineDone(&lane->machine)) lane->place = ++r->finished;
+    }
+    r->laneCount = laneCount;
+    return true;
+}
+
+// The running lane that has had the least time; ties (steps too quick for the clock) go
+// to the one with the fewest steps
+static SortRaceLane *NextLane(SortRace *r) {
+    SortRaceLane *best = NULL;
+    for (int i = 0; i < r->laneCount; i++) {
+        SortRaceLane *lane = &r->lanes[i];
+        if (lane->place) continue;
+        if (!best || lane->ms < best->ms || (lane->ms == best->ms && lane->steps < best->steps)) best = lane;
+    }
+    return best;
+}
+
+int64_t SortRaceRun(SortRace *r, int64_t maxSteps) {
+    int64_t done = 0;
+    while (done < maxSteps) {
+        SortRaceLane *lane = NextLane(r);
+        if (!lane) break;
+
+        int64_t want = maxSteps - done;
+        if (want > lane->chunk) want = lane->chunk;
+        double start = SortClockMs();
+        int64_t ran = SortMachineRun(&lane->machine, want);
+        double ms = SortClockMs() - start;
+        lane->ms += ms;
+        lane->steps += ran;
+        done += ran;
+
+        if (ran < want || SortMachineDone(&lane->machine)) {
+            lane->place = ++r->finished;
+        } else if (want == lane->chunk && ms < RACE_SLICE_MS / 2 && lane->chunk < MAX_LANE_CHUNK) {
+            lane->chunk *= 2;
+        } else if (ms > RACE_SLICE_MS * 2 && lane->chunk > 1) {
+            lane->chunk /= 2;
+        }
+    }
+    return done;
+}
+
+bool SortRaceDone(const SortRace *r) {
+    return r->finished >= r->laneCount;
+}
+
+void SortRaceFree(SortRace *r) {
+    ArenaFree(&r->arena);
+    *r = (SortRace){0};
+}
+
+double SortRaceLaneOpsPerSecond(const SortRaceLane *lane) {
+    return lane->ms > 0 ? (double)lane->steps / (lane->ms / 1000.0) : 0.0;
+}
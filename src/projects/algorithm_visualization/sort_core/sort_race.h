@@ -0,0 +1,49 @@
+// sort_race.h
+// Several engines sorting identical copies of one input side by side. Every lane's
+// buffers come out of a single arena, so a lane costs its values, aux and highlight and
+// nothing else.
+//
+// SortRaceRun is a StepFn: the steps it is given go to the lanes in slices of about
+// RACE_SLICE_MS, always to the running lane that has had the least time so far, so each
+// lane gets an equal share of the CPU whatever its steps cost. Ops per second and the
+// time a lane needed to finish then compare the algorithms themselves, not how many
+// steps a frame happens to allow.
+#ifndef SORT_RACE_H
+#define SORT_RACE_H
+
+#include "sort_engine.h"
+#include "sort_session.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SORT_RACE_MAX_LANES 12
+#define RACE_SLICE_MS 0.25
+
+typedef struct SortRaceLane {
+    const SortEngine *engine;
+    SortMachine machine;
+    int *values, *aux;
+    unsigned char *highlight;
+    int64_t steps;
+    double ms;                 // time spent in this lane's steps
+    int64_t chunk;             // steps per slice, adapted to the engine's step cost
+    int place;                 // 1 for the first lane to finish; 0 while running
+} SortRaceLane;
+
+typedef struct SortRace {
+    SortArena arena;
+    int n;
+    int laneCount;
+    int finished;
+    SortRaceLane lanes[SORT_RACE_MAX_LANES];
+} SortRace;
+
+// Copies input into one lane per engine; false when the arena cannot hold them
+bool SortRaceBegin(SortRace *r, const SortEngine *const engines[], int laneCount, const int *input, int n);
+int64_t SortRaceRun(SortRace *r, int64_t maxSteps);      // a StepFn over all lanes
+bool SortRaceDone(const SortRace *r);
+void SortRaceFree(SortRace *r);
+
+double SortRaceLaneOpsPerSecond(const SortRaceLane *lane);
+
+#endif // SORT_RACE_H
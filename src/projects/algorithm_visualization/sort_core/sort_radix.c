@@ -0,0 +1,123 @@
+// sort_radix.c
+#include "sort_core.h"
+#include <string.h>
+
+// Flipping the sign bit makes the unsigned digit order match signed int order
+static inline unsigned Digit(int v, int pass) {
+    return (((uint32_t)v ^ 0x80000000u) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+static void NextPass(RadixSort *r) {
+    r->pass++;
+    r->i = 0;
+    memset(r->offsets, 0, sizeof(r->offsets));
+    if (r->pass < RADIX_PASSES)
+        r->phase = RADIX_COUNT;
+    else if (r->srcBuf == 1)
+        r->phase = RADIX_COPY_BACK;
+    else
+        r->done = true;
+}
+
+void RadixSortInit(RadixSort *r, int *values, int *aux, int n) {
+    r->values = values;
+    r->aux = aux;
+    r->n = n;
+    r->pass = 0;
+    r->phase = RADIX_COUNT;
+    r->i = 0;
+    r->srcBuf = 0;
+    memset(r->offsets, 0, sizeof(r->offsets));
+    r->done = n < 2;
+    r->stats = (SortStats){0};
+    r->trace = NULL;
+}
+
+int64_t RadixSortRun(RadixSort *r, int64_t maxSteps) {
+    uint64_t start = r->stats.steps;
+    int n = r->n;
+    while (!r->done && (int64_t)(r->stats.steps - start) < maxSteps) {
+        int *src = r->srcBuf ? r->aux : r->values;
+        int *dst = r->srcBuf ? r->values : r->aux;
+
+        if (r->phase == RADIX_COUNT) {
+            if (r->i < n) {
+                r->stats.steps++;
+                SORT_TRACE(r->trace, TraceCompare(r->trace, r->srcBuf, r->i, r->srcBuf, r->i));
+                r->offsets[Digit(src[r->i], r->pass)]++;
+                r->i++;
+                continue;
+            }
+            // Counts -> start offsets; a digit shared by every key makes the pass a no-op
+            bool trivial = false;
+            int sum = 0;
+            for (int b = 0; b < RADIX_BUCKETS; b++) {
+                int count = r->offsets[b];
+                if (count == n) trivial = true;
+                r->offsets[b] = sum;
+                sum += count;
+            }
+            r->i = 0;
+            if (trivial)
+                NextPass(r);
+            else
+                r->phase = RADIX_SCATTER;
+        } else if (r->phase == RADIX_SCATTER) {
+            if (r->i < n) {
+                r->stats.steps++;
+                r->stats.writes++;
+                int v = src[r->i];
+                int at = r->offsets[Digit(v, r->pass)]++;
+                SORT_TRACE(r->trace, TraceMove(r->trace, r->srcBuf ^ 1, at, r->srcBuf, r->i));
+                dst[at] = v;
+                r->i++;
+                continue;
+            }
+            r->srcBuf ^= 1;
+            NextPass(r);
+        } else {
+            r->stats.steps++;
+            r->stats.writes += (uint64_t)n;
+            SORT_TRACE(r->trace, TraceCopyRange(r->trace, 0, 1, 0, n));
+            memcpy(r->values, r->aux, (size_t)n * sizeof(int));
+            r->done = true;
+        }
+    }
+    return (int64_t)(r->stats.steps - start);
+}
+
+void RadixSortCursor(const RadixSort *r, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (r->done || r->phase == RADIX_COPY_BACK) return;
+    c->a = r->i < r->n ? r->i : -1;
+}
+
+void RadixSortFast(int *values, int *aux, int n) {
+    int counts[RADIX_PASSES][RADIX_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++)
+        for (int p = 0; p < RADIX_PASSES; p++) counts[p][Digit(values[i], p)]++;
+
+    int *src = values, *dst = aux;
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        int *offsets = counts[p];
+        bool trivial = false;
+        int sum = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            int count = offsets[b];
+            if (count == n) trivial = true;
+            offsets[b] = sum;
+            sum += count;
+        }
+        if (trivial) continue;
+
+        for (int i = 0; i < n; i++) {
+            int v = src[i];
+            dst[offsets[Digit(v, p)]++] = v;
+        }
+        int *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != values) memcpy(values, src, (size_t)n * sizeof(int));
+}
@@ -0,0 +1,76 @@
+// sort_session.c
+#include "sort_session.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_GRANULE (64 * 1024)   // wasm page size; avoids regrowing for small changes
+
+static size_t AlignUp(size_t v, size_t a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+bool ArenaReserve(SortArena *arena, size_t capacity) {
+    if (capacity <= arena->capacity) return true;
+
+    capacity = AlignUp(capacity, ARENA_GRANULE);
+    // Old contents are never needed by callers that grow, so free first to keep the peak low
+    free(arena->base);
+    arena->base = malloc(capacity);
+    arena->used = 0;
+    if (!arena->base) {
+        arena->capacity = 0;
+        return false;
+    }
+    arena->capacity = capacity;
+    return true;
+}
+
+void *ArenaAlloc(SortArena *arena, size_t size) {
+    size_t offset = AlignUp(arena->used, ARENA_ALIGN);
+    if (offset + size > arena->capacity) return NULL;
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+void ArenaReset(SortArena *arena) {
+    arena->used = 0;
+}
+
+void ArenaFree(SortArena *arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+size_t SortSessionBytes(int n) {
+    size_t count = (size_t)(n > 0 ? n : 1);
+    return AlignUp(count * sizeof(int), ARENA_ALIGN) * 2 + AlignUp(count, ARENA_ALIGN);
+}
+
+bool SortSessionResize(SortSession *s, int n) {
+    if (n < 1) n = 1;
+    if (n > SORT_SESSION_MAX_N) n = SORT_SESSION_MAX_N;
+
+    if (!ArenaReserve(&s->arena, SortSessionBytes(n))) {
+        s->n = 0;
+        s->values = s->aux = NULL;
+        s->highlight = NULL;
+        return false;
+    }
+    ArenaReset(&s->arena);
+    s->n = n;
+    s->values = ArenaAlloc(&s->arena, (size_t)n * sizeof(int));
+    s->aux = ArenaAlloc(&s->arena, (size_t)n * sizeof(int));
+    s->highlight = ArenaAlloc(&s->arena, (size_t)n);
+    memset(s->highlight, HL_NONE, (size_t)n);
+    return true;
+}
+
+void SortSessionFree(SortSession *s) {
+    ArenaFree(&s->arena);
+    s->n = 0;
+    s->values = s->aux = NULL;
+    s->highlight = NULL;
+}
@@ -0,0 +1,46 @@
+// sort_session.h
+// Runtime-sized sort buffers. Everything a session needs (values, aux, highlight)
+// is carved out of one arena so resizing never fragments the wasm heap.
+#ifndef SORT_SESSION_H
+#define SORT_SESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SORT_SESSION_MAX_N (1 << 24)
+
+// Linear allocator over a single block; individual allocations are never freed
+typedef struct SortArena {
+    unsigned char *base;
+    size_t capacity;
+    size_t used;
+} SortArena;
+
+bool ArenaReserve(SortArena *arena, size_t capacity);   // discards contents when it has to grow
+void *ArenaAlloc(SortArena *arena, size_t size);         // 16-byte aligned, NULL when full
+void ArenaReset(SortArena *arena);
+void ArenaFree(SortArena *arena);
+
+// Per-element highlight codes written by the visualizers
+typedef enum {
+    HL_NONE = 0,
+    HL_RANGE,          // inside the region currently being worked on
+    HL_ACTIVE,         // being compared / moved this step
+    HL_DONE            // known to be in its final position
+} HighlightCode;
+
+typedef struct SortSession {
+    SortArena arena;
+    int n;
+    int *values;
+    int *aux;
+    unsigned char *highlight;
+} SortSession;
+
+// Carves n-element buffers out of the arena, growing it only when n exceeds what it
+// already holds. Buffer contents are undefined afterwards.
+bool SortSessionResize(SortSession *s, int n);
+void SortSessionFree(SortSession *s);
+size_t SortSessionBytes(int n);
+
+#endif // SORT_SESSION_H
@@ -0,0 +1,216 @@
+// sort_simd.c
+// Vectorized bottom-up merge sort: 4x4 register sorting network for the first runs,
+// then a bitonic 4+4 merge kernel driven over whole runs, ping-ponging between values
+// and aux. Also the odd-even transposition phase, two pairs per vector. Compiled for
+// wasm SIMD128 (-msimd128) or SSE4.1 (-msse4.1); without either it falls back to the
+// scalar fast paths.
+#include "sort_core.h"
+#include <string.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define SORT_SIMD_NAME "simd128"
+typedef v128_t V4;
+#define V4Load(p) wasm_v128_load(p)
+#define V4Store(p, v) wasm_v128_store((p), (v))
+#define V4Min(a, b) wasm_i32x4_min((a), (b))
+#define V4Max(a, b) wasm_i32x4_max((a), (b))
+#define V4Reverse(a) wasm_i32x4_shuffle((a), (a), 3, 2, 1, 0)
+#define V4UnpackLo32(a, b) wasm_i32x4_shuffle((a), (b), 0, 4, 1, 5)
+#define V4UnpackHi32(a, b) wasm_i32x4_shuffle((a), (b), 2, 6, 3, 7)
+#define V4UnpackLo64(a, b) wasm_i32x4_shuffle((a), (b), 0, 1, 4, 5)
+#define V4UnpackHi64(a, b) wasm_i32x4_shuffle((a), (b), 2, 3, 6, 7)
+#define V4SwapPairs(a) wasm_i32x4_shuffle((a), (a), 1, 0, 3, 2)
+#define V4BlendPairs(lo, hi) wasm_i32x4_shuffle((lo), (hi), 0, 5, 2, 7)
+#define V4Zero() wasm_i32x4_splat(0)
+#define V4Or(a, b) wasm_v128_or((a), (b))
+#define V4Xor(a, b) wasm_v128_xor((a), (b))
+#define V4AnyBits(a) wasm_v128_any_true(a)
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define SORT_SIMD_NAME "sse4.1"
+typedef __m128i V4;
+#define V4Load(p) _mm_loadu_si128((const __m128i *)(p))
+#define V4Store(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define V4Min(a, b) _mm_min_epi32((a), (b))
+#define V4Max(a, b) _mm_max_epi32((a), (b))
+#define V4Reverse(a) _mm_shuffle_epi32((a), _MM_SHUFFLE(0, 1, 2, 3))
+#define V4UnpackLo32(a, b) _mm_unpacklo_epi32((a), (b))
+#define V4UnpackHi32(a, b) _mm_unpackhi_epi32((a), (b))
+#define V4UnpackLo64(a, b) _mm_unpacklo_epi64((a), (b))
+#define V4UnpackHi64(a, b) _mm_unpackhi_epi64((a), (b))
+#define V4SwapPairs(a) _mm_shuffle_epi32((a), _MM_SHUFFLE(2, 3, 0, 1))
+#define V4BlendPairs(lo, hi) _mm_blend_epi16((lo), (hi), 0xCC)
+#define V4Zero() _mm_setzero_si128()
+#define V4Or(a, b) _mm_or_si128((a), (b))
+#define V4Xor(a, b) _mm_xor_si128((a), (b))
+#define V4AnyBits(a) (!_mm_testz_si128((a), (a)))
+#endif
+
+// One pair without a branch: compilers turn the selects into cmov / select
+static inline bool OrderPair(int *p) {
+    int a = p[0], b = p[1];
+    bool out = b < a;
+    p[0] = out ? b : a;
+    p[1] = out ? a : b;
+    return out;
+}
+
+// Two quiet phases in a row (one even, one odd) leave no neighbours out of order
+void OddEvenSortFast(int *values, int n) {
+    for (int phase = 0, quiet = 0; quiet < 2; phase ^= 1)
+        quiet = OddEvenPhase(values, phase, n) ? 0 : quiet + 1;
+}
+
+#ifdef SORT_SIMD_NAME
+
+const char *MergeSortSimdName(void) { return SORT_SIMD_NAME; }
+
+// Each vector holds two pairs: min of a lane and its neighbour goes to the even lane, max
+// to the odd one. Changed lanes are OR-ed together and tested once at the end
+bool OddEvenPhase(int *values, int from, int to) {
+    V4 changed = V4Zero();
+    int p = from;
+    for (; p + 4 <= to; p += 4) {
+        V4 v = V4Load(values + p);
+        V4 w = V4SwapPairs(v);
+        V4 r = V4BlendPairs(V4Min(v, w), V4Max(v, w));
+        changed = V4Or(changed, V4Xor(r, v));
+        V4Store(values + p, r);
+    }
+    bool any = V4AnyBits(changed);
+    for (; p + 1 < to; p += 2) any |= OrderPair(values + p);
+    return any;
+}
+
+// Bitonic merge of two sorted vectors: lo gets the 4 smallest, hi the 4 largest, both sorted
+static inline void Merge4x4(V4 a, V4 b, V4 *lo, V4 *hi) {
+    b = V4Reverse(b);
+    V4 l1 = V4Min(a, b), h1 = V4Max(a, b);        // two bitonic halves, l1 <= h1
+
+    // Half-cleaner at distance 2, both halves at once
+    V4 x = V4UnpackLo64(l1, h1), y = V4UnpackHi64(l1, h1);
+    V4 l2 = V4Min(x, y), h2 = V4Max(x, y);
+
+    // Distance 1: pair lanes (0,1) and (2,3) of each half
+    V4 u = V4UnpackLo32(l2, h2), v = V4UnpackHi32(l2, h2);
+    x = V4UnpackLo64(u, v);
+    y = V4UnpackHi64(u, v);
+    V4 mn = V4Min(x, y), mx = V4Max(x, y);
+
+    *lo = V4UnpackLo32(mn, mx);
+    *hi = V4UnpackHi32(mn, mx);
+}
+
+// Sorts 16 ints as four sorted runs of 4: a sorting network down the columns, then a transpose
+static inline void SortColumns4x4(int *p) {
+    V4 r0 = V4Load(p), r1 = V4Load(p + 4), r2 = V4Load(p + 8), r3 = V4Load(p + 12);
+    V4 t;
+    t = V4Min(r0, r1); r1 = V4Max(r0, r1); r0 = t;
+    t = V4Min(r2, r3); r3 = V4Max(r2, r3); r2 = t;
+    t = V4Min(r0, r2); r2 = V4Max(r0, r2); r0 = t;
+    t = V4Min(r1, r3); r3 = V4Max(r1, r3); r1 = t;
+    t = V4Min(r1, r2); r2 = V4Max(r1, r2); r1 = t;
+
+    V4 a = V4UnpackLo32(r0, r1), b = V4UnpackLo32(r2, r3);
+    V4 c = V4UnpackHi32(r0, r1), d = V4UnpackHi32(r2, r3);
+    V4Store(p, V4UnpackLo64(a, b));
+    V4Store(p + 4, V4UnpackHi64(a, b));
+    V4Store(p + 8, V4UnpackLo64(c, d));
+    V4Store(p + 12, V4UnpackHi64(c, d));
+}
+
+// Merges a[0..na) and b[0..nb) into out; both lengths are non-zero multiples of 4.
+// The kernel keeps the upper half in a register and feeds it the next block from
+// whichever run has the smaller head, so only one branch is taken per 4 outputs.
+static void MergeRunsSimd(const int *a, int na, const int *b, int nb, int *out) {
+    V4 lo, carry;
+    Merge4x4(V4Load(a), V4Load(b), &lo, &carry);
+    V4Store(out, lo);
+    out += 4;
+
+    const int *aEnd = a + na, *bEnd = b + nb;
+    a += 4;
+    b += 4;
+    while (a < aEnd && b < bEnd) {
+        V4 next;
+        if (*a <= *b) {
+            next = V4Load(a);
+            a += 4;
+        } else {
+            next = V4Load(b);
+            b += 4;
+        }
+        Merge4x4(next, carry, &lo, &carry);
+        V4Store(out, lo);
+        out += 4;
+    }
+    for (; a < aEnd; a += 4, out += 4) {
+        Merge4x4(V4Load(a), carry, &lo, &carry);
+        V4Store(out, lo);
+    }
+    for (; b < bEnd; b += 4, out += 4) {
+        Merge4x4(V4Load(b), carry, &lo, &carry);
+        V4Store(out, lo);
+    }
+    V4Store(out, carry);
+}
+
+static void Sort4(int *p) {
+    #define CSWAP(i, j) if (p[j] < p[i]) { int t = p[i]; p[i] = p[j]; p[j] = t; }
+    CSWAP(0, 1) CSWAP(2, 3) CSWAP(0, 2) CSWAP(1, 3) CSWAP(1, 2)
+    #undef CSWAP
+}
+
+void MergeSortSimd(int *values, int *aux, int n) {
+    int m = n & ~3;
+
+    int i = 0;
+    for (; i + 16 <= m; i += 16) SortColumns4x4(values + i);
+    for (; i < m; i += 4) Sort4(values + i);
+
+    int *src = values, *dst = aux;
+    for (int width = 4; width < m; width *= 2) {
+        for (int lo = 0; lo < m; lo += 2 * width) {
+            int mid = lo + width;
+            if (mid >= m) {
+                memcpy(dst + lo, src + lo, (size_t)(m - lo) * sizeof(int));
+                continue;
+            }
+            int hi = (mid + width < m) ? mid + width : m;
+            MergeRunsSimd(src + lo, width, src + mid, hi - mid, dst + lo);
+        }
+        int *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != values) memcpy(values, src, (size_t)m * sizeof(int));
+
+    // Up to 3 leftover elements: insert each into the sorted prefix
+    for (int t = m; t < n; t++) {
+        int key = values[t];
+        int lo = 0, hi = t;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (values[mid] <= key) lo = mid + 1; else hi = mid;
+        }
+        memmove(values + lo + 1, values + lo, (size_t)(t - lo) * sizeof(int));
+        values[lo] = key;
+    }
+}
+
+#else
+
+const char *MergeSortSimdName(void) { return "scalar"; }
+
+bool OddEvenPhase(int *values, int from, int to) {
+    bool any = false;
+    for (int p = from; p + 1 < to; p += 2) any |= OrderPair(values + p);
+    return any;
+}
+
+void MergeSortSimd(int *values, int *aux, int n) {
+    MergeSortFast(values, aux, n);
+}
+
+#endif
@@ -0,0 +1,319 @@
+// sort_tim.c
+#include "sort_core.h"
+#include <string.h>
+
+// n itself below 64, otherwise a value in [32, 64] that makes n / minRun a power of
+// two or slightly below one, so the final merges stay balanced
+static int ComputeMinRun(int n) {
+    int r = 0;
+    while (n >= 64) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+void TimSortInit(TimSort *t, int *values, int *aux, int n) {
+    t->values = values;
+    t->aux = aux;
+    t->n = n;
+    t->minRun = ComputeMinRun(n);
+    t->runCount = 0;
+    t->pos = 0;
+    t->mode = TIM_SCAN;
+    t->finalCollapse = false;
+    t->done = n < 2;
+    t->stats = (SortStats){0};
+    t->trace = NULL;
+}
+
+static void PushRun(TimSort *t) {
+    t->runs[t->runCount++] = (TimRun){ t->runStart, t->runEnd - t->runStart };
+    t->pos = t->runEnd;
+    t->mode = TIM_COLLAPSE;
+}
+
+// A natural run shorter than minRun is padded with the following elements by insertion
+static void FinishRun(TimSort *t) {
+    int len = t->runEnd - t->runStart;
+    if (len < t->minRun && t->runEnd < t->n) {
+        int force = (t->minRun < t->n - t->runStart) ? t->minRun : t->n - t->runStart;
+        InsertionPassInit(&t->ins, t->runStart, t->runStart + force - 1, t->runEnd);
+        t->runEnd = t->runStart + force;
+        t->mode = TIM_INSERTION;
+        return;
+    }
+    PushRun(t);
+}
+
+// Merges runs k and k + 1; skipped when the pair is already in order
+static void BeginMerge(TimSort *t, int k) {
+    int base1 = t->runs[k].base, len1 = t->runs[k].len;
+    int base2 = t->runs[k + 1].base, len2 = t->runs[k + 1].len;
+    t->runs[k].len = len1 + len2;
+    for (int r = k + 1; r < t->runCount - 1; r++) t->runs[r] = t->runs[r + 1];
+    t->runCount--;
+
+    t->stats.steps++;
+    t->stats.comparisons++;
+    SORT_TRACE(t->trace, TraceCompare(t->trace, 0, base2 - 1, 0, base2));
+    if (t->values[base2 - 1] <= t->values[base2]) return;
+
+    SORT_TRACE(t->trace, TraceRange(t->trace, base1, base2 + len2 - 1));
+    t->mergeLo = base1;
+    t->i = base1;
+    t->iEnd = base2;
+    t->j = base2;
+    t->jEnd = base2 + len2;
+    t->k = base1;
+    t->mode = TIM_COPY_LEFT;
+}
+
+// Restores runs[k-1] > runs[k] + runs[k+1] and runs[k] > runs[k+1] for the top of the
+// stack (including the depth-3 check missing from the original listsort)
+static void Collapse(TimSort *t) {
+    TimRun *runs = t->runs;
+    if (t->runCount <= 1) {
+        if (t->finalCollapse)
+            t->done = true;
+        else
+            t->mode = TIM_SCAN;
+        return;
+    }
+
+    int k = t->runCount - 2;
+    if (t->finalCollapse) {
+        if (k > 0 && runs[k - 1].len < runs[k + 1].len) k--;
+    } else if ((k > 0 && runs[k - 1].len <= runs[k].len + runs[k + 1].len) ||
+               (k > 1 && runs[k - 2].len <= runs[k - 1].len + runs[k].len)) {
+        if (runs[k - 1].len < runs[k + 1].len) k--;
+    } else if (runs[k].len > runs[k + 1].len) {
+        t->mode = TIM_SCAN;
+        return;
+    }
+    BeginMerge(t, k);
+}
+
+static void MergeStep(TimSort *t) {
+    int *values = t->values, *aux = t->aux;
+    if (t->i >= t->iEnd) {
+        t->mode = TIM_COLLAPSE;   // what is left of the right run is already in place
+        return;
+    }
+
+    t->stats.steps++;
+    t->stats.writes++;
+    if (t->j < t->jEnd) {
+        t->stats.comparisons++;
+        SORT_TRACE(t->trace, TraceCompare(t->trace, 1, t->i, 0, t->j));
+        if (values[t->j] < aux[t->i]) {
+            SORT_TRACE(t->trace, TraceMove(t->trace, 0, t->k, 0, t->j));
+            values[t->k++] = values[t->j++];
+            return;
+        }
+    }
+    SORT_TRACE(t->trace, TraceMove(t->trace, 0, t->k, 1, t->i));
+    values[t->k++] = aux[t->i++];
+}
+
+int64_t TimSortRun(TimSort *t, int64_t maxSteps) {
+    uint64_t start = t->stats.steps;
+    int *values = t->values;
+    while (!t->done && (int64_t)(t->stats.steps - start) < maxSteps) {
+        switch (t->mode) {
+        case TIM_SCAN:
+            if (t->pos >= t->n) {
+                t->finalCollapse = true;
+                t->mode = TIM_COLLAPSE;
+                break;
+            }
+            t->runStart = t->pos;
+            if (t->pos == t->n - 1) {
+                t->runEnd = t->n;
+                FinishRun(t);
+                break;
+            }
+            t->stats.steps++;
+            t->stats.comparisons++;
+            SORT_TRACE(t->trace, TraceCompare(t->trace, 0, t->pos, 0, t->pos + 1));
+            t->descending = values[t->pos + 1] < values[t->pos];
+            t->runEnd = t->pos + 2;
+            t->mode = TIM_EXTEND_RUN;
+            break;
+        case TIM_EXTEND_RUN: {
+            int e = t->runEnd;
+            if (e < t->n) {
+                t->stats.steps++;
+                t->stats.comparisons++;
+                SORT_TRACE(t->trace, TraceCompare(t->trace, 0, e - 1, 0, e));
+                // Descending runs must be strict so reversing them keeps the sort stable
+                bool extends = t->descending ? values[e] < values[e - 1] : values[e] >= values[e - 1];
+                if (extends) {
+                    t->runEnd++;
+                    break;
+                }
+            }
+            if (t->descending) {
+                t->revLo = t->runStart;
+                t->revHi = t->runEnd - 1;
+                t->mode = TIM_REVERSE;
+            } else {
+                FinishRun(t);
+            }
+        } break;
+        case TIM_REVERSE:
+            if (t->revLo < t->revHi) {
+                t->stats.steps++;
+                t->stats.swaps++;
+                SORT_TRACE(t->trace, TraceSwap(t->trace, 0, t->revLo, t->revHi));
+                int tmp = values[t->revLo];
+                values[t->revLo++] = values[t->revHi];
+                values[t->revHi--] = tmp;
+            } else {
+                FinishRun(t);
+            }
+            break;
+        case TIM_INSERTION:
+            if (InsertionPassStep(&t->ins, values, &t->stats, t->trace)) FinishRun(t);
+            break;
+        case TIM_COLLAPSE:
+            Collapse(t);
+            break;
+        case TIM_COPY_LEFT: {
+            int len = t->iEnd - t->i;
+            t->stats.steps++;
+            t->stats.writes += (uint64_t)len;
+            SORT_TRACE(t->trace, TraceCopyRange(t->trace, 1, 0, t->i, len));
+            memcpy(t->aux + t->i, values + t->i, (size_t)len * sizeof(int));
+            t->mode = TIM_MERGE;
+        } break;
+        case TIM_MERGE:
+            MergeStep(t);
+            break;
+        }
+    }
+    return (int64_t)(t->stats.steps - start);
+}
+
+void TimSortCursor(const TimSort *t, SortCursor *c) {
+    *c = (SortCursor){ -1, -1, 0, -1 };
+    if (t->done) return;
+    switch (t->mode) {
+    case TIM_EXTEND_RUN:
+        c->a = t->runEnd - 1;
+        c->b = t->runEnd < t->n ? t->runEnd : -1;
+        c->rangeLo = t->runStart;
+        c->rangeHi = t->runEnd - 1;
+        break;
+    case TIM_REVERSE:
+        c->a = t->revLo;
+        c->b = t->revHi;
+        c->rangeLo = t->runStart;
+        c->rangeHi = t->runEnd - 1;
+        break;
+    case TIM_INSERTION:
+        c->a = t->ins.done ? -1 : t->ins.j - 1;
+        c->b = t->ins.done ? -1 : t->ins.j;
+        c->rangeLo = t->runStart;
+        c->rangeHi = t->runEnd - 1;
+        break;
+    case TIM_COPY_LEFT:
+    case TIM_MERGE:
+        c->a = t->k;
+        c->b = t->j < t->jEnd ? t->j : -1;
+        c->rangeLo = t->mergeLo;
+        c->rangeHi = t->jEnd - 1;
+        break;
+    default:
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Fast path
+//------------------------------------------------------------------------------------
+// First index in [lo, hi) whose value is > key
+static int UpperBound(const int *values, int lo, int hi, int key) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (values[mid] <= key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// First index in [lo, hi) whose value is >= key
+static int LowerBound(const int *values, int lo, int hi, int key) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (values[mid] < key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static void MergeRunsFast(int *values, int *aux, int base1, int base2, int len2) {
+    // Elements of run 1 not above run2[0], and of run 2 not below run1's last,
+    // are already in their final place
+    int lo = UpperBound(values, base1, base2, values[base2]);
+    int hi = LowerBound(values, base2, base2 + len2, values[base2 - 1]);
+    if (lo == base2) return;
+
+    int len = base2 - lo;
+    memcpy(aux + lo, values + lo, (size_t)len * sizeof(int));
+    int i = lo, iEnd = base2, j = base2, k = lo;
+    while (i < iEnd && j < hi) values[k++] = (values[j] < aux[i]) ? values[j++] : aux[i++];
+    while (i < iEnd) values[k++] = aux[i++];
+}
+
+void TimSortFast(int *values, int *aux, int n) {
+    if (n < 2) return;
+    int minRun = ComputeMinRun(n);
+    TimRun runs[TIM_MAX_RUNS];
+    int count = 0;
+
+    for (int pos = 0; pos < n;) {
+        int end = pos + 1;
+        if (end < n) {
+            if (values[end] < values[pos]) {
+                while (end < n && values[end] < values[end - 1]) end++;
+                for (int lo = pos, hi = end - 1; lo < hi; lo++, hi--) {
+                    int tmp = values[lo];
+                    values[lo] = values[hi];
+                    values[hi] = tmp;
+                }
+            } else {
+                while (end < n && values[end] >= values[end - 1]) end++;
+            }
+        }
+        if (end - pos < minRun && end < n) {
+            int force = (minRun < n - pos) ? minRun : n - pos;
+            InsertionSortFast(values, pos, pos + force - 1);
+            end = pos + force;
+        }
+        runs[count++] = (TimRun){ pos, end - pos };
+        pos = end;
+
+        for (;;) {
+            if (count <= 1) break;
+            int k = count - 2;
+            if ((k > 0 && runs[k - 1].len <= runs[k].len + runs[k + 1].len) ||
+                (k > 1 && runs[k - 2].len <= runs[k - 1].len + runs[k].len)) {
+                if (runs[k - 1].len < runs[k + 1].len) k--;
+            } else if (runs[k].len > runs[k + 1].len) {
+                break;
+            }
+            MergeRunsFast(values, aux, runs[k].base, runs[k + 1].base, runs[k + 1].len);
+            runs[k].len += runs[k + 1].len;
+            for (int r = k + 1; r < count - 1; r++) runs[r] = runs[r + 1];
+            count--;
+        }
+    }
+
+    while (count > 1) {
+        int k = count - 2;
+        if (k > 0 && runs[k - 1].len < runs[k + 1].len) k--;
+        MergeRunsFast(values, aux, runs[k].base, runs[k + 1].base, runs[k + 1].len);
+        runs[k].len += runs[k + 1].len;
+        for (int r = k + 1; r < count - 1; r++) runs[r] = runs[r + 1];
+        count--;
+    }
+}
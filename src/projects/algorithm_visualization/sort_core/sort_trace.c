@@ -0,0 +1,262 @@
+// sort_trace.c
+#include "sort_trace.h"
+#include "sort_cache.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEYFRAME_OPS_PER_ELEMENT 32
+#define MIN_KEYFRAME_INTERVAL 4096
+#define INITIAL_TRACE_BYTES (64 * 1024)
+
+static size_t KeyframeBytes(const SortTrace *t, int count) {
+    return (size_t)count * (size_t)t->bufferCount * (size_t)t->n * sizeof(int);
+}
+
+void SortTraceBegin(SortTrace *t, int *buffers[], int bufferCount, int n, uint64_t keyframeInterval,
+                    size_t maxBytes) {
+    SortTraceFree(t);
+    t->n = n;
+    t->maxBytes = maxBytes;
+    t->bufferCount = bufferCount < TRACE_MAX_BUFFERS ? bufferCount : TRACE_MAX_BUFFERS;
+    for (int b = 0; b < t->bufferCount; b++) t->live[b] = buffers[b];
+
+    // A keyframe costs bufferCount * n ints; spacing them ~32n ops apart keeps them
+    // under a byte per op, a fraction of the ops themselves, while bounding a seek to
+    // 32n decoded ops
+    if (keyframeInterval == 0) keyframeInterval = (uint64_t)n * KEYFRAME_OPS_PER_ELEMENT;
+    if (keyframeInterval < MIN_KEYFRAME_INTERVAL) keyframeInterval = MIN_KEYFRAME_INTERVAL;
+    t->keyframeInterval = keyframeInterval;
+
+    t->bytes = malloc(INITIAL_TRACE_BYTES);
+    if (!t->bytes || (maxBytes && INITIAL_TRACE_BYTES + KeyframeBytes(t, 1) > maxBytes)) {
+        t->failed = true;
+        return;
+    }
+    t->capacity = INITIAL_TRACE_BYTES;
+    SortTraceKeyframe(t);
+}
+
+void SortTraceFree(SortTrace *t) {
+    for (int k = 0; k < t->keyframeCount; k++) free(t->keyframes[k].snapshot);
+    free(t->keyframes);
+    free(t->bytes);
+    *t = (SortTrace){0};
+}
+
+size_t SortTraceBytes(const SortTrace *t) {
+    return t->size + KeyframeBytes(t, t->keyframeCount);
+}
+
+// On a failure the old allocations stay valid, so SortTraceFree still releases them
+bool SortTraceKeyframe(SortTrace *t) {
+    if (t->failed) return false;
+    if (t->maxBytes && t->capacity + KeyframeBytes(t, t->keyframeCount + 1) > t->maxBytes) {
+        t->failed = true;
+        return false;
+    }
+    if (t->keyframeCount == t->keyframeCapacity) {
+        int capacity = t->keyframeCapacity ? t->keyframeCapacity * 2 : 8;
+        TraceKeyframe *keyframes = realloc(t->keyframes, (size_t)capacity * sizeof(TraceKeyframe));
+        if (!keyframes) {
+            t->failed = true;
+            return false;
+        }
+        t->keyframes = keyframes;
+        t->keyframeCapacity = capacity;
+    }
+    int *snapshot = malloc((size_t)t->bufferCount * (size_t)t->n * sizeof(int));
+    if (!snapshot) {
+        t->failed = true;
+        return false;
+    }
+    TraceKeyframe *k = &t->keyframes[t->keyframeCount++];
+    k->op = t->opCount;
+    k->offset = t->size;
+    k->cursor = t->enc;
+    k->snapshot = snapshot;
+    for (int b = 0; b < t->bufferCount; b++)
+        memcpy(k->snapshot + (size_t)b * t->n, t->live[b], (size_t)t->n * sizeof(int));
+    t->nextKeyframe = t->opCount + t->keyframeInterval;
+    return true;
+}
+
+bool SortTraceGrow(SortTrace *t, size_t extra) {
+    if (t->failed) return false;
+    size_t capacity = t->capacity ? t->capacity : INITIAL_TRACE_BYTES;
+    while (t->size + extra > capacity) capacity *= 2;
+    // Doubling stops at what the keyframes leave of maxBytes
+    if (t->maxBytes) {
+        size_t room = t->maxBytes - KeyframeBytes(t, t->keyframeCount);
+        if (capacity > room) capacity = room;
+    }
+    uint8_t *bytes = t->size + extra <= capacity ? realloc(t->bytes, capacity) : NULL;
+    if (!bytes) {
+        t->failed = true;
+        return false;
+    }
+    t->bytes = bytes;
+    t->capacity = capacity;
+    return true;
+}
+
+//------------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------------
+static inline uint32_t GetVarint(const uint8_t *bytes, size_t *offset) {
+    uint32_t v = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+        byte = bytes[(*offset)++];
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return v;
+}
+
+static inline int GetZigzag(const uint8_t *bytes, size_t *offset) {
+    uint32_t v = GetVarint(bytes, offset);
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+// Decodes and applies one op; mirrors the Trace* recorders exactly
+static inline void ApplyOp(TracePlayer *p) {
+    const uint8_t *bytes = p->trace->bytes;
+    TraceCursor *c = &p->cur;
+    TraceOp *op = &p->last;
+    uint8_t head = bytes[p->offset++];
+    int payload = head & 0x1F;
+
+    switch (head >> 5) {
+    case TOP_CMP_SHORT:
+        c->cmpA += (payload >> 3) - 2;
+        c->cmpB += (payload & 7) - 4;
+        *op = (TraceOp){ TRACE_COMPARE, c->cmpBufA, c->cmpBufB, c->cmpA, c->cmpB, 0 };
+        break;
+    case TOP_CMP:
+        c->cmpBufA = payload & 1;
+        c->cmpBufB = (payload >> 1) & 1;
+        c->cmpA += GetZigzag(bytes, &p->offset);
+        c->cmpB += GetZigzag(bytes, &p->offset);
+        *op = (TraceOp){ TRACE_COMPARE, c->cmpBufA, c->cmpBufB, c->cmpA, c->cmpB, 0 };
+        break;
+    case TOP_SWAP:
+        c->cmpBufA = c->cmpBufB = payload & 1;
+        c->cmpA += GetZigzag(bytes, &p->offset);
+        c->cmpB += GetZigzag(bytes, &p->offset);
+        // fallthrough
+    swap: {
+        int *buf = p->buffers[c->cmpBufA];
+        int tmp = buf[c->cmpA];
+        buf[c->cmpA] = buf[c->cmpB];
+        buf[c->cmpB] = tmp;
+        *op = (TraceOp){ TRACE_SWAP, c->cmpBufA, c->cmpBufA, c->cmpA, c->cmpB, 0 };
+    } break;
+    case TOP_MOVE_SHORT: {
+        int fromB = payload >> 4;
+        c->moveDst += (payload & 0xF) - 8;
+        c->moveSrc = fromB ? c->cmpB : c->cmpA;
+        c->moveSrcBuf = fromB ? c->cmpBufB : c->cmpBufA;
+        goto move;
+    }
+    case TOP_MOVE:
+        c->moveDstBuf = payload & 1;
+        c->moveSrcBuf = (payload >> 1) & 1;
+        c->moveDst += GetZigzag(bytes, &p->offset);
+        c->moveSrc += GetZigzag(bytes, &p->offset);
+        // fallthrough
+    move:
+        p->buffers[c->moveDstBuf][c->moveDst] = p->buffers[c->moveSrcBuf][c->moveSrc];
+        *op = (TraceOp){ TRACE_MOVE, c->moveDstBuf, c->moveSrcBuf, c->moveDst, c->moveSrc, 0 };
+        break;
+    case TOP_WRITE: {
+        c->moveDstBuf = payload & 1;
+        c->moveDst += GetZigzag(bytes, &p->offset);
+        int value = GetZigzag(bytes, &p->offset);
+        p->buffers[c->moveDstBuf][c->moveDst] = value;
+        *op = (TraceOp){ TRACE_WRITE, c->moveDstBuf, c->moveDstBuf, c->moveDst, c->moveDst, value };
+    } break;
+    case TOP_COPY: {
+        int dstBuf = payload & 1, srcBuf = (payload >> 1) & 1;
+        int start = c->moveDst + GetZigzag(bytes, &p->offset);
+        int len = (int)GetVarint(bytes, &p->offset);
+        memmove(p->buffers[dstBuf] + start, p->buffers[srcBuf] + start, (size_t)len * sizeof(int));
+        *op = (TraceOp){ TRACE_COPY_RANGE, dstBuf, srcBuf, start, start + len - 1, len };
+    } break;
+    case TOP_EXT:
+    default:
+        if (payload == TEXT_SWAP_LAST) goto swap;
+        if (payload == TEXT_MOVE_NEXT) {
+            c->moveDst++;
+            c->moveSrc++;
+            goto move;
+        }
+        c->rangeLo += GetZigzag(bytes, &p->offset);
+        c->rangeHi = c->rangeLo + (int)GetVarint(bytes, &p->offset);
+        *op = (TraceOp){ TRACE_RANGE, 0, 0, c->rangeLo, c->rangeHi, 0 };
+        break;
+    }
+    p->op++;
+}
+
+void TracePlayerInit(TracePlayer *p, const SortTrace *trace, int *buffers[]) {
+    *p = (TracePlayer){ .trace = trace, .op = UINT64_MAX,     // forces the first seek to restore
+                        .touchedLo = INT_MAX, .touchedHi = INT_MIN };
+    for (int b = 0; b < trace->bufferCount; b++) p->buffers[b] = buffers[b];
+    TracePlayerSeek(p, 0);
+}
+
+static inline void Touch(TracePlayer *p, int lo, int hi) {
+    if (lo < p->touchedLo) p->touchedLo = lo;
+    if (hi > p->touchedHi) p->touchedHi = hi;
+}
+
+void TracePlayerSeek(TracePlayer *p, uint64_t op) {
+    const SortTrace *t = p->trace;
+    if (op > t->opCount) op = t->opCount;
+    Touch(p, 0, t->n - 1);
+
+    // Rewind to the nearest keyframe at or before op unless playing forward is cheaper
+    uint64_t k = op / t->keyframeInterval;
+    if (k >= (uint64_t)t->keyframeCount) k = (uint64_t)t->keyframeCount - 1;
+    const TraceKeyframe *kf = &t->keyframes[k];
+    if (op < p->op || kf->op > p->op) {
+        for (int b = 0; b < t->bufferCount; b++)
+            memcpy(p->buffers[b], kf->snapshot + (size_t)b * t->n, (size_t)t->n * sizeof(int));
+        p->offset = kf->offset;
+        p->op = kf->op;
+        p->cur = kf->cursor;
+        p->last = (TraceOp){ TRACE_RANGE, 0, 0, p->cur.rangeLo, p->cur.rangeHi, 0 };
+    }
+    while (p->op < op) ApplyOp(p);
+    if (p->cache) SortCacheReset(p->cache);
+}
+
+int64_t TracePlayerRun(TracePlayer *p, int64_t maxOps) {
+    int64_t done = 0;
+    uint64_t total = p->trace->opCount;
+    while (done < maxOps && p->op < total) {
+        ApplyOp(p);
+        done++;
+        const TraceOp *op = &p->last;
+        if (p->cache) SortCacheApply(p->cache, op);
+        if (op->bufA != 0 || op->type == TRACE_COMPARE || op->type == TRACE_RANGE) continue;
+        if (op->type == TRACE_MOVE) Touch(p, op->a, op->a);      // b is the source
+        else if (op->a < op->b) Touch(p, op->a, op->b);
+        else Touch(p, op->b, op->a);
+    }
+    return done;
+}
+
+bool TracePlayerTakeTouched(TracePlayer *p, int *lo, int *hi) {
+    *lo = p->touchedLo;
+    *hi = p->touchedHi;
+    p->touchedLo = INT_MAX;
+    p->touchedHi = INT_MIN;
+    return *lo <= *hi;
+}
+
+bool TracePlayerDone(const TracePlayer *p) {
+    return p->op >= p->trace->opCount;
+}
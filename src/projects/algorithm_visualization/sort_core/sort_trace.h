@@ -0,0 +1,233 @@
+// sort_trace.h
+// Compact binary trace of the operations a sort performs, so it can run once at full
+// speed and be replayed (and scrubbed) by the renderer afterwards.
+//
+// Every op starts with one byte: 3 bits of opcode and 5 bits of payload. Indices are
+// stored as zigzag varint deltas against the previous op of the same kind, and the
+// common patterns (neighbouring compares, "move the element just compared",
+// sequential copies, swapping the pair just compared) fit in that single byte.
+// Snapshots of the buffers are taken every keyframeInterval ops so a seek never
+// decodes more than one interval.
+//
+// When an allocation fails or the trace would outgrow maxBytes it is marked failed and
+// records nothing more; the caller checks failed after the sort and must not replay it.
+#ifndef SORT_TRACE_H
+#define SORT_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_MAX_BUFFERS 2
+#define TRACE_MAX_OP_BYTES 16
+
+typedef enum {
+    TRACE_COMPARE,         // a, b (bufA, bufB)
+    TRACE_SWAP,            // a, b in bufA
+    TRACE_MOVE,            // bufA[a] = bufB[b]
+    TRACE_WRITE,           // bufA[a] = value
+    TRACE_COPY_RANGE,      // bufA[a .. a+value) = bufB[a .. a+value)
+    TRACE_RANGE            // marker: algorithm now works on [a, b]
+} TraceOpType;
+
+typedef struct TraceOp {
+    TraceOpType type;
+    int bufA, bufB;
+    int a, b;
+    int value;
+} TraceOp;
+
+// Encoder/decoder state; both sides update it identically
+typedef struct TraceCursor {
+    int cmpA, cmpB;
+    uint8_t cmpBufA, cmpBufB;
+    int moveDst, moveSrc;
+    uint8_t moveDstBuf, moveSrcBuf;
+    int rangeLo, rangeHi;
+} TraceCursor;
+
+typedef struct TraceKeyframe {
+    uint64_t op;           // state before this op
+    size_t offset;
+    TraceCursor cursor;
+    int *snapshot;         // bufferCount * n ints
+} TraceKeyframe;
+
+typedef struct SortTrace {
+    uint8_t *bytes;
+    size_t size, capacity;
+    uint64_t opCount;
+    TraceCursor enc;
+
+    int n;
+    int bufferCount;
+    int *live[TRACE_MAX_BUFFERS];     // buffers being sorted while recording
+
+    uint64_t keyframeInterval;
+    uint64_t nextKeyframe;
+    TraceKeyframe *keyframes;
+    int keyframeCount, keyframeCapacity;
+    size_t maxBytes;       // ops (allocated) plus keyframes; 0 for no limit
+    bool failed;           // out of memory or maxBytes: recording stopped, the trace is incomplete
+} SortTrace;
+
+// keyframeInterval 0 picks a default proportional to n; maxBytes 0 records without a limit
+void SortTraceBegin(SortTrace *t, int *buffers[], int bufferCount, int n, uint64_t keyframeInterval,
+                    size_t maxBytes);
+void SortTraceFree(SortTrace *t);
+size_t SortTraceBytes(const SortTrace *t);          // ops + keyframes
+
+// Slow paths of TraceBeginOp; false once the trace has failed
+bool SortTraceKeyframe(SortTrace *t);
+bool SortTraceGrow(SortTrace *t, size_t extra);
+
+//------------------------------------------------------------------------------------
+// Recording (inline: called once per algorithm step)
+//------------------------------------------------------------------------------------
+enum {
+    TOP_CMP_SHORT,         // payload: (da+2)<<3 | (db+4)
+    TOP_MOVE_SHORT,        // payload: srcIsB<<4 | (ddst+8), src is the last compared element
+    TOP_CMP,               // payload: bufA | bufB<<1, zz(da), zz(db)
+    TOP_SWAP,              // payload: buf, zz(da), zz(db)
+    TOP_MOVE,              // payload: dstBuf | srcBuf<<1, zz(ddst), zz(dsrc)
+    TOP_WRITE,             // payload: buf, zz(ddst), zz(value)
+    TOP_COPY,              // payload: dstBuf | srcBuf<<1, zz(dstart), len
+    TOP_EXT                // payload: TEXT_*
+};
+
+enum {
+    TEXT_SWAP_LAST,        // swap the pair of the last compare
+    TEXT_MOVE_NEXT,        // move with dst+1, src+1, same buffers
+    TEXT_RANGE             // zz(dlo), hi - lo
+};
+
+static inline void TracePutVarint(SortTrace *t, uint32_t v) {
+    while (v >= 0x80) {
+        t->bytes[t->size++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    t->bytes[t->size++] = (uint8_t)v;
+}
+
+static inline void TracePutZigzag(SortTrace *t, int v) {
+    TracePutVarint(t, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+// False when the op cannot be recorded
+static inline bool TraceBeginOp(SortTrace *t) {
+    if (t->opCount == t->nextKeyframe && !SortTraceKeyframe(t)) return false;
+    if (t->size + TRACE_MAX_OP_BYTES > t->capacity && !SortTraceGrow(t, TRACE_MAX_OP_BYTES)) return false;
+    t->opCount++;
+    return true;
+}
+
+static inline void TraceCompare(SortTrace *t, int bufA, int a, int bufB, int b) {
+    TraceCursor *c = &t->enc;
+    if (!TraceBeginOp(t)) return;
+    int da = a - c->cmpA, db = b - c->cmpB;
+    if (bufA == c->cmpBufA && bufB == c->cmpBufB && da >= -2 && da <= 1 && db >= -4 && db <= 3) {
+        t->bytes[t->size++] = (uint8_t)((TOP_CMP_SHORT << 5) | ((da + 2) << 3) | (db + 4));
+    } else {
+        t->bytes[t->size++] = (uint8_t)((TOP_CMP << 5) | bufA | (bufB << 1));
+        TracePutZigzag(t, da);
+        TracePutZigzag(t, db);
+        c->cmpBufA = (uint8_t)bufA;
+        c->cmpBufB = (uint8_t)bufB;
+    }
+    c->cmpA = a;
+    c->cmpB = b;
+}
+
+static inline void TraceSwap(SortTrace *t, int buf, int a, int b) {
+    TraceCursor *c = &t->enc;
+    if (!TraceBeginOp(t)) return;
+    if (a == c->cmpA && b == c->cmpB && buf == c->cmpBufA && buf == c->cmpBufB) {
+        t->bytes[t->size++] = (uint8_t)((TOP_EXT << 5) | TEXT_SWAP_LAST);
+        return;
+    }
+    t->bytes[t->size++] = (uint8_t)((TOP_SWAP << 5) | buf);
+    TracePutZigzag(t, a - c->cmpA);
+    TracePutZigzag(t, b - c->cmpB);
+    c->cmpA = a;
+    c->cmpB = b;
+    c->cmpBufA = c->cmpBufB = (uint8_t)buf;
+}
+
+static inline void TraceMove(SortTrace *t, int dstBuf, int dst, int srcBuf, int src) {
+    TraceCursor *c = &t->enc;
+    if (!TraceBeginOp(t)) return;
+    int ddst = dst - c->moveDst;
+    if (dstBuf == c->moveDstBuf && srcBuf == c->moveSrcBuf && ddst == 1 && src == c->moveSrc + 1) {
+        t->bytes[t->size++] = (uint8_t)((TOP_EXT << 5) | TEXT_MOVE_NEXT);
+    } else if (dstBuf == c->moveDstBuf && ddst >= -8 && ddst <= 7 &&
+               ((src == c->cmpA && srcBuf == c->cmpBufA) || (src == c->cmpB && srcBuf == c->cmpBufB))) {
+        int fromB = !(src == c->cmpA && srcBuf == c->cmpBufA);
+        t->bytes[t->size++] = (uint8_t)((TOP_MOVE_SHORT << 5) | (fromB << 4) | (ddst + 8));
+        c->moveSrcBuf = (uint8_t)srcBuf;
+    } else {
+        t->bytes[t->size++] = (uint8_t)((TOP_MOVE << 5) | dstBuf | (srcBuf << 1));
+        TracePutZigzag(t, ddst);
+        TracePutZigzag(t, src - c->moveSrc);
+        c->moveDstBuf = (uint8_t)dstBuf;
+        c->moveSrcBuf = (uint8_t)srcBuf;
+    }
+    c->moveDst = dst;
+    c->moveSrc = src;
+}
+
+static inline void TraceWrite(SortTrace *t, int buf, int idx, int value) {
+    TraceCursor *c = &t->enc;
+    if (!TraceBeginOp(t)) return;
+    t->bytes[t->size++] = (uint8_t)((TOP_WRITE << 5) | buf);
+    TracePutZigzag(t, idx - c->moveDst);
+    TracePutZigzag(t, value);
+    c->moveDst = idx;
+    c->moveDstBuf = (uint8_t)buf;
+}
+
+static inline void TraceCopyRange(SortTrace *t, int dstBuf, int srcBuf, int start, int len) {
+    if (!TraceBeginOp(t)) return;
+    t->bytes[t->size++] = (uint8_t)((TOP_COPY << 5) | dstBuf | (srcBuf << 1));
+    TracePutZigzag(t, start - t->enc.moveDst);
+    TracePutVarint(t, (uint32_t)len);
+}
+
+static inline void TraceRange(SortTrace *t, int lo, int hi) {
+    TraceCursor *c = &t->enc;
+    if (!TraceBeginOp(t)) return;
+    t->bytes[t->size++] = (uint8_t)((TOP_EXT << 5) | TEXT_RANGE);
+    TracePutZigzag(t, lo - c->rangeLo);
+    TracePutVarint(t, (uint32_t)(hi - lo));
+    c->rangeLo = lo;
+    c->rangeHi = hi;
+}
+
+// Used by the engines: records only when a trace is attached
+#define SORT_TRACE(trace, call) do { if (trace) call; } while (0)
+
+//------------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------------
+struct SortCache;
+
+typedef struct TracePlayer {
+    const SortTrace *trace;
+    int *buffers[TRACE_MAX_BUFFERS];
+    size_t offset;
+    uint64_t op;                      // ops applied so far
+    TraceCursor cur;
+    TraceOp last;
+    int touchedLo, touchedHi;         // buffer 0 elements written since the last take; lo > hi for none
+    struct SortCache *cache;          // optional: every op run goes through it (sort_cache.h); a seek
+                                      // empties it, since the ops skipped are never simulated
+} TracePlayer;
+
+void TracePlayerInit(TracePlayer *p, const SortTrace *trace, int *buffers[]);
+void TracePlayerSeek(TracePlayer *p, uint64_t op);
+int64_t TracePlayerRun(TracePlayer *p, int64_t maxOps);     // returns ops applied
+bool TracePlayerDone(const TracePlayer *p);
+// Span of buffer 0 changed since the previous call (a seek counts as all of it); false
+// when nothing was written
+bool TracePlayerTakeTouched(TracePlayer *p, int *lo, int *hi);
+
+#endif // SORT_TRACE_H
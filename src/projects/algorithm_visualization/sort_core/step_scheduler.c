@@ -0,0 +1,121 @@
+// step_scheduler.c
+#include "step_scheduler.h"
+#include <stdio.h>
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/emscripten.h>
+#else
+#include <time.h>
+#endif
+
+#define DEFAULT_FRAME_BUDGET_MS 8.0
+#define DEFAULT_COMPLETE_BUDGET_MS 100.0
+#define CHUNK_TARGET_MS 0.25        // aim for a clock read every quarter millisecond
+#define MIN_CHUNK 16
+#define MAX_CHUNK (1 << 22)
+#define MAX_CATCHUP_SECONDS 0.25    // a stalled tab should not unleash seconds of backlog
+#define MIN_RATE 1.0
+#define MAX_RATE 1e8
+
+double SortClockMs(void) {
+#if defined(__EMSCRIPTEN__)
+    return emscripten_get_now();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+#endif
+}
+
+void StepSchedulerInit(StepScheduler *s, double stepsPerSecond) {
+    *s = (StepScheduler){
+        .mode = SCHED_RATE,
+        .stepsPerSecond = stepsPerSecond,
+        .frameBudgetMs = DEFAULT_FRAME_BUDGET_MS,
+        .completeBudgetMs = DEFAULT_COMPLETE_BUDGET_MS,
+        .chunk = MIN_CHUNK,
+    };
+}
+
+void StepSchedulerReset(StepScheduler *s) {
+    s->credit = 0;
+    s->finished = false;
+    s->lastSteps = 0;
+    s->lastMs = 0;
+}
+
+int64_t StepSchedulerRun(StepScheduler *s, double frameSeconds, StepFn fn, void *ctx) {
+    s->lastSteps = 0;
+    s->lastMs = 0;
+    if (s->finished) return 0;
+
+    double budgetMs = (s->mode == SCHED_COMPLETE) ? s->completeBudgetMs : s->frameBudgetMs;
+    int64_t allowed = INT64_MAX;
+    if (s->mode == SCHED_RATE) {
+        if (frameSeconds > MAX_CATCHUP_SECONDS) frameSeconds = MAX_CATCHUP_SECONDS;
+        s->credit += s->stepsPerSecond * frameSeconds;
+        allowed = (int64_t)s->credit;
+        if (allowed <= 0) return 0;
+    }
+
+    double start = SortClockMs();
+    double now = start;
+    int64_t done = 0;
+    while (done < allowed) {
+        int64_t want = allowed - done;
+        if (want > s->chunk) want = s->chunk;
+
+        int64_t ran = fn(ctx, want);
+        done += ran;
+        if (ran < want) {
+            s->finished = true;
+            break;
+        }
+
+        now = SortClockMs();
+        double chunkMs = now - start;
+        if (chunkMs >= budgetMs) break;
+
+        // Grow the chunk while clock reads are a noticeable share of the work
+        double perStepMs = chunkMs / (double)done;
+        if (perStepMs * (double)s->chunk < CHUNK_TARGET_MS && s->chunk < MAX_CHUNK) s->chunk *= 2;
+        else if (perStepMs * (double)s->chunk > 4 * CHUNK_TARGET_MS && s->chunk > MIN_CHUNK) s->chunk /= 2;
+    }
+
+    if (s->mode == SCHED_RATE) {
+        // Steps the budget could not fit are dropped rather than queued
+        s->credit -= (double)done;
+        if (s->credit > 1.0) s->credit = 1.0;
+    }
+    s->lastSteps = done;
+    s->lastMs = SortClockMs() - start;
+    return done;
+}
+
+void StepSchedulerFaster(StepScheduler *s) {
+    if (s->mode == SCHED_RATE) {
+        if (s->stepsPerSecond * 2 <= MAX_RATE) s->stepsPerSecond *= 2;
+        else s->mode = SCHED_MAX;
+    } else if (s->mode == SCHED_MAX) {
+        s->mode = SCHED_COMPLETE;
+    }
+}
+
+void StepSchedulerSlower(StepScheduler *s) {
+    if (s->mode == SCHED_COMPLETE) {
+        s->mode = SCHED_MAX;
+    } else if (s->mode == SCHED_MAX) {
+        s->mode = SCHED_RATE;
+    } else if (s->stepsPerSecond / 2 >= MIN_RATE) {
+        s->stepsPerSecond /= 2;
+    }
+}
+
+const char *StepSchedulerDescribe(const StepScheduler *s, char *buf, int size) {
+    switch (s->mode) {
+    case SCHED_MAX: snprintf(buf, size, "max"); break;
+    case SCHED_COMPLETE: snprintf(buf, size, "to completion"); break;
+    default: snprintf(buf, size, "%.0f steps/s", s->stepsPerSecond); break;
+    }
+    return buf;
+}
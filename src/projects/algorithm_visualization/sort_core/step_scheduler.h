@@ -0,0 +1,46 @@
+// step_scheduler.h
+// Decides how many algorithm steps run in a frame. Steps are paced by a target rate
+// (steps/second, independent of FPS) and capped by a per-frame time budget measured
+// with a high-resolution clock, so a slow step function can never stall the page.
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs up to maxSteps steps and returns how many ran; fewer than maxSteps means finished
+typedef int64_t (*StepFn)(void *ctx, int64_t maxSteps);
+
+typedef enum {
+    SCHED_RATE,          // stepsPerSecond, within the frame budget
+    SCHED_MAX,           // as many steps as fit in the frame budget
+    SCHED_COMPLETE       // run to completion, redrawing every completeBudgetMs
+} SchedulerMode;
+
+typedef struct StepScheduler {
+    SchedulerMode mode;
+    double stepsPerSecond;
+    double frameBudgetMs;      // SCHED_RATE / SCHED_MAX
+    double completeBudgetMs;   // SCHED_COMPLETE
+    double credit;             // fractional steps owed from previous frames
+    int64_t chunk;             // steps between clock reads, adapted to step cost
+    bool finished;
+
+    // Last frame, for the status line
+    int64_t lastSteps;
+    double lastMs;
+} StepScheduler;
+
+void StepSchedulerInit(StepScheduler *s, double stepsPerSecond);
+void StepSchedulerReset(StepScheduler *s);     // clears credit/finished, keeps mode and rate
+// frameSeconds is the wall time since the previous call (used for rate pacing)
+int64_t StepSchedulerRun(StepScheduler *s, double frameSeconds, StepFn fn, void *ctx);
+
+// Speed ladder used by the [ ] keys: rate halves/doubles, then MAX, then COMPLETE
+void StepSchedulerFaster(StepScheduler *s);
+void StepSchedulerSlower(StepScheduler *s);
+const char *StepSchedulerDescribe(const StepScheduler *s, char *buf, int size);
+
+double SortClockMs(void);
+
+#endif // STEP_SCHEDULER_H
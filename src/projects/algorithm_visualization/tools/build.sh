@@ -0,0 +1,13 @@
+gcc -O2 -Wall -msse4.1 -pthread -o sort_bench sort_bench.c \
+../sort_core/sort_bubble.c ../sort_core/sort_exchange.c ../sort_core/sort_merge.c ../sort_core/sort_quick.c ../sort_core/sort_heap.c \
+../sort_core/sort_radix.c ../sort_core/sort_intro.c ../sort_core/sort_tim.c ../sort_core/sort_insertion.c \
+../sort_core/sort_engine.c ../sort_core/sort_simd.c ../sort_core/sort_parallel.c ../sort_core/step_scheduler.c \
+../sort_core/sort_data.c ../sort_core/sort_session.c ../sort_core/sort_trace.c ../sort_core/sort_cache.c \
+-I../sort_core
+
+gcc -O2 -Wall -msse4.1 -o ext_sort ext_sort.c \
+../sort_core/sort_external.c ../sort_core/sort_bubble.c ../sort_core/sort_exchange.c ../sort_core/sort_merge.c ../sort_core/sort_quick.c \
+../sort_core/sort_heap.c ../sort_core/sort_radix.c ../sort_core/sort_intro.c ../sort_core/sort_tim.c \
+../sort_core/sort_insertion.c ../sort_core/sort_engine.c ../sort_core/sort_simd.c ../sort_core/step_scheduler.c \
+../sort_core/sort_data.c ../sort_core/sort_session.c ../sort_core/sort_trace.c ../sort_core/sort_cache.c \
+-I../sort_core
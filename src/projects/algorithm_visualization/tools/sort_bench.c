@@ -0,0 +1,410 @@
+// sort_bench.c
+// Native benchmark for the sort engines. Runs each algorithm to completion over a
+// matrix of sizes and input distributions and prints throughput and op counts.
+//
+//   ./sort_bench [--algo bubble,merge,quick,heap,radix,intro,tim,cocktail,comb,odd-even]
+//                [--mode step,fast] [--sizes 1000,10000,...] [--dist random,nearly-sorted,...]
+//                [--seed N] [--bubble-max N] [--threads 1,2,4,8] [--csv] [--trace]
+//                [--cache tiny,small,desktop]
+//
+// --mode step drives the resumable step machine the visualizers use, --mode fast the
+// engine's plain-loop path; "x merge-step" compares each run against DoMergeStep on
+// the same input. --trace additionally records each step run as an operation trace and
+// reports its size, the recording time and the average cost of a random seek.
+// --cache (implies --trace) replays each trace from the start through the memory-hierarchy
+// model of every preset listed and reports the L1, L2 and TLB miss rates, and the element
+// accesses simulated per second against a plain replay of the same trace.
+// --bubble-max caps n for the O(n^2) engines (bubble, cocktail, odd-even); compare their
+// op counts on random against nearly-sorted input to see the adaptive passes at work.
+// --threads adds a "merge-par" row per thread count for the parallel merge sort and,
+// up to --bubble-max, an "odd-even-par" row for the threaded odd-even transposition; the
+// "x merge" column of those rows is the speedup over the same sort's single-threaded
+// SIMD fast path.
+#include "sort_engine.h"
+#include "sort_cache.h"
+#include "sort_session.h"
+#include "sort_parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define MAX_LIST 16
+#define MAX_VALUE 1000000
+
+#define MAX_ENGINES 16
+
+typedef enum { MODE_STEP, MODE_FAST, MODE_COUNT } BenchMode;
+
+static const char *modeNames[MODE_COUNT] = { "step", "fast" };
+
+typedef struct BenchResult {
+    double seconds;
+    SortStats stats;
+    size_t bytes;          // arena capacity backing the run
+    bool ok;
+} BenchResult;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static long PeakRssKb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// The session arena is shared by all runs, as in the visualizers
+static SortSession session;
+
+static BenchResult RunOne(const SortEngine *engine, BenchMode mode, const int *input, int n) {
+    BenchResult r = {0};
+    if (!SortSessionResize(&session, n) || session.n != n) return r;
+    int *values = session.values;
+    int *aux = session.aux;
+    memcpy(values, input, (size_t)n * sizeof(int));
+    r.bytes = session.arena.capacity;
+
+    double t0 = NowSeconds();
+    if (mode == MODE_FAST) {
+        engine->sortFast(values, aux, n);
+    } else {
+        SortMachine m;
+        SortMachineInit(&m, engine, values, aux, n);
+        SortMachineRun(&m, INT64_MAX);
+        r.stats = *SortMachineStats(&m);
+    }
+    r.seconds = NowSeconds() - t0;
+    r.ok = IsSorted(values, n);
+    return r;
+}
+
+typedef enum { PAR_MERGE, PAR_ODD_EVEN } ParallelAlgo;
+
+static BenchResult RunParallel(ParallelAlgo algo, const int *input, int n, int threads, int *started) {
+    BenchResult r = {0};
+    if (!SortSessionResize(&session, n) || session.n != n) return r;
+    memcpy(session.values, input, (size_t)n * sizeof(int));
+    r.bytes = session.arena.capacity;
+
+    double t0 = NowSeconds();
+    if (algo == PAR_MERGE) {
+        ParallelSort p = {0};
+        *started = ParallelSortStart(&p, session.values, session.aux, n, threads);
+        ParallelSortWait(&p);
+    } else {
+        *started = OddEvenSortParallel(session.values, n, threads);
+    }
+    r.seconds = NowSeconds() - t0;
+    r.ok = IsSorted(session.values, n);
+    return r;
+}
+
+// One row per thread count, against the single-threaded fast path of the same sort
+static int BenchParallel(ParallelAlgo algo, const char *name, const char *singleName, const int *input, int n,
+                         SortDistribution d, const int *threadCounts, int threadCountCount, bool csv) {
+    int failures = 0;
+    BenchResult single = RunOne(SortEngineFind(singleName), MODE_FAST, input, n);
+    for (int k = 0; k < threadCountCount; k++) {
+        int started = 0;
+        BenchResult r = RunParallel(algo, input, n, threadCounts[k], &started);
+        if (!r.ok) {
+            fprintf(stderr, "%s/t%d/%s/%d: output not sorted\n", name, threadCounts[k], SortDistributionName(d), n);
+            failures++;
+        }
+        char mode[8];
+        snprintf(mode, sizeof(mode), "t%d", started);
+        double nsPerElem = r.seconds * 1e9 / n;
+        double speedup = r.seconds > 0 ? single.seconds / r.seconds : 0;
+        if (csv)
+            printf("%s,%s,%s,%d,%.6f,%.3f,%.2f,0,0,0,%zu,%ld\n", name, mode, SortDistributionName(d), n, r.seconds,
+                   nsPerElem, speedup, r.bytes, PeakRssKb());
+        else
+            printf("%-12s %-5s %-13s %10d %10.2f %8.2f %14s %14s %14s %10zu %12ld\n", name, mode,
+                   SortDistributionName(d), n, nsPerElem, speedup, "-", "-", "-", r.bytes / 1024, PeakRssKb());
+        fflush(stdout);
+    }
+    return failures;
+}
+
+typedef struct CacheResult {
+    double seconds;            // replay with the model attached
+    uint64_t accesses;
+    double l1Miss, l2Miss, tlbMiss;    // L2 misses per L2 access, i.e. per L1 miss
+    bool ok;
+} CacheResult;
+
+typedef struct TraceResult {
+    double recordSeconds;
+    double seekMs;             // average over TRACE_SEEKS random seeks
+    double replaySeconds;      // start to end, nothing attached
+    uint64_t ops;
+    size_t opBytes;
+    size_t keyframeBytes;
+    bool ok;
+    bool outOfMemory;          // the trace could not be recorded
+    CacheResult caches[MAX_LIST];
+} TraceResult;
+
+#define TRACE_SEEKS 16
+
+static CacheResult ReplayCached(TracePlayer *player, const SortCacheConfig *config, int *buffers[], int n) {
+    CacheResult r = {0};
+    SortCache cache = {0};
+    if (!SortCacheBegin(&cache, config, buffers, player->trace->bufferCount, n)) return r;
+    player->cache = &cache;
+    TracePlayerSeek(player, 0);
+    double t0 = NowSeconds();
+    TracePlayerRun(player, INT64_MAX);
+    r.seconds = NowSeconds() - t0;
+    player->cache = NULL;
+    r.accesses = cache.l1.accesses;
+    r.l1Miss = SortCacheMissRate(&cache.l1);
+    r.l2Miss = SortCacheMissRate(&cache.l2);
+    r.tlbMiss = SortCacheMissRate(&cache.tlb);
+    r.ok = IsSorted(buffers[0], n);
+    SortCacheFree(&cache);
+    return r;
+}
+
+static TraceResult RunTraced(const SortEngine *engine, const int *input, int n, uint64_t seed,
+                             const SortCacheConfig *const caches[], int cacheCount) {
+    TraceResult r = {0};
+    if (!SortSessionResize(&session, n) || session.n != n) return r;
+    memcpy(session.values, input, (size_t)n * sizeof(int));
+
+    SortTrace trace = {0};
+    int *buffers[2] = { session.values, session.aux };
+
+    double t0 = NowSeconds();
+    SortTraceBegin(&trace, buffers, engine->bufferCount, n, 0, 0);
+    SortMachine m;
+    SortMachineInit(&m, engine, session.values, session.aux, n);
+    SortMachineAttachTrace(&m, &trace);
+    SortMachineRun(&m, INT64_MAX);
+    r.recordSeconds = NowSeconds() - t0;
+    if (trace.failed) {
+        SortTraceFree(&trace);
+        r.outOfMemory = true;
+        return r;
+    }
+    r.ops = trace.opCount;
+    r.opBytes = trace.size;
+    r.keyframeBytes = SortTraceBytes(&trace) - trace.size;
+
+    // Replay into the same buffers: random seeks, then play to the end
+    TracePlayer player;
+    TracePlayerInit(&player, &trace, buffers);
+    uint64_t rng = seed | 1;
+    t0 = NowSeconds();
+    for (int k = 0; k < TRACE_SEEKS; k++) {
+        rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        TracePlayerSeek(&player, (rng >> 11) % (trace.opCount + 1));
+    }
+    r.seekMs = (NowSeconds() - t0) * 1000.0 / TRACE_SEEKS;
+    TracePlayerRun(&player, INT64_MAX);
+    r.ok = IsSorted(session.values, n);
+
+    if (cacheCount > 0) {
+        TracePlayerSeek(&player, 0);
+        t0 = NowSeconds();
+        TracePlayerRun(&player, INT64_MAX);
+        r.replaySeconds = NowSeconds() - t0;
+    }
+    for (int k = 0; k < cacheCount; k++) r.caches[k] = ReplayCached(&player, caches[k], buffers, n);
+
+    SortTraceFree(&trace);
+    return r;
+}
+
+// Parses "a,b,c" into items; returns count
+static int SplitList(char *arg, char **items) {
+    int count = 0;
+    for (char *tok = strtok(arg, ","); tok && count < MAX_LIST; tok = strtok(NULL, ","))
+        items[count++] = tok;
+    return count;
+}
+
+static void Usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--algo bubble,merge,quick,heap,radix,intro,tim,cocktail,comb,odd-even]\n"
+            "          [--mode step,fast] [--sizes 1000,...]\n"
+            "          [--dist random,sorted,reversed,few-unique,nearly-sorted]\n"
+            "          [--seed N] [--bubble-max N] [--threads 1,2,...] [--csv] [--trace]\n"
+            "          [--cache tiny,small,desktop]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    bool algos[MAX_ENGINES];
+    for (int g = 0; g < sortEngineCount; g++) algos[g] = true;
+    bool modes[MODE_COUNT] = { true, true };
+    int sizes[MAX_LIST] = { 1000, 10000, 100000, 1000000, 10000000 };
+    int sizeCount = 5;
+    bool dists[DIST_COUNT] = { true, true, true, true, true };
+    uint64_t seed = 12345;
+    int bubbleMax = 20000;     // the O(n^2) engines; larger sizes take minutes
+    bool csv = false;
+    int threadCounts[MAX_LIST];
+    int threadCountCount = 0;
+    bool traces = false;
+    const SortCacheConfig *caches[MAX_LIST];
+    int cacheCount = 0;
+
+    for (int a = 1; a < argc; a++) {
+        char *items[MAX_LIST];
+        if (strcmp(argv[a], "--algo") == 0 && a + 1 < argc) {
+            int count = SplitList(argv[++a], items);
+            memset(algos, 0, sizeof(algos));
+            for (int k = 0; k < count; k++) {
+                const SortEngine *engine = SortEngineFind(items[k]);
+                if (!engine) { fprintf(stderr, "unknown algorithm '%s'\n", items[k]); return 1; }
+                algos[engine - sortEngines] = true;
+            }
+        } else if (strcmp(argv[a], "--mode") == 0 && a + 1 < argc) {
+            int count = SplitList(argv[++a], items);
+            memset(modes, 0, sizeof(modes));
+            for (int k = 0; k < count; k++) {
+                int found = 0;
+                for (int md = 0; md < MODE_COUNT; md++)
+                    if (strcmp(items[k], modeNames[md]) == 0) { modes[md] = true; found = 1; }
+                if (!found) { fprintf(stderr, "unknown mode '%s'\n", items[k]); return 1; }
+            }
+        } else if (strcmp(argv[a], "--sizes") == 0 && a + 1 < argc) {
+            sizeCount = SplitList(argv[++a], items);
+            for (int k = 0; k < sizeCount; k++) sizes[k] = (int)strtod(items[k], NULL);
+        } else if (strcmp(argv[a], "--dist") == 0 && a + 1 < argc) {
+            int count = SplitList(argv[++a], items);
+            memset(dists, 0, sizeof(dists));
+            for (int k = 0; k < count; k++) {
+                SortDistribution d;
+                if (!SortDistributionFromName(items[k], &d)) { fprintf(stderr, "unknown distribution '%s'\n", items[k]); return 1; }
+                dists[d] = true;
+            }
+        } else if (strcmp(argv[a], "--seed") == 0 && a + 1 < argc) {
+            seed = strtoull(argv[++a], NULL, 10);
+        } else if (strcmp(argv[a], "--bubble-max") == 0 && a + 1 < argc) {
+            bubbleMax = (int)strtod(argv[++a], NULL);
+        } else if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) {
+            threadCountCount = SplitList(argv[++a], items);
+            for (int k = 0; k < threadCountCount; k++) threadCounts[k] = atoi(items[k]);
+        } else if (strcmp(argv[a], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[a], "--trace") == 0) {
+            traces = true;
+        } else if (strcmp(argv[a], "--cache") == 0 && a + 1 < argc) {
+            int count = SplitList(argv[++a], items);
+            for (int k = 0; k < count; k++) {
+                int found = -1;
+                for (int c = 0; c < sortCachePresetCount; c++)
+                    if (strcmp(items[k], sortCachePresets[c].name) == 0) found = c;
+                if (found < 0) { fprintf(stderr, "unknown cache preset '%s'\n", items[k]); return 1; }
+                caches[cacheCount++] = &sortCachePresets[found];
+            }
+            traces = true;
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv)
+        printf("algo,mode,dist,n,seconds,ns_per_elem,vs_merge_step,comparisons,swaps,writes,arena_bytes,peak_rss_kb\n");
+    else
+        printf("%-12s %-5s %-13s %10s %10s %8s %14s %14s %14s %10s %12s\n", "algo", "mode", "dist", "n", "ns/elem",
+               "x merge", "comparisons", "swaps", "writes", "arena KB", "peak RSS KB");
+
+    const SortEngine *mergeEngine = SortEngineFind("merge");
+    int failures = 0;
+    for (int s = 0; s < sizeCount; s++) {
+        int n = sizes[s];
+        if (n <= 0) continue;
+        int *input = malloc((size_t)n * sizeof(int));
+
+        for (int d = 0; d < DIST_COUNT; d++) {
+            if (!dists[d]) continue;
+            GenerateValues(input, n, (SortDistribution)d, 0, MAX_VALUE, seed);
+
+            // Baseline for the "x merge" column: the element-at-a-time DoMergeStep machine
+            BenchResult baseline = RunOne(mergeEngine, MODE_STEP, input, n);
+
+            for (int g = 0; g < sortEngineCount; g++) {
+                const SortEngine *engine = &sortEngines[g];
+                if (!algos[g]) continue;
+                if (engine->quadratic && n > bubbleMax) continue;     // minutes beyond it
+
+                for (int md = 0; md < MODE_COUNT; md++) {
+                    if (!modes[md]) continue;
+                    BenchResult r = (engine == mergeEngine && md == MODE_STEP)
+                                        ? baseline : RunOne(engine, (BenchMode)md, input, n);
+                    if (!r.ok) {
+                        fprintf(stderr, "%s/%s/%s/%d: output not sorted\n", engine->name, modeNames[md],
+                                SortDistributionName(d), n);
+                        failures++;
+                    }
+                    double nsPerElem = r.seconds * 1e9 / n;
+                    double speedup = r.seconds > 0 ? baseline.seconds / r.seconds : 0;
+                    if (csv)
+                        printf("%s,%s,%s,%d,%.6f,%.3f,%.2f,%llu,%llu,%llu,%zu,%ld\n", engine->name, modeNames[md],
+                               SortDistributionName(d), n, r.seconds, nsPerElem, speedup,
+                               (unsigned long long)r.stats.comparisons, (unsigned long long)r.stats.swaps,
+                               (unsigned long long)r.stats.writes, r.bytes, PeakRssKb());
+                    else
+                        printf("%-12s %-5s %-13s %10d %10.2f %8.2f %14llu %14llu %14llu %10zu %12ld\n", engine->name,
+                               modeNames[md], SortDistributionName(d), n, nsPerElem, speedup,
+                               (unsigned long long)r.stats.comparisons, (unsigned long long)r.stats.swaps,
+                               (unsigned long long)r.stats.writes, r.bytes / 1024, PeakRssKb());
+                }
+                if (traces) {
+                    TraceResult t = RunTraced(engine, input, n, seed, caches, cacheCount);
+                    if (t.outOfMemory) {
+                        fprintf(stderr, "%s/%s/%d: out of memory recording the trace\n", engine->name, SortDistributionName(d), n);
+                        failures++;
+                        continue;
+                    }
+                    if (!t.ok) {
+                        fprintf(stderr, "%s/%s/%d: trace replay not sorted\n", engine->name, SortDistributionName(d), n);
+                        failures++;
+                    }
+                    printf(csv ? "trace,%s,%s,%d,record_s=%.4f,ops=%llu,op_bytes=%zu,keyframe_bytes=%zu,seek_ms=%.3f\n"
+                               : "  trace  %-12s %-13s %10d record %.3fs  ops %llu  %zu KB ops + %zu KB keyframes  seek %.3f ms\n",
+                           engine->name, SortDistributionName(d), n, t.recordSeconds, (unsigned long long)t.ops,
+                           csv ? t.opBytes : t.opBytes / 1024, csv ? t.keyframeBytes : t.keyframeBytes / 1024, t.seekMs);
+                    for (int k = 0; k < cacheCount; k++) {
+                        const CacheResult *c = &t.caches[k];
+                        if (!c->ok) {
+                            fprintf(stderr, "%s/%s/%d: cached replay (%s) not sorted\n", engine->name,
+                                    SortDistributionName(d), n, caches[k]->name);
+                            failures++;
+                        }
+                        double rate = c->seconds > 0 ? (double)c->accesses / c->seconds / 1e6 : 0;
+                        double slowdown = t.replaySeconds > 0 ? c->seconds / t.replaySeconds : 0;
+                        printf(csv ? "cache,%s,%s,%d,%s,accesses=%llu,l1_miss=%.4f,l2_miss=%.4f,tlb_miss=%.4f,"
+                                     "maccess_per_s=%.1f,x_replay=%.2f\n"
+                                   : "  cache  %-12s %-13s %10d %-8s %llu accesses  miss L1 %.2f%%  L2 %.2f%%  TLB %.2f%%"
+                                     "  %.1f M accesses/s  %.2fx plain replay\n",
+                               engine->name, SortDistributionName(d), n, caches[k]->name,
+                               (unsigned long long)c->accesses, csv ? c->l1Miss : c->l1Miss * 100.0,
+                               csv ? c->l2Miss : c->l2Miss * 100.0, csv ? c->tlbMiss : c->tlbMiss * 100.0, rate,
+                               slowdown);
+                    }
+                }
+                fflush(stdout);
+            }
+
+            if (threadCountCount > 0) {
+                failures += BenchParallel(PAR_MERGE, "merge-par", "merge-simd", input, n, (SortDistribution)d,
+                                          threadCounts, threadCountCount, csv);
+                if (n <= bubbleMax)
+                    failures += BenchParallel(PAR_ODD_EVEN, "odd-even-par", "odd-even", input, n, (SortDistribution)d,
+                                              threadCounts, threadCountCount, csv);
+            }
+        }
+        free(input);
+    }
+    SortSessionFree(&session);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+// frame_gate.c
+#include "frame_gate.h"
+#include "raylib.h"
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/emscripten.h>
+#endif
+
+#define FIRST_KEY 32                   // KEY_SPACE; nothing below it is a key
+#define LAST_KEY 348                   // KEY_KB_MENU
+#define ACTIVE_WAIT (1.0 / 60.0)       // native skip wait until the idle delay has passed
+
+// Anything the user did since the last poll, held keys and buttons included
+static bool InputActivity(void) {
+    for (int key = FIRST_KEY; key <= LAST_KEY; key++) {
+        if (IsKeyDown(key) || IsKeyReleased(key)) return true;
+    }
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_MIDDLE; b++) {
+        if (IsMouseButtonDown(b) || IsMouseButtonReleased(b)) return true;
+    }
+    Vector2 delta = GetMouseDelta();
+    if (delta.x != 0 || delta.y != 0) return true;
+    if (GetMouseWheelMove() != 0) return true;
+    if (GetTouchPointCount() > 0) return true;
+    return IsFileDropped();
+}
+
+static void SetThrottled(FrameGate *g, bool throttled) {
+    if (g->throttled == throttled) return;
+    g->throttled = throttled;
+#if defined(PLATFORM_WEB)
+    if (throttled) emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, 1000 / FRAME_GATE_IDLE_FPS);
+    else emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+#endif
+}
+
+void FrameGateInit(FrameGate *g) {
+    *g = (FrameGate){ .dirty = true, .lastDraw = GetTime() };
+}
+
+void FrameGateInvalidate(FrameGate *g) {
+    g->dirty = true;
+}
+
+bool FrameGateBegin(FrameGate *g, bool animating) {
+    double now = GetTime();
+    int width = GetScreenWidth(), height = GetScreenHeight();
+    bool draw = g->dirty || animating || width != g->width || height != g->height || InputActivity();
+
+    if (draw) {
+        g->frameTime = g->drewLast ? (float)(now - g->lastDraw) : 0.0f;
+        g->lastDraw = now;
+        g->drewLast = true;
+        g->dirty = false;
+        g->width = width;
+        g->height = height;
+        SetThrottled(g, false);
+        return true;
+    }
+
+    // EndDrawing polls input; without it nothing new would ever arrive
+    g->drewLast = false;
+    g->skipped++;
+    bool idle = now - g->lastDraw >= FRAME_GATE_IDLE_DELAY;
+    SetThrottled(g, idle);
+#if !defined(PLATFORM_WEB)
+    WaitTime(idle ? 1.0 / FRAME_GATE_IDLE_FPS : ACTIVE_WAIT);
+#endif
+    PollInputEvents();
+    return false;
+}
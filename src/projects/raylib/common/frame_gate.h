@@ -0,0 +1,36 @@
+// frame_gate.h
+// Skips frames that would draw the same picture again. A program calls FrameGateBegin at
+// the top of its frame with whether anything is moving; the frame is drawn when it is, when
+// there was input, when the screen was resized or after FrameGateInvalidate. Otherwise no
+// draw calls are issued and the loop slows down: native waits instead of spinning, and
+// on the web the main loop drops from requestAnimationFrame to a FRAME_GATE_IDLE_FPS timer
+// until something happens.
+//
+// frameTime replaces GetFrameTime(): raylib's counts the time spent skipping, which would
+// arrive as one huge step in the first frame after a wake-up.
+#ifndef FRAME_GATE_H
+#define FRAME_GATE_H
+
+#include <stdbool.h>
+
+#define FRAME_GATE_IDLE_FPS 10
+#define FRAME_GATE_IDLE_DELAY 0.5      // seconds of stillness before slowing the loop
+
+typedef struct FrameGate {
+    bool dirty;                // draw the next frame whatever happens
+    int width, height;         // screen size last drawn at
+    double lastDraw;           // GetTime() of the last drawn frame
+    bool drewLast;             // the previous frame was drawn
+    bool throttled;            // loop slowed down (web: timing switched)
+    float frameTime;           // seconds since the previous drawn frame; 0 after a skip
+    unsigned long skipped;     // frames not drawn so far
+} FrameGate;
+
+void FrameGateInit(FrameGate *g);
+// The next frame draws even when nothing else changed
+void FrameGateInvalidate(FrameGate *g);
+// Call first thing in the frame. False: nothing would change, return without drawing
+// (input has been polled already)
+bool FrameGateBegin(FrameGate *g, bool animating);
+
+#endif // FRAME_GATE_H
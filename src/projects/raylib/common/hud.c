@@ -0,0 +1,156 @@
+// hud.c
+#include "hud.h"
+#include "rlgl.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ATLAS_MIN_HEIGHT 256
+#define ROW_PADDING 2
+
+void HudInit(Hud *hud) {
+    *hud = (Hud){0};
+}
+
+void HudUnload(Hud *hud) {
+    if (hud->atlasHeight > 0) UnloadRenderTexture(hud->atlas);
+    *hud = (Hud){0};
+}
+
+void HudAdd(Hud *hud, HudText *text) {
+    if (hud->count == HUD_MAX_TEXTS) return;
+    *text = (HudText){ .hud = hud, .row = -1 };
+    hud->texts[hud->count++] = text;
+}
+
+void HudTextSet(HudText *t, const char *text, int fontSize) {
+    if (fontSize == t->fontSize && strcmp(text, t->text) == 0) return;
+    snprintf(t->text, sizeof(t->text), "%s", text);
+    t->fontSize = fontSize;
+    t->width = MeasureText(t->text, fontSize);
+    t->hasValue = false;
+    t->dirty = true;
+}
+
+void HudTextSetInt(HudText *t, int value, int fontSize) {
+    if (t->hasValue && value == t->value && fontSize == t->fontSize) return;
+    char text[16];
+    snprintf(text, sizeof(text), "%d", value);
+    HudTextSet(t, text, fontSize);
+    t->hasValue = true;
+    t->value = value;
+}
+
+void HudTextSetf(HudText *t, int fontSize, const char *format, ...) {
+    char text[HUD_TEXT_MAX];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    HudTextSet(t, text, fontSize);
+}
+
+// Clears area in the bound render texture to transparent: blending off, not "draw nothing"
+void HudLayerClear(Rectangle area) {
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    DrawRectangleRec(area, BLANK);
+    EndBlendMode();
+}
+
+// Gives every line a row tall enough for its font; a new atlas when they no longer fit
+static void PackRows(Hud *hud) {
+    int y = 0;
+    for (int i = 0; i < hud->count; i++) {
+        HudText *t = hud->texts[i];
+        t->row = y;
+        t->rowHeight = t->fontSize + ROW_PADDING;
+        t->dirty = true;
+        y += t->rowHeight;
+    }
+    if (y <= hud->atlasHeight) return;
+
+    int height = hud->atlasHeight > 0 ? hud->atlasHeight : ATLAS_MIN_HEIGHT;
+    while (height < y) height *= 2;
+    if (hud->atlasHeight > 0) UnloadRenderTexture(hud->atlas);
+    hud->atlas = LoadRenderTexture(HUD_ATLAS_WIDTH, height);
+    hud->atlasHeight = height;
+    BeginTextureMode(hud->atlas);
+    ClearBackground(BLANK);
+    EndTextureMode();
+}
+
+void HudUpdate(Hud *hud) {
+    bool any = false;
+    bool repack = hud->atlasHeight == 0;
+    for (int i = 0; i < hud->count; i++) {
+        HudText *t = hud->texts[i];
+        any |= t->dirty;
+        repack |= t->row < 0 || t->fontSize + ROW_PADDING > t->rowHeight;
+    }
+    if (repack) PackRows(hud);
+    if (!any && !repack) return;
+
+    BeginTextureMode(hud->atlas);
+    for (int i = 0; i < hud->count; i++) {
+        HudText *t = hud->texts[i];
+        if (!t->dirty) continue;
+        HudLayerClear((Rectangle){ 0, (float)t->row, HUD_ATLAS_WIDTH, (float)t->rowHeight });
+        if (t->text[0]) DrawText(t->text, 0, t->row, t->fontSize, WHITE);
+        t->dirty = false;
+        hud->rasterized++;
+    }
+    EndTextureMode();
+}
+
+void HudTextDraw(const HudText *t, int x, int y, Color tint) {
+    const Hud *hud = t->hud;
+    if (!hud || t->row < 0 || !t->text[0]) return;
+    int width = t->width < HUD_ATLAS_WIDTH ? t->width : HUD_ATLAS_WIDTH;
+    int height = t->fontSize;
+
+    // Render textures are stored bottom-up: flip the source rows
+    Rectangle source = { 0, (float)(hud->atlasHeight - t->row - height), (float)width, (float)-height };
+    DrawTextureRec(hud->atlas.texture, source, (Vector2){ (float)x, (float)y }, tint);
+}
+
+void HudTextDrawCentered(const HudText *t, int centerX, int y, Color tint) {
+    HudTextDraw(t, centerX - t->width / 2, y, tint);
+}
+
+//------------------------------------------------------------------------------------
+// Cell-updated layer
+//------------------------------------------------------------------------------------
+bool HudLayerResize(HudLayer *layer, int width, int height) {
+    if (width == layer->width && height == layer->height) return false;
+    if (layer->width > 0) UnloadRenderTexture(layer->target);
+    *layer = (HudLayer){0};
+    if (width <= 0 || height <= 0) return true;
+
+    layer->target = LoadRenderTexture(width, height);
+    layer->width = width;
+    layer->height = height;
+    BeginTextureMode(layer->target);
+    ClearBackground(BLANK);
+    EndTextureMode();
+    return true;
+}
+
+void HudLayerBegin(HudLayer *layer) {
+    BeginTextureMode(layer->target);
+}
+
+void HudLayerEnd(void) {
+    EndTextureMode();
+}
+
+void HudLayerDraw(const HudLayer *layer, int x, int y, Color tint) {
+    if (layer->width <= 0) return;
+    Rectangle source = { 0, 0, (float)layer->width, (float)-layer->height };
+    DrawTextureRec(layer->target.texture, source, (Vector2){ (float)x, (float)y }, tint);
+}
+
+void HudLayerUnload(HudLayer *layer) {
+    if (layer->width > 0) UnloadRenderTexture(layer->target);
+    *layer = (HudLayer){0};
+}
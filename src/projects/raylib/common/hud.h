@@ -0,0 +1,74 @@
+// hud.h
+// Cached HUD text shared by the raylib projects. Every HudText owns a row of one shared
+// render-texture atlas and is only formatted, measured and rasterized again when its
+// text or font size changes. A frame's HUD is then a few quads from a single texture,
+// which raylib batches into one draw call.
+//
+// HudLayer does the same for many small items in one region (the bar labels): the
+// caller redraws only the cells that changed and the layer is drawn as one quad.
+#ifndef HUD_H
+#define HUD_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HUD_MAX_TEXTS 32
+#define HUD_TEXT_MAX 256
+#define HUD_ATLAS_WIDTH 2048           // longer lines are clipped
+
+typedef struct Hud Hud;
+
+typedef struct HudText {
+    Hud *hud;
+    char text[HUD_TEXT_MAX];
+    int fontSize;
+    int width;                 // measured, in pixels
+    int row, rowHeight;        // place in the atlas; row < 0 until packed
+    bool dirty;                // needs rasterizing
+    bool hasValue;             // HudTextSetInt cache
+    int value;
+} HudText;
+
+struct Hud {
+    RenderTexture2D atlas;
+    int atlasHeight;           // 0 until the first HudUpdate
+    HudText *texts[HUD_MAX_TEXTS];
+    int count;
+    uint32_t rasterized;       // lines re-rendered so far
+};
+
+void HudInit(Hud *hud);
+void HudUnload(Hud *hud);
+// Registers a line; it stays at the given address for the Hud's lifetime
+void HudAdd(Hud *hud, HudText *text);
+
+// Each Set is a no-op when nothing changed
+void HudTextSet(HudText *t, const char *text, int fontSize);
+void HudTextSetInt(HudText *t, int value, int fontSize);          // formats only a new value
+void HudTextSetf(HudText *t, int fontSize, const char *format, ...);
+
+// Rasterizes every changed line into the atlas; call before BeginDrawing
+void HudUpdate(Hud *hud);
+// Draws at (x, y), top-left, tinted (lines are rasterized white)
+void HudTextDraw(const HudText *t, int x, int y, Color tint);
+void HudTextDrawCentered(const HudText *t, int centerX, int y, Color tint);
+
+//------------------------------------------------------------------------------------
+// Cell-updated layer
+//------------------------------------------------------------------------------------
+typedef struct HudLayer {
+    RenderTexture2D target;
+    int width, height;
+} HudLayer;
+
+// (Re)creates the layer at width x height; true when it was recreated and is blank
+bool HudLayerResize(HudLayer *layer, int width, int height);
+void HudLayerBegin(HudLayer *layer);
+void HudLayerEnd(void);
+// Between Begin and End: makes area transparent again before it is redrawn
+void HudLayerClear(Rectangle area);
+void HudLayerDraw(const HudLayer *layer, int x, int y, Color tint);
+void HudLayerUnload(HudLayer *layer);
+
+#endif // HUD_H
@@ -0,0 +1,180 @@
+// prof.c
+#include "prof.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/emscripten.h>
+#else
+#include <time.h>
+#endif
+
+#define FRAME_SECTION PROF_MAX_SECTIONS
+
+Profiler profiler;
+
+double ProfNowMs(void) {
+#if defined(__EMSCRIPTEN__)
+    return emscripten_get_now();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+#endif
+}
+
+static void RecordEvent(int section, int depth, double startMs, double endMs) {
+    Profiler *p = &profiler;
+    if (!p->events) {
+        p->events = malloc(PROF_EVENT_CAPACITY * sizeof(ProfEvent));
+        if (!p->events) return;
+    }
+    p->events[p->eventNext] = (ProfEvent){
+        .startUs = (startMs - p->originMs) * 1000.0,
+        .durationUs = (float)((endMs - startMs) * 1000.0),
+        .section = (uint16_t)section,
+        .depth = (uint16_t)depth,
+    };
+    p->eventNext = (p->eventNext + 1) % PROF_EVENT_CAPACITY;
+    if (p->eventCount < PROF_EVENT_CAPACITY) p->eventCount++;
+}
+
+// Sections are keyed by name; literals usually match by pointer, the strcmp catches the rest
+static int FindSection(const char *name) {
+    Profiler *p = &profiler;
+    for (int i = 0; i < p->sectionCount; i++) {
+        if (p->sections[i].name == name || strcmp(p->sections[i].name, name) == 0) return i;
+    }
+    if (p->sectionCount == PROF_MAX_SECTIONS) return -1;
+    p->sections[p->sectionCount] = (ProfSection){ .name = name };
+    return p->sectionCount++;
+}
+
+void ProfFrameBegin(void) {
+    profiler.frameStartMs = ProfNowMs();
+    if (profiler.originMs == 0) profiler.originMs = profiler.frameStartMs;
+    profiler.depth = 0;
+}
+
+void ProfFrameEnd(void) {
+    Profiler *p = &profiler;
+    double end = ProfNowMs();
+    RecordEvent(FRAME_SECTION, 0, p->frameStartMs, end);
+
+    p->frameMs[p->frameNext] = (float)(end - p->frameStartMs);
+    for (int i = 0; i < p->sectionCount; i++) {
+        p->sections[i].historyMs[p->frameNext] = p->sections[i].frameMs;
+        p->sections[i].frameMs = 0;
+    }
+    p->frameNext = (p->frameNext + 1) % PROF_FRAME_HISTORY;
+    if (p->frameCount < PROF_FRAME_HISTORY) p->frameCount++;
+}
+
+int ProfBegin(const char *name) {
+    Profiler *p = &profiler;
+    if (p->depth < PROF_MAX_DEPTH) {
+        p->stack[p->depth] = FindSection(name);
+        p->stackStartMs[p->depth] = ProfNowMs();
+        if (p->originMs == 0) p->originMs = p->stackStartMs[p->depth];
+    }
+    p->depth++;
+    return 1;
+}
+
+int ProfEnd(void) {
+    Profiler *p = &profiler;
+    p->depth--;
+    if (p->depth < PROF_MAX_DEPTH && p->stack[p->depth] >= 0) {
+        double end = ProfNowMs();
+        double start = p->stackStartMs[p->depth];
+        int section = p->stack[p->depth];
+        p->sections[section].frameMs += (float)(end - start);
+        RecordEvent(section, p->depth + 1, start, end);
+    }
+    return 0;
+}
+
+float ProfSectionAverageMs(int section) {
+    const Profiler *p = &profiler;
+    if (p->frameCount == 0) return 0;
+    double sum = 0;
+    for (int i = 0; i < p->frameCount; i++) sum += p->sections[section].historyMs[i];
+    return (float)(sum / p->frameCount);
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+float ProfFramePercentileMs(float p) {
+    int n = profiler.frameCount;
+    if (n == 0) return 0;
+    float sorted[PROF_FRAME_HISTORY];
+    memcpy(sorted, profiler.frameMs, (size_t)n * sizeof(float));
+    qsort(sorted, (size_t)n, sizeof(float), CompareFloat);
+    int k = (int)(p * (float)(n - 1) + 0.5f);
+    return sorted[k < 0 ? 0 : (k >= n ? n - 1 : k)];
+}
+
+// Appends to a growing buffer; false once out of memory
+typedef struct TraceBuffer {
+    char *data;
+    size_t size, capacity;
+} TraceBuffer;
+
+static bool Append(TraceBuffer *b, const char *format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(b->data ? b->data + b->size : NULL, b->data ? b->capacity - b->size : 0, format, args);
+        va_end(args);
+        if (n < 0) return false;
+        if (b->data && b->size + (size_t)n < b->capacity) {
+            b->size += (size_t)n;
+            return true;
+        }
+        size_t capacity = b->capacity ? b->capacity * 2 : 1 << 16;
+        while (capacity <= b->size + (size_t)n) capacity *= 2;
+        char *data = realloc(b->data, capacity);
+        if (!data) return false;
+        b->data = data;
+        b->capacity = capacity;
+    }
+}
+
+bool ProfExportTrace(const char *fileName) {
+    const Profiler *p = &profiler;
+    TraceBuffer b = {0};
+    bool ok = Append(&b, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    // Oldest first; the section names are string literals without characters to escape
+    uint32_t first = (p->eventNext + PROF_EVENT_CAPACITY - p->eventCount) % PROF_EVENT_CAPACITY;
+    for (uint32_t i = 0; ok && i < p->eventCount; i++) {
+        const ProfEvent *e = &p->events[(first + i) % PROF_EVENT_CAPACITY];
+        const char *name = e->section == FRAME_SECTION ? "frame" : p->sections[e->section].name;
+        ok = Append(&b, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    i ? "," : "", name, e->startUs, (double)e->durationUs);
+    }
+    ok = ok && Append(&b, "]}\n");
+
+    if (ok) {
+#if defined(__EMSCRIPTEN__)
+        EM_ASM({
+            var link = document.createElement('a');
+            link.href = URL.createObjectURL(new Blob([HEAPU8.slice($0, $0 + $1)], { type: 'application/json' }));
+            link.download = UTF8ToString($2);
+            link.click();
+            setTimeout(function() { URL.revokeObjectURL(link.href); }, 0);
+        }, b.data, (int)b.size, fileName);
+#else
+        FILE *f = fopen(fileName, "wb");
+        ok = f && fwrite(b.data, 1, b.size, f) == b.size;
+        if (f) ok = fclose(f) == 0 && ok;
+#endif
+    }
+    free(b.data);
+    return ok;
+}
@@ -0,0 +1,86 @@
+// prof.h
+// Scoped section timers for the main loop, compiled in only with -DPROF_ENABLED (the
+// build scripts' profile and debug variants); otherwise every macro below is empty.
+// Sections are recorded into a ring of trace events and into per-frame totals, which
+// prof_overlay.h shows in the canvas and ProfExportTrace writes as Chrome trace-event
+// JSON (chrome://tracing, ui.perfetto.dev).
+//
+//     PROF_FRAME_BEGIN();
+//     PROF_SCOPE("sim") {
+//         ...                 // leave the block normally: no return/break/goto out of it
+//     }
+//     PROF_FRAME_END();
+//
+// Main thread only: keep scopes out of code the headless tools run on worker threads
+// (PongStep in selfplay). Nothing in here depends on raylib.
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROF_MAX_SECTIONS 32
+#define PROF_MAX_DEPTH 16
+#define PROF_FRAME_HISTORY 240          // frames kept for the histogram and percentiles
+#define PROF_EVENT_CAPACITY 65536       // trace events kept for export (about 1 MB)
+
+typedef struct ProfEvent {
+    double startUs;                     // since the first frame or section began
+    float durationUs;
+    uint16_t section;                   // PROF_MAX_SECTIONS for the whole frame
+    uint16_t depth;
+} ProfEvent;
+
+typedef struct ProfSection {
+    const char *name;
+    float frameMs;                      // accumulated in the current frame
+    float historyMs[PROF_FRAME_HISTORY];
+} ProfSection;
+
+typedef struct Profiler {
+    ProfSection sections[PROF_MAX_SECTIONS];
+    int sectionCount;
+
+    ProfEvent *events;                  // ring, allocated on first use
+    uint32_t eventNext, eventCount;
+
+    double frameStartMs;
+    float frameMs[PROF_FRAME_HISTORY];  // work per frame, FRAME_BEGIN to FRAME_END
+    int frameNext, frameCount;
+
+    int stack[PROF_MAX_DEPTH];
+    double stackStartMs[PROF_MAX_DEPTH];
+    int depth;
+    double originMs;
+} Profiler;
+
+extern Profiler profiler;
+
+double ProfNowMs(void);
+void ProfFrameBegin(void);
+void ProfFrameEnd(void);
+int ProfBegin(const char *name);        // always returns 1 (see PROF_SCOPE)
+int ProfEnd(void);                      // always returns 0
+
+// Average over the kept frames, and the frame-time percentile p in [0, 1]
+float ProfSectionAverageMs(int section);
+float ProfFramePercentileMs(float p);
+
+// Writes the event ring as trace-event JSON: a download on the web, a file natively
+bool ProfExportTrace(const char *fileName);
+
+#if defined(PROF_ENABLED)
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_FRAME_BEGIN() ProfFrameBegin()
+#define PROF_FRAME_END() ProfFrameEnd()
+#define PROF_SCOPE(name) \
+    for (int PROF_CONCAT(profScope, __LINE__) = ProfBegin(name); PROF_CONCAT(profScope, __LINE__); \
+         PROF_CONCAT(profScope, __LINE__) = ProfEnd())
+#else
+#define PROF_FRAME_BEGIN() ((void)0)
+#define PROF_FRAME_END() ((void)0)
+#define PROF_SCOPE(name)
+#endif
+
+#endif // PROF_H
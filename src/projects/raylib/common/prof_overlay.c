@@ -0,0 +1,80 @@
+// prof_overlay.c
+#include "prof_overlay.h"
+
+#if defined(PROF_ENABLED)
+#include "raylib.h"
+#include "hud.h"
+#include <stdio.h>
+
+#define OVERLAY_FONT_SIZE 10
+#define OVERLAY_LINE 12
+#define OVERLAY_WIDTH 240
+#define HISTOGRAM_HEIGHT 60
+#define HISTOGRAM_MAX_MS 33.3f          // two 60 Hz frames; taller bars are clipped
+#define TEXT_REFRESH_SECONDS 0.25       // numbers change slowly enough to read
+#define TRACE_FILE "trace.json"
+
+static bool visible = false;
+static bool initialized = false;
+static double lastRefresh = -1.0;
+static Hud hud;
+static HudText summaryText, sectionTexts[PROF_MAX_SECTIONS];
+
+static void InitOverlay(void) {
+    HudInit(&hud);
+    HudAdd(&hud, &summaryText);
+    // The HUD holds HUD_MAX_TEXTS lines; sections past that are not listed
+    for (int i = 0; i < PROF_MAX_SECTIONS && i + 1 < HUD_MAX_TEXTS; i++) HudAdd(&hud, &sectionTexts[i]);
+    initialized = true;
+}
+
+void ProfOverlayUpdate(void) {
+    if (IsKeyPressed(KEY_F2)) visible = !visible;
+    if (IsKeyPressed(KEY_F4)) {
+        if (!ProfExportTrace(TRACE_FILE)) printf("Cannot export %s\n", TRACE_FILE);
+    }
+    if (!visible) return;
+    if (!initialized) InitOverlay();
+
+    double now = GetTime();
+    if (lastRefresh >= 0 && now - lastRefresh < TEXT_REFRESH_SECONDS) return;
+    lastRefresh = now;
+
+    HudTextSetf(&summaryText, OVERLAY_FONT_SIZE, "frame p50 %.2f ms  p99 %.2f ms  (F4: trace)",
+                ProfFramePercentileMs(0.5f), ProfFramePercentileMs(0.99f));
+    for (int i = 0; i < profiler.sectionCount && i + 1 < HUD_MAX_TEXTS; i++) {
+        HudTextSetf(&sectionTexts[i], OVERLAY_FONT_SIZE, "%s  %.3f ms", profiler.sections[i].name,
+                    ProfSectionAverageMs(i));
+    }
+    HudUpdate(&hud);
+}
+
+bool ProfOverlayVisible(void) {
+    return visible;
+}
+
+void ProfOverlayDraw(int x, int y) {
+    if (!visible || !initialized) return;
+    int lines = profiler.sectionCount < HUD_MAX_TEXTS - 1 ? profiler.sectionCount : HUD_MAX_TEXTS - 1;
+    int height = HISTOGRAM_HEIGHT + 8 + OVERLAY_LINE * (lines + 1);
+    DrawRectangle(x, y, OVERLAY_WIDTH, height, (Color){ 0, 0, 0, 180 });
+
+    // One bar per kept frame, oldest on the left; the line marks 16.7 ms
+    float barWidth = (float)OVERLAY_WIDTH / PROF_FRAME_HISTORY;
+    int bottom = y + HISTOGRAM_HEIGHT;
+    int first = (profiler.frameNext + PROF_FRAME_HISTORY - profiler.frameCount) % PROF_FRAME_HISTORY;
+    for (int i = 0; i < profiler.frameCount; i++) {
+        float ms = profiler.frameMs[(first + i) % PROF_FRAME_HISTORY];
+        float h = ms / HISTOGRAM_MAX_MS * HISTOGRAM_HEIGHT;
+        if (h > HISTOGRAM_HEIGHT) h = HISTOGRAM_HEIGHT;
+        Color color = ms > HISTOGRAM_MAX_MS / 2 ? RED : GREEN;
+        DrawRectangleRec((Rectangle){ x + i * barWidth, bottom - h, barWidth, h }, color);
+    }
+    DrawLine(x, bottom - HISTOGRAM_HEIGHT / 2, x + OVERLAY_WIDTH, bottom - HISTOGRAM_HEIGHT / 2, GRAY);
+
+    int textY = bottom + 4;
+    HudTextDraw(&summaryText, x + 4, textY, RAYWHITE);
+    for (int i = 0; i < lines; i++) HudTextDraw(&sectionTexts[i], x + 4, textY + OVERLAY_LINE * (i + 1), LIGHTGRAY);
+}
+
+#endif // PROF_ENABLED
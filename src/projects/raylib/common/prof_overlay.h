@@ -0,0 +1,23 @@
+// prof_overlay.h
+// In-canvas view of prof.h's timings: a frame-time histogram over the last
+// PROF_FRAME_HISTORY frames, p50/p99, and the average ms of every section. F2 toggles it,
+// F4 exports the trace. Compiled out with the rest of the profiler.
+#ifndef PROF_OVERLAY_H
+#define PROF_OVERLAY_H
+
+#include "prof.h"
+
+#if defined(PROF_ENABLED)
+void ProfOverlayUpdate(void);           // keys and cached text; call before BeginDrawing
+void ProfOverlayDraw(int x, int y);     // top-left corner; draws nothing while hidden
+bool ProfOverlayVisible(void);          // its numbers change every frame it is shown
+#define PROF_OVERLAY_UPDATE() ProfOverlayUpdate()
+#define PROF_OVERLAY_DRAW(x, y) ProfOverlayDraw((x), (y))
+#define PROF_OVERLAY_VISIBLE() ProfOverlayVisible()
+#else
+#define PROF_OVERLAY_UPDATE() ((void)0)
+#define PROF_OVERLAY_DRAW(x, y) ((void)0)
+#define PROF_OVERLAY_VISIBLE() false
+#endif
+
+#endif // PROF_OVERLAY_H
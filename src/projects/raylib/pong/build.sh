@@ -1,6 +1,27 @@
-emcc game.c -o game.html \
--I/home/c9der/raylib/src \
-/home/c9der/raylib/src/libraylib.web.a \
--s USE_GLFW=3 -s ASYNCIFY -s TOTAL_MEMORY=134217728 \
--DPLATFORM_WEB --shell-file ./shell.html
+# Usage: ./build.sh [release|size|profile|debug]
+#   release  -O3 with LTO and wasm SIMD (default)
+#   size     -Oz with LTO and wasm SIMD: the smallest download, for mobile
+#   profile  release plus the prof.h section timers (F2 overlay, F4 trace export)
+#   debug    -O0 with DWARF, a source map, runtime assertions and the section timers
+# No Asyncify: the game only runs from emscripten_set_main_loop, ?replay= is fetched
+# asynchronously and ?server= talks through the browser's WebSocket callbacks, so nothing blocks
+set -e
+case "${1:-release}" in
+    release) OPT="-O3 -flto" ;;
+    size) OPT="-Oz -flto" ;;
+    profile) OPT="-O3 -flto -DPROF_ENABLED" ;;
+    debug) OPT="-O0 -g -gsource-map -s ASSERTIONS=2 -DPROF_ENABLED" ;;
+    *) echo "usage: $0 [release|size|profile|debug]"; exit 1 ;;
+esac
+RAYLIB_SRC="${RAYLIB_SRC:-/home/c9der/raylib/src}"    # raylib/src with libraylib.web.a
 
+emcc game.c pong_sim.c pong_ai.c pong_replay.c pong_net.c pong_chaos.c ../common/hud.c ../common/prof.c ../common/prof_overlay.c ../common/frame_gate.c -o game.html \
+-I../common \
+-I"$RAYLIB_SRC" \
+"$RAYLIB_SRC/libraylib.web.a" \
+$OPT -msimd128 \
+-s USE_GLFW=3 -s INITIAL_MEMORY=33554432 -s ALLOW_MEMORY_GROWTH=1 \
+-lwebsocket.js -DPLATFORM_WEB --shell-file ./shell.html
+
+# Download size; the page prints its time to first frame in the console
+echo "game.wasm: $(wc -c < game.wasm) bytes, $(gzip -9c game.wasm | wc -c) gzipped"
@@ -1,53 +1,134 @@
 #include "raylib.h"
+#include "rlgl.h"
+#include "pong_sim.h"
+#include "pong_ai.h"
+#include "pong_replay.h"
+#include "pong_net.h"
+#include "pong_chaos.h"
+#include "frame_gate.h"
+#include "hud.h"
+#include "prof_overlay.h"
+#if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
 #include <emscripten/html5.h>
+#include <emscripten/websocket.h>
+#else
+#include "pong_ws.h"
+#endif
 #include <math.h>
 #include <stdio.h>
-
-// Game constants (proportional to screen size)
-#define PADDLE_WIDTH_RATIO 0.15f  // Paddle width as % of screen width
-#define PADDLE_HEIGHT_RATIO 0.015f  // Paddle height as % of screen height
-#define BALL_SIZE_RATIO 0.012f  // Ball size as % of screen height
-#define PADDLE_SPEED 700.0f
-#define AI_PADDLE_SPEED 750.0f
-#define BALL_SPEED 600.0f
-#define PADDLE_MARGIN_RATIO 0.04f  // Margin as % of screen height
-#define AI_REACTION_DELAY 0.05f
-#define AI_PREDICTION_ERROR 0.15f
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_FRAME_TIME 0.25f    // longest hitch the simulation catches up on
+#define REPLAY_FAST_FORWARD 8   // ticks per tick while TAB is held during a replay
+#define REPLAY_RESULT_TIME 3.0  // seconds the replay verdict stays on screen
+#define MAX_CENTER_DASHES 512
+#define FRAME_STATS_WINDOW 120  // frames averaged by the F3 overlay
+#define NATIVE_WIDTH 800        // desktop window size; the web build fills the page
+#define NATIVE_HEIGHT 900
+#define CHAOS_DEFAULT_BALLS 10000
+#define CHAOS_MIN_BALLS 1000
+#define CHAOS_BATCH_QUADS 16384 // GLES2 indexes a batch with 16 bits: 65536 vertices
+#define CHAOS_TEXTURE_SIZE 32
 
 // Dynamic game dimensions
-int PADDLE_WIDTH;
-int PADDLE_HEIGHT;
-int BALL_SIZE;
-int PADDLE_MARGIN;
-
-// Game state
-typedef struct {
-    Vector2 topPaddle;
-    Vector2 bottomPaddle;
-    Vector2 ball;
-    Vector2 ballVelocity;
-    int topScore;
-    int bottomScore;
-    bool gameStarted;
-} GameState;
-
+PongLayout layout;
+
+// Canvas size and everything drawn from it. The resize callback only records the new size;
+// the main loop applies it once, so nothing size-related is queried or derived per frame
+typedef struct Viewport {
+    int width, height;
+    int pendingWidth, pendingHeight;    // set by the resize callback, 0 when none
+    int scoreFontSize, startFontSize, hintFontSize;
+    int scoreMargin;
+    int dashCount;
+    Rectangle dashes[MAX_CENTER_DASHES];
+} Viewport;
+
+Viewport viewport;
+
+// Main-loop cost, excluding EndDrawing (buffer swap and frame pacing)
+typedef struct FrameStats {
+    float simMs[FRAME_STATS_WINDOW];
+    float drawMs[FRAME_STATS_WINDOW];
+    int next, count;
+    uint32_t relayouts;
+    bool visible;
+} FrameStats;
+
+FrameStats frameStats;
+
+// Before the serve nothing moves unless the player does, so those frames are not redrawn
+FrameGate gate;
+
+// All text is cached by the HUD and only re-rendered when it changes
+Hud hud;
+HudText topScoreText, bottomScoreText, startText, startText2, controlsText, replayText, statsText, chaosText;
+
+// The simulation runs at PONG_TICK_RATE; drawing interpolates between the last two ticks
 GameState game;
+GameState prevGame;
+float accumulator = 0.0f;
+
+// Every live tick is recorded. F9 downloads the session so far, F8 replays it in place and
+// checks it lands on the state live play left off in; game.html?replay=FILE plays a saved one
+PongRecorder recorder;
+PongReplay replay;
+uint8_t *replayBytes = NULL;
+bool replaying = false;
+bool resumeRecording = false;   // replaying this session: keep extending its recording after
+bool replayMatched = false;
+double replayResultTime = -1.0;   // -1 once the verdict is off the screen
+
+// Online play against another player through pong_server: game.html?server=ws://HOST:PORT,
+// or natively `pong --connect HOST[:PORT]`. The server owns the match; game only holds the
+// client's view of it, drawn through a camera that fits the server's field to the screen
+// and turns it so the player's own paddle is always at the bottom
+bool netMode = false;
+bool netJoined = false;         // NET_JOIN sent
+bool netClosed = false;
+char netServer[256];
+PongNetClient net;
+Camera2D netCamera;
+#if defined(PLATFORM_WEB)
+EMSCRIPTEN_WEBSOCKET_T netSocket;
+#else
+PongWs netSocket;
+#endif
+
+// Chaos mode, C in local play: thousands of extra balls over the game, which carries on
+// underneath untouched; +/- double and halve them. They are drawn as one call per
+// CHAOS_BATCH_QUADS balls, through a render batch of their own textured with one circle
+bool chaosMode = false;
+int chaosBalls = CHAOS_DEFAULT_BALLS;
+PongChaos chaos;
+float chaosTickMs = 0.0f;       // smoothed cost of one chaos tick
+rlRenderBatch chaosBatch;
+Texture2D chaosTexture;
 
 void UpdateDrawFrame(void);
-void ResetBall(void);
-void UpdateGame(void);
-void UpdateAIPaddle(void);
-void DrawGame(void);
+void DrawGame(float alpha);
+static void UpdateHud(void);
+static void ApplyViewport(int width, int height);
+static void StartNet(const char *server);
+#if defined(PLATFORM_WEB)
+static void LoadReplayFromUrl(void);
+static void ConnectFromUrl(void);
 EM_BOOL onCanvasResize(int eventType, const EmscriptenUiEvent *uiEvent, void *userData);
+#else
+static void LoadReplayFromFile(const char *path);
+#endif
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
+#if defined(PLATFORM_WEB)
     // Make it resizable *and* start borderless
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_UNDECORATED);
 
@@ -55,391 +136,656 @@ int main(void)
     double cssWidth, cssHeight;
     emscripten_get_element_css_size("#canvas", &cssWidth, &cssHeight);
     
-    // Initialize window with browser dimensions
+    // Initialize window with browser dimensions (this also sizes the canvas)
     InitWindow((int)cssWidth, (int)cssHeight, "Top-Down Pong");
+    // No SetTargetFPS: requestAnimationFrame paces the main loop, and raylib's frame wait
+    // would busy-wait the browser thread now that the build has no Asyncify
+#else
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    InitWindow(NATIVE_WIDTH, NATIVE_HEIGHT, "Top-Down Pong");
     SetTargetFPS(60);
+#endif
+
+    FrameGateInit(&gate);
+    HudInit(&hud);
+    HudText *texts[] = { &topScoreText, &bottomScoreText, &startText, &startText2, &controlsText, &replayText, &statsText,
+                         &chaosText };
+    for (int i = 0; i < (int)(sizeof(texts) / sizeof(texts[0])); i++) HudAdd(&hud, texts[i]);
     
-    // Set canvas size to match
-    emscripten_set_canvas_element_size("#canvas", (int)cssWidth, (int)cssHeight);
-    
-    // Register resize callback
+#if defined(PLATFORM_WEB)
+    // Register resize callback; it is the only thing that watches the browser size
     emscripten_set_resize_callback(EMSCRIPTEN_EVENT_TARGET_WINDOW, NULL, EM_FALSE, onCanvasResize);
+#endif
     
-    // Get actual screen dimensions after initialization
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    
-    // Calculate responsive dimensions
-    PADDLE_WIDTH = (int)(screenWidth * PADDLE_WIDTH_RATIO);
-    PADDLE_HEIGHT = (int)(screenHeight * PADDLE_HEIGHT_RATIO);
-    BALL_SIZE = (int)(screenHeight * BALL_SIZE_RATIO);
-    PADDLE_MARGIN = (int)(screenHeight * PADDLE_MARGIN_RATIO);
-    
-    // Ensure minimum sizes
-    if (PADDLE_WIDTH < 50) PADDLE_WIDTH = 50;
-    if (PADDLE_HEIGHT < 10) PADDLE_HEIGHT = 10;
-    if (BALL_SIZE < 8) BALL_SIZE = 8;
-    if (PADDLE_MARGIN < 20) PADDLE_MARGIN = 20;
-
-    // Initialize game state (will be set properly in UpdateGame on first frame)
-    game.topPaddle = (Vector2){0, PADDLE_MARGIN};
-    game.bottomPaddle = (Vector2){0, screenHeight - PADDLE_MARGIN - PADDLE_HEIGHT};
-    game.topScore = 0;
-    game.bottomScore = 0;
-    game.gameStarted = false;
-    ResetBall();
-
+    // Calculate responsive dimensions from the actual screen size
+    ApplyViewport(GetScreenWidth(), GetScreenHeight());
+
+    // Initialize game state; the seed is the only input to the ball's randomness
+    PongInit(&game, &layout, (uint64_t)time(NULL));
+    prevGame = game;
+    PongRecorderBegin(&recorder, &game, &layout);
+#if defined(PLATFORM_WEB)
+    LoadReplayFromUrl();
+    ConnectFromUrl();
     emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
+#else
+    if (argc > 2 && strcmp(argv[1], "--connect") == 0) StartNet(argv[2]);
+    else if (argc > 1) LoadReplayFromFile(argv[1]);
+    while (!WindowShouldClose()) UpdateDrawFrame();
+#endif
 
     // --------------------------------------------------------------------------------------
+    if (chaos.block) {
+        PongChaosFree(&chaos);
+        rlUnloadRenderBatch(chaosBatch);
+        UnloadTexture(chaosTexture);
+    }
+    HudUnload(&hud);
     CloseWindow();        
     // --------------------------------------------------------------------------------------
 
     return 0;
 }
 
-void ResetBall(void) {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    
-    game.ball = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
-    
-    // Random direction for ball (primarily vertical)
-    float angle = (float)(GetRandomValue(0, 360)) * DEG2RAD;
-    game.ballVelocity = (Vector2){cosf(angle) * BALL_SPEED, sinf(angle) * BALL_SPEED};
-    
-    // Ensure ball doesn't go too horizontal
-    if (fabsf(game.ballVelocity.y) < BALL_SPEED * 0.3f) {
-        game.ballVelocity.y = (game.ballVelocity.y > 0 ? 1 : -1) * BALL_SPEED * 0.7f;
-        game.ballVelocity.x = (game.ballVelocity.x > 0 ? 1 : -1) * BALL_SPEED * 0.7f;
-    }
-    
-    game.gameStarted = false;
+// Where a paddle aimed at a screen point puts its left edge, in field coordinates
+static float TargetX(Vector2 point) {
+    if (netMode) point = GetScreenToWorld2D(point, netCamera);
+    return point.x - layout.paddleWidth / 2.0f;
 }
 
-void UpdateGame(void) {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    float deltaTime = GetFrameTime();
-    
-    // Recalculate responsive dimensions (in case window was resized)
-    static int lastScreenWidth = 0;
-    static int lastScreenHeight = 0;
-    
-    if (lastScreenWidth != screenWidth || lastScreenHeight != screenHeight) {
-        PADDLE_WIDTH = (int)(screenWidth * PADDLE_WIDTH_RATIO);
-        PADDLE_HEIGHT = (int)(screenHeight * PADDLE_HEIGHT_RATIO);
-        BALL_SIZE = (int)(screenHeight * BALL_SIZE_RATIO);
-        PADDLE_MARGIN = (int)(screenHeight * PADDLE_MARGIN_RATIO);
-        
-        // Ensure minimum sizes
-        if (PADDLE_WIDTH < 50) PADDLE_WIDTH = 50;
-        if (PADDLE_HEIGHT < 10) PADDLE_HEIGHT = 10;
-        if (BALL_SIZE < 8) BALL_SIZE = 8;
-        if (PADDLE_MARGIN < 20) PADDLE_MARGIN = 20;
-        
-        lastScreenWidth = screenWidth;
-        lastScreenHeight = screenHeight;
-    }
-
-    // Initialize paddle positions on first frame (in case screen size changed)
-    static bool paddlesInitialized = false;
-    if (!paddlesInitialized) {
-        game.topPaddle = (Vector2){screenWidth / 2.0f - PADDLE_WIDTH / 2.0f, PADDLE_MARGIN};
-        game.bottomPaddle = (Vector2){screenWidth / 2.0f - PADDLE_WIDTH / 2.0f, screenHeight - PADDLE_MARGIN - PADDLE_HEIGHT};
-        paddlesInitialized = true;
-    }
+// Reads this frame's input; edge-triggered events must not be sampled per tick
+static PongInput ReadInput(void) {
+    PongInput input = { .difficulty = -1 };
+    int screenHeight = viewport.height;
 
     // Start game on spacebar, mouse click, or touch tap
-    if (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        game.gameStarted = true;
-    }
-    
-    // Also start on touch tap
-    if (GetTouchPointCount() > 0 && !game.gameStarted) {
-        game.gameStarted = true;
-    }
+    input.start = IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || GetTouchPointCount() > 0;
 
-    // Update AI-controlled top paddle
-    if (game.gameStarted) {
-        UpdateAIPaddle();
+    // AI difficulty (1 = easy, 2 = normal, 3 = hard)
+    for (int level = 0; level < PONG_AI_LEVEL_COUNT; level++) {
+        if (IsKeyPressed(KEY_ONE + level)) input.difficulty = level;
     }
 
-    // Update bottom paddle (Left/Right arrow keys)
-    if (IsKeyDown(KEY_LEFT) && game.bottomPaddle.x > 0) {
-        game.bottomPaddle.x -= PADDLE_SPEED * deltaTime;
-    }
-    if (IsKeyDown(KEY_RIGHT) && game.bottomPaddle.x + PADDLE_WIDTH < screenWidth) {
-        game.bottomPaddle.x += PADDLE_SPEED * deltaTime;
+    // Bottom paddle (Left/Right arrow keys); online the player's paddle, and on the top side
+    // the field is turned around, so the keys swap
+    input.left = IsKeyDown(KEY_LEFT);
+    input.right = IsKeyDown(KEY_RIGHT);
+    if (netMode && net.side == PONG_TOP) {
+        input.left = IsKeyDown(KEY_RIGHT);
+        input.right = IsKeyDown(KEY_LEFT);
     }
-    
+
     // Touch and mouse control for bottom paddle
     // Check for touch input first (mobile priority)
-    int touchCount = GetTouchPointCount();
-    if (touchCount > 0) {
-        // Use first touch point
-        Vector2 touchPos = GetTouchPosition(0);
-        // Allow control anywhere on screen for mobile
-        float targetX = touchPos.x - PADDLE_WIDTH / 2.0f;
-        targetX = fmaxf(0, fminf(targetX, screenWidth - PADDLE_WIDTH));
-        game.bottomPaddle.x = targetX;
+    if (GetTouchPointCount() > 0) {
+        // Use first touch point; allow control anywhere on screen for mobile
+        input.targetX = TargetX(GetTouchPosition(0));
+        input.hasTarget = true;
     } else {
         // Desktop mouse control - only in bottom half or when dragging
         Vector2 mousePos = GetMousePosition();
         if (mousePos.y >= screenHeight / 2 || IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            float targetX = mousePos.x - PADDLE_WIDTH / 2.0f;
-            targetX = fmaxf(0, fminf(targetX, screenWidth - PADDLE_WIDTH));
-            game.bottomPaddle.x = targetX;
+            input.targetX = TargetX(mousePos);
+            input.hasTarget = true;
         }
     }
+    return input;
+}
 
-    // Update ball if game has started
-    if (game.gameStarted) {
-        game.ball.x += game.ballVelocity.x * deltaTime;
-        game.ball.y += game.ballVelocity.y * deltaTime;
+// Takes ownership of bytes on success; game and layout jump to the recording's start
+static bool StartReplay(uint8_t *bytes, size_t size) {
+    if (!PongReplayBegin(&replay, bytes, size, &game, &layout)) return false;
+    free(replayBytes);
+    replayBytes = bytes;
+    replaying = true;
+    prevGame = game;
+    return true;
+}
 
-        // Ball collision with left and right walls
-        if (game.ball.x <= BALL_SIZE / 2.0f || game.ball.x >= screenWidth - BALL_SIZE / 2.0f) {
-            game.ballVelocity.x = -game.ballVelocity.x;
-            game.ball.x = fmaxf(BALL_SIZE / 2.0f, fminf(game.ball.x, screenWidth - BALL_SIZE / 2.0f));
-        }
+static void EndReplay(void) {
+    replayMatched = replay.tick == replay.ticks && PongReplayMatches(&replay, &game);
+    replayResultTime = GetTime();
+    replaying = false;
+    free(replayBytes);
+    replayBytes = NULL;
+    PongLayoutCompute(&layout, viewport.width, viewport.height);
+
+    // The session recording stays valid only if the replay landed on the same state
+    if (!resumeRecording || !replayMatched) PongRecorderBegin(&recorder, &game, &layout);
+    resumeRecording = false;
+}
 
-        // Ball collision with top paddle
-        if (game.ball.y - BALL_SIZE / 2.0f <= game.topPaddle.y + PADDLE_HEIGHT &&
-            game.ball.y - BALL_SIZE / 2.0f >= game.topPaddle.y &&
-            game.ball.x + BALL_SIZE / 2.0f >= game.topPaddle.x &&
-            game.ball.x - BALL_SIZE / 2.0f <= game.topPaddle.x + PADDLE_WIDTH &&
-            game.ballVelocity.y < 0) {
-            
-            game.ballVelocity.y = -game.ballVelocity.y;
-            
-            // Add spin based on where ball hits paddle
-            float hitPos = (game.ball.x - game.topPaddle.x) / PADDLE_WIDTH; // 0 to 1
-            float spin = (hitPos - 0.5f) * 2.0f; // -1 to 1
-            game.ballVelocity.x += spin * 100.0f;
-            
-            game.ball.y = game.topPaddle.y + PADDLE_HEIGHT + BALL_SIZE / 2.0f;
-        }
+static void ReplaySession(void) {
+    PongRecorderFinish(&recorder, &game);
+    uint8_t *copy = malloc(recorder.size);
+    if (!copy) return;
+    memcpy(copy, recorder.bytes, recorder.size);
+    if (StartReplay(copy, recorder.size)) resumeRecording = true;
+    else free(copy);
+}
 
-        // Ball collision with bottom paddle
-        if (game.ball.y + BALL_SIZE / 2.0f >= game.bottomPaddle.y &&
-            game.ball.y + BALL_SIZE / 2.0f <= game.bottomPaddle.y + PADDLE_HEIGHT &&
-            game.ball.x + BALL_SIZE / 2.0f >= game.bottomPaddle.x &&
-            game.ball.x - BALL_SIZE / 2.0f <= game.bottomPaddle.x + PADDLE_WIDTH &&
-            game.ballVelocity.y > 0) {
-            
-            game.ballVelocity.y = -game.ballVelocity.y;
-            
-            // Add spin based on where ball hits paddle
-            float hitPos = (game.ball.x - game.bottomPaddle.x) / PADDLE_WIDTH; // 0 to 1
-            float spin = (hitPos - 0.5f) * 2.0f; // -1 to 1
-            game.ballVelocity.x += spin * 100.0f;
-            
-            game.ball.y = game.bottomPaddle.y - BALL_SIZE / 2.0f;
-        }
+// Milliseconds since page navigation on the web, since InitWindow natively
+static double ClockMs(void) {
+#if defined(PLATFORM_WEB)
+    return emscripten_get_now();
+#else
+    return GetTime() * 1000.0;
+#endif
+}
 
-        // Limit ball velocity
-        float speed = sqrtf(game.ballVelocity.x * game.ballVelocity.x + game.ballVelocity.y * game.ballVelocity.y);
-        if (speed > BALL_SPEED * 1.5f) {
-            game.ballVelocity.x = (game.ballVelocity.x / speed) * BALL_SPEED * 1.5f;
-            game.ballVelocity.y = (game.ballVelocity.y / speed) * BALL_SPEED * 1.5f;
-        }
+// A browser download on the web; natively the file lands in the working directory
+static void DownloadRecording(void) {
+    PongRecorderFinish(&recorder, &game);
+    const char *name = TextFormat("pong-%u.pongrec", game.tick);
+#if !defined(PLATFORM_WEB)
+    if (!SaveFileData(name, recorder.bytes, (int)recorder.size)) printf("Cannot write %s\n", name);
+#else
+    EM_ASM({
+        var link = document.createElement('a');
+        link.href = URL.createObjectURL(new Blob([HEAPU8.slice($0, $0 + $1)], { type: 'application/octet-stream' }));
+        link.download = UTF8ToString($2);
+        link.click();
+        setTimeout(function() { URL.revokeObjectURL(link.href); }, 0);
+    }, recorder.bytes, (int)recorder.size, name);
+#endif
+}
 
-        // Score points
-        if (game.ball.y < 0) {
-            game.bottomScore++;
-            ResetBall();
-        }
-        if (game.ball.y > screenHeight) {
-            game.topScore++;
-            ResetBall();
-        }
-    } else {
-        // Keep ball centered when game hasn't started
-        game.ball = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
+static void OnReplayLoaded(void *arg, void *data, int size) {
+    const char *url = arg;
+    // data belongs to the fetch and is freed once this returns
+    uint8_t *copy = malloc(size > 0 ? (size_t)size : 1);
+    if (copy) memcpy(copy, data, (size_t)size);
+    if (!copy || !StartReplay(copy, (size_t)size)) {
+        printf("Cannot replay %s\n", url);
+        free(copy);
     }
+    resumeRecording = false;
+}
 
-    // Keep paddles in bounds
-    if (game.topPaddle.x < 0) game.topPaddle.x = 0;
-    if (game.topPaddle.x + PADDLE_WIDTH > screenWidth) game.topPaddle.x = screenWidth - PADDLE_WIDTH;
-    if (game.topPaddle.y < 0) game.topPaddle.y = 0;
-    
-    if (game.bottomPaddle.x < 0) game.bottomPaddle.x = 0;
-    if (game.bottomPaddle.x + PADDLE_WIDTH > screenWidth) game.bottomPaddle.x = screenWidth - PADDLE_WIDTH;
-    // Ensure bottom paddle stays at bottom (always update Y position based on screen height)
-    game.bottomPaddle.y = screenHeight - PADDLE_MARGIN - PADDLE_HEIGHT;
+#if defined(PLATFORM_WEB)
+static void OnReplayFailed(void *arg) {
+    printf("Cannot fetch %s\n", (const char *)arg);
 }
 
-void UpdateAIPaddle(void) {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    float deltaTime = GetFrameTime();
-    
-    // Only react if ball is moving towards the top paddle (negative Y velocity)
-    if (game.ballVelocity.y >= 0) {
-        // Ball is moving away, AI can relax or move to center
-        float centerX = screenWidth / 2.0f - PADDLE_WIDTH / 2.0f;
-        float diff = centerX - game.topPaddle.x;
-        if (fabsf(diff) > 5.0f) {
-            float moveSpeed = AI_PADDLE_SPEED * 0.7f * deltaTime; // Faster return to center
-            if (diff > 0) {
-                game.topPaddle.x += fminf(moveSpeed, diff);
-            } else {
-                game.topPaddle.x -= fminf(moveSpeed, -diff);
-            }
-        }
+// game.html?replay=FILE fetches FILE in the background; live play runs until it arrives
+static void LoadReplayFromUrl(void) {
+    static char url[256];
+    EM_ASM({
+        var name = new URLSearchParams(location.search).get('replay') || '';
+        stringToUTF8(name, $0, $1);
+    }, url, (int)sizeof(url));
+    if (!url[0]) return;
+
+    emscripten_async_wget_data(url, url, OnReplayLoaded, OnReplayFailed);
+}
+#else
+// `pong FILE` plays a saved recording first
+static void LoadReplayFromFile(const char *path) {
+    int size = 0;
+    unsigned char *data = LoadFileData(path, &size);
+    if (!data) {
+        printf("Cannot read %s\n", path);
         return;
     }
-    
-    // Calculate where ball will be when it reaches the top paddle
-    // React immediately even if ball is far away
-    float paddleY = game.topPaddle.y + PADDLE_HEIGHT / 2.0f;
-    float distanceToPaddle = paddleY - game.ball.y;
-    
-    // Always predict and move if ball is coming towards us
-    if (game.ballVelocity.y < 0) {
-        // Use absolute distance (ball might be below paddle initially)
-        float timeToReach = fabsf(distanceToPaddle) / fabsf(game.ballVelocity.y);
-        
-        // Predict ball's X position when it reaches the paddle
-        // Account for wall bounces
-        float predictedX = game.ball.x;
-        float remainingTime = timeToReach;
-        float ballX = game.ball.x;
-        float ballVelX = game.ballVelocity.x;
-        
-        // Simulate ball movement with wall bounces
-        while (remainingTime > 0.001f) {
-            float timeToWall = 0;
-            if (ballVelX > 0) {
-                timeToWall = (screenWidth - BALL_SIZE / 2.0f - ballX) / ballVelX;
-            } else if (ballVelX < 0) {
-                timeToWall = (ballX - BALL_SIZE / 2.0f) / (-ballVelX);
-            } else {
-                timeToWall = remainingTime + 1.0f; // No horizontal movement
-            }
-            
-            if (timeToWall > remainingTime || timeToWall <= 0) {
-                // Ball reaches paddle before hitting wall
-                predictedX = ballX + ballVelX * remainingTime;
-                break;
-            } else {
-                // Ball hits wall, bounce and continue
-                ballX += ballVelX * timeToWall;
-                ballVelX = -ballVelX;
-                remainingTime -= timeToWall;
-            }
-        }
-        
-        // Add prediction error to make AI beatable
-        float errorRange = screenWidth * AI_PREDICTION_ERROR;
-        float error = ((float)GetRandomValue(-100, 100) / 100.0f) * errorRange;
-        predictedX += error;
-        
-        // Target is center of paddle aligned with predicted ball position
-        float targetX = predictedX - PADDLE_WIDTH / 2.0f;
-        targetX = fmaxf(0, fminf(targetX, screenWidth - PADDLE_WIDTH));
-        
-        // Move towards target immediately with full speed
-        float diff = targetX - game.topPaddle.x;
-        float maxMove = AI_PADDLE_SPEED * deltaTime;
-        
-        // Reduced dead zone for faster reaction
-        if (fabsf(diff) > 1.0f) {
-            if (diff > 0) {
-                game.topPaddle.x += fminf(maxMove, diff);
-            } else {
-                game.topPaddle.x -= fminf(maxMove, -diff);
-            }
+    OnReplayLoaded((void *)path, data, size);
+    UnloadFileData(data);
+}
+#endif
+
+//------------------------------------------------------------------------------------
+// Online play
+//------------------------------------------------------------------------------------
+static void NetSend(const uint8_t *msg, size_t size) {
+    if (size == 0) return;
+#if defined(PLATFORM_WEB)
+    emscripten_websocket_send_binary(netSocket, (void *)msg, (uint32_t)size);
+#else
+    PongWsSend(&netSocket, msg, size);
+#endif
+}
+
+static void JoinNet(void) {
+    uint8_t msg[4];
+    NetSend(msg, PongNetWriteJoin(msg, sizeof(msg)));
+    netJoined = true;
+}
+
+// Fits the server's field to the screen with the player's side at the bottom
+static void UpdateNetCamera(void) {
+    const PongLayout *field = &net.layout;
+    netCamera = (Camera2D){
+        .offset = { viewport.width / 2.0f, viewport.height / 2.0f },
+        .target = { field->width / 2.0f, field->height / 2.0f },
+        .rotation = net.side == PONG_TOP ? 180.0f : 0.0f,
+        .zoom = fminf(viewport.width / field->width, viewport.height / field->height),
+    };
+}
+
+#if defined(PLATFORM_WEB)
+static EM_BOOL OnNetOpen(int eventType, const EmscriptenWebSocketOpenEvent *event, void *userData) {
+    JoinNet();
+    return EM_TRUE;
+}
+
+static EM_BOOL OnNetMessage(int eventType, const EmscriptenWebSocketMessageEvent *event, void *userData) {
+    if (!event->isText) PongNetClientReceive(&net, event->data, event->numBytes, ClockMs());
+    return EM_TRUE;
+}
+
+static EM_BOOL OnNetClose(int eventType, const EmscriptenWebSocketCloseEvent *event, void *userData) {
+    netClosed = true;
+    net.welcomed = false;
+    return EM_TRUE;
+}
+
+// game.html?server=ws://HOST:PORT plays online instead of against the AI
+static void ConnectFromUrl(void) {
+    static char url[256];
+    EM_ASM({
+        var server = new URLSearchParams(location.search).get('server') || '';
+        stringToUTF8(server, $0, $1);
+    }, url, (int)sizeof(url));
+    if (url[0]) StartNet(url);
+}
+#endif
+
+// Falls back to playing the AI when the server cannot be reached at all
+static void StartNet(const char *server) {
+    snprintf(netServer, sizeof(netServer), "%s", server);
+    PongNetClientInit(&net);
+#if defined(PLATFORM_WEB)
+    EmscriptenWebSocketCreateAttributes attributes;
+    emscripten_websocket_init_create_attributes(&attributes);
+    attributes.url = netServer;
+    netSocket = emscripten_websocket_new(&attributes);
+    if (netSocket <= 0) {
+        printf("Cannot open %s\n", server);
+        return;
+    }
+    emscripten_websocket_set_onopen_callback(netSocket, NULL, OnNetOpen);
+    emscripten_websocket_set_onmessage_callback(netSocket, NULL, OnNetMessage);
+    emscripten_websocket_set_onclose_callback(netSocket, NULL, OnNetClose);
+#else
+    char host[256];
+    int port = PONG_NET_PORT;
+    snprintf(host, sizeof(host), "%s", server);
+    char *colon = strrchr(host, ':');
+    if (colon) {
+        port = atoi(colon + 1);
+        *colon = '\0';
+    }
+    if (!PongWsConnect(&netSocket, host, port)) {
+        printf("Cannot connect to %s\n", server);
+        return;
+    }
+#endif
+    netMode = true;
+    layout = net.layout;
+}
+
+// Natively the socket is polled once a frame; the browser calls OnNetMessage instead
+static void PollNet(void) {
+#if !defined(PLATFORM_WEB)
+    if (netClosed) return;
+    PongWsRead(&netSocket);
+    const uint8_t *msg;
+    size_t size;
+    while ((msg = PongWsNext(&netSocket, &size)) != NULL) PongNetClientReceive(&net, msg, size, ClockMs());
+    if (netSocket.state == WS_OPEN && !netJoined) JoinNet();
+    if (netSocket.state == WS_CLOSED) {
+        netClosed = true;
+        net.welcomed = false;
+        PongWsClose(&netSocket);
+    }
+#endif
+}
+
+// Sends this frame's inputs, then takes the frame to draw from the client
+static void StepNet(void) {
+    uint8_t msg[PONG_NET_MAX_MESSAGE];
+    NetSend(msg, PongNetClientFlush(&net, msg, sizeof(msg), ClockMs()));
+#if !defined(PLATFORM_WEB)
+    if (!netClosed) PongWsFlush(&netSocket);
+#endif
+    layout = net.layout;
+    UpdateNetCamera();
+    PongNetClientView(&net, ClockMs(), &game);
+    prevGame = game;
+}
+
+static void SetNetStatusText(void) {
+    int size = viewport.hintFontSize;
+    if (netClosed) {
+        HudTextSetf(&controlsText, size, "Disconnected from %s", netServer);
+    } else if (net.welcomed) {
+        HudTextSetf(&controlsText, size, "Online vs a player | in %.0f B/s, out %.0f B/s", net.stats.inPerSecond,
+                    net.stats.outPerSecond);
+    } else if (!netJoined) {
+        HudTextSetf(&controlsText, size, "Connecting to %s", netServer);
+    } else {
+        HudTextSet(&controlsText, net.opponentLeft ? "Opponent left; waiting for another player" : "Waiting for an opponent",
+                   size);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Chaos mode
+//------------------------------------------------------------------------------------
+// The balls, their batch and their texture are made the first time chaos mode is entered
+static void ToggleChaos(void) {
+    if (!chaos.block) {
+        if (!PongChaosInit(&chaos, PONG_CHAOS_MAX_BALLS, (uint64_t)time(NULL))) {
+            printf("Not enough memory for chaos mode\n");
+            return;
         }
+        chaosBatch = rlLoadRenderBatch(1, CHAOS_BATCH_QUADS);
+        Image circle = GenImageColor(CHAOS_TEXTURE_SIZE, CHAOS_TEXTURE_SIZE, BLANK);
+        ImageDrawCircle(&circle, CHAOS_TEXTURE_SIZE / 2, CHAOS_TEXTURE_SIZE / 2, CHAOS_TEXTURE_SIZE / 2 - 1, WHITE);
+        chaosTexture = LoadTextureFromImage(circle);
+        SetTextureFilter(chaosTexture, TEXTURE_FILTER_BILINEAR);
+        UnloadImage(circle);
     }
+    chaosMode = !chaosMode;
+    // Leaving drops the balls, so coming back starts from a fresh spread
+    PongChaosResize(&chaos, &layout, chaosMode ? chaosBalls : 0);
 }
 
-void DrawGame(void) {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    
-    // Calculate responsive font sizes (based on screen height)
-    int scoreFontSize = (int)(screenHeight * 0.08f);  // 8% of screen height
-    int startFontSize = (int)(screenHeight * 0.04f);  // 4% of screen height
-    int hintFontSize = (int)(screenHeight * 0.025f);  // 2.5% of screen height
-    
-    // Ensure minimum font sizes
-    if (scoreFontSize < 20) scoreFontSize = 20;
-    if (startFontSize < 16) startFontSize = 16;
-    if (hintFontSize < 12) hintFontSize = 12;
+static void ReadChaosKeys(void) {
+    if (IsKeyPressed(KEY_C)) ToggleChaos();
+    if (!chaosMode) return;
+    int balls = chaosBalls;
+    if (IsKeyPressed(KEY_EQUAL) && balls * 2 <= PONG_CHAOS_MAX_BALLS) balls *= 2;
+    if (IsKeyPressed(KEY_MINUS) && balls / 2 >= CHAOS_MIN_BALLS) balls /= 2;
+    if (balls != chaosBalls) {
+        chaosBalls = balls;
+        PongChaosResize(&chaos, &layout, balls);
+    }
+}
+
+// Around the real game's paddles as they are after this tick
+static void StepChaos(void) {
+    double start = ClockMs();
+    PongChaosStep(&chaos, &layout, &game.topPaddle, &game.bottomPaddle, PONG_DT);
+    chaosTickMs += ((float)(ClockMs() - start) - chaosTickMs) * 0.05f;
+}
+
+static void SetChaosText(void) {
+    if (!chaosMode) {
+        HudTextSet(&chaosText, "", viewport.hintFontSize);
+        return;
+    }
+    double updates = chaosTickMs > 0 ? chaos.count / (chaosTickMs / 1000.0) : 0.0;
+    HudTextSetf(&chaosText, viewport.hintFontSize, "CHAOS %d balls (+/-, C to leave) | %.2f ms/tick, %.1fM updates/s | escaped %llu / %llu",
+                chaos.count, chaosTickMs, updates / 1e6, (unsigned long long)chaos.escaped[PONG_TOP],
+                (unsigned long long)chaos.escaped[PONG_BOTTOM]);
+}
+
+// Every ball a textured quad between its last two ticks, straight into chaosBatch; making
+// it active draws whatever the default batch held first, and switching back draws it
+static void DrawChaos(float alpha) {
+    float r = PongChaosBallSize(&layout) / 2.0f;
+    rlSetRenderBatchActive(&chaosBatch);
+    rlSetTexture(chaosTexture.id);
+    rlBegin(RL_QUADS);
+        rlColor4ub(255, 161, 0, 255);
+        for (int i = 0; i < chaos.count; i++) {
+            rlCheckRenderBatchLimit(4);
+            float x = chaos.prevX[i] + (chaos.x[i] - chaos.prevX[i]) * alpha;
+            float y = chaos.prevY[i] + (chaos.y[i] - chaos.prevY[i]) * alpha;
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(x - r, y - r);
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(x - r, y + r);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(x + r, y + r);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(x + r, y - r);
+        }
+    rlEnd();
+    rlSetTexture(0);
+    rlSetRenderBatchActive(NULL);
+}
 
-    // Draw center line (horizontal) - responsive spacing
-    int lineSpacing = (int)(screenWidth * 0.02f);
+// Resizes the window to the canvas' CSS size and rebuilds everything derived from it
+static void ApplyViewport(int width, int height) {
+    if (width < 1 || height < 1) return;
+    if (GetScreenWidth() != width || GetScreenHeight() != height) SetWindowSize(width, height);
+    viewport.width = width;
+    viewport.height = height;
+
+    // Responsive font sizes (based on screen height), with minimums
+    viewport.scoreFontSize = (int)(height * 0.08f);  // 8% of screen height
+    viewport.startFontSize = (int)(height * 0.04f);  // 4% of screen height
+    viewport.hintFontSize = (int)(height * 0.025f);  // 2.5% of screen height
+    if (viewport.scoreFontSize < 20) viewport.scoreFontSize = 20;
+    if (viewport.startFontSize < 16) viewport.startFontSize = 16;
+    if (viewport.hintFontSize < 12) viewport.hintFontSize = 12;
+    viewport.scoreMargin = (int)(height * 0.05f);
+
+    // Center line dashes - responsive spacing
+    int lineSpacing = (int)(width * 0.02f);
+    int lineWidth = (int)(width * 0.01f);
+    int lineHeight = (int)(height * 0.005f);
     if (lineSpacing < 10) lineSpacing = 10;
-    for (int i = 0; i < screenWidth; i += lineSpacing * 2) {
-        int lineWidth = (int)(screenWidth * 0.01f);
-        int lineHeight = (int)(screenHeight * 0.005f);
-        if (lineWidth < 5) lineWidth = 5;
-        if (lineHeight < 2) lineHeight = 2;
-        DrawRectangle(i, screenHeight / 2 - lineHeight / 2, lineWidth, lineHeight, (Color){255, 255, 255, 100});
+    if (lineWidth < 5) lineWidth = 5;
+    if (lineHeight < 2) lineHeight = 2;
+    viewport.dashCount = 0;
+    for (int x = 0; x < width && viewport.dashCount < MAX_CENTER_DASHES; x += lineSpacing * 2) {
+        viewport.dashes[viewport.dashCount++] = (Rectangle){ (float)x, (float)(height / 2 - lineHeight / 2),
+                                                             (float)lineWidth, (float)lineHeight };
+    }
+
+    // A replay keeps the layout it was recorded with; EndReplay catches up. Online play is
+    // on the server's field, scaled by netCamera
+    if (!replaying && !netMode) PongLayoutCompute(&layout, width, height);
+    frameStats.relayouts++;
+}
+
+static void RecordFrameStats(double start, double simulated, double drawn) {
+    frameStats.simMs[frameStats.next] = (float)(simulated - start);
+    frameStats.drawMs[frameStats.next] = (float)(drawn - simulated);
+    frameStats.next = (frameStats.next + 1) % FRAME_STATS_WINDOW;
+    if (frameStats.count < FRAME_STATS_WINDOW) frameStats.count++;
+}
+
+static void UpdateFrameStatsText(void) {
+    float simSum = 0, simMax = 0, drawSum = 0, drawMax = 0;
+    for (int i = 0; i < frameStats.count; i++) {
+        simSum += frameStats.simMs[i];
+        drawSum += frameStats.drawMs[i];
+        simMax = fmaxf(simMax, frameStats.simMs[i]);
+        drawMax = fmaxf(drawMax, frameStats.drawMs[i]);
+    }
+    int n = frameStats.count > 0 ? frameStats.count : 1;
+    HudTextSetf(&statsText, viewport.hintFontSize, "sim %.3f ms (max %.3f)  draw %.3f ms (max %.3f)  relayouts %u  %d fps",
+                simSum / n, simMax, drawSum / n, drawMax, frameStats.relayouts, GetFPS());
+}
+
+// Brings every HUD line up to date and rasterizes the ones that changed; before BeginDrawing
+static void UpdateHud(void) {
+    // Online the player's own score sits at the bottom, by their paddle
+    bool turned = netMode && net.side == PONG_TOP;
+    HudTextSetInt(&topScoreText, turned ? game.bottomScore : game.topScore, viewport.scoreFontSize);
+    HudTextSetInt(&bottomScoreText, turned ? game.topScore : game.bottomScore, viewport.scoreFontSize);
+    HudTextSet(&startText, "TAP or PRESS SPACE", viewport.startFontSize);
+    HudTextSet(&startText2, "to start", viewport.startFontSize);
+    if (netMode) {
+        SetNetStatusText();
+    } else {
+        HudTextSetf(&controlsText, viewport.hintFontSize, "Top: AI (%s, 1-3) | Bottom: Touch/Mouse/Arrows",
+                    pongAIProfiles[game.ai[PONG_TOP].difficulty].name);
+    }
+
+    // Replay progress, then its verdict for a few seconds
+    if (replaying) {
+        HudTextSetf(&replayText, viewport.hintFontSize, "REPLAY %u / %u (hold TAB to fast-forward)", replay.tick, replay.ticks);
+    } else if (replayResultTime >= 0 && GetTime() - replayResultTime < REPLAY_RESULT_TIME) {
+        HudTextSet(&replayText, replayMatched ? "Replay reached the recorded end state" : "Replay DIVERGED from the recording",
+                   viewport.hintFontSize);
+    } else {
+        HudTextSet(&replayText, "", viewport.hintFontSize);
+        replayResultTime = -1.0;
     }
 
+    SetChaosText();
+    if (frameStats.visible) UpdateFrameStatsText();
+    HudUpdate(&hud);
+}
+
+static PongVec2 LerpVec2(PongVec2 a, PongVec2 b, float t) {
+    return (PongVec2){ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+// Paddles and ball in field coordinates
+static void DrawField(float alpha) {
+    // A point or a start teleports the ball; never interpolate across one
+    bool continuous = prevGame.topScore == game.topScore && prevGame.bottomScore == game.bottomScore &&
+                      prevGame.gameStarted == game.gameStarted;
+    PongVec2 ball = continuous ? LerpVec2(prevGame.ball, game.ball, alpha) : game.ball;
+    PongVec2 topPaddle = LerpVec2(prevGame.topPaddle, game.topPaddle, alpha);
+    PongVec2 bottomPaddle = LerpVec2(prevGame.bottomPaddle, game.bottomPaddle, alpha);
+
     // Draw paddles
-    DrawRectangleRec((Rectangle){game.topPaddle.x, game.topPaddle.y, PADDLE_WIDTH, PADDLE_HEIGHT}, RAYWHITE);
-    DrawRectangleRec((Rectangle){game.bottomPaddle.x, game.bottomPaddle.y, PADDLE_WIDTH, PADDLE_HEIGHT}, RAYWHITE);
+    DrawRectangleRec((Rectangle){topPaddle.x, topPaddle.y, layout.paddleWidth, layout.paddleHeight}, RAYWHITE);
+    DrawRectangleRec((Rectangle){bottomPaddle.x, bottomPaddle.y, layout.paddleWidth, layout.paddleHeight}, RAYWHITE);
 
     // Draw ball
-    DrawCircleV(game.ball, BALL_SIZE / 2.0f, RAYWHITE);
+    DrawCircleV((Vector2){ball.x, ball.y}, layout.ballSize / 2.0f, RAYWHITE);
+}
+
+// alpha is how far the frame is between the previous tick and the current one
+void DrawGame(float alpha) {
+    int screenWidth = viewport.width;
+    int screenHeight = viewport.height;
+    int startFontSize = viewport.startFontSize;
+
+    if (netMode) {
+        // The server's field, outlined since it rarely fills the screen
+        BeginMode2D(netCamera);
+            DrawRectangleLinesEx((Rectangle){ 0, 0, layout.width, layout.height }, 2.0f, (Color){255, 255, 255, 60});
+            DrawLineEx((Vector2){ 0, layout.height / 2.0f }, (Vector2){ layout.width, layout.height / 2.0f }, 2.0f,
+                       (Color){255, 255, 255, 100});
+            DrawField(alpha);
+        EndMode2D();
+    } else {
+        // Draw center line (horizontal)
+        for (int i = 0; i < viewport.dashCount; i++) {
+            DrawRectangleRec(viewport.dashes[i], (Color){255, 255, 255, 100});
+        }
+        if (chaosMode) DrawChaos(alpha);
+        DrawField(alpha);
+    }
 
     // Draw scores
-    char topScoreText[10];
-    char bottomScoreText[10];
-    sprintf(topScoreText, "%d", game.topScore);
-    sprintf(bottomScoreText, "%d", game.bottomScore);
-    
-    int topScoreWidth = MeasureText(topScoreText, scoreFontSize);
-    int bottomScoreWidth = MeasureText(bottomScoreText, scoreFontSize);
-    
-    int scoreMargin = (int)(screenHeight * 0.05f);
-    DrawText(topScoreText, screenWidth / 2 - topScoreWidth / 2, scoreMargin, scoreFontSize, RAYWHITE);
-    DrawText(bottomScoreText, screenWidth / 2 - bottomScoreWidth / 2, screenHeight - scoreMargin - scoreFontSize, scoreFontSize, RAYWHITE);
-
-    // Draw start message
-    if (!game.gameStarted) {
-        const char* startText = "TAP or PRESS SPACE";
-        const char* startText2 = "to start";
-        int textWidth = MeasureText(startText, startFontSize);
-        int textWidth2 = MeasureText(startText2, startFontSize);
-        DrawText(startText, screenWidth / 2 - textWidth / 2, screenHeight / 2 + startFontSize, startFontSize, YELLOW);
-        DrawText(startText2, screenWidth / 2 - textWidth2 / 2, screenHeight / 2 + startFontSize * 2.5f, startFontSize, YELLOW);
+    int scoreMargin = viewport.scoreMargin;
+    HudTextDrawCentered(&topScoreText, screenWidth / 2, scoreMargin, RAYWHITE);
+    HudTextDrawCentered(&bottomScoreText, screenWidth / 2, screenHeight - scoreMargin - viewport.scoreFontSize, RAYWHITE);
+
+    // Draw start message; online only once there is someone to play
+    if (!game.gameStarted && (!netMode || net.welcomed)) {
+        HudTextDrawCentered(&startText, screenWidth / 2, screenHeight / 2 + startFontSize, YELLOW);
+        HudTextDrawCentered(&startText2, screenWidth / 2, (int)(screenHeight / 2 + startFontSize * 2.5f), YELLOW);
     }
 
     // Draw controls hint
-    const char* controlsText = "Top: AI | Bottom: Touch/Mouse/Arrows";
-    int controlsWidth = MeasureText(controlsText, hintFontSize);
-    DrawText(controlsText, screenWidth / 2 - controlsWidth / 2, screenHeight / 2 - startFontSize, hintFontSize, (Color){200, 200, 200, 255});
+    HudTextDrawCentered(&controlsText, screenWidth / 2, screenHeight / 2 - startFontSize, (Color){200, 200, 200, 255});
+
+    if (replaying) {
+        HudTextDraw(&replayText, 10, 10, YELLOW);
+    } else {
+        HudTextDraw(&replayText, 10, 10, replayMatched ? GREEN : RED);
+    }
+    HudTextDraw(&chaosText, 10, 10 + viewport.hintFontSize + 6, ORANGE);
 }
 
-// Function to handle canvas resize
+#if defined(PLATFORM_WEB)
+// Records the canvas' new CSS size; the main loop applies it once (see ApplyViewport)
 EM_BOOL onCanvasResize(int eventType, const EmscriptenUiEvent *uiEvent, void *userData) {
     double width, height;
     emscripten_get_element_css_size("#canvas", &width, &height);
-    emscripten_set_canvas_element_size("#canvas", (int)width, (int)height);
+    viewport.pendingWidth = (int)width;
+    viewport.pendingHeight = (int)height;
+    FrameGateInvalidate(&gate);
     return EM_TRUE;
 }
+#endif
+
+// Anything on screen that moves without input: play, online play (the other player), chaos
+// balls, a replay and its verdict, the overlays, or a paddle still between its last two ticks
+static bool Animating(void) {
+    return game.gameStarted || netMode || chaosMode || replaying || replayResultTime >= 0 || frameStats.visible || PROF_OVERLAY_VISIBLE() ||
+           prevGame.bottomPaddle.x != game.bottomPaddle.x || prevGame.topPaddle.x != game.topPaddle.x;
+}
 
 void UpdateDrawFrame(void) {
-    // Check and update canvas size if window was resized
-    int currentWidth = GetScreenWidth();
-    int currentHeight = GetScreenHeight();
-    
-    double cssWidth, cssHeight;
-    emscripten_get_element_css_size("#canvas", &cssWidth, &cssHeight);
-    
-    if ((int)cssWidth != currentWidth || (int)cssHeight != currentHeight) {
-        emscripten_set_canvas_element_size("#canvas", (int)cssWidth, (int)cssHeight);
+    if (!FrameGateBegin(&gate, Animating())) return;
+    double frameStart = ClockMs();
+    PROF_FRAME_BEGIN();
+
+#if !defined(PLATFORM_WEB)
+    if (IsWindowResized()) {
+        viewport.pendingWidth = GetScreenWidth();
+        viewport.pendingHeight = GetScreenHeight();
     }
-    
-    UpdateGame();
-    
+#endif
+    // Apply a resize reported since the last frame
+    if (viewport.pendingWidth > 0) {
+        if (viewport.pendingWidth != viewport.width || viewport.pendingHeight != viewport.height) {
+            ApplyViewport(viewport.pendingWidth, viewport.pendingHeight);
+        }
+        viewport.pendingWidth = viewport.pendingHeight = 0;
+    }
+    if (IsKeyPressed(KEY_F3)) frameStats.visible = !frameStats.visible;
+
+    // Fixed-timestep simulation: run as many ticks as real time calls for, clamped so a
+    // long hitch cannot trigger a spiral of catch-up ticks
+    static bool pendingStart = false;
+    static int pendingDifficulty = -1;
+    if (!replaying && !netMode && IsKeyPressed(KEY_F8)) ReplaySession();
+    if (!replaying && !netMode && IsKeyPressed(KEY_F9)) DownloadRecording();
+    if (netMode) PollNet();
+    else ReadChaosKeys();
+    PongInput input = ReadInput();
+    pendingStart = pendingStart || input.start;
+    if (input.difficulty >= 0) pendingDifficulty = input.difficulty;
+    accumulator += fminf(gate.frameTime, MAX_FRAME_TIME);
+    PROF_SCOPE("sim") while (accumulator >= PONG_DT) {
+        input.start = pendingStart;
+        input.difficulty = pendingDifficulty;
+        pendingStart = false;
+        pendingDifficulty = -1;
+        prevGame = game;
+        if (replaying) {
+            // Live input is ignored until the replay is over
+            int steps = IsKeyDown(KEY_TAB) ? REPLAY_FAST_FORWARD : 1;
+            for (int i = 0; i < steps && replaying; i++) {
+                if (!PongReplayStep(&replay, &game, &layout)) EndReplay();
+            }
+        } else if (netMode) {
+            PongNetClientTick(&net, &input);
+        } else {
+            PongRecorderTick(&recorder, &game, &layout, &input);
+            // Timed here rather than inside PongStep, which selfplay runs on worker threads
+            PROF_SCOPE("step") PongStep(&game, &layout, &input, PONG_DT);
+        }
+        if (chaosMode) PROF_SCOPE("chaos") StepChaos();
+        accumulator -= PONG_DT;
+    }
+    if (netMode) PROF_SCOPE("net") StepNet();
+
+    double simulated = ClockMs();
+
+    PROF_SCOPE("hud") UpdateHud();
+    PROF_OVERLAY_UPDATE();
     BeginDrawing();
         ClearBackground(BLACK);
-        DrawGame();
-    EndDrawing();
+        PROF_SCOPE("draw") DrawGame(accumulator / PONG_DT);
+        PROF_OVERLAY_DRAW(viewport.width - 250, 10);
+        if (frameStats.visible) HudTextDraw(&statsText, 10, viewport.height - viewport.hintFontSize - 10, GREEN);
+        RecordFrameStats(frameStart, simulated, ClockMs());
+    PROF_SCOPE("end drawing") EndDrawing();
+    PROF_FRAME_END();
+
+    // Startup cost as a visitor sees it: time to the first finished frame
+    static bool firstFrameReported = false;
+    if (!firstFrameReported) {
+        printf("First frame at %.0f ms\n", ClockMs());
+        firstFrameReported = true;
+    }
 }
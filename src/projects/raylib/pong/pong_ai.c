@@ -0,0 +1,77 @@
+// pong_ai.c
+#include "pong_ai.h"
+#include <math.h>
+
+const PongAIProfile pongAIProfiles[PONG_AI_LEVEL_COUNT] = {
+    [PONG_AI_EASY]   = { "Easy",   550.0f, 0.15f, 0.25f },
+    [PONG_AI_NORMAL] = { "Normal", 750.0f, 0.05f, 0.15f },
+    [PONG_AI_HARD]   = { "Hard",   950.0f, 0.0f,  0.04f },
+};
+
+float PongPredictX(const GameState *game, const PongLayout *layout, float y) {
+    float vy = game->ballVelocity.y;
+    float t = vy != 0 ? (y - game->ball.y) / vy : -1;
+    if (t <= 0) return game->ball.x;
+
+    // The ball centre bounces between r and W - r. Unfolding the walls turns that into a
+    // straight line; folding the line back into [0, 2L) gives the position directly
+    float r = layout->ballSize / 2.0f;
+    float span = layout->width - 2.0f * r;
+    if (span <= 0) return layout->width / 2.0f;
+
+    float u = game->ball.x - r + game->ballVelocity.x * t;
+    float m = fmodf(u, 2.0f * span);
+    if (m < 0) m += 2.0f * span;
+    return r + (m <= span ? m : 2.0f * span - m);
+}
+
+void PongAISetDifficulty(GameState *game, PongSide side, PongDifficulty difficulty) {
+    if (difficulty < 0 || difficulty >= PONG_AI_LEVEL_COUNT) return;
+    const PongAIProfile *profile = &pongAIProfiles[difficulty];
+    PongAIState *ai = &game->ai[side];
+    ai->difficulty = difficulty;
+    ai->paddleSpeed = profile->paddleSpeed;
+    ai->reactionDelay = profile->reactionDelay;
+    ai->predictionError = profile->predictionError;
+}
+
+static void MoveTowards(float *x, float target, float maxMove, float deadZone) {
+    float diff = target - *x;
+    if (fabsf(diff) <= deadZone) return;
+    *x += diff > 0 ? fminf(maxMove, diff) : -fminf(maxMove, -diff);
+}
+
+void PongAIUpdate(GameState *game, const PongLayout *layout, PongSide side, float dt) {
+    PongAIState *ai = &game->ai[side];
+    bool top = side == PONG_TOP;
+    PongVec2 *paddle = top ? &game->topPaddle : &game->bottomPaddle;
+
+    // Ball moving away: drift back to the centre, a little slower than when chasing
+    if (top ? game->ballVelocity.y >= 0 : game->ballVelocity.y <= 0) {
+        float centerX = layout->width / 2.0f - layout->paddleWidth / 2.0f;
+        MoveTowards(&paddle->x, centerX, ai->paddleSpeed * 0.7f * dt, 5.0f);
+        return;
+    }
+
+    // New approach: one error sample and one reaction delay, not one per tick
+    bool newApproach = ai->approach != game->approach;
+    if (newApproach) {
+        ai->approach = game->approach;
+        ai->error = (float)PongRandomRange(game, -100, 100) / 100.0f * layout->width * ai->predictionError;
+        ai->reactionLeft = ai->reactionDelay;
+    }
+    // A relayout keeps this approach's error sample and only re-runs the prediction
+    if (newApproach || ai->field.x != layout->width || ai->field.y != layout->height) {
+        float r = layout->ballSize / 2.0f;
+        float faceY = top ? paddle->y + layout->paddleHeight + r : paddle->y - r;
+        float targetX = PongPredictX(game, layout, faceY) + ai->error - layout->paddleWidth / 2.0f;
+        ai->targetX = fmaxf(0, fminf(targetX, layout->width - layout->paddleWidth));
+        ai->field = (PongVec2){ layout->width, layout->height };
+    }
+
+    if (ai->reactionLeft > 0) {
+        ai->reactionLeft -= dt;
+        return;
+    }
+    MoveTowards(&paddle->x, ai->targetX, ai->paddleSpeed * dt, 1.0f);
+}
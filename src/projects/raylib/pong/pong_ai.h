@@ -0,0 +1,29 @@
+// pong_ai.h
+// Paddle AI, for either side. The landing point is predicted in closed form (the ball's
+// x path is folded back into the field instead of simulated bounce by bounce) once per
+// approach, together with one aim error sample, so the per-tick cost is constant.
+#ifndef PONG_AI_H
+#define PONG_AI_H
+
+#include "pong_sim.h"
+
+// Tuning for one difficulty level
+typedef struct PongAIProfile {
+    const char *name;
+    float paddleSpeed;       // px/s
+    float reactionDelay;     // seconds between a new approach and the first move
+    float predictionError;   // max aim error as a fraction of the screen width
+} PongAIProfile;
+
+extern const PongAIProfile pongAIProfiles[PONG_AI_LEVEL_COUNT];
+
+// Ball centre x when it reaches height y on its current course, wall bounces included.
+// Returns the current x when the ball is not moving towards y.
+float PongPredictX(const GameState *game, const PongLayout *layout, float y);
+
+// Loads a difficulty's tuning; the fields can be overridden afterwards (see tools/selfplay.c)
+void PongAISetDifficulty(GameState *game, PongSide side, PongDifficulty difficulty);
+// Moves one paddle for one tick
+void PongAIUpdate(GameState *game, const PongLayout *layout, PongSide side, float dt);
+
+#endif // PONG_AI_H
@@ -0,0 +1,327 @@
+// pong_chaos.c
+#include "pong_chaos.h"
+#include "prof.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PONG_PI 3.14159265358979323846f
+#define MAX_BALL_SPEED (BALL_SPEED * 1.5f)  // as PaddleBounce limits the real ball
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define CHAOS_SIMD_NAME "simd128"
+typedef v128_t F4;
+#define F4Load(p) wasm_v128_load(p)
+#define F4Store(p, v) wasm_v128_store((p), (v))
+#define F4Set1(x) wasm_f32x4_splat(x)
+#define F4Add(a, b) wasm_f32x4_add((a), (b))
+#define F4Mul(a, b) wasm_f32x4_mul((a), (b))
+#define F4Min(a, b) wasm_f32x4_pmin((a), (b))
+#define F4Max(a, b) wasm_f32x4_pmax((a), (b))
+#define F4Lt(a, b) wasm_f32x4_lt((a), (b))
+#define F4Gt(a, b) wasm_f32x4_gt((a), (b))
+#define F4Or(a, b) wasm_v128_or((a), (b))
+#define F4Abs(a) wasm_f32x4_abs(a)
+#define F4NegAbs(a) wasm_v128_or((a), wasm_f32x4_splat(-0.0f))
+#define F4Select(mask, a, b) wasm_v128_bitselect((a), (b), (mask))
+#define F4Mask(a) wasm_i32x4_bitmask(a)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CHAOS_SIMD_NAME "sse2"
+typedef __m128 F4;
+#define F4Load(p) _mm_loadu_ps(p)
+#define F4Store(p, v) _mm_storeu_ps((p), (v))
+#define F4Set1(x) _mm_set1_ps(x)
+#define F4Add(a, b) _mm_add_ps((a), (b))
+#define F4Mul(a, b) _mm_mul_ps((a), (b))
+#define F4Min(a, b) _mm_min_ps((a), (b))
+#define F4Max(a, b) _mm_max_ps((a), (b))
+#define F4Lt(a, b) _mm_cmplt_ps((a), (b))
+#define F4Gt(a, b) _mm_cmpgt_ps((a), (b))
+#define F4Or(a, b) _mm_or_ps((a), (b))
+#define F4Abs(a) _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+#define F4NegAbs(a) _mm_or_ps((a), _mm_set1_ps(-0.0f))
+#define F4Select(mask, a, b) _mm_or_ps(_mm_and_ps((mask), (a)), _mm_andnot_ps((mask), (b)))
+#define F4Mask(a) _mm_movemask_ps(a)
+#endif
+
+const char *PongChaosSimdName(void) {
+#ifdef CHAOS_SIMD_NAME
+    return CHAOS_SIMD_NAME;
+#else
+    return "scalar";
+#endif
+}
+
+float PongChaosBallSize(const PongLayout *layout) {
+    return fmaxf(layout->ballSize * PONG_CHAOS_BALL_RATIO, 2.0f);
+}
+
+bool PongChaosInit(PongChaos *c, int capacity, uint64_t seed) {
+    *c = (PongChaos){0};
+    if (capacity < 1) capacity = 1;
+    if (capacity > PONG_CHAOS_MAX_BALLS) capacity = PONG_CHAOS_MAX_BALLS;
+    capacity = (capacity + 3) & ~3;
+    c->block = malloc((size_t)capacity * 12 * sizeof(float));
+    c->cellOf = malloc((size_t)capacity * sizeof(int));
+    if (!c->block || !c->cellOf) {
+        PongChaosFree(c);
+        return false;
+    }
+    float **arrays[12] = { &c->x, &c->y, &c->vx, &c->vy, &c->prevX, &c->prevY,
+                           &c->sorted[0], &c->sorted[1], &c->sorted[2], &c->sorted[3], &c->sorted[4], &c->sorted[5] };
+    for (int i = 0; i < 12; i++) *arrays[i] = c->block + (size_t)i * (size_t)capacity;
+    c->capacity = capacity;
+    c->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    return true;
+}
+
+void PongChaosFree(PongChaos *c) {
+    free(c->block);
+    free(c->cellOf);
+    free(c->cellStart);
+    *c = (PongChaos){0};
+}
+
+static uint32_t NextRandom(PongChaos *c) {
+    uint64_t x = c->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    c->rng = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static float RandomUnit(PongChaos *c) {
+    return (float)(NextRandom(c) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Somewhere in the middle third, heading up or down no flatter than 30 degrees
+static void Spawn(PongChaos *c, const PongLayout *layout, int i) {
+    float r = PongChaosBallSize(layout) / 2.0f;
+    float angle = PONG_PI / 6.0f + RandomUnit(c) * (PONG_PI * 2.0f / 3.0f);
+    c->x[i] = r + RandomUnit(c) * (layout->width - 2.0f * r);
+    c->y[i] = layout->height * (1.0f / 3.0f + RandomUnit(c) / 3.0f);
+    c->vx[i] = cosf(angle) * BALL_SPEED;
+    c->vy[i] = sinf(angle) * BALL_SPEED * ((NextRandom(c) & 1) ? 1.0f : -1.0f);
+    c->prevX[i] = c->x[i];
+    c->prevY[i] = c->y[i];
+}
+
+void PongChaosResize(PongChaos *c, const PongLayout *layout, int count) {
+    if (count < 0) count = 0;
+    if (count > c->capacity) count = c->capacity;
+    for (int i = c->count; i < count; i++) Spawn(c, layout, i);
+    c->count = count;
+}
+
+static void Escape(PongChaos *c, const PongLayout *layout, int i) {
+    c->escaped[c->y[i] < 0 ? PONG_TOP : PONG_BOTTOM]++;
+    Spawn(c, layout, i);
+}
+
+//------------------------------------------------------------------------------------
+// Move and side walls
+//------------------------------------------------------------------------------------
+static void MoveOne(PongChaos *c, const PongLayout *layout, int i, float dt, float lo, float hi) {
+    c->prevX[i] = c->x[i];
+    c->prevY[i] = c->y[i];
+    float x = c->x[i] + c->vx[i] * dt;
+    c->y[i] += c->vy[i] * dt;
+    if (x < lo) c->vx[i] = fabsf(c->vx[i]);
+    if (x > hi) c->vx[i] = -fabsf(c->vx[i]);
+    c->x[i] = fminf(fmaxf(x, lo), hi);
+    if (c->y[i] < 0 || c->y[i] > layout->height) Escape(c, layout, i);
+}
+
+// Four balls at a time; the few that left the field this tick are respawned one by one
+static void Move(PongChaos *c, const PongLayout *layout, float dt) {
+    float r = PongChaosBallSize(layout) / 2.0f;
+    float lo = r, hi = layout->width - r;
+    int n = c->count, i = 0;
+#ifdef CHAOS_SIMD_NAME
+    F4 step = F4Set1(dt), left = F4Set1(lo), right = F4Set1(hi);
+    F4 top = F4Set1(0.0f), bottom = F4Set1(layout->height);
+    for (; i + 4 <= n; i += 4) {
+        F4 x = F4Load(c->x + i), y = F4Load(c->y + i);
+        F4 vx = F4Load(c->vx + i), vy = F4Load(c->vy + i);
+        F4Store(c->prevX + i, x);
+        F4Store(c->prevY + i, y);
+        x = F4Add(x, F4Mul(vx, step));
+        y = F4Add(y, F4Mul(vy, step));
+        vx = F4Select(F4Lt(x, left), F4Abs(vx), vx);
+        vx = F4Select(F4Gt(x, right), F4NegAbs(vx), vx);
+        F4Store(c->x + i, F4Min(F4Max(x, left), right));
+        F4Store(c->y + i, y);
+        F4Store(c->vx + i, vx);
+        int out = F4Mask(F4Or(F4Lt(y, top), F4Gt(y, bottom)));
+        for (int lane = 0; out; lane++, out >>= 1) {
+            if (out & 1) Escape(c, layout, i + lane);
+        }
+    }
+#endif
+    for (; i < n; i++) MoveOne(c, layout, i, dt, lo, hi);
+}
+
+//------------------------------------------------------------------------------------
+// Grid
+//------------------------------------------------------------------------------------
+static bool PrepareGrid(PongChaos *c, const PongLayout *layout) {
+    if (c->cellStart && c->field.width == layout->width && c->field.height == layout->height &&
+        c->field.ballSize == layout->ballSize) return true;
+    float cell = PongChaosBallSize(layout);    // touching balls are never more than a cell apart
+    int cols = (int)ceilf(layout->width / cell), rows = (int)ceilf(layout->height / cell);
+    if (cols < 1) cols = 1;
+    if (rows < 1) rows = 1;
+    int cells = cols * rows;
+    if (cells + 1 > c->cellCapacity) {
+        int *cellStart = realloc(c->cellStart, (size_t)(cells + 1) * sizeof(int));
+        if (!cellStart) return false;
+        c->cellStart = cellStart;
+        c->cellCapacity = cells + 1;
+    }
+    c->field = *layout;
+    c->cols = cols;
+    c->rows = rows;
+    c->cellSize = cell;
+    return true;
+}
+
+static inline int CellCoord(float v, float inv, int size) {
+    int i = (int)(v * inv);
+    return i < 0 ? 0 : i >= size ? size - 1 : i;
+}
+
+// Counting sort by cell, carrying all six arrays into cell order
+static void Regrid(PongChaos *c) {
+    int cells = c->cols * c->rows;
+    float inv = 1.0f / c->cellSize;
+    int *start = c->cellStart;
+    memset(start, 0, (size_t)(cells + 1) * sizeof(int));
+    for (int i = 0; i < c->count; i++) {
+        int cell = CellCoord(c->y[i], inv, c->rows) * c->cols + CellCoord(c->x[i], inv, c->cols);
+        c->cellOf[i] = cell;
+        start[cell + 1]++;
+    }
+    for (int cell = 0; cell < cells; cell++) start[cell + 1] += start[cell];
+
+    // start[cell] runs up to the next cell's start while scattering, then shifts back
+    float **from[6] = { &c->x, &c->y, &c->vx, &c->vy, &c->prevX, &c->prevY };
+    float *x = c->sorted[0], *y = c->sorted[1], *vx = c->sorted[2], *vy = c->sorted[3];
+    float *px = c->sorted[4], *py = c->sorted[5];
+    for (int i = 0; i < c->count; i++) {
+        int to = start[c->cellOf[i]]++;
+        x[to] = c->x[i];
+        y[to] = c->y[i];
+        vx[to] = c->vx[i];
+        vy[to] = c->vy[i];
+        px[to] = c->prevX[i];
+        py[to] = c->prevY[i];
+    }
+    memmove(start + 1, start, (size_t)cells * sizeof(int));
+    start[0] = 0;
+    for (int k = 0; k < 6; k++) {
+        float *old = *from[k];
+        *from[k] = c->sorted[k];
+        c->sorted[k] = old;
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Paddles
+//------------------------------------------------------------------------------------
+// Only the cells under the paddle grown by a ball radius; the bounce is PaddleBounce's
+static void HitPaddle(PongChaos *c, const PongLayout *layout, const PongVec2 *paddle, bool top) {
+    float r = PongChaosBallSize(layout) / 2.0f, inv = 1.0f / c->cellSize;
+    float left = paddle->x - r, right = paddle->x + layout->paddleWidth + r;
+    float upper = paddle->y - r, lower = paddle->y + layout->paddleHeight + r;
+    int col0 = CellCoord(left, inv, c->cols), col1 = CellCoord(right, inv, c->cols);
+    int row0 = CellCoord(upper, inv, c->rows), row1 = CellCoord(lower, inv, c->rows);
+    for (int row = row0; row <= row1; row++) {
+        int end = c->cellStart[row * c->cols + col1 + 1];
+        for (int i = c->cellStart[row * c->cols + col0]; i < end; i++) {
+            if (c->x[i] < left || c->x[i] > right || c->y[i] < upper || c->y[i] > lower) continue;
+            if (top ? c->vy[i] >= 0 : c->vy[i] <= 0) continue;       // already on its way out
+            c->vy[i] = -c->vy[i];
+            c->y[i] = top ? lower : upper;
+            float spin = ((c->x[i] - paddle->x) / layout->paddleWidth - 0.5f) * 2.0f;
+            c->vx[i] += spin * 100.0f;
+            float speed = sqrtf(c->vx[i] * c->vx[i] + c->vy[i] * c->vy[i]);
+            if (speed > MAX_BALL_SPEED) {
+                c->vx[i] *= MAX_BALL_SPEED / speed;
+                c->vy[i] *= MAX_BALL_SPEED / speed;
+            }
+            c->paddleHits++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Ball against ball
+//------------------------------------------------------------------------------------
+// Equal masses: an elastic hit swaps the velocity components along the line between the
+// centres. Overlapping balls are pushed apart either way, so none stay stuck together
+static inline bool Contact(PongChaos *c, int a, int b, float diameter) {
+    float dx = c->x[b] - c->x[a], dy = c->y[b] - c->y[a];
+    float d2 = dx * dx + dy * dy;
+    if (d2 >= diameter * diameter || d2 <= 0.0f) return false;
+    float approach = (c->vx[b] - c->vx[a]) * dx + (c->vy[b] - c->vy[a]) * dy;
+    if (approach < 0) {
+        float k = approach / d2;
+        c->vx[a] += k * dx;
+        c->vy[a] += k * dy;
+        c->vx[b] -= k * dx;
+        c->vy[b] -= k * dy;
+    }
+    float d = sqrtf(d2);
+    float push = (diameter - d) / d * 0.5f;
+    c->x[a] -= dx * push;
+    c->y[a] -= dy * push;
+    c->x[b] += dx * push;
+    c->y[b] += dy * push;
+    return true;
+}
+
+// Each pair once: a ball meets the rest of its cell and the cell to the right, which are
+// one run of the arrays, then the three cells below, which are another
+static void Collide(PongChaos *c, float diameter) {
+    const int *start = c->cellStart;
+    int cols = c->cols;
+    uint32_t tested = 0, contacts = 0;
+    for (int row = 0; row < c->rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            int cell = row * cols + col;
+            int first = start[cell], last = start[cell + 1];
+            if (first == last) continue;
+            int sideEnd = start[cell + (col + 1 < cols ? 2 : 1)];
+            int belowFrom = 0, belowTo = 0;
+            if (row + 1 < c->rows) {
+                int below = (row + 1) * cols;
+                belowFrom = start[below + (col > 0 ? col - 1 : 0)];
+                belowTo = start[below + (col + 1 < cols ? col + 1 : col) + 1];
+            }
+            for (int a = first; a < last; a++) {
+                for (int b = a + 1; b < sideEnd; b++) contacts += Contact(c, a, b, diameter);
+                for (int b = belowFrom; b < belowTo; b++) contacts += Contact(c, a, b, diameter);
+                tested += (uint32_t)(sideEnd - a - 1 + belowTo - belowFrom);
+            }
+        }
+    }
+    c->pairsTested = tested;
+    c->contacts = contacts;
+}
+
+void PongChaosStep(PongChaos *c, const PongLayout *layout, const PongVec2 *topPaddle,
+                   const PongVec2 *bottomPaddle, float dt) {
+    c->pairsTested = c->contacts = c->paddleHits = 0;
+    if (c->count == 0 || !PrepareGrid(c, layout)) return;
+    PROF_SCOPE("chaos move") Move(c, layout, dt);
+    PROF_SCOPE("chaos grid") Regrid(c);
+    PROF_SCOPE("chaos paddles") {
+        HitPaddle(c, layout, topPaddle, true);
+        HitPaddle(c, layout, bottomPaddle, false);
+    }
+    PROF_SCOPE("chaos contacts") Collide(c, PongChaosBallSize(layout));
+    c->ballUpdates += (uint64_t)c->count;
+}
@@ -0,0 +1,60 @@
+// pong_chaos.h
+// Chaos mode: thousands of extra balls in the field, bouncing off the walls, the paddles
+// and each other. The balls are stored struct-of-arrays, so the move-and-wall pass runs
+// four balls per instruction (wasm SIMD128 or SSE2, scalar otherwise). Paddle and ball
+// contacts go through a uniform grid of ball-sized cells: every tick the balls are
+// re-sorted by cell, so a cell and its right and lower neighbours are contiguous runs of
+// the arrays and no pair is tested that is more than a cell apart.
+//
+// The chaos balls never touch GameState: the real game, its recording and its replays
+// carry on underneath unchanged. Like the rest of the simulation this does not depend on
+// raylib, so chaos_bench runs it headless.
+#ifndef PONG_CHAOS_H
+#define PONG_CHAOS_H
+
+#include "pong_sim.h"
+
+#define PONG_CHAOS_MAX_BALLS 65536
+#define PONG_CHAOS_BALL_RATIO 0.4f         // of the real ball's size: ten thousand full-size
+                                           // balls would more than cover the field
+
+typedef struct PongChaos {
+    int count, capacity;
+    float *x, *y, *vx, *vy;
+    float *prevX, *prevY;              // a tick ago, for drawing between ticks
+    float *sorted[6];                  // the six arrays above in cell order, swapped in each tick
+    float *block;                      // the one allocation behind all twelve
+
+    // Grid over the field the balls last stepped in; cell c holds balls
+    // cellStart[c] .. cellStart[c + 1] - 1, row-major
+    PongLayout field;
+    int cols, rows;
+    float cellSize;
+    int *cellStart;
+    int *cellOf;                       // per ball, for the counting sort
+    int cellCapacity;
+
+    uint64_t rng;
+
+    // The last tick
+    uint32_t pairsTested, contacts, paddleHits;
+    // Since PongChaosInit
+    uint64_t escaped[PONG_SIDE_COUNT];     // balls that got past each side's paddle
+    uint64_t ballUpdates;
+} PongChaos;
+
+bool PongChaosInit(PongChaos *c, int capacity, uint64_t seed);
+void PongChaosFree(PongChaos *c);
+// Adds or drops balls to reach count (capped at capacity); new ones start at random points
+// in the middle of the field, heading for one of the paddles
+void PongChaosResize(PongChaos *c, const PongLayout *layout, int count);
+// One tick: move and bounce off the walls, re-grid, paddles, then ball against ball. A
+// ball that leaves past a paddle counts in escaped and comes back in the middle
+void PongChaosStep(PongChaos *c, const PongLayout *layout, const PongVec2 *topPaddle,
+                   const PongVec2 *bottomPaddle, float dt);
+// Diameter of a chaos ball, never under 2 px
+float PongChaosBallSize(const PongLayout *layout);
+// "simd128", "sse2" or "scalar": what the move pass was built with
+const char *PongChaosSimdName(void);
+
+#endif // PONG_CHAOS_H
@@ -0,0 +1,492 @@
+// pong_net.c
+#include "pong_net.h"
+#include <math.h>
+#include <string.h>
+
+#define SMALL_DELTA_BITS 4
+#define MEDIUM_DELTA_BITS 8
+#define POS_BITS 16
+#define VEL_BITS 12
+#define VEL_BIAS (1 << (VEL_BITS - 1))
+#define TARGET_BIAS 32768
+#define BASE_AGO_BITS 5                    // PONG_NET_HISTORY - 1 fits
+#define INPUT_COUNT_BITS 6                 // PONG_NET_MAX_INPUTS fits
+#define SEQ_BITS 16                        // input messages carry sequence numbers cut to this
+
+//------------------------------------------------------------------------------------
+// Bit streams
+//------------------------------------------------------------------------------------
+void PongBitsBeginWrite(PongBitWriter *w, uint8_t *bytes, size_t capacity) {
+    *w = (PongBitWriter){ .bytes = bytes, .capacity = capacity };
+}
+
+void PongBitsWrite(PongBitWriter *w, uint32_t value, int bits) {
+    if (bits < 32) value &= (1u << bits) - 1;
+    w->acc |= (uint64_t)value << w->bits;
+    w->bits += bits;
+    while (w->bits >= 8) {
+        if (w->size < w->capacity) w->bytes[w->size++] = (uint8_t)w->acc;
+        else w->overflow = true;
+        w->acc >>= 8;
+        w->bits -= 8;
+    }
+}
+
+size_t PongBitsFinish(PongBitWriter *w) {
+    if (w->bits > 0) PongBitsWrite(w, 0, 8 - w->bits);
+    return w->overflow ? 0 : w->size;
+}
+
+void PongBitsBeginRead(PongBitReader *r, const uint8_t *bytes, size_t size) {
+    *r = (PongBitReader){ .bytes = bytes, .size = size };
+}
+
+uint32_t PongBitsRead(PongBitReader *r, int bits) {
+    while (r->bits < bits) {
+        if (r->pos < r->size) r->acc |= (uint64_t)r->bytes[r->pos++] << r->bits;
+        else r->overflow = true;
+        r->bits += 8;
+    }
+    uint32_t value = (uint32_t)(bits < 32 ? r->acc & ((1u << bits) - 1) : r->acc);
+    r->acc >>= bits;
+    r->bits -= bits;
+    return value;
+}
+
+//------------------------------------------------------------------------------------
+// Field codecs
+//------------------------------------------------------------------------------------
+static uint32_t ZigZag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t UnZigZag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static int32_t Clamp(int32_t v, int32_t lo, int32_t hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// '0' as predicted; '10' and '110' a small or medium zigzagged difference; '111' the
+// value itself in rawBits, offset by bias
+static void WriteDelta(PongBitWriter *w, int32_t value, int32_t predicted, int rawBits, int32_t bias) {
+    if (value == predicted) {
+        PongBitsWrite(w, 0, 1);
+        return;
+    }
+    uint32_t zz = ZigZag(value - predicted);
+    PongBitsWrite(w, 1, 1);
+    if (zz < (1u << SMALL_DELTA_BITS)) {
+        PongBitsWrite(w, 0, 1);
+        PongBitsWrite(w, zz, SMALL_DELTA_BITS);
+        return;
+    }
+    PongBitsWrite(w, 1, 1);
+    if (zz < (1u << MEDIUM_DELTA_BITS)) {
+        PongBitsWrite(w, 0, 1);
+        PongBitsWrite(w, zz, MEDIUM_DELTA_BITS);
+        return;
+    }
+    PongBitsWrite(w, 1, 1);
+    PongBitsWrite(w, (uint32_t)(value + bias), rawBits);
+}
+
+static int32_t ReadDelta(PongBitReader *r, int32_t predicted, int rawBits, int32_t bias) {
+    if (!PongBitsRead(r, 1)) return predicted;
+    if (!PongBitsRead(r, 1)) return predicted + UnZigZag(PongBitsRead(r, SMALL_DELTA_BITS));
+    if (!PongBitsRead(r, 1)) return predicted + UnZigZag(PongBitsRead(r, MEDIUM_DELTA_BITS));
+    return (int32_t)PongBitsRead(r, rawBits) - bias;
+}
+
+// Delta against the base when there is one, raw otherwise
+static void WriteField(PongBitWriter *w, bool hasBase, int32_t value, int32_t predicted, int rawBits, int32_t bias) {
+    if (hasBase) WriteDelta(w, value, predicted, rawBits, bias);
+    else PongBitsWrite(w, (uint32_t)(value + bias), rawBits);
+}
+
+static int32_t ReadField(PongBitReader *r, bool hasBase, int32_t predicted, int rawBits, int32_t bias) {
+    return hasBase ? ReadDelta(r, predicted, rawBits, bias) : (int32_t)PongBitsRead(r, rawBits) - bias;
+}
+
+static int32_t Quantize(float v) {
+    return Clamp((int32_t)lrintf(v * PONG_NET_POS_SCALE), 0, (1 << POS_BITS) - 1);
+}
+
+// Where the base's velocity carries its ball by tick; integer math, so both ends agree
+static void PredictBall(const PongSnapshot *base, uint32_t tick, int32_t *x, int32_t *y) {
+    int64_t ticks = (int64_t)(tick - base->tick);
+    *x = base->ballX + (int32_t)((int64_t)base->ballVX * PONG_NET_POS_SCALE * ticks / PONG_TICK_RATE);
+    *y = base->ballY + (int32_t)((int64_t)base->ballVY * PONG_NET_POS_SCALE * ticks / PONG_TICK_RATE);
+}
+
+//------------------------------------------------------------------------------------
+// Snapshots
+//------------------------------------------------------------------------------------
+void PongSnapshotCapture(PongSnapshot *s, const GameState *game, uint32_t seq) {
+    s->seq = seq;
+    s->tick = game->tick;
+    s->paddleX[PONG_TOP] = Quantize(game->topPaddle.x);
+    s->paddleX[PONG_BOTTOM] = Quantize(game->bottomPaddle.x);
+    s->ballX = Quantize(game->ball.x);
+    s->ballY = Quantize(game->ball.y);
+    s->ballVX = Clamp((int32_t)lrintf(game->ballVelocity.x), -VEL_BIAS, VEL_BIAS - 1);
+    s->ballVY = Clamp((int32_t)lrintf(game->ballVelocity.y), -VEL_BIAS, VEL_BIAS - 1);
+    s->score[PONG_TOP] = (uint8_t)game->topScore;
+    s->score[PONG_BOTTOM] = (uint8_t)game->bottomScore;
+    s->started = game->gameStarted;
+}
+
+size_t PongSnapshotEncode(const PongSnapshot *s, const PongSnapshot *base, uint32_t inputAck,
+                          const PongNetStream *stream, uint8_t *out, size_t capacity) {
+    if (capacity < 1) return 0;
+    out[0] = NET_SNAPSHOT;
+    PongBitWriter w;
+    PongBitsBeginWrite(&w, out + 1, capacity - 1);
+
+    bool nextSeq = s->seq == stream->lastSeq + 1;
+    PongBitsWrite(&w, nextSeq, 1);
+    if (!nextSeq) PongBitsWrite(&w, s->seq, 32);
+
+    bool hasBase = base && s->seq - base->seq < PONG_NET_HISTORY && s->seq != base->seq;
+    PongBitsWrite(&w, hasBase, 1);
+    if (hasBase) {
+        PongBitsWrite(&w, s->seq - base->seq, BASE_AGO_BITS);
+        bool expected = s->tick == base->tick + (s->seq - base->seq) * PONG_NET_SNAPSHOT_TICKS;
+        PongBitsWrite(&w, expected, 1);
+        if (!expected) PongBitsWrite(&w, s->tick, 32);
+    } else {
+        PongBitsWrite(&w, s->tick, 32);
+    }
+
+    int32_t ballX = 0, ballY = 0;
+    if (hasBase) PredictBall(base, s->tick, &ballX, &ballY);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++)
+        WriteField(&w, hasBase, s->paddleX[side], hasBase ? base->paddleX[side] : 0, POS_BITS, 0);
+    WriteField(&w, hasBase, s->ballVX, hasBase ? base->ballVX : 0, VEL_BITS, VEL_BIAS);
+    WriteField(&w, hasBase, s->ballVY, hasBase ? base->ballVY : 0, VEL_BITS, VEL_BIAS);
+    WriteField(&w, hasBase, s->ballX, ballX, POS_BITS, 0);
+    WriteField(&w, hasBase, s->ballY, ballY, POS_BITS, 0);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        bool changed = !hasBase || s->score[side] != base->score[side];
+        if (hasBase) PongBitsWrite(&w, changed, 1);
+        if (changed) PongBitsWrite(&w, s->score[side], 8);
+    }
+    PongBitsWrite(&w, s->started, 1);
+    WriteDelta(&w, (int32_t)inputAck, (int32_t)stream->lastAck, 32, 0);
+
+    size_t size = PongBitsFinish(&w);
+    return size ? size + 1 : 0;
+}
+
+bool PongSnapshotDecode(const uint8_t *msg, size_t size, PongNetStream *stream,
+                        const PongSnapshot history[PONG_NET_HISTORY], PongSnapshot *out, uint32_t *inputAck) {
+    if (size < 1 || msg[0] != NET_SNAPSHOT) return false;
+    PongBitReader r;
+    PongBitsBeginRead(&r, msg + 1, size - 1);
+
+    PongSnapshot s = {0};
+    s.seq = PongBitsRead(&r, 1) ? stream->lastSeq + 1 : PongBitsRead(&r, 32);
+    const PongSnapshot *base = NULL;
+    if (PongBitsRead(&r, 1)) {
+        uint32_t ago = PongBitsRead(&r, BASE_AGO_BITS);
+        base = &history[(s.seq - ago) % PONG_NET_HISTORY];
+        if (ago == 0 || base->seq != s.seq - ago) return false;
+        s.tick = PongBitsRead(&r, 1) ? base->tick + ago * PONG_NET_SNAPSHOT_TICKS : PongBitsRead(&r, 32);
+    } else {
+        s.tick = PongBitsRead(&r, 32);
+    }
+
+    bool hasBase = base != NULL;
+    int32_t ballX = 0, ballY = 0;
+    if (hasBase) PredictBall(base, s.tick, &ballX, &ballY);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++)
+        s.paddleX[side] = ReadField(&r, hasBase, hasBase ? base->paddleX[side] : 0, POS_BITS, 0);
+    s.ballVX = ReadField(&r, hasBase, hasBase ? base->ballVX : 0, VEL_BITS, VEL_BIAS);
+    s.ballVY = ReadField(&r, hasBase, hasBase ? base->ballVY : 0, VEL_BITS, VEL_BIAS);
+    s.ballX = ReadField(&r, hasBase, ballX, POS_BITS, 0);
+    s.ballY = ReadField(&r, hasBase, ballY, POS_BITS, 0);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        bool changed = !hasBase || PongBitsRead(&r, 1);
+        s.score[side] = changed ? (uint8_t)PongBitsRead(&r, 8) : base->score[side];
+    }
+    s.started = PongBitsRead(&r, 1);
+    uint32_t ack = (uint32_t)ReadDelta(&r, (int32_t)stream->lastAck, 32, 0);
+    if (r.overflow || s.seq == 0) return false;
+
+    stream->lastSeq = s.seq;
+    stream->lastAck = ack;
+    *out = s;
+    *inputAck = ack;
+    return true;
+}
+
+bool PongSnapshotHasBase(const uint8_t *msg, size_t size) {
+    PongBitReader r;
+    PongBitsBeginRead(&r, msg + 1, size > 0 ? size - 1 : 0);
+    if (!PongBitsRead(&r, 1)) PongBitsRead(&r, 32);
+    return PongBitsRead(&r, 1) && !r.overflow;
+}
+
+//------------------------------------------------------------------------------------
+// Other messages
+//------------------------------------------------------------------------------------
+size_t PongNetWriteJoin(uint8_t *out, size_t capacity) {
+    if (capacity < 2) return 0;
+    out[0] = NET_JOIN;
+    out[1] = PONG_NET_VERSION;
+    return 2;
+}
+
+size_t PongNetWriteWelcome(uint8_t *out, size_t capacity, PongSide side, uint8_t match, int width, int height) {
+    if (capacity < 7) return 0;
+    out[0] = NET_WELCOME;
+    out[1] = (uint8_t)side;
+    out[2] = match;
+    out[3] = (uint8_t)width;
+    out[4] = (uint8_t)(width >> 8);
+    out[5] = (uint8_t)height;
+    out[6] = (uint8_t)(height >> 8);
+    return 7;
+}
+
+void PongNetQuantizeInput(PongInput *input) {
+    int32_t q = Clamp((int32_t)lrintf(input->targetX * PONG_NET_POS_SCALE), -TARGET_BIAS, TARGET_BIAS - 1);
+    input->targetX = (float)q / PONG_NET_POS_SCALE;
+}
+
+static bool SameInput(const PongInput *a, const PongInput *b) {
+    return a->start == b->start && a->left == b->left && a->right == b->right && a->hasTarget == b->hasTarget &&
+           (!a->hasTarget || a->targetX == b->targetX);
+}
+
+// A held key or a still mouse repeats the previous input, which costs one bit; a moving
+// target is coded against the previous one
+size_t PongNetWriteInputs(const PongNetInputs *in, uint8_t *out, size_t capacity) {
+    if (capacity < 1 || in->count < 0 || in->count > PONG_NET_MAX_INPUTS) return 0;
+    out[0] = NET_INPUT;
+    PongBitWriter w;
+    PongBitsBeginWrite(&w, out + 1, capacity - 1);
+    PongBitsWrite(&w, in->match, 8);
+    PongBitsWrite(&w, in->ackSeq, SEQ_BITS);
+    PongBitsWrite(&w, in->firstSeq, SEQ_BITS);
+    PongBitsWrite(&w, (uint32_t)in->count, INPUT_COUNT_BITS);
+
+    PongInput prev = {0};
+    for (int i = 0; i < in->count; i++) {
+        const PongInput *input = &in->inputs[i];
+        bool same = SameInput(input, &prev);
+        PongBitsWrite(&w, same, 1);
+        if (!same) {
+            PongBitsWrite(&w, input->start, 1);
+            PongBitsWrite(&w, input->left, 1);
+            PongBitsWrite(&w, input->right, 1);
+            PongBitsWrite(&w, input->hasTarget, 1);
+            if (input->hasTarget) {
+                int32_t target = (int32_t)lrintf(input->targetX * PONG_NET_POS_SCALE);
+                int32_t prevTarget = (int32_t)lrintf(prev.targetX * PONG_NET_POS_SCALE);
+                WriteDelta(&w, target, prevTarget, 16, TARGET_BIAS);
+            }
+            prev = *input;
+            if (!prev.hasTarget) prev.targetX = 0.0f;      // what the reader makes of it
+        }
+    }
+    size_t size = PongBitsFinish(&w);
+    return size ? size + 1 : 0;
+}
+
+// The value with these low SEQ_BITS that is nearest to near
+static uint32_t WidenSeq(uint32_t low, uint32_t near) {
+    return near + (uint32_t)(int16_t)(uint16_t)(low - near);
+}
+
+bool PongNetReadInputs(const uint8_t *msg, size_t size, uint32_t nextSeq, uint32_t snapshotSeq, PongNetInputs *out) {
+    if (size < 1 || msg[0] != NET_INPUT) return false;
+    PongBitReader r;
+    PongBitsBeginRead(&r, msg + 1, size - 1);
+    out->match = (uint8_t)PongBitsRead(&r, 8);
+    out->ackSeq = WidenSeq(PongBitsRead(&r, SEQ_BITS), snapshotSeq);
+    out->firstSeq = WidenSeq(PongBitsRead(&r, SEQ_BITS), nextSeq);
+    out->count = (int)PongBitsRead(&r, INPUT_COUNT_BITS);
+    if (out->count > PONG_NET_MAX_INPUTS) return false;
+
+    PongInput prev = { .difficulty = -1 };
+    for (int i = 0; i < out->count; i++) {
+        PongInput input = prev;
+        if (!PongBitsRead(&r, 1)) {
+            input.start = PongBitsRead(&r, 1);
+            input.left = PongBitsRead(&r, 1);
+            input.right = PongBitsRead(&r, 1);
+            input.hasTarget = PongBitsRead(&r, 1);
+            int32_t prevTarget = (int32_t)lrintf(prev.targetX * PONG_NET_POS_SCALE);
+            input.targetX = input.hasTarget ? (float)ReadDelta(&r, prevTarget, 16, TARGET_BIAS) / PONG_NET_POS_SCALE : 0.0f;
+        }
+        out->inputs[i] = input;
+        prev = input;
+    }
+    return !r.overflow;
+}
+
+//------------------------------------------------------------------------------------
+// Client
+//------------------------------------------------------------------------------------
+static void CountBytes(PongNetStats *s, size_t in, size_t out, double nowMs) {
+    s->bytesIn += in;
+    s->bytesOut += out;
+    s->windowIn += in;
+    s->windowOut += out;
+    if (s->windowStartMs <= 0) s->windowStartMs = nowMs;
+    double elapsed = nowMs - s->windowStartMs;
+    if (elapsed >= 1000.0) {
+        s->inPerSecond = (float)(s->windowIn * 1000.0 / elapsed);
+        s->outPerSecond = (float)(s->windowOut * 1000.0 / elapsed);
+        s->windowIn = s->windowOut = 0;
+        s->windowStartMs = nowMs;
+    }
+}
+
+static float PaddleY(const PongLayout *layout, PongSide side) {
+    return side == PONG_TOP ? layout->paddleMargin : layout->height - layout->paddleMargin - layout->paddleHeight;
+}
+
+void PongNetClientInit(PongNetClient *c) {
+    *c = (PongNetClient){ .nextInput = 1, .unsent = 1 };
+    PongLayoutCompute(&c->layout, PONG_NET_FIELD_WIDTH, PONG_NET_FIELD_HEIGHT);
+}
+
+// A new match: everything but the byte counts starts over
+static void Welcome(PongNetClient *c, PongSide side, uint8_t match, int width, int height) {
+    PongNetStats stats = c->stats;
+    PongNetClientInit(c);
+    c->stats = stats;
+    c->welcomed = true;
+    c->side = side;
+    c->match = match;
+    PongLayoutCompute(&c->layout, width, height);
+    c->predicted = (PongVec2){ c->layout.width / 2.0f - c->layout.paddleWidth / 2.0f, PaddleY(&c->layout, side) };
+}
+
+// The server's paddle as of the acked input, then every input it has not applied yet
+static void Repredict(PongNetClient *c) {
+    if (c->nextInput - c->inputAck > PONG_NET_INPUT_HISTORY) return;    // inputs gone: keep the guess
+    const PongSnapshot *s = &c->snapshots[c->latestSeq % PONG_NET_HISTORY];
+    PongVec2 paddle = { (float)s->paddleX[c->side] / PONG_NET_POS_SCALE, c->predicted.y };
+    for (uint32_t seq = c->inputAck + 1; seq < c->nextInput; seq++)
+        PongMovePaddle(&paddle, &c->layout, &c->inputs[seq % PONG_NET_INPUT_HISTORY], PONG_DT);
+    float correction = fabsf(paddle.x - c->predicted.x);
+    if (correction > c->stats.maxCorrection) c->stats.maxCorrection = correction;
+    c->predicted = paddle;
+}
+
+bool PongNetClientReceive(PongNetClient *c, const uint8_t *msg, size_t size, double nowMs) {
+    if (size < 1) return false;
+    CountBytes(&c->stats, size, 0, nowMs);
+    switch (msg[0]) {
+    case NET_WELCOME:
+        if (size < 7 || msg[1] >= PONG_SIDE_COUNT) return false;
+        Welcome(c, (PongSide)msg[1], msg[2], msg[3] | msg[4] << 8, msg[5] | msg[6] << 8);
+        return true;
+    case NET_OPPONENT_LEFT:
+        c->welcomed = false;
+        c->opponentLeft = true;
+        return true;
+    case NET_SNAPSHOT: {
+        if (!c->welcomed) return true;      // from a match that has just ended
+        PongSnapshot s;
+        uint32_t ack;
+        if (!PongSnapshotDecode(msg, size, &c->stream, c->snapshots, &s, &ack)) return false;
+        c->snapshots[s.seq % PONG_NET_HISTORY] = s;
+        c->stats.snapshots++;
+        if (!PongSnapshotHasBase(msg, size)) c->stats.fullSnapshots++;
+        if (s.seq > c->latestSeq) {
+            c->latestSeq = s.seq;
+            c->latestMs = nowMs;
+        }
+        c->inputAck = ack;
+        Repredict(c);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void PongNetClientTick(PongNetClient *c, const PongInput *input) {
+    if (!c->welcomed) return;
+    PongInput q = *input;
+    PongNetQuantizeInput(&q);
+    q.difficulty = -1;
+    q.bottomAI = false;
+    c->inputs[c->nextInput % PONG_NET_INPUT_HISTORY] = q;
+    c->nextInput++;
+    PongMovePaddle(&c->predicted, &c->layout, &q, PONG_DT);
+}
+
+size_t PongNetClientFlush(PongNetClient *c, uint8_t *out, size_t capacity, double nowMs) {
+    if (!c->welcomed || c->unsent == c->nextInput) return 0;
+    PongNetInputs msg = { .match = c->match, .ackSeq = c->latestSeq, .firstSeq = c->unsent };
+    // Too far behind: the server skips ahead to the newest inputs
+    if (c->nextInput - msg.firstSeq > PONG_NET_MAX_INPUTS) msg.firstSeq = c->nextInput - PONG_NET_MAX_INPUTS;
+    msg.count = (int)(c->nextInput - msg.firstSeq);
+    for (int i = 0; i < msg.count; i++) msg.inputs[i] = c->inputs[(msg.firstSeq + (uint32_t)i) % PONG_NET_INPUT_HISTORY];
+
+    size_t size = PongNetWriteInputs(&msg, out, capacity);
+    if (size) {
+        c->unsent = c->nextInput;
+        CountBytes(&c->stats, 0, size, nowMs);
+    }
+    return size;
+}
+
+static float Lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+void PongNetClientView(const PongNetClient *c, double nowMs, GameState *view) {
+    const PongLayout *layout = &c->layout;
+    *view = (GameState){0};
+    float centerX = layout->width / 2.0f - layout->paddleWidth / 2.0f;
+    view->topPaddle = (PongVec2){ centerX, PaddleY(layout, PONG_TOP) };
+    view->bottomPaddle = (PongVec2){ centerX, PaddleY(layout, PONG_BOTTOM) };
+    view->ball = (PongVec2){ layout->width / 2.0f, layout->height / 2.0f };
+    PongVec2 *own = c->side == PONG_TOP ? &view->topPaddle : &view->bottomPaddle;
+    PongVec2 *other = c->side == PONG_TOP ? &view->bottomPaddle : &view->topPaddle;
+    if (c->welcomed) *own = c->predicted;
+    if (c->latestSeq == 0) return;
+
+    // Snapshots a and b around the render tick, newest first; the oldest one held when the
+    // render tick is older still
+    const PongSnapshot *latest = &c->snapshots[c->latestSeq % PONG_NET_HISTORY];
+    float renderTick = (float)latest->tick + (float)((nowMs - c->latestMs) * PONG_TICK_RATE / 1000.0) -
+                       PONG_NET_INTERP_TICKS;
+    if (renderTick > (float)latest->tick) renderTick = (float)latest->tick;
+    const PongSnapshot *a = latest, *b = latest;
+    for (uint32_t seq = c->latestSeq; seq > 0 && c->latestSeq - seq < PONG_NET_HISTORY; seq--) {
+        const PongSnapshot *s = &c->snapshots[seq % PONG_NET_HISTORY];
+        if (s->seq != seq) break;
+        b = a;
+        a = s;
+        if ((float)s->tick <= renderTick) break;
+    }
+    float t = b->tick > a->tick ? (renderTick - (float)a->tick) / (float)(b->tick - a->tick) : 1.0f;
+    t = fmaxf(0.0f, fminf(t, 1.0f));
+    const PongSnapshot *shown = t >= 1.0f ? b : a;
+
+    // A point or a serve teleports the ball; never interpolate across one
+    bool continuous = a->score[PONG_TOP] == b->score[PONG_TOP] && a->score[PONG_BOTTOM] == b->score[PONG_BOTTOM] &&
+                      a->started == b->started;
+    const float scale = 1.0f / PONG_NET_POS_SCALE;
+    if (continuous) {
+        view->ball.x = Lerp((float)a->ballX, (float)b->ballX, t) * scale;
+        view->ball.y = Lerp((float)a->ballY, (float)b->ballY, t) * scale;
+    } else {
+        view->ball = (PongVec2){ (float)shown->ballX * scale, (float)shown->ballY * scale };
+    }
+    PongSide otherSide = c->side == PONG_TOP ? PONG_BOTTOM : PONG_TOP;
+    other->x = Lerp((float)a->paddleX[otherSide], (float)b->paddleX[otherSide], t) * scale;
+    view->ballVelocity = (PongVec2){ (float)shown->ballVX, (float)shown->ballVY };
+    view->topScore = shown->score[PONG_TOP];
+    view->bottomScore = shown->score[PONG_BOTTOM];
+    view->gameStarted = shown->started;
+    view->tick = (uint32_t)renderTick;
+}
@@ -0,0 +1,162 @@
+// pong_net.h
+// Wire format of two-player pong and the client's half of it. The server owns the match:
+// it runs PongStepVersus at PONG_TICK_RATE and every PONG_NET_SNAPSHOT_TICKS sends each
+// client a snapshot. Clients send their inputs, predict their own paddle from them and
+// draw the ball and the other paddle from snapshots, PONG_NET_INTERP_TICKS behind.
+//
+// Snapshots are bit-packed and delta-coded against the newest snapshot the client has
+// acknowledged: an unchanged field is one bit, a small change a few, and the ball is
+// coded against where the base snapshot's velocity would have carried it, so it costs
+// bits only when it bounces. Without a usable base (first snapshot, or an ack older than
+// PONG_NET_HISTORY) the snapshot goes out whole.
+//
+// Messages are whole WebSocket binary frames starting with a PongNetMessage byte. Nothing
+// in here touches sockets; see pong_ws.h for the native transport.
+#ifndef PONG_NET_H
+#define PONG_NET_H
+
+#include "pong_sim.h"
+#include <stddef.h>
+
+#define PONG_NET_VERSION 1
+#define PONG_NET_PORT 8420
+#define PONG_NET_FIELD_WIDTH 800          // every match plays on this field; clients scale it
+#define PONG_NET_FIELD_HEIGHT 900
+#define PONG_NET_SNAPSHOT_TICKS 4         // 30 snapshots a second
+#define PONG_NET_HISTORY 32               // snapshots kept on both ends, about a second
+#define PONG_NET_INTERP_TICKS (2 * PONG_NET_SNAPSHOT_TICKS)
+#define PONG_NET_MAX_INPUTS 32            // inputs in one NET_INPUT message
+#define PONG_NET_INPUT_HISTORY 128        // client inputs kept for re-prediction
+#define PONG_NET_MAX_MESSAGE 512
+#define PONG_NET_POS_SCALE 8              // positions travel in 1/8 px
+
+typedef enum {
+    NET_JOIN = 1,          // C->S: version byte
+    NET_WELCOME,           // S->C: side, match tag and field size; the match starts
+    NET_SNAPSHOT,          // S->C: bit-packed, see PongSnapshotEncode
+    NET_INPUT,             // C->S: bit-packed PongNetInputs
+    NET_OPPONENT_LEFT      // S->C: the match is over; the client waits for a new one
+} PongNetMessage;
+
+//------------------------------------------------------------------------------------
+// Bit streams, least significant bit first
+//------------------------------------------------------------------------------------
+typedef struct PongBitWriter {
+    uint8_t *bytes;
+    size_t capacity, size;
+    uint64_t acc;
+    int bits;
+    bool overflow;
+} PongBitWriter;
+
+typedef struct PongBitReader {
+    const uint8_t *bytes;
+    size_t size, pos;
+    uint64_t acc;
+    int bits;
+    bool overflow;         // read past the end; values read since are zero
+} PongBitReader;
+
+void PongBitsBeginWrite(PongBitWriter *w, uint8_t *bytes, size_t capacity);
+void PongBitsWrite(PongBitWriter *w, uint32_t value, int bits);     // bits <= 32
+size_t PongBitsFinish(PongBitWriter *w);                            // bytes used, 0 on overflow
+void PongBitsBeginRead(PongBitReader *r, const uint8_t *bytes, size_t size);
+uint32_t PongBitsRead(PongBitReader *r, int bits);
+
+//------------------------------------------------------------------------------------
+// Snapshots
+//------------------------------------------------------------------------------------
+typedef struct PongSnapshot {
+    uint32_t seq;          // per match, from 1; 0 marks an empty history slot
+    uint32_t tick;
+    int32_t paddleX[PONG_SIDE_COUNT];      // PONG_NET_POS_SCALE units
+    int32_t ballX, ballY;
+    int32_t ballVX, ballVY;                // px/s
+    uint8_t score[PONG_SIDE_COUNT];
+    bool started;
+} PongSnapshot;
+
+// What both ends of one connection remember about the snapshots sent over it; a dropped
+// snapshot must not advance the sender's copy
+typedef struct PongNetStream {
+    uint32_t lastSeq;
+    uint32_t lastAck;
+} PongNetStream;
+
+void PongSnapshotCapture(PongSnapshot *s, const GameState *game, uint32_t seq);
+// base is a snapshot the recipient holds, or NULL for a whole one; inputAck is the last of
+// the recipient's inputs the server has applied. Returns the message size, 0 if it does
+// not fit
+size_t PongSnapshotEncode(const PongSnapshot *s, const PongSnapshot *base, uint32_t inputAck,
+                          const PongNetStream *stream, uint8_t *out, size_t capacity);
+// history holds the snapshots received so far by seq % PONG_NET_HISTORY; false when the
+// message is malformed or names a base that is not there
+bool PongSnapshotDecode(const uint8_t *msg, size_t size, PongNetStream *stream,
+                        const PongSnapshot history[PONG_NET_HISTORY], PongSnapshot *out, uint32_t *inputAck);
+// Whether a snapshot message is delta-coded; for bandwidth stats
+bool PongSnapshotHasBase(const uint8_t *msg, size_t size);
+
+//------------------------------------------------------------------------------------
+// Other messages
+//------------------------------------------------------------------------------------
+typedef struct PongNetInputs {
+    uint8_t match;         // tag from NET_WELCOME, so inputs still in flight from an
+                           // earlier match are not taken for this one's
+    uint32_t ackSeq;       // newest snapshot the client holds
+    uint32_t firstSeq;     // input seq of inputs[0]; inputs count from 1
+    int count;
+    PongInput inputs[PONG_NET_MAX_INPUTS];
+} PongNetInputs;
+
+size_t PongNetWriteJoin(uint8_t *out, size_t capacity);
+size_t PongNetWriteWelcome(uint8_t *out, size_t capacity, PongSide side, uint8_t match, int width, int height);
+size_t PongNetWriteInputs(const PongNetInputs *in, uint8_t *out, size_t capacity);
+// The message carries only the low 16 bits of its two sequence numbers; they are widened to
+// the values nearest nextSeq (the input the server expects next) and snapshotSeq (the
+// newest snapshot it has sent)
+bool PongNetReadInputs(const uint8_t *msg, size_t size, uint32_t nextSeq, uint32_t snapshotSeq, PongNetInputs *out);
+// Rounds targetX to what the wire carries, so a prediction runs on the server's input
+void PongNetQuantizeInput(PongInput *input);
+
+//------------------------------------------------------------------------------------
+// Client: prediction, interpolation and bandwidth
+//------------------------------------------------------------------------------------
+typedef struct PongNetStats {
+    uint64_t bytesIn, bytesOut;            // message payloads
+    uint32_t snapshots, fullSnapshots;
+    float inPerSecond, outPerSecond;       // over the last whole second
+    float maxCorrection;   // largest jump of the predicted paddle on a snapshot, px
+    double windowStartMs;
+    uint64_t windowIn, windowOut;
+} PongNetStats;
+
+typedef struct PongNetClient {
+    bool welcomed;         // in a match
+    bool opponentLeft;
+    PongSide side;
+    uint8_t match;
+    PongLayout layout;
+    PongNetStream stream;
+    PongSnapshot snapshots[PONG_NET_HISTORY];
+    uint32_t latestSeq;    // 0 until the first snapshot of the match
+    double latestMs;       // when it arrived
+    uint32_t inputAck;
+    PongInput inputs[PONG_NET_INPUT_HISTORY];      // by input seq % size
+    uint32_t nextInput;    // seq the next tick's input gets
+    uint32_t unsent;       // first input seq not sent yet
+    PongVec2 predicted;    // own paddle after every input so far
+    PongNetStats stats;
+} PongNetClient;
+
+void PongNetClientInit(PongNetClient *c);
+// Handles one message from the server; false if it was malformed
+bool PongNetClientReceive(PongNetClient *c, const uint8_t *msg, size_t size, double nowMs);
+// Records this tick's input and moves the predicted paddle by it
+void PongNetClientTick(PongNetClient *c, const PongInput *input);
+// The NET_INPUT message carrying the inputs not sent yet and the snapshot ack; 0 when
+// there is nothing to send
+size_t PongNetClientFlush(PongNetClient *c, uint8_t *out, size_t capacity, double nowMs);
+// The state to draw at nowMs: the own paddle predicted, the rest interpolated
+void PongNetClientView(const PongNetClient *c, double nowMs, GameState *view);
+
+#endif // PONG_NET_H
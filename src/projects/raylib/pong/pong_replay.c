@@ -0,0 +1,246 @@
+// pong_replay.c
+#include "pong_replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_RECORDING_BYTES (16 * 1024)
+
+//------------------------------------------------------------------------------------
+// Recording
+//------------------------------------------------------------------------------------
+// Makes room for extra more bytes; false once that would pass PONG_REC_MAX_BYTES
+static bool Reserve(PongRecorder *r, size_t extra) {
+    if (r->size + extra > PONG_REC_MAX_BYTES) return false;
+    if (r->size + extra <= r->capacity) return true;
+
+    size_t capacity = r->capacity ? r->capacity : INITIAL_RECORDING_BYTES;
+    while (r->size + extra > capacity) capacity *= 2;
+    uint8_t *bytes = realloc(r->bytes, capacity);
+    if (!bytes) return false;
+    r->bytes = bytes;
+    r->capacity = capacity;
+    return true;
+}
+
+static void PutVarint(PongRecorder *r, uint32_t v) {
+    while (v >= 0x80) {
+        r->bytes[r->size++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    r->bytes[r->size++] = (uint8_t)v;
+}
+
+// Bitwise, so -0 and 0 stay distinct and the replayed paddle is the recorded one exactly
+static bool SameFloat(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static bool SameInput(const PongInput *a, const PongInput *b) {
+    return a->start == b->start && a->left == b->left && a->right == b->right &&
+           a->hasTarget == b->hasTarget && (!a->hasTarget || SameFloat(a->targetX, b->targetX)) &&
+           a->difficulty == b->difficulty && a->bottomAI == b->bottomAI;
+}
+
+// Always fits: every tick leaves PONG_REC_MAX_TICK_BYTES spare
+static void FlushRepeat(PongRecorder *r) {
+    if (r->repeat == 0) return;
+    r->bytes[r->size++] = REC_REPEAT;
+    PutVarint(r, r->repeat);
+    r->repeat = 0;
+}
+
+void PongRecorderBegin(PongRecorder *r, const GameState *game, const PongLayout *layout) {
+    PongRecorderFree(r);
+    PongRecordingHeader header = {
+        .magic = PONG_REC_MAGIC,
+        .stateSize = sizeof(GameState),
+        .width = (uint32_t)layout->width,
+        .height = (uint32_t)layout->height,
+        .start = *game,
+    };
+    if (!Reserve(r, sizeof(header) + 2 * PONG_REC_MAX_TICK_BYTES)) {
+        r->full = true;
+        return;
+    }
+    memcpy(r->bytes, &header, sizeof(header));
+    r->size = sizeof(header);
+    r->width = (int)layout->width;
+    r->height = (int)layout->height;
+}
+
+void PongRecorderTick(PongRecorder *r, const GameState *game, const PongLayout *layout, const PongInput *input) {
+    if (r->full) return;
+    int width = (int)layout->width;
+    int height = (int)layout->height;
+    bool resize = width != r->width || height != r->height;
+    if (r->hasPrev && !resize && SameInput(input, &r->prev)) {
+        r->repeat++;
+        r->ticks++;
+        return;
+    }
+
+    FlushRepeat(r);
+    if (!Reserve(r, 2 * PONG_REC_MAX_TICK_BYTES)) {
+        r->full = true;
+        r->endHash = PongStateHash(game);
+        return;
+    }
+
+    bool newTarget = input->hasTarget && !SameFloat(input->targetX, r->target);
+    uint8_t flags = (input->start ? REC_START : 0) | (input->left ? REC_LEFT : 0) |
+                    (input->right ? REC_RIGHT : 0) | (input->hasTarget ? REC_TARGET : 0) |
+                    (newTarget ? REC_NEW_TARGET : 0) | (input->difficulty >= 0 ? REC_DIFFICULTY : 0) |
+                    (resize ? REC_RESIZE : 0);
+    r->bytes[r->size++] = flags;
+    if (newTarget) {
+        memcpy(r->bytes + r->size, &input->targetX, sizeof(float));
+        r->size += sizeof(float);
+        r->target = input->targetX;
+    }
+    if (input->difficulty >= 0) r->bytes[r->size++] = (uint8_t)input->difficulty;
+    if (resize) {
+        PutVarint(r, (uint32_t)width);
+        PutVarint(r, (uint32_t)height);
+        r->width = width;
+        r->height = height;
+    }
+
+    r->prev = *input;
+    r->hasPrev = true;
+    r->ticks++;
+}
+
+void PongRecorderFinish(PongRecorder *r, const GameState *game) {
+    if (!r->bytes) return;
+    if (!r->full) {
+        FlushRepeat(r);
+        r->endHash = PongStateHash(game);
+    }
+    memcpy(r->bytes + offsetof(PongRecordingHeader, ticks), &r->ticks, sizeof(r->ticks));
+    memcpy(r->bytes + offsetof(PongRecordingHeader, endHash), &r->endHash, sizeof(r->endHash));
+}
+
+void PongRecorderFree(PongRecorder *r) {
+    free(r->bytes);
+    *r = (PongRecorder){0};
+}
+
+//------------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------------
+static bool GetVarint(PongReplay *p, uint32_t *out) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35 && p->pos < p->size; shift += 7) {
+        uint8_t byte = p->bytes[p->pos++];
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PongReplayBegin(PongReplay *p, const uint8_t *bytes, size_t size, GameState *game, PongLayout *layout) {
+    *p = (PongReplay){0};
+    PongRecordingHeader header;
+    if (!bytes || size < sizeof(header)) return false;
+    memcpy(&header, bytes, sizeof(header));
+    if (header.magic != PONG_REC_MAGIC || header.stateSize != sizeof(GameState)) return false;
+    if (header.width == 0 || header.height == 0) return false;
+
+    p->bytes = bytes;
+    p->size = size;
+    p->pos = sizeof(header);
+    p->ticks = header.ticks;
+    p->endHash = header.endHash;
+    p->input.difficulty = -1;
+    *game = header.start;
+    PongLayoutCompute(layout, (int)header.width, (int)header.height);
+    return true;
+}
+
+bool PongReplayNext(PongReplay *p, PongLayout *layout, PongInput *input) {
+    if (p->tick >= p->ticks) return false;
+
+    if (p->repeatLeft > 0) {
+        p->repeatLeft--;
+    } else {
+        if (p->pos >= p->size) return false;
+        uint8_t flags = p->bytes[p->pos++];
+        if (flags == REC_REPEAT) {
+            uint32_t count;
+            if (!GetVarint(p, &count) || count == 0) return false;
+            p->repeatLeft = count - 1;
+        } else {
+            PongInput next = { .difficulty = -1, .targetX = p->input.targetX };
+            next.start = flags & REC_START;
+            next.left = flags & REC_LEFT;
+            next.right = flags & REC_RIGHT;
+            next.hasTarget = flags & REC_TARGET;
+            if (flags & REC_NEW_TARGET) {
+                if (p->pos + sizeof(float) > p->size) return false;
+                memcpy(&next.targetX, p->bytes + p->pos, sizeof(float));
+                p->pos += sizeof(float);
+            }
+            if (flags & REC_DIFFICULTY) {
+                if (p->pos >= p->size) return false;
+                next.difficulty = p->bytes[p->pos++];
+            }
+            if (flags & REC_RESIZE) {
+                uint32_t width, height;
+                if (!GetVarint(p, &width) || !GetVarint(p, &height)) return false;
+                PongLayoutCompute(layout, (int)width, (int)height);
+            }
+            p->input = next;
+        }
+    }
+
+    p->tick++;
+    *input = p->input;
+    return true;
+}
+
+bool PongReplayStep(PongReplay *p, GameState *game, PongLayout *layout) {
+    PongInput input;
+    if (!PongReplayNext(p, layout, &input)) return false;
+    PongStep(game, layout, &input, PONG_DT);
+    return true;
+}
+
+bool PongReplayMatches(const PongReplay *p, const GameState *game) {
+    return PongStateHash(game) == p->endHash;
+}
+
+//------------------------------------------------------------------------------------
+// Rollback
+//------------------------------------------------------------------------------------
+void PongHistoryReset(PongHistory *h) {
+    h->count = 0;
+    h->resimulated = 0;
+}
+
+void PongHistoryStep(PongHistory *h, GameState *game, const PongLayout *layout, const PongInput *input, float dt) {
+    uint32_t slot = game->tick % PONG_ROLLBACK_TICKS;
+    h->states[slot] = *game;
+    h->layouts[slot] = *layout;
+    h->inputs[slot] = *input;
+    if (h->count < PONG_ROLLBACK_TICKS) h->count++;
+    PongStep(game, layout, input, dt);
+}
+
+bool PongHistoryCorrect(PongHistory *h, GameState *game, uint32_t tick, const PongInput *input, float dt) {
+    uint32_t now = game->tick;
+    uint32_t back = now - tick;
+    if (back == 0 || back > h->count) return false;
+
+    h->inputs[tick % PONG_ROLLBACK_TICKS] = *input;
+    *game = h->states[tick % PONG_ROLLBACK_TICKS];
+    for (uint32_t t = tick; t != now; t++) {
+        uint32_t slot = t % PONG_ROLLBACK_TICKS;
+        h->states[slot] = *game;
+        PongStep(game, &h->layouts[slot], &h->inputs[slot], dt);
+        h->resimulated++;
+    }
+    return true;
+}
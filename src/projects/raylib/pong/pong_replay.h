@@ -0,0 +1,113 @@
+// pong_replay.h
+// Per-tick input recording with exact replay, and a ring of state snapshots for rollback.
+//
+// A recording is a header holding the GameState and layout the session started from,
+// followed by the input stream. PongStep is deterministic, so feeding the stream back
+// reproduces the session bit for bit, headless or in the browser.
+//
+// Every tick starts with a flags byte (REC_*). A new target x or a new layout carries its
+// value; a run of ticks whose input equals the previous tick's is one REC_REPEAT byte and
+// a varint count. Idle play costs a few bytes a second, a dragged paddle five bytes a tick.
+//
+// The start state is stored as the in-memory GameState, so a recording only loads in a
+// build with the same struct layout (the wasm32 and x86-64 builds agree); the header keeps
+// sizeof(GameState) and anything else is rejected.
+#ifndef PONG_REPLAY_H
+#define PONG_REPLAY_H
+
+#include "pong_sim.h"
+#include <stddef.h>
+
+#define PONG_REC_MAGIC 0x31434552u         // "REC1"
+#define PONG_REC_MAX_BYTES (16u << 20)     // a recording stops growing here
+#define PONG_REC_MAX_TICK_BYTES 16
+
+enum {
+    REC_START = 1 << 0,
+    REC_LEFT = 1 << 1,
+    REC_RIGHT = 1 << 2,
+    REC_TARGET = 1 << 3,       // hasTarget, using the last target x
+    REC_NEW_TARGET = 1 << 4,   // float targetX follows
+    REC_DIFFICULTY = 1 << 5,   // difficulty byte follows
+    REC_RESIZE = 1 << 6,       // varint width and height follow; applied before the tick
+    REC_REPEAT = 1 << 7        // alone: varint n, the previous tick's input n more times
+};
+
+typedef struct PongRecordingHeader {
+    uint32_t magic;
+    uint32_t stateSize;        // sizeof(GameState) of the recording build
+    uint32_t width, height;    // layout the session started with
+    uint32_t ticks;
+    uint32_t reserved;
+    uint64_t endHash;          // PongStateHash after the last recorded tick
+    GameState start;
+} PongRecordingHeader;
+
+//------------------------------------------------------------------------------------
+// Recording
+//------------------------------------------------------------------------------------
+typedef struct PongRecorder {
+    uint8_t *bytes;            // header, then the input stream
+    size_t size, capacity;
+    bool full;                 // hit PONG_REC_MAX_BYTES; later ticks are not recorded
+    uint32_t ticks;
+    uint32_t repeat;           // ticks pending in the current REC_REPEAT run
+    bool hasPrev;
+    PongInput prev;
+    float target;              // last target x written
+    int width, height;         // layout of the last recorded tick
+    uint64_t endHash;          // set when the recording filled up
+} PongRecorder;
+
+void PongRecorderBegin(PongRecorder *r, const GameState *game, const PongLayout *layout);
+// Records the tick about to run; game is the state before it
+void PongRecorderTick(PongRecorder *r, const GameState *game, const PongLayout *layout, const PongInput *input);
+// Closes the pending run and stamps the tick count and game's hash into the header.
+// Recording may continue afterwards
+void PongRecorderFinish(PongRecorder *r, const GameState *game);
+void PongRecorderFree(PongRecorder *r);
+
+//------------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------------
+typedef struct PongReplay {
+    const uint8_t *bytes;
+    size_t size, pos;
+    uint32_t ticks, tick;
+    uint32_t repeatLeft;
+    PongInput input;           // input of the tick last decoded
+    uint64_t endHash;
+} PongReplay;
+
+// Checks the header and loads the starting state and layout; false if bytes is not a
+// recording this build can play
+bool PongReplayBegin(PongReplay *p, const uint8_t *bytes, size_t size, GameState *game, PongLayout *layout);
+// Decodes the next tick's input, applying any relayout; false at the end (or on a
+// truncated stream)
+bool PongReplayNext(PongReplay *p, PongLayout *layout, PongInput *input);
+// PongReplayNext followed by PongStep
+bool PongReplayStep(PongReplay *p, GameState *game, PongLayout *layout);
+// True when game matches the state the recording ended with
+bool PongReplayMatches(const PongReplay *p, const GameState *game);
+
+//------------------------------------------------------------------------------------
+// Rollback: the state, layout and input of the last PONG_ROLLBACK_TICKS ticks
+//------------------------------------------------------------------------------------
+#define PONG_ROLLBACK_TICKS 64     // about half a second at PONG_TICK_RATE
+
+typedef struct PongHistory {
+    GameState states[PONG_ROLLBACK_TICKS];     // state before the tick, by tick % size
+    PongLayout layouts[PONG_ROLLBACK_TICKS];
+    PongInput inputs[PONG_ROLLBACK_TICKS];
+    uint32_t count;                            // ticks before game->tick that can be redone
+    uint64_t resimulated;                      // ticks re-run by corrections so far
+} PongHistory;
+
+void PongHistoryReset(PongHistory *h);
+// Saves the tick about to run, then runs it
+void PongHistoryStep(PongHistory *h, GameState *game, const PongLayout *layout, const PongInput *input, float dt);
+// Replaces the input an earlier tick ran with and re-simulates up to the present; false
+// if that tick is no longer in the window
+bool PongHistoryCorrect(PongHistory *h, GameState *game, uint32_t tick, const PongInput *input, float dt);
+
+#endif // PONG_REPLAY_H
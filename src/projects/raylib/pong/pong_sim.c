@@ -0,0 +1,261 @@
+// pong_sim.c
+#include "pong_sim.h"
+#include "pong_ai.h"
+#include <math.h>
+#include <stddef.h>
+
+#define PONG_PI 3.14159265358979323846f
+#define MAX_SWEEP_EVENTS 8      // wall/paddle hits resolved within a single step
+
+void PongLayoutCompute(PongLayout *layout, int screenWidth, int screenHeight) {
+    layout->width = (float)screenWidth;
+    layout->height = (float)screenHeight;
+    layout->paddleWidth = (float)(int)(screenWidth * PADDLE_WIDTH_RATIO);
+    layout->paddleHeight = (float)(int)(screenHeight * PADDLE_HEIGHT_RATIO);
+    layout->ballSize = (float)(int)(screenHeight * BALL_SIZE_RATIO);
+    layout->paddleMargin = (float)(int)(screenHeight * PADDLE_MARGIN_RATIO);
+
+    // Ensure minimum sizes
+    if (layout->paddleWidth < 50) layout->paddleWidth = 50;
+    if (layout->paddleHeight < 10) layout->paddleHeight = 10;
+    if (layout->ballSize < 8) layout->ballSize = 8;
+    if (layout->paddleMargin < 20) layout->paddleMargin = 20;
+}
+
+void PongInit(GameState *game, const PongLayout *layout, uint64_t seed) {
+    *game = (GameState){0};
+    game->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) PongAISetDifficulty(game, (PongSide)side, PONG_AI_NORMAL);
+    game->topPaddle = (PongVec2){ layout->width / 2.0f - layout->paddleWidth / 2.0f, layout->paddleMargin };
+    game->bottomPaddle = (PongVec2){ layout->width / 2.0f - layout->paddleWidth / 2.0f,
+                                     layout->height - layout->paddleMargin - layout->paddleHeight };
+    PongResetBall(game, layout);
+}
+
+uint32_t PongRandom(GameState *game) {
+    uint64_t x = game->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    game->rng = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+int PongRandomRange(GameState *game, int min, int max) {
+    return min + (int)(PongRandom(game) % (uint32_t)(max - min + 1));
+}
+
+void PongResetBall(GameState *game, const PongLayout *layout) {
+    game->ball = (PongVec2){ layout->width / 2.0f, layout->height / 2.0f };
+
+    // Random direction for ball (primarily vertical)
+    float angle = (float)PongRandomRange(game, 0, 360) * (PONG_PI / 180.0f);
+    game->ballVelocity = (PongVec2){ cosf(angle) * BALL_SPEED, sinf(angle) * BALL_SPEED };
+
+    // Ensure ball doesn't go too horizontal
+    if (fabsf(game->ballVelocity.y) < BALL_SPEED * 0.3f) {
+        game->ballVelocity.y = (game->ballVelocity.y > 0 ? 1 : -1) * BALL_SPEED * 0.7f;
+        game->ballVelocity.x = (game->ballVelocity.x > 0 ? 1 : -1) * BALL_SPEED * 0.7f;
+    }
+
+    game->gameStarted = false;
+    game->approach++;
+}
+
+typedef enum { HIT_NONE, HIT_WALL, HIT_TOP_PADDLE, HIT_BOTTOM_PADDLE } HitKind;
+
+// Time until the ball's leading edge reaches faceY, or -1 if it will not within limit.
+// A ball already inside the paddle band (py..py+ph) counts as hitting now, as the old
+// overlap test did.
+static float PaddleHitTime(const GameState *game, const PongLayout *layout, const PongVec2 *paddle,
+                           bool top, float limit) {
+    float r = layout->ballSize / 2.0f;
+    float vy = game->ballVelocity.y;
+    if (top ? vy >= 0 : vy <= 0) return -1;
+
+    float faceY = top ? paddle->y + layout->paddleHeight + r : paddle->y - r;
+    float t = (faceY - game->ball.y) / vy;
+    if (t < 0) {
+        // Leading edge already past the face: a hit only while still within the paddle
+        float edge = top ? game->ball.y - r : game->ball.y + r;
+        if (edge < paddle->y || edge > paddle->y + layout->paddleHeight) return -1;
+        t = 0;
+    }
+    if (t > limit) return -1;
+
+    float x = game->ball.x + game->ballVelocity.x * t;
+    if (x + r < paddle->x || x - r > paddle->x + layout->paddleWidth) return -1;
+    return t;
+}
+
+static void PaddleBounce(GameState *game, const PongLayout *layout, const PongVec2 *paddle) {
+    game->ballVelocity.y = -game->ballVelocity.y;
+    game->approach++;
+
+    // Add spin based on where ball hits paddle
+    float hitPos = (game->ball.x - paddle->x) / layout->paddleWidth; // 0 to 1
+    float spin = (hitPos - 0.5f) * 2.0f; // -1 to 1
+    game->ballVelocity.x += spin * 100.0f;
+
+    // Limit ball velocity
+    float speed = sqrtf(game->ballVelocity.x * game->ballVelocity.x + game->ballVelocity.y * game->ballVelocity.y);
+    if (speed > BALL_SPEED * 1.5f) {
+        game->ballVelocity.x = (game->ballVelocity.x / speed) * BALL_SPEED * 1.5f;
+        game->ballVelocity.y = (game->ballVelocity.y / speed) * BALL_SPEED * 1.5f;
+    }
+}
+
+void PongStepBall(GameState *game, const PongLayout *layout, float dt) {
+    float r = layout->ballSize / 2.0f;
+    float remaining = dt;
+
+    // Resolve hits in time order, so a fast ball cannot skip a paddle between ticks
+    for (int event = 0; event < MAX_SWEEP_EVENTS && remaining > 0; event++) {
+        float vx = game->ballVelocity.x;
+        float best = remaining;
+        HitKind kind = HIT_NONE;
+
+        float wallT = -1;
+        if (vx > 0) wallT = (layout->width - r - game->ball.x) / vx;
+        else if (vx < 0) wallT = (r - game->ball.x) / vx;
+        if (vx != 0 && wallT < 0) wallT = 0;        // already outside: bounce back now
+        if (wallT >= 0 && wallT <= best) { best = wallT; kind = HIT_WALL; }
+
+        float t = PaddleHitTime(game, layout, &game->topPaddle, true, best);
+        if (t >= 0 && (kind == HIT_NONE || t < best)) { best = t; kind = HIT_TOP_PADDLE; }
+        t = PaddleHitTime(game, layout, &game->bottomPaddle, false, best);
+        if (t >= 0 && (kind == HIT_NONE || t < best)) { best = t; kind = HIT_BOTTOM_PADDLE; }
+
+        game->ball.x += game->ballVelocity.x * best;
+        game->ball.y += game->ballVelocity.y * best;
+        remaining -= best;
+
+        if (kind == HIT_NONE) break;
+        if (kind == HIT_WALL) {
+            game->ballVelocity.x = -game->ballVelocity.x;
+            game->ball.x = fmaxf(r, fminf(game->ball.x, layout->width - r));
+        } else if (kind == HIT_TOP_PADDLE) {
+            game->ball.y = game->topPaddle.y + layout->paddleHeight + r;
+            PaddleBounce(game, layout, &game->topPaddle);
+        } else {
+            game->ball.y = game->bottomPaddle.y - r;
+            PaddleBounce(game, layout, &game->bottomPaddle);
+        }
+    }
+
+    // Score points
+    if (game->ball.y < 0) {
+        game->bottomScore++;
+        PongResetBall(game, layout);
+    } else if (game->ball.y > layout->height) {
+        game->topScore++;
+        PongResetBall(game, layout);
+    }
+}
+
+void PongStep(GameState *game, const PongLayout *layout, const PongInput *input, float dt) {
+    float screenWidth = layout->width;
+    float screenHeight = layout->height;
+
+    if (input->start) game->gameStarted = true;
+    if (input->difficulty >= 0) PongAISetDifficulty(game, PONG_TOP, (PongDifficulty)input->difficulty);
+
+    // Update AI-controlled paddles
+    if (game->gameStarted) {
+        PongAIUpdate(game, layout, PONG_TOP, dt);
+        if (input->bottomAI) PongAIUpdate(game, layout, PONG_BOTTOM, dt);
+    }
+
+    // Update bottom paddle (Left/Right arrow keys, then touch/mouse target)
+    if (!input->bottomAI) {
+        if (input->left && game->bottomPaddle.x > 0) {
+            game->bottomPaddle.x -= PADDLE_SPEED * dt;
+        }
+        if (input->right && game->bottomPaddle.x + layout->paddleWidth < screenWidth) {
+            game->bottomPaddle.x += PADDLE_SPEED * dt;
+        }
+        if (input->hasTarget) game->bottomPaddle.x = input->targetX;
+    }
+
+    // Update ball if game has started
+    if (game->gameStarted) {
+        PongStepBall(game, layout, dt);
+    } else {
+        // Keep ball centered when game hasn't started
+        game->ball = (PongVec2){screenWidth / 2.0f, screenHeight / 2.0f};
+    }
+
+    // Keep paddles in bounds
+    if (game->topPaddle.x < 0) game->topPaddle.x = 0;
+    if (game->topPaddle.x + layout->paddleWidth > screenWidth) game->topPaddle.x = screenWidth - layout->paddleWidth;
+    if (game->topPaddle.y < 0) game->topPaddle.y = 0;
+
+    if (game->bottomPaddle.x < 0) game->bottomPaddle.x = 0;
+    if (game->bottomPaddle.x + layout->paddleWidth > screenWidth) game->bottomPaddle.x = screenWidth - layout->paddleWidth;
+    // Ensure bottom paddle stays at bottom (always update Y position based on screen height)
+    game->bottomPaddle.y = screenHeight - layout->paddleMargin - layout->paddleHeight;
+    game->tick++;
+}
+
+void PongMovePaddle(PongVec2 *paddle, const PongLayout *layout, const PongInput *input, float dt) {
+    if (input->left) paddle->x -= PADDLE_SPEED * dt;
+    if (input->right) paddle->x += PADDLE_SPEED * dt;
+    if (input->hasTarget) paddle->x = input->targetX;
+    if (paddle->x + layout->paddleWidth > layout->width) paddle->x = layout->width - layout->paddleWidth;
+    if (paddle->x < 0) paddle->x = 0;
+}
+
+void PongStepVersus(GameState *game, const PongLayout *layout, const PongInput inputs[PONG_SIDE_COUNT], float dt) {
+    if (inputs[PONG_TOP].start || inputs[PONG_BOTTOM].start) game->gameStarted = true;
+
+    // Paddles first, so the ball sweeps against where the players put them this tick
+    PongMovePaddle(&game->topPaddle, layout, &inputs[PONG_TOP], dt);
+    PongMovePaddle(&game->bottomPaddle, layout, &inputs[PONG_BOTTOM], dt);
+    game->topPaddle.y = layout->paddleMargin;
+    game->bottomPaddle.y = layout->height - layout->paddleMargin - layout->paddleHeight;
+
+    if (game->gameStarted) {
+        PongStepBall(game, layout, dt);
+    } else {
+        game->ball = (PongVec2){ layout->width / 2.0f, layout->height / 2.0f };
+    }
+    game->tick++;
+}
+
+static uint64_t HashBytes(uint64_t h, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+#define HASH_FIELD(h, field) ((h) = HashBytes((h), &(field), sizeof(field)))
+
+uint64_t PongStateHash(const GameState *game) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    HASH_FIELD(h, game->topPaddle);
+    HASH_FIELD(h, game->bottomPaddle);
+    HASH_FIELD(h, game->ball);
+    HASH_FIELD(h, game->ballVelocity);
+    HASH_FIELD(h, game->topScore);
+    HASH_FIELD(h, game->bottomScore);
+    HASH_FIELD(h, game->gameStarted);
+    HASH_FIELD(h, game->rng);
+    HASH_FIELD(h, game->tick);
+    HASH_FIELD(h, game->approach);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        const PongAIState *ai = &game->ai[side];
+        HASH_FIELD(h, ai->difficulty);
+        HASH_FIELD(h, ai->paddleSpeed);
+        HASH_FIELD(h, ai->reactionDelay);
+        HASH_FIELD(h, ai->predictionError);
+        HASH_FIELD(h, ai->approach);
+        HASH_FIELD(h, ai->field);
+        HASH_FIELD(h, ai->error);
+        HASH_FIELD(h, ai->targetX);
+        HASH_FIELD(h, ai->reactionLeft);
+    }
+    return h;
+}
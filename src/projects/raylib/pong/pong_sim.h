@@ -0,0 +1,109 @@
+// pong_sim.h
+// Deterministic pong physics: fixed timestep, swept (continuous) ball collisions and
+// an RNG that lives in the game state. Nothing in here may depend on raylib or
+// emscripten, so the same code runs in the browser and headless.
+#ifndef PONG_SIM_H
+#define PONG_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Game constants (proportional to screen size)
+#define PADDLE_WIDTH_RATIO 0.15f  // Paddle width as % of screen width
+#define PADDLE_HEIGHT_RATIO 0.015f  // Paddle height as % of screen height
+#define BALL_SIZE_RATIO 0.012f  // Ball size as % of screen height
+#define PADDLE_SPEED 700.0f
+#define BALL_SPEED 600.0f
+#define PADDLE_MARGIN_RATIO 0.04f  // Margin as % of screen height
+
+// Simulation rate; rendering interpolates between the last two ticks
+#define PONG_TICK_RATE 120
+#define PONG_DT (1.0f / PONG_TICK_RATE)
+
+typedef struct PongVec2 {
+    float x, y;
+} PongVec2;
+
+// Play-field dimensions derived from the screen size
+typedef struct PongLayout {
+    float width, height;
+    float paddleWidth, paddleHeight;
+    float ballSize;
+    float paddleMargin;
+} PongLayout;
+
+// AI strength; see pong_ai.h
+typedef enum {
+    PONG_AI_EASY,
+    PONG_AI_NORMAL,
+    PONG_AI_HARD,
+    PONG_AI_LEVEL_COUNT
+} PongDifficulty;
+
+typedef enum { PONG_TOP, PONG_BOTTOM, PONG_SIDE_COUNT } PongSide;
+
+// Paddle AI memory and tuning. Lives in the game state so the AI stays deterministic with it
+typedef struct PongAIState {
+    PongDifficulty difficulty;
+    float paddleSpeed;     // tuning, copied from the difficulty profile
+    float reactionDelay;
+    float predictionError;
+    uint32_t approach;     // game approach the cached prediction belongs to
+    PongVec2 field;        // layout size it was made for; a resize re-predicts
+    float error;           // aim error sampled once per approach, in pixels
+    float targetX;         // paddle x to steer to
+    float reactionLeft;    // seconds before the paddle starts moving
+} PongAIState;
+
+// Game state
+typedef struct GameState {
+    PongVec2 topPaddle;
+    PongVec2 bottomPaddle;
+    PongVec2 ball;
+    PongVec2 ballVelocity;
+    int topScore;
+    int bottomScore;
+    bool gameStarted;
+    uint64_t rng;          // xorshift64* state; the only source of randomness
+    uint32_t tick;
+    uint32_t approach;     // bumped on every serve and paddle hit, i.e. whenever the ball's
+                           // course changes other than by a wall bounce
+    PongAIState ai[PONG_SIDE_COUNT];
+} GameState;
+
+// Everything a tick reads from the outside world
+typedef struct PongInput {
+    bool start;
+    bool left, right;      // bottom paddle keys
+    bool hasTarget;
+    float targetX;         // desired bottom paddle x (left edge); the step keeps it in bounds
+    int difficulty;        // PongDifficulty for the top AI to switch to, or -1
+    bool bottomAI;         // bottom paddle driven by the AI instead of the fields above
+} PongInput;
+
+void PongLayoutCompute(PongLayout *layout, int screenWidth, int screenHeight);
+
+void PongInit(GameState *game, const PongLayout *layout, uint64_t seed);
+uint32_t PongRandom(GameState *game);
+int PongRandomRange(GameState *game, int min, int max);     // inclusive, like GetRandomValue
+void PongResetBall(GameState *game, const PongLayout *layout);
+
+// One fixed tick of the whole game: AI, paddles and ball. Pure: reads only its arguments
+void PongStep(GameState *game, const PongLayout *layout, const PongInput *input, float dt);
+
+// Two-player tick: each paddle follows its own input's left/right/target fields (in field
+// coordinates, whichever way the player sees the field), the AI stays idle and either
+// player's start serves. The networked game runs this on the server
+void PongStepVersus(GameState *game, const PongLayout *layout, const PongInput inputs[PONG_SIDE_COUNT], float dt);
+// A paddle's move for one tick, kept inside the field; what the versus tick does to each
+// paddle, so a client can predict its own
+void PongMovePaddle(PongVec2 *paddle, const PongLayout *layout, const PongInput *input, float dt);
+
+// FNV-1a over every field (never the padding), for comparing runs that should match
+uint64_t PongStateHash(const GameState *game);
+
+// Advances the ball by dt with swept wall and paddle collisions (paddles are treated as
+// static during the step), then scores and resets it if it left the field
+void PongStepBall(GameState *game, const PongLayout *layout, float dt);
+
+#endif // PONG_SIM_H
@@ -0,0 +1,378 @@
+// pong_ws.c
+#include "pong_ws.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+enum { OP_CONTINUATION = 0x0, OP_TEXT = 0x1, OP_BINARY = 0x2, OP_CLOSE = 0x8, OP_PING = 0x9, OP_PONG = 0xA };
+
+//------------------------------------------------------------------------------------
+// SHA-1 and base64, for the accept key only
+//------------------------------------------------------------------------------------
+static uint32_t Rol(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+static void Sha1Block(uint32_t h[5], const uint8_t *p) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) w[i] = (uint32_t)p[i * 4] << 24 | (uint32_t)p[i * 4 + 1] << 16 | (uint32_t)p[i * 4 + 2] << 8 | p[i * 4 + 3];
+    for (int i = 16; i < 80; i++) w[i] = Rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+        uint32_t t = Rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = Rol(b, 30);
+        b = a;
+        a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void Sha1(const uint8_t *data, size_t size, uint8_t digest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    size_t whole = size & ~(size_t)63;
+    for (size_t i = 0; i < whole; i += 64) Sha1Block(h, data + i);
+    uint8_t tail[128] = {0};
+    size_t rest = size - whole;
+    memcpy(tail, data + whole, rest);
+    tail[rest] = 0x80;
+    size_t tailSize = rest < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)size * 8;
+    for (int i = 0; i < 8; i++) tail[tailSize - 1 - i] = (uint8_t)(bits >> (i * 8));
+    for (size_t i = 0; i < tailSize; i += 64) Sha1Block(h, tail + i);
+    for (int i = 0; i < 20; i++) digest[i] = (uint8_t)(h[i / 4] >> (24 - (i % 4) * 8));
+}
+
+static void Base64(const uint8_t *data, size_t size, char *out) {
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16 | (i + 1 < size ? (uint32_t)data[i + 1] << 8 : 0) | (i + 2 < size ? data[i + 2] : 0);
+        out[o++] = digits[v >> 18 & 63];
+        out[o++] = digits[v >> 12 & 63];
+        out[o++] = i + 1 < size ? digits[v >> 6 & 63] : '=';
+        out[o++] = i + 2 < size ? digits[v & 63] : '=';
+    }
+    out[o] = '\0';
+}
+
+// Sec-WebSocket-Accept for a Sec-WebSocket-Key
+static void AcceptKey(const char *key, size_t keyLen, char out[32]) {
+    char joined[128];
+    if (keyLen > sizeof(joined) - sizeof(WS_GUID)) keyLen = sizeof(joined) - sizeof(WS_GUID);
+    memcpy(joined, key, keyLen);
+    memcpy(joined + keyLen, WS_GUID, sizeof(WS_GUID) - 1);
+    uint8_t digest[20];
+    Sha1((const uint8_t *)joined, keyLen + sizeof(WS_GUID) - 1, digest);
+    Base64(digest, sizeof(digest), out);
+}
+
+//------------------------------------------------------------------------------------
+// Sockets
+//------------------------------------------------------------------------------------
+static void Configure(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static void Open(PongWs *ws, int fd, bool isClient) {
+    ws->fd = fd;
+    ws->isClient = isClient;
+    ws->state = WS_HANDSHAKE;
+    ws->inSize = ws->consumed = ws->outSize = 0;
+    ws->accept[0] = '\0';
+    ws->maskState = (uint32_t)fd * 2654435761u ^ (uint32_t)time(NULL);
+    if (ws->maskState == 0) ws->maskState = 1;
+    ws->bytesIn = ws->bytesOut = 0;
+    Configure(fd);
+}
+
+int PongWsListen(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port), .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 256) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+bool PongWsAccept(int listenFd, PongWs *ws) {
+    int fd = accept(listenFd, NULL, NULL);
+    if (fd < 0) return false;
+    Open(ws, fd, false);
+    return true;
+}
+
+static bool Queue(PongWs *ws, const void *data, size_t size) {
+    if (ws->outSize + size > sizeof(ws->out)) return false;
+    memcpy(ws->out + ws->outSize, data, size);
+    ws->outSize += size;
+    return true;
+}
+
+bool PongWsConnect(PongWs *ws, const char *host, int port) {
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM }, *found;
+    if (getaddrinfo(host, service, &hints, &found) != 0) return false;
+    int fd = -1;
+    for (struct addrinfo *a = found; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) return false;
+    Open(ws, fd, true);
+
+    // The key only has to be unique per connection, not secret
+    uint8_t nonce[16];
+    for (int i = 0; i < 16; i++) {
+        ws->maskState ^= ws->maskState << 13;
+        ws->maskState ^= ws->maskState >> 17;
+        ws->maskState ^= ws->maskState << 5;
+        nonce[i] = (uint8_t)ws->maskState;
+    }
+    char key[32], request[256];
+    Base64(nonce, sizeof(nonce), key);
+    AcceptKey(key, strlen(key), ws->accept);
+    int size = snprintf(request, sizeof(request),
+                        "GET / HTTP/1.1\r\nHost: %s:%d\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n", host, port, key);
+    return Queue(ws, request, (size_t)size) && PongWsFlush(ws);
+}
+
+bool PongWsRead(PongWs *ws) {
+    if (ws->state == WS_CLOSED) return false;
+    if (ws->consumed > 0) {
+        memmove(ws->in, ws->in + ws->consumed, ws->inSize - ws->consumed);
+        ws->inSize -= ws->consumed;
+        ws->consumed = 0;
+    }
+    while (ws->inSize < sizeof(ws->in)) {
+        ssize_t got = recv(ws->fd, ws->in + ws->inSize, sizeof(ws->in) - ws->inSize, 0);
+        if (got > 0) {
+            ws->inSize += (size_t)got;
+            ws->bytesIn += (uint64_t)got;
+        } else if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            break;
+        } else {
+            ws->state = WS_CLOSED;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PongWsFlush(PongWs *ws) {
+    if (ws->state == WS_CLOSED && ws->outSize == 0) return false;
+    size_t sent = 0;
+    while (sent < ws->outSize) {
+        ssize_t n = send(ws->fd, ws->out + sent, ws->outSize - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            break;
+        } else {
+            ws->state = WS_CLOSED;
+            ws->outSize = 0;
+            return false;
+        }
+    }
+    ws->bytesOut += sent;
+    memmove(ws->out, ws->out + sent, ws->outSize - sent);
+    ws->outSize -= sent;
+    return ws->state != WS_CLOSED;
+}
+
+bool PongWsWantsWrite(const PongWs *ws) {
+    return ws->outSize > 0;
+}
+
+void PongWsClose(PongWs *ws) {
+    if (ws->fd >= 0) close(ws->fd);
+    ws->fd = -1;
+    ws->state = WS_CLOSED;
+    ws->outSize = 0;
+}
+
+//------------------------------------------------------------------------------------
+// Framing
+//------------------------------------------------------------------------------------
+static bool SendFrame(PongWs *ws, int opcode, const uint8_t *payload, size_t size) {
+    uint8_t header[14];
+    size_t h = 0;
+    header[h++] = (uint8_t)(0x80 | opcode);
+    uint8_t maskBit = ws->isClient ? 0x80 : 0;
+    if (size < 126) {
+        header[h++] = (uint8_t)(maskBit | size);
+    } else if (size < 65536) {
+        header[h++] = maskBit | 126;
+        header[h++] = (uint8_t)(size >> 8);
+        header[h++] = (uint8_t)size;
+    } else {
+        header[h++] = maskBit | 127;
+        for (int i = 7; i >= 0; i--) header[h++] = (uint8_t)((uint64_t)size >> (i * 8));
+    }
+    uint8_t mask[4] = {0};
+    if (ws->isClient) {
+        ws->maskState ^= ws->maskState << 13;
+        ws->maskState ^= ws->maskState >> 17;
+        ws->maskState ^= ws->maskState << 5;
+        memcpy(mask, &ws->maskState, 4);
+        memcpy(header + h, mask, 4);
+        h += 4;
+    }
+    if (ws->outSize + h + size > sizeof(ws->out)) return false;
+    Queue(ws, header, h);
+    uint8_t *dst = ws->out + ws->outSize;
+    for (size_t i = 0; i < size; i++) dst[i] = payload[i] ^ mask[i & 3];
+    ws->outSize += size;
+    return true;
+}
+
+bool PongWsSend(PongWs *ws, const uint8_t *msg, size_t size) {
+    return ws->state == WS_OPEN && SendFrame(ws, OP_BINARY, msg, size);
+}
+
+// The value of an HTTP header in the request or response, case-insensitively
+static const char *FindHeader(const char *head, const char *name, size_t *len) {
+    size_t nameLen = strlen(name);
+    for (const char *line = strstr(head, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+        const char *p = line + 2;
+        if (strncasecmp(p, name, nameLen) != 0 || p[nameLen] != ':') continue;
+        p += nameLen + 1;
+        while (*p == ' ') p++;
+        const char *end = strstr(p, "\r\n");
+        *len = end ? (size_t)(end - p) : strlen(p);
+        return p;
+    }
+    return NULL;
+}
+
+static void Handshake(PongWs *ws) {
+    uint8_t *start = ws->in + ws->consumed;
+    size_t avail = ws->inSize - ws->consumed;
+    uint8_t *end = NULL;
+    for (size_t i = 0; i + 4 <= avail; i++) {
+        if (memcmp(start + i, "\r\n\r\n", 4) == 0) {
+            end = start + i + 4;
+            break;
+        }
+    }
+    if (!end) {
+        if (ws->inSize == sizeof(ws->in)) ws->state = WS_CLOSED;     // headers too big
+        return;
+    }
+    char head[PONG_WS_IN_SIZE + 1];
+    size_t headSize = (size_t)(end - start);
+    memcpy(head, start, headSize);
+    head[headSize] = '\0';
+    ws->consumed += headSize;
+
+    size_t len;
+    const char *value;
+    if (ws->isClient) {
+        value = FindHeader(head, "Sec-WebSocket-Accept", &len);
+        bool ok = strncmp(head, "HTTP/1.1 101", 12) == 0 && value && len == strlen(ws->accept) &&
+                  memcmp(value, ws->accept, len) == 0;
+        ws->state = ok ? WS_OPEN : WS_CLOSED;
+        return;
+    }
+    value = FindHeader(head, "Sec-WebSocket-Key", &len);
+    if (strncmp(head, "GET ", 4) != 0 || !value) {
+        static const char refused[] = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+        Queue(ws, refused, sizeof(refused) - 1);
+        ws->state = WS_CLOSED;
+        return;
+    }
+    char accept[32], response[192];
+    AcceptKey(value, len, accept);
+    int size = snprintf(response, sizeof(response),
+                        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    Queue(ws, response, (size_t)size);
+    ws->state = WS_OPEN;
+}
+
+const uint8_t *PongWsNext(PongWs *ws, size_t *size) {
+    if (ws->state == WS_HANDSHAKE) Handshake(ws);
+    while (ws->state == WS_OPEN) {
+        uint8_t *p = ws->in + ws->consumed;
+        size_t avail = ws->inSize - ws->consumed;
+        if (avail < 2) return NULL;
+        bool fin = p[0] & 0x80;
+        int opcode = p[0] & 0x0F;
+        bool masked = p[1] & 0x80;
+        uint64_t len = p[1] & 0x7F;
+        size_t h = 2;
+        if (len == 126) {
+            if (avail < 4) return NULL;
+            len = (uint64_t)p[2] << 8 | p[3];
+            h = 4;
+        } else if (len == 127) {
+            if (avail < 10) return NULL;
+            len = 0;
+            for (int i = 0; i < 8; i++) len = len << 8 | p[2 + i];
+            h = 10;
+        }
+        size_t maskAt = h;
+        if (masked) h += 4;
+        // RFC 6455 5.1: a server must close the connection on an unmasked client frame
+        if (!ws->isClient && !masked) {
+            ws->state = WS_CLOSED;
+            return NULL;
+        }
+        // Whole frames only: anything the input buffer cannot hold is not pong traffic
+        if (!fin || opcode == OP_CONTINUATION || len > sizeof(ws->in) - h) {
+            ws->state = WS_CLOSED;
+            return NULL;
+        }
+        if (avail < h + len) return NULL;
+        uint8_t *payload = p + h;
+        if (masked) {
+            for (size_t i = 0; i < len; i++) payload[i] ^= p[maskAt + (i & 3)];
+        }
+        ws->consumed += h + (size_t)len;
+
+        switch (opcode) {
+        case OP_BINARY:
+            *size = (size_t)len;
+            return payload;
+        case OP_PING:
+            SendFrame(ws, OP_PONG, payload, (size_t)len);
+            break;
+        case OP_CLOSE:
+            SendFrame(ws, OP_CLOSE, payload, len < 2 ? (size_t)len : 2);
+            ws->state = WS_CLOSED;
+            break;
+        default:
+            break;         // text and pongs
+        }
+    }
+    return NULL;
+}
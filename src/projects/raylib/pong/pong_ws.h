@@ -0,0 +1,50 @@
+// pong_ws.h
+// Just enough RFC 6455 WebSocket over non-blocking POSIX sockets for the pong server,
+// the soak test and the native game: the HTTP upgrade on both sides, unfragmented binary
+// messages, ping and close. Reading and writing never block; the owner polls fd and
+// calls PongWsRead/PongWsFlush when it is ready. Not built for the web, where the
+// browser's WebSocket does all of this.
+#ifndef PONG_WS_H
+#define PONG_WS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PONG_WS_IN_SIZE 4096
+#define PONG_WS_OUT_SIZE 16384
+
+typedef enum { WS_HANDSHAKE, WS_OPEN, WS_CLOSED } PongWsState;
+
+typedef struct PongWs {
+    int fd;
+    bool isClient;         // masks what it sends, checks the server's accept key
+    PongWsState state;
+    uint8_t in[PONG_WS_IN_SIZE];
+    size_t inSize, consumed;
+    uint8_t out[PONG_WS_OUT_SIZE];
+    size_t outSize;
+    char accept[32];       // client: the Sec-WebSocket-Accept it expects
+    uint32_t maskState;
+    uint64_t bytesIn, bytesOut;            // on the wire, frames and handshake included
+} PongWs;
+
+// A non-blocking listening socket on every interface, or -1
+int PongWsListen(int port);
+// Takes one pending connection; false when there is none
+bool PongWsAccept(int listenFd, PongWs *ws);
+// Connects (blocking) and queues the upgrade request; the socket is non-blocking after
+bool PongWsConnect(PongWs *ws, const char *host, int port);
+// Takes whatever the socket has; false once the connection is closed
+bool PongWsRead(PongWs *ws);
+// The next whole binary message, or NULL. Answers the handshake, pings and closes on the
+// way. The message stays valid until the next PongWsRead
+const uint8_t *PongWsNext(PongWs *ws, size_t *size);
+// Queues one binary message; false when the connection is not open or the queue is full
+bool PongWsSend(PongWs *ws, const uint8_t *msg, size_t size);
+// Writes what the socket takes; false once the connection is closed
+bool PongWsFlush(PongWs *ws);
+bool PongWsWantsWrite(const PongWs *ws);
+void PongWsClose(PongWs *ws);
+
+#endif // PONG_WS_H
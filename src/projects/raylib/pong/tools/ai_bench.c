@@ -0,0 +1,179 @@
+// ai_bench.c
+// Headless benchmark for the pong AI. Compares the closed-form landing predictor against
+// the bounce-by-bounce loop it replaced over a range of field widths and ball speeds, then
+// plays matches at every difficulty against a scripted bottom paddle.
+//
+//   ./ai_bench [--calls N] [--ticks N] [--seed N]
+//
+// "angle" is the ball's heading from the horizontal. "bounces" is the average number of
+// wall hits the loop had to walk; the fold does the same work for any count. "loop off"
+// is the share of calls where the loop lands more than a pixel from the fold: it returns
+// the ball's current x when the last bounce falls within 1 ms of the paddle. The match table reports the AI's cost per tick, how often it
+// actually predicted, and how many returns it missed.
+#include "pong_ai.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MATCH_HEIGHT 900
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// The per-frame prediction loop from the original UpdateAIPaddle
+static float LegacyPredictX(const GameState *game, const PongLayout *layout, float y, int *bounces) {
+    float timeToReach = fabsf(y - game->ball.y) / fabsf(game->ballVelocity.y);
+    float predictedX = game->ball.x;
+    float remainingTime = timeToReach;
+    float ballX = game->ball.x;
+    float ballVelX = game->ballVelocity.x;
+
+    while (remainingTime > 0.001f) {
+        float timeToWall = 0;
+        if (ballVelX > 0) {
+            timeToWall = (layout->width - layout->ballSize / 2.0f - ballX) / ballVelX;
+        } else if (ballVelX < 0) {
+            timeToWall = (ballX - layout->ballSize / 2.0f) / (-ballVelX);
+        } else {
+            timeToWall = remainingTime + 1.0f;
+        }
+
+        if (timeToWall > remainingTime || timeToWall <= 0) {
+            predictedX = ballX + ballVelX * remainingTime;
+            break;
+        } else {
+            ballX += ballVelX * timeToWall;
+            ballVelX = -ballVelX;
+            remainingTime -= timeToWall;
+            (*bounces)++;
+        }
+    }
+    return predictedX;
+}
+
+// Random balls heading up from the lower half of the field at BALL_SPEED, leaving at
+// angle degrees from the horizontal (shallower means more wall bounces on the way)
+static void MakeBalls(GameState *balls, int count, const PongLayout *layout, float angleDeg, GameState *rng) {
+    float r = layout->ballSize / 2.0f;
+    float speed = BALL_SPEED;
+    for (int i = 0; i < count; i++) {
+        float angle = angleDeg * (3.14159265f / 180.0f);
+        if (PongRandom(rng) & 1) angle = 3.14159265f - angle;
+        balls[i] = (GameState){0};
+        balls[i].ball.x = r + (float)PongRandomRange(rng, 1, 999) / 1000.0f * (layout->width - 2.0f * r);
+        balls[i].ball.y = layout->height * (0.5f + (float)PongRandomRange(rng, 0, 400) / 1000.0f);
+        balls[i].ballVelocity = (PongVec2){ cosf(angle) * speed, -sinf(angle) * speed };
+    }
+}
+
+static void BenchPredictors(int calls, uint64_t seed) {
+    static const int widths[] = { 320, 800, 1920 };
+    static const float angles[] = { 60.0f, 30.0f, 10.0f, 2.0f };
+    GameState *balls = malloc((size_t)calls * sizeof(GameState));
+    if (!balls) return;
+
+    printf("%-6s %-6s %9s %12s %12s %10s\n", "width", "angle", "bounces", "loop ns", "fold ns", "loop off");
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        PongLayout layout;
+        PongLayoutCompute(&layout, widths[w], MATCH_HEIGHT);
+        float faceY = layout.paddleMargin + layout.paddleHeight + layout.ballSize / 2.0f;
+
+        for (size_t a = 0; a < sizeof(angles) / sizeof(angles[0]); a++) {
+            GameState rng = { .rng = seed };
+            MakeBalls(balls, calls, &layout, angles[a], &rng);
+
+            int bounces = 0;
+            volatile float sink = 0;
+            double t0 = NowSeconds();
+            for (int i = 0; i < calls; i++) sink += LegacyPredictX(&balls[i], &layout, faceY, &bounces);
+            double loopSeconds = NowSeconds() - t0;
+
+            t0 = NowSeconds();
+            for (int i = 0; i < calls; i++) sink += PongPredictX(&balls[i], &layout, faceY);
+            double foldSeconds = NowSeconds() - t0;
+
+            int off = 0;
+            for (int i = 0; i < calls; i++) {
+                int unused = 0;
+                float diff = fabsf(LegacyPredictX(&balls[i], &layout, faceY, &unused) - PongPredictX(&balls[i], &layout, faceY));
+                if (diff > 1.0f) off++;
+            }
+            (void)sink;
+
+            printf("%-6d %-6.0f %9.1f %12.1f %12.1f %9.2f%%\n", widths[w], angles[a], (double)bounces / calls,
+                   loopSeconds * 1e9 / calls, foldSeconds * 1e9 / calls, 100.0 * off / calls);
+        }
+    }
+    free(balls);
+}
+
+// Bottom paddle that always gets to the ball, aiming off-centre so returns carry spin
+static void ScriptedBottom(GameState *game, const PongLayout *layout) {
+    float offset = sinf((float)game->approach * 1.7f) * 0.4f * layout->paddleWidth;
+    float x = game->ball.x - layout->paddleWidth / 2.0f + offset;
+    game->bottomPaddle.x = fmaxf(0, fminf(x, layout->width - layout->paddleWidth));
+}
+
+static void BenchMatches(int ticks, uint64_t seed) {
+    PongLayout layout;
+    PongLayoutCompute(&layout, 1280, MATCH_HEIGHT);
+
+    printf("\n%-7s %10s %12s %10s %10s %8s\n", "level", "ticks", "ai ns/tick", "approaches", "returns", "missed");
+    for (int level = 0; level < PONG_AI_LEVEL_COUNT; level++) {
+        GameState game;
+        PongInit(&game, &layout, seed);
+        PongAISetDifficulty(&game, PONG_TOP, (PongDifficulty)level);
+        game.gameStarted = true;
+
+        double aiSeconds = 0;
+        int returns = 0;
+        for (int t = 0; t < ticks; t++) {
+            double t0 = NowSeconds();
+            PongAIUpdate(&game, &layout, PONG_TOP, PONG_DT);
+            aiSeconds += NowSeconds() - t0;
+
+            game.topPaddle.x = fmaxf(0, fminf(game.topPaddle.x, layout.width - layout.paddleWidth));
+            ScriptedBottom(&game, &layout);
+
+            // A top return flips the ball downwards without a point being scored
+            float vy = game.ballVelocity.y;
+            int points = game.topScore + game.bottomScore;
+            PongStepBall(&game, &layout, PONG_DT);
+            if (vy < 0 && game.ballVelocity.y > 0 && game.topScore + game.bottomScore == points) returns++;
+            game.gameStarted = true;
+            game.tick++;
+        }
+
+        printf("%-7s %10d %12.1f %10u %10d %7.1f%%\n", pongAIProfiles[level].name, ticks, aiSeconds * 1e9 / ticks,
+               game.approach, returns, returns + game.bottomScore ? 100.0 * game.bottomScore / (returns + game.bottomScore) : 0.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    int calls = 1000000;
+    int ticks = 1000000;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--calls") == 0 && val) { calls = atoi(val); i++; }
+        else if (strcmp(arg, "--ticks") == 0 && val) { ticks = atoi(val); i++; }
+        else if (strcmp(arg, "--seed") == 0 && val) { seed = strtoull(val, NULL, 10); i++; }
+        else {
+            fprintf(stderr, "usage: %s [--calls N] [--ticks N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (calls < 1) calls = 1;
+    if (ticks < 1) ticks = 1;
+
+    BenchPredictors(calls, seed);
+    BenchMatches(ticks, seed);
+    return 0;
+}
@@ -0,0 +1,6 @@
+gcc -O2 -Wall -o ai_bench ai_bench.c ../pong_sim.c ../pong_ai.c -I.. -I../../common -lm
+gcc -O2 -Wall -pthread -o selfplay selfplay.c ../pong_sim.c ../pong_ai.c -I.. -I../../common -lm
+gcc -O2 -Wall -o replay replay.c ../pong_sim.c ../pong_ai.c ../pong_replay.c -I.. -I../../common -lm
+gcc -O2 -Wall -o pong_server pong_server.c ../pong_sim.c ../pong_ai.c ../pong_net.c ../pong_ws.c -I.. -I../../common -lm
+gcc -O2 -Wall -o net_soak net_soak.c ../pong_sim.c ../pong_ai.c ../pong_net.c ../pong_ws.c -I.. -I../../common -lm
+gcc -O2 -Wall -o chaos_bench chaos_bench.c ../pong_sim.c ../pong_ai.c ../pong_chaos.c -I.. -I../../common -lm
@@ -0,0 +1,107 @@
+// chaos_bench.c
+// Headless benchmark for chaos mode: steps PongChaos at a range of ball counts on the
+// standard 800x900 field, with both paddles sweeping back and forth, and reports the cost
+// per tick and ball-updates per second.
+//
+//   ./chaos_bench [--balls 1000,10000,50000] [--ticks N] [--seed N]
+//
+// "pairs/ball" is how many other balls the grid handed each ball to test, against the
+// count - 1 an all-pairs check would; "contacts" are the pairs that touched, per tick.
+// "budget" is the ball count one 120 Hz tick could hold in half of a 60 fps frame at the
+// measured rate, which is roughly what the browser has left after drawing.
+#include "pong_chaos.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_COUNTS 16
+#define WARMUP_TICKS 120
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void SweepPaddles(const PongLayout *layout, uint32_t tick, PongVec2 *top, PongVec2 *bottom) {
+    float travel = layout->width - layout->paddleWidth;
+    float phase = (float)tick / PONG_TICK_RATE;
+    top->x = travel * (0.5f + 0.5f * sinf(phase * 1.3f));
+    bottom->x = travel * (0.5f + 0.5f * sinf(phase * 0.9f + 1.0f));
+}
+
+int main(int argc, char **argv) {
+    int counts[MAX_COUNTS] = { 1000, 5000, 10000, 20000, 50000 };
+    int countCount = 5;
+    int ticks = 1200;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+        if (ok && strcmp(arg, "--ticks") == 0) ticks = atoi(val);
+        else if (ok && strcmp(arg, "--seed") == 0) seed = strtoull(val, NULL, 10);
+        else if (ok && strcmp(arg, "--balls") == 0) {
+            char list[256];
+            snprintf(list, sizeof(list), "%s", val);
+            countCount = 0;
+            for (char *tok = strtok(list, ","); tok && countCount < MAX_COUNTS; tok = strtok(NULL, ",")) {
+                counts[countCount++] = atoi(tok);
+            }
+            ok = countCount > 0;
+        } else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--balls 1000,10000,...] [--ticks N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (ticks < 1) ticks = 1;
+
+    PongLayout layout;
+    PongLayoutCompute(&layout, 800, 900);
+    printf("800x900 field, %d ticks per count, move pass: %s\n\n", ticks, PongChaosSimdName());
+    printf("%7s %10s %14s %11s %10s %12s %10s\n", "balls", "ms/tick", "updates/s", "pairs/ball", "contacts",
+           "paddle hits", "budget");
+
+    for (int k = 0; k < countCount; k++) {
+        PongChaos chaos;
+        if (!PongChaosInit(&chaos, counts[k], seed)) {
+            fprintf(stderr, "out of memory at %d balls\n", counts[k]);
+            return 1;
+        }
+        PongChaosResize(&chaos, &layout, counts[k]);
+        PongVec2 top = { 0, layout.paddleMargin };
+        PongVec2 bottom = { 0, layout.height - layout.paddleMargin - layout.paddleHeight };
+
+        // Let the spawn pattern spread out before timing
+        uint32_t tick = 0;
+        for (; tick < WARMUP_TICKS; tick++) {
+            SweepPaddles(&layout, tick, &top, &bottom);
+            PongChaosStep(&chaos, &layout, &top, &bottom, PONG_DT);
+        }
+
+        uint64_t pairs = 0, contacts = 0, hits = 0;
+        double t0 = NowSeconds();
+        for (int t = 0; t < ticks; t++, tick++) {
+            SweepPaddles(&layout, tick, &top, &bottom);
+            PongChaosStep(&chaos, &layout, &top, &bottom, PONG_DT);
+            pairs += chaos.pairsTested;
+            contacts += chaos.contacts;
+            hits += chaos.paddleHits;
+        }
+        double seconds = NowSeconds() - t0;
+
+        double perTick = seconds / ticks;
+        double updates = (double)chaos.count * ticks / seconds;
+        double budget = (1.0 / 60.0 / 2.0) / (2.0 * perTick / chaos.count);
+        printf("%7d %10.3f %13.1fM %11.2f %10.1f %12.2f %10.0f\n", chaos.count, perTick * 1000.0, updates / 1e6,
+               (double)pairs / ticks / chaos.count, (double)contacts / ticks, (double)hits / ticks, budget);
+        PongChaosFree(&chaos);
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+// net_soak.c
+// Load generator for pong_server: opens two WebSocket clients per match from one process
+// and plays them like the game does, through PongNetClient. Each bot predicts its paddle,
+// steers it at the interpolated ball 120 times a second and sends its inputs 60 times a
+// second, the rate the browser flushes at.
+//
+//   ./net_soak [--host H] [--port N] [--matches N] [--seconds N] [--ramp CLIENTS_PER_S]
+//
+// Reports, per client, the bytes per second both ways on the wire and as message
+// payloads, snapshots per second and how many went out whole, plus malformed messages, the
+// longest gap between two snapshots any bot saw and the largest correction a snapshot made
+// to a predicted paddle. Run pong_server alongside for the server-side CPU cost and
+// matches per core.
+#include "pong_net.h"
+#include "pong_ws.h"
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BOTS 2048
+#define SEND_EVERY_TICKS 2
+
+typedef struct Bot {
+    PongWs ws;
+    bool connected;
+    bool joinSent;
+    PongNetClient net;
+    double lastSnapshotMs;
+    double maxGapMs;
+    uint32_t malformed;
+    uint32_t matches;      // welcomes received
+} Bot;
+
+static Bot bots[MAX_BOTS];
+
+static double NowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+}
+
+// Serves when the ball is idle, otherwise chases it across the field
+static void Steer(Bot *bot, double nowMs, uint32_t tick) {
+    GameState view;
+    PongNetClientView(&bot->net, nowMs, &view);
+    const PongLayout *layout = &bot->net.layout;
+    PongInput input = { .difficulty = -1 };
+    input.start = !view.gameStarted && tick % PONG_TICK_RATE == 0;
+    input.hasTarget = true;
+    input.targetX = view.ball.x - layout->paddleWidth / 2.0f;
+    PongNetClientTick(&bot->net, &input);
+}
+
+static void Receive(Bot *bot, double nowMs) {
+    if (!PongWsRead(&bot->ws) && bot->ws.state == WS_CLOSED) return;
+    const uint8_t *msg;
+    size_t size;
+    while ((msg = PongWsNext(&bot->ws, &size)) != NULL) {
+        bool welcomed = bot->net.welcomed;
+        uint32_t snapshots = bot->net.stats.snapshots;
+        if (!PongNetClientReceive(&bot->net, msg, size, nowMs)) bot->malformed++;
+        if (bot->net.welcomed && !welcomed) {
+            bot->matches++;
+            bot->lastSnapshotMs = 0;
+        }
+        if (bot->net.stats.snapshots != snapshots) {
+            if (bot->lastSnapshotMs > 0 && nowMs - bot->lastSnapshotMs > bot->maxGapMs)
+                bot->maxGapMs = nowMs - bot->lastSnapshotMs;
+            bot->lastSnapshotMs = nowMs;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = PONG_NET_PORT;
+    int matchCount = 100;
+    double seconds = 30.0;
+    double ramp = 200.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+        if (ok && strcmp(arg, "--host") == 0) host = val;
+        else if (ok && strcmp(arg, "--port") == 0) port = atoi(val);
+        else if (ok && strcmp(arg, "--matches") == 0) matchCount = atoi(val);
+        else if (ok && strcmp(arg, "--seconds") == 0) seconds = atof(val);
+        else if (ok && strcmp(arg, "--ramp") == 0) ramp = atof(val);
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--host H] [--port N] [--matches N] [--seconds N] [--ramp CLIENTS_PER_S]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (matchCount < 1) matchCount = 1;
+    if (matchCount > MAX_BOTS / 2) matchCount = MAX_BOTS / 2;
+    if (ramp < 1.0) ramp = 1.0;
+    int botCount = matchCount * 2;
+
+    static struct pollfd fds[MAX_BOTS];
+    static int fdBot[MAX_BOTS];
+    const double period = 1000.0 / PONG_TICK_RATE;
+    double start = NowMs();
+    double rampEnd = start + botCount / ramp * 1000.0;
+    double measureFrom = rampEnd + 1000.0;     // a second for the last matches to settle
+    double end = measureFrom + seconds * 1000.0;
+    double nextTick = start;
+    uint32_t tick = 0;
+    int opened = 0, failed = 0;
+    uint64_t wireIn0 = 0, wireOut0 = 0, payloadIn0 = 0, payloadOut0 = 0, snapshots0 = 0, full0 = 0;
+    bool measuring = false;
+
+    printf("%d matches (%d clients) against ws://%s:%d, ramping at %.0f clients/s, measuring for %.0f s\n",
+           matchCount, botCount, host, port, ramp, seconds);
+    fflush(stdout);
+
+    for (double now = start; now < end; now = NowMs()) {
+        // Ramp up
+        int want = (int)((now - start) / 1000.0 * ramp) + 1;
+        if (want > botCount) want = botCount;
+        while (opened < want) {
+            Bot *bot = &bots[opened++];
+            PongNetClientInit(&bot->net);
+            bot->connected = PongWsConnect(&bot->ws, host, port);
+            if (!bot->connected) failed++;
+        }
+
+        int count = 0;
+        for (int b = 0; b < opened; b++) {
+            if (!bots[b].connected) continue;
+            fdBot[count] = b;
+            fds[count++] = (struct pollfd){ .fd = bots[b].ws.fd,
+                                            .events = (short)(POLLIN | (PongWsWantsWrite(&bots[b].ws) ? POLLOUT : 0)) };
+        }
+        int wait = (int)(nextTick - now);
+        poll(fds, (nfds_t)count, wait > 0 ? wait : 0);
+        now = NowMs();
+
+        for (int i = 0; i < count; i++) {
+            Bot *bot = &bots[fdBot[i]];
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) Receive(bot, now);
+            if (bot->ws.state == WS_OPEN && !bot->joinSent) {
+                uint8_t msg[4];
+                bot->joinSent = PongWsSend(&bot->ws, msg, PongNetWriteJoin(msg, sizeof(msg)));
+            }
+            if (bot->ws.state == WS_CLOSED) {
+                PongWsClose(&bot->ws);
+                bot->connected = false;
+                failed++;
+            }
+        }
+
+        while (now >= nextTick) {
+            bool send = ++tick % SEND_EVERY_TICKS == 0;
+            for (int b = 0; b < opened; b++) {
+                Bot *bot = &bots[b];
+                if (!bot->connected || !bot->net.welcomed) continue;
+                Steer(bot, now, tick);
+                if (send) {
+                    uint8_t msg[PONG_NET_MAX_MESSAGE];
+                    size_t size = PongNetClientFlush(&bot->net, msg, sizeof(msg), now);
+                    if (size) PongWsSend(&bot->ws, msg, size);
+                }
+            }
+            nextTick += period;
+        }
+        for (int b = 0; b < opened; b++) {
+            if (bots[b].connected && PongWsWantsWrite(&bots[b].ws)) PongWsFlush(&bots[b].ws);
+        }
+
+        if (!measuring && now >= measureFrom) {
+            measuring = true;
+            for (int b = 0; b < opened; b++) {
+                wireIn0 += bots[b].ws.bytesIn;
+                wireOut0 += bots[b].ws.bytesOut;
+                payloadIn0 += bots[b].net.stats.bytesIn;
+                payloadOut0 += bots[b].net.stats.bytesOut;
+                snapshots0 += bots[b].net.stats.snapshots;
+                full0 += bots[b].net.stats.fullSnapshots;
+                bots[b].maxGapMs = 0;
+            }
+        }
+    }
+
+    uint64_t wireIn = 0, wireOut = 0, payloadIn = 0, payloadOut = 0, snapshots = 0, full = 0;
+    uint32_t malformed = 0, playing = 0, rematches = 0;
+    double maxGap = 0;
+    float maxCorrection = 0;
+    for (int b = 0; b < opened; b++) {
+        const Bot *bot = &bots[b];
+        wireIn += bot->ws.bytesIn;
+        wireOut += bot->ws.bytesOut;
+        payloadIn += bot->net.stats.bytesIn;
+        payloadOut += bot->net.stats.bytesOut;
+        snapshots += bot->net.stats.snapshots;
+        full += bot->net.stats.fullSnapshots;
+        malformed += bot->malformed;
+        playing += bot->connected && bot->net.welcomed;
+        rematches += bot->matches > 1 ? bot->matches - 1 : 0;
+        if (bot->maxGapMs > maxGap) maxGap = bot->maxGapMs;
+        if (bot->net.stats.maxCorrection > maxCorrection) maxCorrection = bot->net.stats.maxCorrection;
+    }
+    double perClient = (double)botCount * seconds;
+    uint64_t measured = snapshots - snapshots0;
+    printf("clients playing %u of %d, connect failures or drops %d, rematches %u\n", playing, botCount, failed, rematches);
+    printf("per client: in %.0f B/s (payload %.0f), out %.0f B/s (payload %.0f), %.1f snapshots/s, %.2f B/snapshot\n",
+           (double)(wireIn - wireIn0) / perClient, (double)(payloadIn - payloadIn0) / perClient,
+           (double)(wireOut - wireOut0) / perClient, (double)(payloadOut - payloadOut0) / perClient,
+           (double)measured / perClient, measured ? (double)(payloadIn - payloadIn0) / (double)measured : 0.0);
+    printf("full snapshots %llu of %llu, malformed messages %u, longest snapshot gap %.1f ms, "
+           "largest prediction correction %.3f px\n",
+           (unsigned long long)(full - full0), (unsigned long long)measured, malformed, maxGap, maxCorrection);
+
+    for (int b = 0; b < opened; b++) {
+        if (bots[b].connected) PongWsClose(&bots[b].ws);
+    }
+    return malformed > 0;
+}
@@ -0,0 +1,403 @@
+// pong_server.c
+// Server for two-player online pong. One thread, one poll loop: every WebSocket client
+// that sends NET_JOIN waits for the next one and the two play a match, which the server
+// runs with PongStepVersus at PONG_TICK_RATE. Every PONG_NET_SNAPSHOT_TICKS each client
+// gets a snapshot delta-coded against the newest one it has acknowledged.
+//
+//   ./pong_server [--port N] [--stats SECONDS] [--seconds N] [--max-matches N]
+//
+// Every --stats seconds it prints the matches and clients it holds, its CPU use, the
+// simulation and encoding cost per match tick, and the bytes per client per second both
+// ways as they go on the wire (WebSocket framing included, TCP/IP headers not). From the
+// CPU use it estimates how many matches one core could host. --seconds stops it, for
+// scripted soak runs; net_soak is the load generator.
+#include "pong_net.h"
+#include "pong_ws.h"
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 2048
+#define INPUT_QUEUE 64                      // per client, by input seq
+#define MAX_BACKLOG 8                       // queued inputs beyond this are skipped
+#define MAX_CATCH_UP_TICKS (PONG_TICK_RATE / 4)
+
+typedef struct Client {
+    PongWs ws;
+    bool used;
+    bool joined;
+    int match;             // -1 when not in one
+    PongSide side;
+    PongNetStream stream;
+    uint32_t ackSeq;       // newest snapshot it holds
+    uint32_t applied;      // last input seq the simulation used
+    uint32_t received;     // newest input seq in the queue
+    PongInput queue[INPUT_QUEUE];
+    PongInput last;
+} Client;
+
+typedef struct Match {
+    bool used;
+    int clients[PONG_SIDE_COUNT];
+    uint8_t tag;           // sent in NET_WELCOME and echoed in every NET_INPUT
+    GameState game;
+    uint32_t seq;
+    PongSnapshot history[PONG_NET_HISTORY];
+} Match;
+
+typedef struct ServerStats {
+    uint64_t matchTicks;
+    double tickSeconds;    // in simulation and snapshot encoding
+    uint64_t snapshots, fullSnapshots, dropped;
+    uint64_t lateTicks;    // skipped when the loop fell too far behind
+    uint64_t retiredIn, retiredOut;        // wire bytes of clients already gone
+} ServerStats;
+
+static Client clients[MAX_CLIENTS];
+static Match *matches;
+static int maxMatches = 512;
+static int waiting = -1;
+static PongLayout layout;
+static uint64_t matchSeed = 1;          // also the source of match tags
+static ServerStats stats;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double CpuSeconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec * 1e-6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec * 1e-6;
+}
+
+static void Send(Client *c, const uint8_t *msg, size_t size) {
+    if (size == 0 || !PongWsSend(&c->ws, msg, size)) stats.dropped++;
+}
+
+//------------------------------------------------------------------------------------
+// Matches
+//------------------------------------------------------------------------------------
+static void Pair(int id);
+
+static void StartMatch(int top, int bottom) {
+    int m = 0;
+    while (m < maxMatches && matches[m].used) m++;
+    if (m == maxMatches) {
+        waiting = top;     // full: bottom stays unpaired until a match ends
+        return;
+    }
+    Match *match = &matches[m];
+    *match = (Match){ .used = true, .clients = { top, bottom }, .tag = (uint8_t)matchSeed };
+    PongInit(&match->game, &layout, matchSeed++);
+
+    const int ids[PONG_SIDE_COUNT] = { top, bottom };
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        Client *c = &clients[ids[side]];
+        c->match = m;
+        c->side = (PongSide)side;
+        c->stream = (PongNetStream){0};
+        c->ackSeq = c->applied = c->received = 0;
+        c->last = (PongInput){ .difficulty = -1 };
+        uint8_t msg[16];
+        Send(c, msg, PongNetWriteWelcome(msg, sizeof(msg), (PongSide)side, match->tag, (int)layout.width, (int)layout.height));
+    }
+}
+
+static void Pair(int id) {
+    if (waiting >= 0 && waiting != id && clients[waiting].used) {
+        int other = waiting;
+        waiting = -1;
+        StartMatch(other, id);
+    } else {
+        waiting = id;
+    }
+}
+
+static void EndMatch(int m, int leaving) {
+    Match *match = &matches[m];
+    match->used = false;
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        int id = match->clients[side];
+        Client *c = &clients[id];
+        c->match = -1;
+        if (id == leaving) continue;
+        uint8_t msg[1] = { NET_OPPONENT_LEFT };
+        Send(c, msg, 1);
+        Pair(id);
+    }
+    if (waiting >= 0 && clients[waiting].match < 0) {
+        // A client left waiting by a full server gets the freed match
+        for (int id = 0; id < MAX_CLIENTS; id++) {
+            if (id != waiting && clients[id].used && clients[id].joined && clients[id].match < 0) {
+                int other = waiting;
+                waiting = -1;
+                StartMatch(other, id);
+                break;
+            }
+        }
+    }
+}
+
+// The client's input for the next tick: the next one it sent, or its last one again (minus
+// the serve) when it has not arrived
+static PongInput NextInput(Client *c) {
+    if (c->received > c->applied + MAX_BACKLOG) c->applied = c->received - MAX_BACKLOG;
+    if (c->received > c->applied) {
+        c->applied++;
+        c->last = c->queue[c->applied % INPUT_QUEUE];
+        return c->last;
+    }
+    PongInput repeat = c->last;
+    repeat.start = false;
+    return repeat;
+}
+
+static void TickMatch(Match *match) {
+    PongInput inputs[PONG_SIDE_COUNT];
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) inputs[side] = NextInput(&clients[match->clients[side]]);
+    PongStepVersus(&match->game, &layout, inputs, PONG_DT);
+    stats.matchTicks++;
+    if (match->game.tick % PONG_NET_SNAPSHOT_TICKS != 0) return;
+
+    PongSnapshot *s = &match->history[++match->seq % PONG_NET_HISTORY];
+    PongSnapshotCapture(s, &match->game, match->seq);
+    for (int side = 0; side < PONG_SIDE_COUNT; side++) {
+        Client *c = &clients[match->clients[side]];
+        const PongSnapshot *base = &match->history[c->ackSeq % PONG_NET_HISTORY];
+        if (c->ackSeq == 0 || base->seq != c->ackSeq || match->seq - c->ackSeq >= PONG_NET_HISTORY) base = NULL;
+        uint8_t msg[PONG_NET_MAX_MESSAGE];
+        size_t size = PongSnapshotEncode(s, base, c->applied, &c->stream, msg, sizeof(msg));
+        if (size && PongWsSend(&c->ws, msg, size)) {
+            c->stream.lastSeq = s->seq;
+            c->stream.lastAck = c->applied;
+            stats.snapshots++;
+            if (!base) stats.fullSnapshots++;
+        } else {
+            stats.dropped++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Clients
+//------------------------------------------------------------------------------------
+static void Drop(int id) {
+    Client *c = &clients[id];
+    stats.retiredIn += c->ws.bytesIn;
+    stats.retiredOut += c->ws.bytesOut;
+    PongWsClose(&c->ws);
+    c->used = false;
+    if (waiting == id) waiting = -1;
+    if (c->match >= 0) EndMatch(c->match, id);
+}
+
+static void Handle(int id, const uint8_t *msg, size_t size) {
+    Client *c = &clients[id];
+    switch (msg[0]) {
+    case NET_JOIN:
+        if (size < 2 || msg[1] != PONG_NET_VERSION) {
+            c->ws.state = WS_CLOSED;
+        } else if (!c->joined) {
+            c->joined = true;
+            Pair(id);
+        }
+        break;
+    case NET_INPUT: {
+        PongNetInputs in;
+        if (c->match < 0 || !PongNetReadInputs(msg, size, c->received + 1, matches[c->match].seq, &in) ||
+            in.match != matches[c->match].tag) break;
+        if (in.ackSeq > c->ackSeq && in.ackSeq <= matches[c->match].seq) c->ackSeq = in.ackSeq;
+        // A gap means the client skipped ahead; the server follows
+        if (in.firstSeq > c->received + 1) c->applied = c->received = in.firstSeq - 1;
+        for (int i = 0; i < in.count; i++) {
+            uint32_t seq = in.firstSeq + (uint32_t)i;
+            if (seq <= c->received) continue;
+            c->queue[seq % INPUT_QUEUE] = in.inputs[i];
+            c->received = seq;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void Accept(int listenFd) {
+    for (;;) {
+        int id = 0;
+        while (id < MAX_CLIENTS && clients[id].used) id++;
+        PongWs scratch;
+        PongWs *ws = id < MAX_CLIENTS ? &clients[id].ws : &scratch;
+        if (!PongWsAccept(listenFd, ws)) return;
+        if (id == MAX_CLIENTS) {
+            PongWsClose(ws);
+            continue;
+        }
+        clients[id] = (Client){ .ws = clients[id].ws, .used = true, .match = -1 };
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Stats
+//------------------------------------------------------------------------------------
+static void PrintStats(double elapsed, double window, double cpu, const ServerStats *prev,
+                       uint64_t wireIn, uint64_t wireOut) {
+    int matchCount = 0, clientCount = 0;
+    for (int m = 0; m < maxMatches; m++) matchCount += matches[m].used;
+    for (int id = 0; id < MAX_CLIENTS; id++) clientCount += clients[id].used;
+
+    uint64_t ticks = stats.matchTicks - prev->matchTicks;
+    uint64_t snapshots = stats.snapshots - prev->snapshots;
+    double usPerTick = ticks ? (stats.tickSeconds - prev->tickSeconds) * 1e6 / (double)ticks : 0.0;
+    double cpuShare = cpu / window;
+    // With everyone gone the window's traffic belongs to nobody still here: no per-client rate
+    char perClient[64] = "per client -";
+    if (clientCount > 0)
+        snprintf(perClient, sizeof(perClient), "per client in %6.0f B/s out %6.0f B/s",
+                 (double)wireIn / (window * clientCount), (double)wireOut / (window * clientCount));
+    // A core spends cpuShare on matchCount matches; everything it does scales with matches
+    double perCore = cpuShare > 0 && matchCount ? matchCount / cpuShare : 0.0;
+    printf("%6.0fs  matches %4d  clients %4d  cpu %5.1f%%  %5.2f us/match-tick  "
+           "%s  full %4.1f%%  dropped %llu  late %llu  ~%.0f matches/core\n",
+           elapsed, matchCount, clientCount, cpuShare * 100.0, usPerTick, perClient,
+           snapshots ? 100.0 * (double)(stats.fullSnapshots - prev->fullSnapshots) / (double)snapshots : 0.0,
+           (unsigned long long)(stats.dropped - prev->dropped), (unsigned long long)(stats.lateTicks - prev->lateTicks),
+           perCore);
+    fflush(stdout);
+}
+
+static void WireTotals(uint64_t *in, uint64_t *out) {
+    *in = stats.retiredIn;
+    *out = stats.retiredOut;
+    for (int id = 0; id < MAX_CLIENTS; id++) {
+        if (!clients[id].used) continue;
+        *in += clients[id].ws.bytesIn;
+        *out += clients[id].ws.bytesOut;
+    }
+}
+
+int main(int argc, char **argv) {
+    int port = PONG_NET_PORT;
+    double statsEvery = 5.0;
+    double runFor = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+        if (ok && strcmp(arg, "--port") == 0) port = atoi(val);
+        else if (ok && strcmp(arg, "--stats") == 0) statsEvery = atof(val);
+        else if (ok && strcmp(arg, "--seconds") == 0) runFor = atof(val);
+        else if (ok && strcmp(arg, "--max-matches") == 0) maxMatches = atoi(val);
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--port N] [--stats SECONDS] [--seconds N] [--max-matches N]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (maxMatches < 1) maxMatches = 1;
+    if (maxMatches > MAX_CLIENTS / 2) maxMatches = MAX_CLIENTS / 2;
+    if (statsEvery < 0.5) statsEvery = 0.5;
+
+    int listenFd = PongWsListen(port);
+    if (listenFd < 0) {
+        fprintf(stderr, "cannot listen on port %d\n", port);
+        return 1;
+    }
+    matches = calloc((size_t)maxMatches, sizeof(Match));
+    PongLayoutCompute(&layout, PONG_NET_FIELD_WIDTH, PONG_NET_FIELD_HEIGHT);
+    printf("listening on ws://0.0.0.0:%d, %d Hz, a snapshot every %d ticks, up to %d matches\n", port,
+           PONG_TICK_RATE, PONG_NET_SNAPSHOT_TICKS, maxMatches);
+    fflush(stdout);
+
+    static struct pollfd fds[MAX_CLIENTS + 1];
+    static int fdClient[MAX_CLIENTS + 1];
+    const double period = 1.0 / PONG_TICK_RATE;
+    double start = NowSeconds();
+    double nextTick = start, nextStats = start + statsEvery;
+    double statsAt = start, cpuAt = CpuSeconds();
+    ServerStats prev = stats;
+    uint64_t prevIn = 0, prevOut = 0;
+
+    while (runFor <= 0 || NowSeconds() - start < runFor) {
+        int count = 0;
+        fds[count++] = (struct pollfd){ .fd = listenFd, .events = POLLIN };
+        for (int id = 0; id < MAX_CLIENTS; id++) {
+            if (!clients[id].used) continue;
+            fdClient[count] = id;
+            fds[count++] = (struct pollfd){ .fd = clients[id].ws.fd,
+                                            .events = (short)(POLLIN | (PongWsWantsWrite(&clients[id].ws) ? POLLOUT : 0)) };
+        }
+        int wait = (int)((nextTick - NowSeconds()) * 1000.0);
+        poll(fds, (nfds_t)count, wait > 0 ? wait : 0);
+
+        if (fds[0].revents & POLLIN) Accept(listenFd);
+        for (int i = 1; i < count; i++) {
+            int id = fdClient[i];
+            Client *c = &clients[id];
+            if (!c->used) continue;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                PongWsRead(&c->ws);
+                const uint8_t *msg;
+                size_t size;
+                while (c->used && (msg = PongWsNext(&c->ws, &size)) != NULL) {
+                    if (size > 0) Handle(id, msg, size);
+                }
+            }
+            if (c->ws.state == WS_CLOSED) {
+                PongWsFlush(&c->ws);       // a close frame or refusal, best effort
+                Drop(id);
+            }
+        }
+
+        // Fixed-rate ticks; a stall longer than MAX_CATCH_UP_TICKS is skipped, not replayed
+        double now = NowSeconds();
+        if (now - nextTick > MAX_CATCH_UP_TICKS * period) {
+            uint64_t behind = (uint64_t)((now - nextTick) / period);
+            stats.lateTicks += behind;
+            nextTick += (double)behind * period;
+        }
+        while (now >= nextTick) {
+            double t0 = NowSeconds();
+            for (int m = 0; m < maxMatches; m++) {
+                if (matches[m].used) TickMatch(&matches[m]);
+            }
+            stats.tickSeconds += NowSeconds() - t0;
+            nextTick += period;
+        }
+
+        for (int id = 0; id < MAX_CLIENTS; id++) {
+            if (clients[id].used && PongWsWantsWrite(&clients[id].ws) && !PongWsFlush(&clients[id].ws)) Drop(id);
+        }
+
+        if (now >= nextStats) {
+            double cpu = CpuSeconds();
+            uint64_t wireIn, wireOut;
+            WireTotals(&wireIn, &wireOut);
+            PrintStats(now - start, now - statsAt, cpu - cpuAt, &prev, wireIn - prevIn, wireOut - prevOut);
+            prev = stats;
+            prevIn = wireIn;
+            prevOut = wireOut;
+            statsAt = now;
+            cpuAt = cpu;
+            nextStats += statsEvery;
+        }
+    }
+
+    for (int id = 0; id < MAX_CLIENTS; id++) {
+        if (clients[id].used) PongWsClose(&clients[id].ws);
+    }
+    close(listenFd);
+    free(matches);
+    return 0;
+}
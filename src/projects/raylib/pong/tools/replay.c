@@ -0,0 +1,219 @@
+// replay.c
+// Headless player for pong input recordings (see pong_replay.h). Replays a session,
+// checks it ends in the recorded state and reports the replay speed. With --rollback it
+// replays the session again as a laggy client would see it: a --drop share of the ticks
+// get their input --rollback ticks late, run on a guess (the last input that arrived in
+// time) and are corrected by rolling back and re-simulating. The end state must still
+// match.
+//
+//   ./replay FILE [--rollback TICKS] [--drop 0.2] [--seed N]
+//   ./replay --make FILE [--ticks N] [--seed N]
+//
+// --make writes a synthetic session (mouse drags, key runs, difficulty switches and
+// resizes) so the tools can be exercised without a browser recording.
+#include "pong_replay.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct LateInput {
+    uint32_t tick;
+    uint32_t due;
+    PongInput input;
+} LateInput;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint8_t *ReadFile(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *bytes = length > 0 ? malloc((size_t)length) : NULL;
+    if (bytes && fread(bytes, 1, (size_t)length, f) != (size_t)length) {
+        free(bytes);
+        bytes = NULL;
+    }
+    fclose(f);
+    *size = bytes ? (size_t)length : 0;
+    return bytes;
+}
+
+static int MakeSession(const char *path, uint32_t ticks, uint64_t seed) {
+    static const int sizes[][2] = { { 800, 900 }, { 1280, 720 }, { 390, 844 } };
+    PongLayout layout;
+    PongLayoutCompute(&layout, sizes[0][0], sizes[0][1]);
+    GameState game;
+    PongInit(&game, &layout, seed);
+
+    // Scripted player input comes from its own stream, never the game's
+    GameState player = { .rng = seed ^ 0xA5A5A5A5A5A5A5A5ULL };
+    PongRecorder recorder = {0};
+    PongRecorderBegin(&recorder, &game, &layout);
+
+    int keyRun = 0;
+    bool keyLeft = false;
+    for (uint32_t t = 0; t < ticks; t++) {
+        if (t > 0 && t % 20000 == 0) {
+            int s = (int)(t / 20000) % 3;
+            PongLayoutCompute(&layout, sizes[s][0], sizes[s][1]);
+        }
+
+        PongInput input = { .difficulty = -1 };
+        input.start = !game.gameStarted && PongRandomRange(&player, 0, 59) == 0;
+        if (t % 9000 == 4500) input.difficulty = PongRandomRange(&player, 0, PONG_AI_LEVEL_COUNT - 1);
+        if (keyRun > 0) {
+            keyRun--;
+            input.left = keyLeft;
+            input.right = !keyLeft;
+        } else if (PongRandomRange(&player, 0, 299) == 0) {
+            keyRun = PongRandomRange(&player, 30, 240);
+            keyLeft = PongRandom(&player) & 1;
+        } else if (t % 2 == 0 && game.ballVelocity.y > 0) {
+            // The mouse updates every other tick while the ball comes down
+            float offset = sinf((float)game.approach * 1.3f) * 0.35f * layout.paddleWidth;
+            input.targetX = game.ball.x - layout.paddleWidth / 2.0f + offset;
+            input.hasTarget = true;
+        }
+
+        PongRecorderTick(&recorder, &game, &layout, &input);
+        PongStep(&game, &layout, &input, PONG_DT);
+    }
+    PongRecorderFinish(&recorder, &game);
+
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(recorder.bytes, 1, recorder.size, f) != recorder.size) {
+        fprintf(stderr, "cannot write %s\n", path);
+        if (f) fclose(f);
+        PongRecorderFree(&recorder);
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %u ticks, %zu bytes (%.2f bytes/tick after the %zu-byte header), score %d-%d\n", path,
+           recorder.ticks, recorder.size, (double)(recorder.size - sizeof(PongRecordingHeader)) / recorder.ticks,
+           sizeof(PongRecordingHeader), game.topScore, game.bottomScore);
+    PongRecorderFree(&recorder);
+    return 0;
+}
+
+static bool Replay(const uint8_t *bytes, size_t size) {
+    PongReplay replay;
+    GameState game;
+    PongLayout layout;
+    if (!PongReplayBegin(&replay, bytes, size, &game, &layout)) {
+        fprintf(stderr, "not a recording this build can play\n");
+        return false;
+    }
+
+    double t0 = NowSeconds();
+    while (PongReplayStep(&replay, &game, &layout)) {}
+    double seconds = NowSeconds() - t0;
+
+    bool ok = replay.tick == replay.ticks && PongReplayMatches(&replay, &game);
+    printf("replay:   %u/%u ticks in %.3f s (%.0f ticks/s, %.0fx real time), score %d-%d, %s\n", replay.tick,
+           replay.ticks, seconds, replay.tick / seconds, replay.tick / seconds / PONG_TICK_RATE,
+           game.topScore, game.bottomScore, ok ? "end state matches" : "END STATE DIFFERS");
+    return ok;
+}
+
+static bool ReplayWithRollback(const uint8_t *bytes, size_t size, int delay, float drop, uint64_t seed) {
+    static PongHistory history;
+    static LateInput late[PONG_ROLLBACK_TICKS];
+    PongReplay replay;
+    GameState game;
+    PongLayout layout;
+    if (!PongReplayBegin(&replay, bytes, size, &game, &layout)) return false;
+    PongHistoryReset(&history);
+
+    GameState net = { .rng = seed };
+    int lateCount = 0, head = 0;
+    uint64_t rollbacks = 0, failed = 0;
+    PongInput lastKnown = { .difficulty = -1 };
+    PongInput input;
+    double t0 = NowSeconds();
+    for (;;) {
+        // Late inputs due by now replace the guesses they were simulated with
+        while (lateCount > 0 && late[head].due <= game.tick) {
+            if (PongHistoryCorrect(&history, &game, late[head].tick, &late[head].input, PONG_DT)) rollbacks++;
+            else failed++;
+            head = (head + 1) % PONG_ROLLBACK_TICKS;
+            lateCount--;
+        }
+        if (!PongReplayNext(&replay, &layout, &input)) break;
+
+        bool isLate = lateCount < PONG_ROLLBACK_TICKS && (float)(PongRandom(&net) % 10000) < drop * 10000.0f;
+        if (isLate) {
+            late[(head + lateCount) % PONG_ROLLBACK_TICKS] = (LateInput){ game.tick, game.tick + (uint32_t)delay, input };
+            lateCount++;
+            PongHistoryStep(&history, &game, &layout, &lastKnown, PONG_DT);
+        } else {
+            lastKnown = input;
+            PongHistoryStep(&history, &game, &layout, &input, PONG_DT);
+        }
+    }
+    // Whatever is still in flight arrives after the last tick
+    for (; lateCount > 0; lateCount--, head = (head + 1) % PONG_ROLLBACK_TICKS) {
+        if (PongHistoryCorrect(&history, &game, late[head].tick, &late[head].input, PONG_DT)) rollbacks++;
+        else failed++;
+    }
+    double seconds = NowSeconds() - t0;
+
+    bool ok = failed == 0 && replay.tick == replay.ticks && PongReplayMatches(&replay, &game);
+    printf("rollback: %d-tick delay on %.0f%% of ticks: %llu rollbacks, %llu ticks re-simulated "
+           "(%.2f per tick), %.3f s, %s\n", delay, drop * 100.0f, (unsigned long long)rollbacks,
+           (unsigned long long)history.resimulated, (double)history.resimulated / replay.tick, seconds,
+           ok ? "end state matches" : "END STATE DIFFERS");
+    printf("          snapshot: %zu bytes per tick, %zu-byte window\n", sizeof(GameState),
+           sizeof(PongHistory));
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    const char *makePath = NULL;
+    uint32_t ticks = 120 * 60 * 10;
+    uint64_t seed = 1;
+    int delay = 0;
+    float drop = 0.2f;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--make") == 0 && val) { makePath = val; i++; }
+        else if (strcmp(arg, "--ticks") == 0 && val) { ticks = (uint32_t)strtoul(val, NULL, 10); i++; }
+        else if (strcmp(arg, "--seed") == 0 && val) { seed = strtoull(val, NULL, 10); i++; }
+        else if (strcmp(arg, "--rollback") == 0 && val) { delay = atoi(val); i++; }
+        else if (strcmp(arg, "--drop") == 0 && val) { drop = strtof(val, NULL); i++; }
+        else if (arg[0] != '-' && !path) path = arg;
+        else {
+            fprintf(stderr, "usage: %s FILE [--rollback TICKS] [--drop 0.2] [--seed N]\n"
+                            "       %s --make FILE [--ticks N] [--seed N]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (makePath) return MakeSession(makePath, ticks, seed);
+    if (!path) {
+        fprintf(stderr, "no recording given\n");
+        return 1;
+    }
+    if (delay < 0) delay = 0;
+    if (delay >= PONG_ROLLBACK_TICKS) delay = PONG_ROLLBACK_TICKS - 1;
+
+    size_t size;
+    uint8_t *bytes = ReadFile(path, &size);
+    if (!bytes) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    bool ok = Replay(bytes, size);
+    if (ok && delay > 0) ok = ReplayWithRollback(bytes, size, delay, drop, seed);
+    free(bytes);
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,255 @@
+// selfplay.c
+// Headless AI-vs-AI pong on the same PongStep the browser runs. Plays rallies across
+// threads, each thread on its own seed stream, once per top-AI prediction error setting,
+// and reports throughput, hit rates and the distribution of final game scores.
+//
+//   ./selfplay [--rallies N] [--threads N] [--errors 0,0.05,0.15,0.25]
+//              [--opponent easy|normal|hard] [--points N] [--size WxH] [--seed N]
+//
+// The bottom AI plays the --opponent profile unchanged; the top AI plays the same
+// profile with its prediction error replaced by each --errors value. Games run to
+// --points; "top score" is the share of games the top AI finished with each score.
+// A rally longer than two minutes of game time is abandoned and counted as stalled.
+#include "pong_ai.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define MAX_THREADS 64
+#define MAX_ERRORS 16
+#define MAX_POINTS 21
+#define MAX_RALLY_HITS 1024                 // histogram size; longer rallies land in the last bucket
+#define MAX_RALLY_TICKS (PONG_TICK_RATE * 120)
+
+typedef struct RunConfig {
+    PongLayout layout;
+    PongDifficulty opponent;
+    float predictionError;
+    int points;
+} RunConfig;
+
+typedef struct Tally {
+    uint64_t rallies;
+    uint64_t ticks;
+    uint64_t hits[PONG_SIDE_COUNT];
+    uint64_t misses[PONG_SIDE_COUNT];
+    uint64_t stalled;
+    uint64_t games;
+    uint64_t topWins;
+    uint64_t topScore[MAX_POINTS + 1];     // games by the top AI's final score
+    uint64_t rallyHits[MAX_RALLY_HITS];
+} Tally;
+
+typedef struct Worker {
+    pthread_t thread;
+    bool running;
+    const RunConfig *config;
+    uint64_t rallies;
+    uint64_t seed;
+    Tally tally;
+} Worker;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Well-spread, independent seeds for neighbouring stream indices
+static uint64_t SplitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void NewGame(GameState *game, const RunConfig *config, uint64_t rng) {
+    PongInit(game, &config->layout, rng);
+    PongAISetDifficulty(game, PONG_TOP, config->opponent);
+    PongAISetDifficulty(game, PONG_BOTTOM, config->opponent);
+    game->ai[PONG_TOP].predictionError = config->predictionError;
+}
+
+static void *PlayRallies(void *arg) {
+    Worker *w = arg;
+    const RunConfig *config = w->config;
+    const PongLayout *layout = &config->layout;
+    Tally *tally = &w->tally;
+    PongInput input = { .start = true, .difficulty = -1, .bottomAI = true };
+
+    GameState game;
+    NewGame(&game, config, w->seed);
+    int rallyHits = 0;
+    int rallyTicks = 0;
+
+    while (tally->rallies < w->rallies) {
+        uint32_t approach = game.approach;
+        int topScore = game.topScore;
+        int bottomScore = game.bottomScore;
+        PongStep(&game, layout, &input, PONG_DT);
+        tally->ticks++;
+        rallyTicks++;
+
+        bool point = game.topScore != topScore || game.bottomScore != bottomScore;
+        if (!point && game.approach != approach) {
+            // The ball leaves a paddle moving away from it
+            tally->hits[game.ballVelocity.y > 0 ? PONG_TOP : PONG_BOTTOM]++;
+            rallyHits++;
+        }
+        if (!point && rallyTicks < MAX_RALLY_TICKS) continue;
+
+        if (point) {
+            tally->misses[game.bottomScore != bottomScore ? PONG_TOP : PONG_BOTTOM]++;
+        } else {
+            tally->stalled++;
+            PongResetBall(&game, layout);
+        }
+        tally->rallies++;
+        tally->rallyHits[rallyHits < MAX_RALLY_HITS ? rallyHits : MAX_RALLY_HITS - 1]++;
+        rallyHits = 0;
+        rallyTicks = 0;
+
+        if (game.topScore >= config->points || game.bottomScore >= config->points) {
+            tally->games++;
+            tally->topWins += game.topScore > game.bottomScore;
+            tally->topScore[game.topScore]++;
+            NewGame(&game, config, game.rng);
+        }
+    }
+    return NULL;
+}
+
+static double Percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static int RallyPercentile(const Tally *t, double p) {
+    uint64_t want = (uint64_t)(p * (double)t->rallies);
+    uint64_t seen = 0;
+    for (int i = 0; i < MAX_RALLY_HITS; i++) {
+        seen += t->rallyHits[i];
+        if (seen > want) return i;
+    }
+    return MAX_RALLY_HITS - 1;
+}
+
+static bool ParseDifficulty(const char *name, PongDifficulty *out) {
+    for (int level = 0; level < PONG_AI_LEVEL_COUNT; level++) {
+        if (strcasecmp(name, pongAIProfiles[level].name) == 0) {
+            *out = (PongDifficulty)level;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    uint64_t rallies = 1000000;
+    int threads = 4;
+    float errors[MAX_ERRORS] = { 0.0f, 0.05f, 0.15f, 0.25f };
+    int errorCount = 4;
+    PongDifficulty opponent = PONG_AI_NORMAL;
+    int points = 11;
+    int width = 800, height = 900;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+        if (ok && strcmp(arg, "--rallies") == 0) rallies = strtoull(val, NULL, 10);
+        else if (ok && strcmp(arg, "--threads") == 0) threads = atoi(val);
+        else if (ok && strcmp(arg, "--points") == 0) points = atoi(val);
+        else if (ok && strcmp(arg, "--seed") == 0) seed = strtoull(val, NULL, 10);
+        else if (ok && strcmp(arg, "--size") == 0) ok = sscanf(val, "%dx%d", &width, &height) == 2;
+        else if (ok && strcmp(arg, "--opponent") == 0) ok = ParseDifficulty(val, &opponent);
+        else if (ok && strcmp(arg, "--errors") == 0) {
+            char list[256];
+            snprintf(list, sizeof(list), "%s", val);
+            errorCount = 0;
+            for (char *tok = strtok(list, ","); tok && errorCount < MAX_ERRORS; tok = strtok(NULL, ",")) {
+                errors[errorCount++] = strtof(tok, NULL);
+            }
+            ok = errorCount > 0;
+        } else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--rallies N] [--threads N] [--errors 0,0.05,...] "
+                            "[--opponent easy|normal|hard] [--points N] [--size WxH] [--seed N]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (points < 1) points = 1;
+    if (points > MAX_POINTS) points = MAX_POINTS;
+    if (width < 64) width = 64;
+    if (height < 64) height = 64;
+    if (rallies < (uint64_t)threads) rallies = (uint64_t)threads;
+
+    printf("%d threads, %dx%d, opponent %s, games to %d\n\n", threads, width, height,
+           pongAIProfiles[opponent].name, points);
+    printf("%-6s %10s %11s %8s %8s %8s %7s %7s %7s %8s\n", "error", "rallies", "rallies/s",
+           "top hit", "bot hit", "top win", "hits", "p50", "p99", "stalled");
+
+    static Worker workers[MAX_THREADS];
+    static Tally totals[MAX_ERRORS];
+    for (int e = 0; e < errorCount; e++) {
+        RunConfig config = { .opponent = opponent, .predictionError = errors[e], .points = points };
+        PongLayoutCompute(&config.layout, width, height);
+
+        double t0 = NowSeconds();
+        for (int t = 0; t < threads; t++) {
+            Worker *w = &workers[t];
+            *w = (Worker){ .config = &config };
+            w->rallies = rallies / (uint64_t)threads + ((uint64_t)t < rallies % (uint64_t)threads);
+            w->seed = SplitMix64(seed + (uint64_t)e * MAX_THREADS + (uint64_t)t);
+            w->running = pthread_create(&w->thread, NULL, PlayRallies, w) == 0;
+            if (!w->running) PlayRallies(w);    // run inline rather than drop the stream
+        }
+        for (int t = 0; t < threads; t++) {
+            if (workers[t].running) pthread_join(workers[t].thread, NULL);
+        }
+        double seconds = NowSeconds() - t0;
+
+        Tally *sum = &totals[e];
+        *sum = (Tally){0};
+        for (int t = 0; t < threads; t++) {
+            const Tally *tally = &workers[t].tally;
+            sum->rallies += tally->rallies;
+            sum->ticks += tally->ticks;
+            sum->stalled += tally->stalled;
+            sum->games += tally->games;
+            sum->topWins += tally->topWins;
+            for (int s = 0; s < PONG_SIDE_COUNT; s++) {
+                sum->hits[s] += tally->hits[s];
+                sum->misses[s] += tally->misses[s];
+            }
+            for (int p = 0; p <= MAX_POINTS; p++) sum->topScore[p] += tally->topScore[p];
+            for (int h = 0; h < MAX_RALLY_HITS; h++) sum->rallyHits[h] += tally->rallyHits[h];
+        }
+
+        uint64_t totalHits = sum->hits[PONG_TOP] + sum->hits[PONG_BOTTOM];
+        printf("%-6.3f %10llu %11.0f %7.1f%% %7.1f%% %7.1f%% %7.2f %7d %7d %8llu\n", errors[e],
+               (unsigned long long)sum->rallies, (double)sum->rallies / seconds,
+               Percent(sum->hits[PONG_TOP], sum->hits[PONG_TOP] + sum->misses[PONG_TOP]),
+               Percent(sum->hits[PONG_BOTTOM], sum->hits[PONG_BOTTOM] + sum->misses[PONG_BOTTOM]),
+               Percent(sum->topWins, sum->games), (double)totalHits / (double)sum->rallies,
+               RallyPercentile(sum, 0.5), RallyPercentile(sum, 0.99), (unsigned long long)sum->stalled);
+    }
+
+    // Final score distribution of the top AI, one row per error setting
+    printf("\ntop score");
+    for (int p = 0; p <= points; p++) printf(" %5d", p);
+    printf("\n");
+    for (int e = 0; e < errorCount; e++) {
+        printf("%-9.3f", errors[e]);
+        for (int p = 0; p <= points; p++) printf(" %4.1f%%", Percent(totals[e].topScore[p], totals[e].games));
+        printf("\n");
+    }
+    return 0;
+}